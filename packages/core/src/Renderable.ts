@@ -4,6 +4,8 @@ import { OptimizedBuffer } from "./buffer"
 import type { KeyEvent, PasteEvent } from "./lib/KeyHandler"
 import type { MouseEventType } from "./lib/parse.mouse"
 import type { Selection } from "./lib/selection"
+import { mergeDamageRects, rectsEqual, rectsIntersect, type DamageRect } from "./lib/damage"
+import { RGBA } from "./lib/RGBA"
 import {
   parseAlign,
   parseAlignItems,
@@ -21,7 +23,7 @@ import {
 } from "./lib/yoga.options"
 import { maybeMakeRenderable, type VNode } from "./renderables/composition/vnode"
 import type { MouseEvent } from "./renderer"
-import type { RenderContext } from "./types"
+import type { ColorStorage, RenderContext } from "./types"
 import {
   validateOptions,
   isPositionType,
@@ -97,6 +99,8 @@ export interface RenderableOptions<T extends BaseRenderable = BaseRenderable> ex
   zIndex?: number
   visible?: boolean
   buffered?: boolean
+  /** Color storage of the buffer kept when `buffered` is set */
+  bufferColorStorage?: ColorStorage
   live?: boolean
   opacity?: number
 
@@ -212,6 +216,7 @@ export abstract class Renderable extends BaseRenderable {
   private _zIndex: number
   public selectable: boolean = false
   protected buffered: boolean
+  protected bufferColorStorage: ColorStorage
   protected frameBuffer: OptimizedBuffer | null = null
 
   protected _focusable: boolean = false
@@ -274,6 +279,7 @@ export abstract class Renderable extends BaseRenderable {
     this._zIndex = options.zIndex ?? 0
     this._visible = options.visible !== false
     this.buffered = options.buffered ?? false
+    this.bufferColorStorage = options.bufferColorStorage ?? "float32"
     this._live = options.live ?? false
     this._liveCount = this._live && this._visible ? 1 : 0
     this._opacity = options.opacity !== undefined ? Math.max(0, Math.min(1, options.opacity)) : 1.0
@@ -1036,7 +1042,11 @@ export abstract class Renderable extends BaseRenderable {
 
     try {
       const widthMethod = this._ctx.widthMethod
-      this.frameBuffer = OptimizedBuffer.create(w, h, widthMethod, { respectAlpha: true, id: `framebuffer-${this.id}` })
+      this.frameBuffer = OptimizedBuffer.create(w, h, widthMethod, {
+        respectAlpha: true,
+        id: `framebuffer-${this.id}`,
+        colorStorage: this.bufferColorStorage,
+      })
     } catch (error) {
       console.error(`Failed to create frame buffer for ${this.id}:`, error)
       this.frameBuffer = null
@@ -1558,6 +1568,16 @@ export type RenderCommand =
 export class RootRenderable extends Renderable {
   private renderList: RenderCommand[] = []
 
+  // Retained mode: the buffer still holds the previous frame, so only regions
+  // damaged by changed, moved or removed renderables are cleared and redrawn
+  private retained: boolean = false
+  private fullRedrawPending: boolean = true
+  private clearColor: RGBA = RGBA.fromInts(0, 0, 0, 0)
+  private damage: DamageRect[] = []
+  // Screen rect of every renderable drawn last frame, and the map being built for this one
+  private renderedRects: Map<Renderable, DamageRect> = new Map()
+  private nextRenderedRects: Map<Renderable, DamageRect> = new Map()
+
   constructor(ctx: RenderContext) {
     super(ctx, { id: "__root__", zIndex: 0, visible: true, width: ctx.width, height: ctx.height, enableLayout: true })
 
@@ -1599,14 +1619,47 @@ export class RootRenderable extends Renderable {
 
     // 3. Render all collected renderables
     this._ctx.clearHitGridScissorRects()
+    if (!this.retained) {
+      this.executeRenderList(buffer, deltaTime, null)
+      return
+    }
+
+    this.collectDamage()
+    let regions: DamageRect[]
+    if (this.fullRedrawPending) {
+      this.fullRedrawPending = false
+      regions = [{ x: 0, y: 0, width: this.width, height: this.height }]
+    } else {
+      regions = mergeDamageRects(this.damage, this.width, this.height)
+    }
+    this.damage.length = 0
+
+    for (const region of regions) {
+      this.redrawRegion(buffer, deltaTime, region)
+    }
+  }
+
+  /** Clear a region of the retained frame and redraw the renderables that overlap it, clipped to it. */
+  private redrawRegion(buffer: OptimizedBuffer, deltaTime: number, region: DamageRect): void {
+    buffer.clearRect(region.x, region.y, region.width, region.height, this.clearColor)
+    this._ctx.addToHitGrid(region.x, region.y, region.width, region.height, 0)
+
+    buffer.pushScissorRect(region.x, region.y, region.width, region.height)
+    this._ctx.pushHitGridScissorRect(region.x, region.y, region.width, region.height)
+    this.executeRenderList(buffer, deltaTime, region)
+    buffer.popScissorRect()
+    this._ctx.popHitGridScissorRect()
+  }
+
+  private executeRenderList(buffer: OptimizedBuffer, deltaTime: number, region: DamageRect | null): void {
     for (let i = 1; i < this.renderList.length; i++) {
       const command = this.renderList[i]
       switch (command.action) {
         case "render":
           // Skip if renderable was destroyed during a previous render callback
-          if (!command.renderable.isDestroyed) {
-            command.renderable.render(buffer, deltaTime)
-          }
+          if (command.renderable.isDestroyed) break
+          if (region && !rectsIntersect(region, this.renderedRects.get(command.renderable)!)) break
+          command.renderable.render(buffer, deltaTime)
           break
         case "pushScissorRect":
           buffer.pushScissorRect(command.x, command.y, command.width, command.height)
@@ -1626,6 +1679,78 @@ export class RootRenderable extends Renderable {
     }
   }
 
+  /**
+   * Compare this frame's render list against the last one. Renderables that are
+   * dirty, live, draw through render hooks, moved, appeared or disappeared damage
+   * both their old and new screen rects.
+   */
+  private collectDamage(): void {
+    const rendered = this.nextRenderedRects
+    rendered.clear()
+
+    for (let i = 1; i < this.renderList.length; i++) {
+      const command = this.renderList[i]
+      if (command.action !== "render") continue
+
+      const renderable = command.renderable
+      const rect = { x: renderable.x, y: renderable.y, width: renderable.width, height: renderable.height }
+      const previous = this.renderedRects.get(renderable)
+      rendered.set(renderable, rect)
+
+      if (!previous) {
+        this.damage.push(rect)
+        continue
+      }
+
+      const moved = !rectsEqual(previous, rect)
+      if (moved || renderable.isDirty || renderable.live || renderable.renderBefore || renderable.renderAfter) {
+        this.damage.push(previous)
+        if (moved) this.damage.push(rect)
+      }
+    }
+
+    for (const [renderable, rect] of this.renderedRects) {
+      if (!rendered.has(renderable)) {
+        this.damage.push(rect)
+      }
+    }
+
+    this.nextRenderedRects = this.renderedRects
+    this.renderedRects = rendered
+  }
+
+  /**
+   * Keep the previous frame in the buffer and redraw only damaged regions. The
+   * native renderer must retain its next buffer between frames for this to work.
+   */
+  public setRetained(enabled: boolean): void {
+    this.retained = enabled
+    this.renderedRects.clear()
+    this.damage.length = 0
+    this.fullRedrawPending = true
+  }
+
+  public get isRetained(): boolean {
+    return this.retained
+  }
+
+  /** Color damaged regions are cleared to before redrawing. */
+  public setClearColor(color: RGBA): void {
+    this.clearColor = color
+    this.fullRedrawPending = true
+  }
+
+  /** Redraw the whole screen on the next retained frame. */
+  public invalidate(): void {
+    this.fullRedrawPending = true
+  }
+
+  /** Redraw a screen region on the next retained frame, for content drawn outside the renderable tree. */
+  public addDamage(x: number, y: number, width: number, height: number): void {
+    if (width <= 0 || height <= 0) return
+    this.damage.push({ x, y, width, height })
+  }
+
   protected propagateLiveCount(delta: number): void {
     const oldCount = this._liveCount
     this._liveCount += delta
@@ -1645,6 +1770,7 @@ export class RootRenderable extends Renderable {
   public resize(width: number, height: number): void {
     this.width = width
     this.height = height
+    this.fullRedrawPending = true
 
     this.emit(LayoutEvents.RESIZED, { width, height })
   }
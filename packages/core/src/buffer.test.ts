@@ -253,4 +253,17 @@ describe("OptimizedBuffer", () => {
       expect(bgBuffer[3]).toBeLessThan(1.0)
     })
   })
+
+  describe("colorStorage", () => {
+    it("should create rgba8 buffers without float color arrays", () => {
+      const packed = OptimizedBuffer.create(4, 2, "unicode", { id: "packed-buffer", colorStorage: "rgba8" })
+      try {
+        expect(packed.colorStorage).toBe("rgba8")
+        packed.drawChar(65, 0, 0, RGBA.fromValues(1, 1, 1, 1), RGBA.fromValues(0, 0, 0, 1))
+        expect(() => packed.buffers).toThrow()
+      } finally {
+        packed.destroy()
+      }
+    })
+  })
 })
@@ -3,7 +3,7 @@ import { RGBA } from "./lib"
 import { resolveRenderLib, type RenderLib } from "./zig"
 import { type Pointer, toArrayBuffer } from "bun:ffi"
 import { type BorderStyle, type BorderSides, BorderCharArrays } from "./lib"
-import { type WidthMethod } from "./types"
+import { type ColorStorage, type WidthMethod } from "./types"
 import type { TextBufferView } from "./text-buffer-view"
 import type { EditorView } from "./editor-view"
 
@@ -48,6 +48,7 @@ export class OptimizedBuffer {
   private _width: number
   private _height: number
   private _widthMethod: WidthMethod
+  private _colorStorage: ColorStorage
   public respectAlpha: boolean = false
   private _rawBuffers: {
     char: Uint32Array
@@ -75,6 +76,9 @@ export class OptimizedBuffer {
     attributes: Uint32Array
   } {
     this.guard()
+    if (this._colorStorage === "rgba8") {
+      throw new Error(`Buffer ${this.id} packs its colors as rgba8 and has no float color arrays`)
+    }
     if (this._rawBuffers === null) {
       const size = this._width * this._height
       const charPtr = this.lib.bufferGetCharPtr(this.bufferPtr)
@@ -98,7 +102,7 @@ export class OptimizedBuffer {
     ptr: Pointer,
     width: number,
     height: number,
-    options: { respectAlpha?: boolean; id?: string; widthMethod?: WidthMethod },
+    options: { respectAlpha?: boolean; id?: string; widthMethod?: WidthMethod; colorStorage?: ColorStorage },
   ) {
     this.id = options.id || `fb_${OptimizedBuffer.fbIdCounter++}`
     this.lib = lib
@@ -106,6 +110,7 @@ export class OptimizedBuffer {
     this._width = width
     this._height = height
     this._widthMethod = options.widthMethod || "unicode"
+    this._colorStorage = options.colorStorage || "float32"
     this.bufferPtr = ptr
   }
 
@@ -113,12 +118,12 @@ export class OptimizedBuffer {
     width: number,
     height: number,
     widthMethod: WidthMethod,
-    options: { respectAlpha?: boolean; id?: string } = {},
+    options: { respectAlpha?: boolean; id?: string; colorStorage?: ColorStorage } = {},
   ): OptimizedBuffer {
     const lib = resolveRenderLib()
     const respectAlpha = options.respectAlpha || false
     const id = options.id && options.id.trim() !== "" ? options.id : "unnamed buffer"
-    const buffer = lib.createOptimizedBuffer(width, height, widthMethod, respectAlpha, id)
+    const buffer = lib.createOptimizedBuffer(width, height, widthMethod, respectAlpha, id, options.colorStorage)
     return buffer
   }
 
@@ -126,6 +131,10 @@ export class OptimizedBuffer {
     return this._widthMethod
   }
 
+  public get colorStorage(): ColorStorage {
+    return this._colorStorage
+  }
+
   public get width(): number {
     return this._width
   }
@@ -140,6 +149,40 @@ export class OptimizedBuffer {
     this.respectAlpha = respectAlpha
   }
 
+  /**
+   * Track which rows change. Writes made directly through `buffers` are not
+   * seen natively and must be reported with markRowsDirty.
+   */
+  public setRowTracking(enabled: boolean): boolean {
+    this.guard()
+    return this.lib.bufferSetRowTracking(this.bufferPtr, enabled)
+  }
+
+  public isRowDirty(y: number): boolean {
+    this.guard()
+    return this.lib.bufferIsRowDirty(this.bufferPtr, y)
+  }
+
+  public getDirtyRowCount(): number {
+    this.guard()
+    return this.lib.bufferGetDirtyRowCount(this.bufferPtr)
+  }
+
+  public markRowsDirty(start: number = 0, end: number = this._height): void {
+    this.guard()
+    this.lib.bufferMarkRowsDirty(this.bufferPtr, start, end)
+  }
+
+  public clearDirtyRows(): void {
+    this.guard()
+    this.lib.bufferClearDirtyRows(this.bufferPtr)
+  }
+
+  public getRowHash(y: number): bigint {
+    this.guard()
+    return this.lib.bufferGetRowHash(this.bufferPtr, y)
+  }
+
   public getNativeId(): string {
     this.guard()
     return this.lib.bufferGetId(this.bufferPtr)
@@ -224,6 +267,12 @@ export class OptimizedBuffer {
     this.lib.bufferFillRect(this.bufferPtr, x, y, width, height, bg)
   }
 
+  /** Reset a rectangle to blank cells without blending, so a transparent `bg` still replaces its content. */
+  public clearRect(x: number, y: number, width: number, height: number, bg: RGBA): void {
+    this.guard()
+    this.lib.bufferClearRect(this.bufferPtr, x, y, width, height, bg)
+  }
+
   public drawFrameBuffer(
     destX: number,
     destY: number,
@@ -691,6 +691,30 @@ describe("EditBuffer", () => {
       expect(lines[3]).toBe("Line 4")
     })
   })
+
+  describe("multiple cursors", () => {
+    it("should insert and delete at every cursor as one undo step", () => {
+      buffer.setText("one\ntwo\nthree")
+      buffer.setCursorToLineCol(0, 0)
+      buffer.addCursor(1, 0)
+      buffer.addCursor(2, 0)
+      buffer.addCursor(2, 0)
+      expect(buffer.getCursorCount()).toBe(3)
+
+      buffer.insertText("- ")
+      expect(buffer.getText()).toBe("- one\n- two\n- three")
+      expect(buffer.getCursorPosition()).toMatchObject({ row: 0, col: 2 })
+
+      buffer.deleteCharBackward()
+      expect(buffer.getText()).toBe("-one\n-two\n-three")
+
+      buffer.undo()
+      expect(buffer.getText()).toBe("- one\n- two\n- three")
+
+      buffer.clearExtraCursors()
+      expect(buffer.getCursorCount()).toBe(1)
+    })
+  })
 })
 
 describe("EditBuffer Placeholder", () => {
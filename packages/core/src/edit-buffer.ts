@@ -213,6 +213,25 @@ export class EditBuffer extends EventEmitter {
     this.lib.editBufferSetCursorByOffset(this.bufferPtr, offset)
   }
 
+  /**
+   * Adds a secondary cursor. While more than one cursor exists, insertText,
+   * deleteCharBackward and deleteChar edit at every cursor as one undo step.
+   */
+  public addCursor(line: number, col: number): void {
+    this.guard()
+    this.lib.editBufferAddCursor(this.bufferPtr, line, col)
+  }
+
+  public clearExtraCursors(): void {
+    this.guard()
+    this.lib.editBufferClearExtraCursors(this.bufferPtr)
+  }
+
+  public getCursorCount(): number {
+    this.guard()
+    return this.lib.editBufferGetCursorCount(this.bufferPtr)
+  }
+
   public getCursorPosition(): LogicalCursor {
     this.guard()
     return this.lib.editBufferGetCursorPosition(this.bufferPtr)
@@ -376,6 +395,11 @@ export class EditBuffer extends EventEmitter {
     this.lib.textBufferAddHighlightByCharRange(this.textBufferPtr, highlight)
   }
 
+  public setHighlightsInLineRange(startLine: number, endLine: number, highlights: Highlight[]): void {
+    this.guard()
+    this.lib.textBufferSetHighlightsInLineRange(this.textBufferPtr, startLine, endLine, highlights)
+  }
+
   public removeHighlightsByRef(hlRef: number): void {
     this.guard()
     this.lib.textBufferRemoveHighlightsByRef(this.textBufferPtr, hlRef)
@@ -0,0 +1,57 @@
+import { test, expect, describe } from "bun:test"
+import { mergeDamageRects, rectsIntersect } from "./damage"
+
+describe("mergeDamageRects", () => {
+  test("returns empty array when nothing is damaged", () => {
+    expect(mergeDamageRects([], 80, 24)).toEqual([])
+  })
+
+  test("keeps disjoint rects separate", () => {
+    const rects = [
+      { x: 0, y: 0, width: 4, height: 2 },
+      { x: 20, y: 10, width: 4, height: 2 },
+    ]
+    expect(mergeDamageRects(rects, 80, 24)).toEqual(rects)
+  })
+
+  test("merges overlapping and adjacent rects into their bounding box", () => {
+    const rects = [
+      { x: 0, y: 0, width: 4, height: 2 },
+      { x: 4, y: 0, width: 4, height: 2 },
+      { x: 6, y: 1, width: 2, height: 3 },
+    ]
+    expect(mergeDamageRects(rects, 80, 24)).toEqual([{ x: 0, y: 0, width: 8, height: 4 }])
+  })
+
+  test("merges chains that only connect through a grown rect", () => {
+    const rects = [
+      { x: 0, y: 0, width: 2, height: 2 },
+      { x: 10, y: 0, width: 2, height: 2 },
+      { x: 1, y: 1, width: 10, height: 1 },
+    ]
+    expect(mergeDamageRects(rects, 80, 24)).toEqual([{ x: 0, y: 0, width: 12, height: 2 }])
+  })
+
+  test("clips to the screen and drops rects outside it", () => {
+    const rects = [
+      { x: -2, y: -1, width: 4, height: 3 },
+      { x: 100, y: 5, width: 4, height: 3 },
+    ]
+    expect(mergeDamageRects(rects, 80, 24)).toEqual([{ x: 0, y: 0, width: 2, height: 2 }])
+  })
+
+  test("collapses to a full-screen region when most of the screen is damaged", () => {
+    const rects = [
+      { x: 0, y: 0, width: 80, height: 10 },
+      { x: 0, y: 12, width: 80, height: 10 },
+    ]
+    expect(mergeDamageRects(rects, 80, 24)).toEqual([{ x: 0, y: 0, width: 80, height: 24 }])
+  })
+})
+
+describe("rectsIntersect", () => {
+  test("edges that only touch do not intersect", () => {
+    expect(rectsIntersect({ x: 0, y: 0, width: 2, height: 2 }, { x: 2, y: 0, width: 2, height: 2 })).toBe(false)
+    expect(rectsIntersect({ x: 0, y: 0, width: 3, height: 2 }, { x: 2, y: 1, width: 2, height: 2 })).toBe(true)
+  })
+})
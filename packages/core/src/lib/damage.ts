@@ -0,0 +1,78 @@
+import type { ViewportBounds } from "../types"
+
+export type DamageRect = ViewportBounds
+
+/**
+ * Share of the screen above which damage is redrawn as one full-screen region.
+ * Past this point clearing and re-walking the render list per region costs more
+ * than it saves.
+ */
+export const FULL_DAMAGE_RATIO = 0.5
+
+export function rectsIntersect(a: DamageRect, b: DamageRect): boolean {
+  return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height
+}
+
+export function rectsEqual(a: DamageRect, b: DamageRect): boolean {
+  return a.x === b.x && a.y === b.y && a.width === b.width && a.height === b.height
+}
+
+function rectsTouch(a: DamageRect, b: DamageRect): boolean {
+  return a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height
+}
+
+/**
+ * Clips damage to the screen and merges overlapping or adjacent rects into their
+ * bounding boxes, so each cell is cleared and redrawn at most once.
+ *
+ * @returns Disjoint regions to redraw, or a single full-screen region when the
+ * damaged area exceeds FULL_DAMAGE_RATIO of the screen
+ */
+export function mergeDamageRects(rects: DamageRect[], width: number, height: number): DamageRect[] {
+  const merged: DamageRect[] = []
+
+  for (const rect of rects) {
+    const x = Math.max(0, rect.x)
+    const y = Math.max(0, rect.y)
+    const right = Math.min(width, rect.x + rect.width)
+    const bottom = Math.min(height, rect.y + rect.height)
+    if (right <= x || bottom <= y) continue
+
+    let current: DamageRect = { x, y, width: right - x, height: bottom - y }
+
+    // Absorb every region the new one touches; the grown rect may touch earlier ones too
+    let absorbed = true
+    while (absorbed) {
+      absorbed = false
+      for (let i = 0; i < merged.length; i++) {
+        const other = merged[i]
+        if (!rectsTouch(current, other)) continue
+
+        const mx = Math.min(current.x, other.x)
+        const my = Math.min(current.y, other.y)
+        current = {
+          x: mx,
+          y: my,
+          width: Math.max(current.x + current.width, other.x + other.width) - mx,
+          height: Math.max(current.y + current.height, other.y + other.height) - my,
+        }
+        merged[i] = merged[merged.length - 1]
+        merged.pop()
+        absorbed = true
+        break
+      }
+    }
+
+    merged.push(current)
+  }
+
+  let area = 0
+  for (const rect of merged) {
+    area += rect.width * rect.height
+  }
+  if (area > width * height * FULL_DAMAGE_RATIO) {
+    return [{ x: 0, y: 0, width, height }]
+  }
+
+  return merged
+}
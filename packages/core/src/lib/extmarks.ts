@@ -1,5 +1,6 @@
 import type { EditBuffer } from "../edit-buffer"
 import type { EditorView } from "../editor-view"
+import type { Highlight } from "../types"
 import { ExtmarksHistory, type ExtmarksSnapshot } from "./extmarks-history"
 
 export interface Extmark {
@@ -568,17 +569,17 @@ export class ExtmarksController {
   }
 
   private updateHighlights(): void {
-    this.editBuffer.clearAllHighlights()
+    const highlights: Highlight[] = []
 
     for (const extmark of this.extmarks.values()) {
       if (extmark.styleId !== undefined) {
         // extmark.start/end are display-width offsets including newlines (from cursor operations)
-        // addHighlightByCharRange expects display-width offsets excluding newlines
+        // setHighlightsInLineRange expects display-width offsets excluding newlines
         // So we need to subtract the number of newlines before each position
         const startWithoutNewlines = this.offsetExcludingNewlines(extmark.start)
         const endWithoutNewlines = this.offsetExcludingNewlines(extmark.end)
 
-        this.editBuffer.addHighlightByCharRange({
+        highlights.push({
           start: startWithoutNewlines,
           end: endWithoutNewlines,
           styleId: extmark.styleId,
@@ -587,6 +588,9 @@ export class ExtmarksController {
         })
       }
     }
+
+    // Replaces every line's highlights in a single native call
+    this.editBuffer.setHighlightsInLineRange(0, this.editBuffer.getLineCount(), highlights)
   }
 
   private offsetExcludingNewlines(offset: number): number {
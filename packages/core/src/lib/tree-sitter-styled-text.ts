@@ -18,7 +18,7 @@ interface Boundary {
   highlightIndex: number
 }
 
-function getSpecificity(group: string): number {
+export function getSpecificity(group: string): number {
   return group.split(".").length
 }
 
@@ -5,6 +5,7 @@ import { join } from "path"
 import { mkdir, writeFile, unlink } from "fs/promises"
 import { getDataPaths } from "../data-paths"
 import { getTreeSitterClient } from "."
+import type { HighlightLineRange, HighlightResponse } from "./types"
 
 describe("TreeSitterClient", () => {
   let client: TreeSitterClient
@@ -209,6 +210,292 @@ describe("TreeSitterClient", () => {
     expect(Array.isArray(performance.queryTimes)).toBe(true)
   })
 
+  test("should ship buffer updates as deltas", async () => {
+    await client.initialize()
+
+    const jsCode = "const a = 1;"
+    await client.createBuffer(1, jsCode, "javascript")
+
+    let receivedVersion: number | undefined
+    client.on("highlights:response", (bufferId, version) => {
+      receivedVersion = version
+    })
+
+    const newCode = "const abc = 1;"
+    const edits = [
+      {
+        startIndex: 7,
+        oldEndIndex: 7,
+        newEndIndex: 9,
+        startPosition: { row: 0, column: 7 },
+        oldEndPosition: { row: 0, column: 7 },
+        newEndPosition: { row: 0, column: 9 },
+      },
+    ]
+    await client.updateBuffer(1, edits, newCode, 2)
+
+    await new Promise((resolve) => setTimeout(resolve, 200))
+
+    expect(receivedVersion).toBe(2)
+    const performance = await client.getPerformance()
+    expect(performance.deltaUpdates).toBe(1)
+    expect(performance.fullUpdates).toBe(0)
+    expect(performance.resyncs).toBe(0)
+    expect(performance.transferTimes.length).toBeGreaterThan(0)
+  })
+
+  test("should resync with a full snapshot when the worker misses a version", async () => {
+    await client.initialize()
+
+    const jsCode = "const a = 1;"
+    await client.createBuffer(1, jsCode, "javascript")
+
+    // Pretend version 2 was lost: the worker still holds version 1
+    const newCode = "const a = 12;"
+    const edits = [
+      {
+        startIndex: 11,
+        oldEndIndex: 11,
+        newEndIndex: 12,
+        startPosition: { row: 0, column: 11 },
+        oldEndPosition: { row: 0, column: 11 },
+        newEndPosition: { row: 0, column: 12 },
+      },
+    ]
+    await new Promise((resolve) => setTimeout(resolve, 100))
+    ;(client as any).channels.get(1).sentVersion = 2
+    await client.updateBuffer(1, edits, newCode, 3)
+
+    await new Promise((resolve) => setTimeout(resolve, 200))
+
+    const performance = await client.getPerformance()
+    expect(performance.resyncs).toBe(1)
+    expect(performance.fullUpdates).toBe(1)
+    expect(client.getBuffer(1)?.content).toBe(newCode)
+  })
+
+  test("should answer edits with a patch for the changed lines only", async () => {
+    await client.initialize()
+
+    const jsCode = "const a = 1;\nconst b = 2;\nconst c = 3;"
+    await client.createBuffer(1, jsCode, "javascript")
+
+    let patch: { highlights: HighlightResponse[]; lineRanges?: HighlightLineRange[] } | undefined
+    client.on("highlights:response", (bufferId, version, highlights, lineRanges) => {
+      if (version === 2) patch = { highlights, lineRanges }
+    })
+
+    // "const b = 2;" -> "const bb = 2;"
+    const newCode = "const a = 1;\nconst bb = 2;\nconst c = 3;"
+    const edits = [
+      {
+        startIndex: 20,
+        oldEndIndex: 20,
+        newEndIndex: 21,
+        startPosition: { row: 1, column: 7 },
+        oldEndPosition: { row: 1, column: 7 },
+        newEndPosition: { row: 1, column: 8 },
+      },
+    ]
+    await client.updateBuffer(1, edits, newCode, 2)
+
+    await new Promise((resolve) => setTimeout(resolve, 200))
+
+    expect(patch).toBeDefined()
+    expect(patch!.lineRanges).toEqual([{ startLine: 1, endLine: 2 }])
+    expect(patch!.highlights.map((response) => response.line)).toEqual([1])
+  })
+
+  test("should re-highlight an edited markdown code block in the patch", async () => {
+    await client.initialize()
+
+    const markdown = "# Title\n\n```typescript\nconst x = 1;\n```\n\n```typescript\nconst y = 2;\n```\n"
+    await client.createBuffer(1, markdown, "markdown")
+
+    let patch: { highlights: HighlightResponse[]; lineRanges?: HighlightLineRange[] } | undefined
+    client.on("highlights:response", (bufferId, version, highlights, lineRanges) => {
+      if (version === 2) patch = { highlights, lineRanges }
+    })
+
+    // "const y = 2;" -> "const y = 23;" in the second block
+    const offset = markdown.indexOf("2;") + 1
+    const newMarkdown = markdown.slice(0, offset) + "3" + markdown.slice(offset)
+    const edits = [
+      {
+        startIndex: offset,
+        oldEndIndex: offset,
+        newEndIndex: offset + 1,
+        startPosition: { row: 7, column: 11 },
+        oldEndPosition: { row: 7, column: 11 },
+        newEndPosition: { row: 7, column: 12 },
+      },
+    ]
+    await client.updateBuffer(1, edits, newMarkdown, 2)
+
+    await new Promise((resolve) => setTimeout(resolve, 300))
+
+    expect(patch).toBeDefined()
+    for (const response of patch!.highlights) {
+      expect(patch!.lineRanges!.some((range) => response.line >= range.startLine && response.line < range.endLine)).toBe(
+        true,
+      )
+    }
+    const line7 = patch!.highlights.find((response) => response.line === 7)
+    expect(line7).toBeDefined()
+    expect(line7!.highlights.some((hl) => hl.group === "number")).toBe(true)
+    expect(patch!.highlights.some((response) => response.line === 3)).toBe(false)
+  })
+
+  test("should patch an edit moved by a later edit in the same update", async () => {
+    await client.initialize()
+
+    const jsCode = "const a = 1;\nconst b = 2;\nconst c = 3;"
+    await client.createBuffer(1, jsCode, "javascript")
+
+    let patch: { highlights: HighlightResponse[]; lineRanges?: HighlightLineRange[] } | undefined
+    client.on("highlights:response", (bufferId, version, highlights, lineRanges) => {
+      if (version === 2) patch = { highlights, lineRanges }
+    })
+
+    // "c = 3" -> "c = 34" on row 2, then two lines inserted above it
+    const numberEnd = jsCode.indexOf("3;") + 1
+    const newCode = "// one\n// two\n" + jsCode.slice(0, numberEnd) + "4" + jsCode.slice(numberEnd)
+    const edits = [
+      {
+        startIndex: numberEnd,
+        oldEndIndex: numberEnd,
+        newEndIndex: numberEnd + 1,
+        startPosition: { row: 2, column: 11 },
+        oldEndPosition: { row: 2, column: 11 },
+        newEndPosition: { row: 2, column: 12 },
+      },
+      {
+        startIndex: 0,
+        oldEndIndex: 0,
+        newEndIndex: 14,
+        startPosition: { row: 0, column: 0 },
+        oldEndPosition: { row: 0, column: 0 },
+        newEndPosition: { row: 2, column: 0 },
+      },
+    ]
+    await client.updateBuffer(1, edits, newCode, 2)
+
+    await new Promise((resolve) => setTimeout(resolve, 200))
+
+    expect(patch).toBeDefined()
+    expect(patch!.lineRanges!.some((range) => range.startLine <= 4 && range.endLine > 4)).toBe(true)
+    const line4 = patch!.highlights.find((response) => response.line === 4)
+    expect(line4).toBeDefined()
+    expect(line4!.highlights.some((hl) => hl.group === "number")).toBe(true)
+  })
+
+  test("should merge updates queued behind an update in flight", async () => {
+    await client.initialize()
+
+    let content = "let x = 1"
+    await client.createBuffer(1, content, "javascript")
+
+    let lastVersion: number | undefined
+    client.on("highlights:response", (bufferId, version) => {
+      lastVersion = version
+    })
+
+    for (let version = 2; version <= 6; version++) {
+      const start = content.length
+      content += "0"
+      const edits = [
+        {
+          startIndex: start,
+          oldEndIndex: start,
+          newEndIndex: start + 1,
+          startPosition: { row: 0, column: start },
+          oldEndPosition: { row: 0, column: start },
+          newEndPosition: { row: 0, column: start + 1 },
+        },
+      ]
+      await client.updateBuffer(1, edits, content, version)
+    }
+
+    await new Promise((resolve) => setTimeout(resolve, 300))
+
+    const performance = await client.getPerformance()
+    expect(performance.deltaUpdates).toBeLessThan(5)
+    expect(performance.resyncs).toBe(0)
+    expect(performance.queueDepth).toBe(0)
+    expect(lastVersion).toBe(6)
+  })
+
+  test("should patch the final rows of edits merged behind an update in flight", async () => {
+    await client.initialize()
+
+    const v1 = "const a = 1;\nconst b = 2;\nconst c = 3;"
+    await client.createBuffer(1, v1, "javascript")
+
+    let patch: { highlights: HighlightResponse[]; lineRanges?: HighlightLineRange[] } | undefined
+    client.on("highlights:response", (bufferId, version, highlights, lineRanges) => {
+      if (version === 4) patch = { highlights, lineRanges }
+    })
+
+    const insertEdit = (index: number, row: number, column: number, text: string) => {
+      const lines = text.split("\n")
+      const endRow = row + lines.length - 1
+      const endColumn = lines.length === 1 ? column + text.length : lines[lines.length - 1].length
+      return {
+        startIndex: index,
+        oldEndIndex: index,
+        newEndIndex: index + text.length,
+        startPosition: { row, column },
+        oldEndPosition: { row, column },
+        newEndPosition: { row: endRow, column: endColumn },
+      }
+    }
+
+    // v2 goes out; v3 and v4 queue behind it and are merged
+    const v2 = v1 + " "
+    const v3 = v2.replace("c = 3", "c = 34")
+    const v4 = "// one\n// two\n" + v3
+    const updates = [
+      client.updateBuffer(1, [insertEdit(v1.length, 2, 12, " ")], v2, 2),
+      client.updateBuffer(1, [insertEdit(v2.indexOf("3;") + 1, 2, 11, "4")], v3, 3),
+      // Shifts the "c = 34" line from row 2 to row 4
+      client.updateBuffer(1, [insertEdit(0, 0, 0, "// one\n// two\n")], v4, 4),
+    ]
+    await Promise.all(updates)
+
+    await new Promise((resolve) => setTimeout(resolve, 300))
+
+    expect(patch).toBeDefined()
+    expect(patch!.lineRanges!.some((range) => range.startLine <= 4 && range.endLine > 4)).toBe(true)
+    const line4 = patch!.highlights.find((response) => response.line === 4)
+    expect(line4).toBeDefined()
+    expect(line4!.highlights.some((hl) => hl.group === "number")).toBe(true)
+  })
+
+  test("should spread filetypes over a worker pool", async () => {
+    await client.destroy()
+    client = new TreeSitterClient({ dataPath, workerCount: 2 })
+    await client.initialize()
+
+    await client.createBuffer(1, "const a = 1;", "javascript")
+    await client.createBuffer(2, "const b: number = 2;", "typescript")
+    await client.createBuffer(3, "const c = 3;", "javascript")
+
+    const result = await client.highlightOnce("const d = 4;", "javascript")
+    expect(result.highlights!.length).toBeGreaterThan(0)
+
+    const performance = await client.getPerformance()
+    expect(performance.workers).toHaveLength(2)
+    expect(performance.workers.reduce((acc, worker) => acc + worker.bufferCount, 0)).toBe(3)
+    for (const worker of performance.workers) {
+      expect(worker.bufferCount).toBeGreaterThan(0)
+      expect(worker.latencies.length).toBeGreaterThan(0)
+    }
+    // Both JavaScript buffers and the one-shot share the worker with that parser loaded
+    const jsWorkers = performance.workers.filter((worker) => worker.filetypes.includes("javascript"))
+    expect(jsWorkers).toHaveLength(1)
+    expect(jsWorkers[0].bufferCount).toBe(2)
+  })
+
   test("should handle concurrent buffer operations", async () => {
     await client.initialize()
 
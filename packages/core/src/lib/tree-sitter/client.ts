@@ -1,6 +1,5 @@
 import { EventEmitter } from "events"
 import { createDebounce, clearDebounceScope, DebounceController } from "../debounce"
-import { ProcessQueue } from "../queue"
 import type {
   TreeSitterClientOptions,
   TreeSitterClientEvents,
@@ -9,8 +8,12 @@ import type {
   FiletypeParserOptions,
   Edit,
   PerformanceStats,
+  ClientPerformanceStats,
   SimpleHighlight,
+  HighlightOnceOptions,
+  HighlightLineRange,
 } from "./types"
+import { computeTextDelta, deltaToEdit } from "./text-delta"
 import { getParsers } from "./default-parsers"
 import { resolve, isAbsolute, parse } from "path"
 import { existsSync } from "fs"
@@ -35,6 +38,53 @@ interface EditQueueItem {
   isReset?: boolean
 }
 
+interface WorkerSlot {
+  index: number
+  worker: Worker
+  // Sequence numbers of tracked messages not yet finished, with their post time
+  inflight: Map<number, number>
+  latencies: number[]
+  averageLatency: number
+  filetypes: Set<string>
+  bufferCount: number
+}
+
+// A buffer's updates go to its worker one at a time
+interface BufferChannel {
+  slot: WorkerSlot
+  // Content and version the worker has once the update in flight is done
+  sentContent: string
+  sentVersion: number
+  inflightSeq?: number
+  // Updates that arrived while one was in flight, merged into one
+  pending?: EditQueueItem
+}
+
+const MAX_LATENCY_SAMPLES = 10
+// How much busier than the least busy worker a worker with the filetype's
+// parser already loaded may be and still get the work
+const AFFINITY_SLACK = 2
+
+// Fold `next` into an update that has not been sent yet, whose edits apply to
+// `base`. Superseded versions are never parsed, and a reset absorbs everything
+// after it. Each edit is in the coordinates of the text right after it, so the
+// merged edits become one edit spanning the whole change since `base`; its
+// rows are then valid in the final content.
+function mergeUpdates(pending: EditQueueItem, next: EditQueueItem, base: string): EditQueueItem {
+  if (next.isReset) {
+    return next
+  }
+  if (pending.isReset) {
+    return { ...pending, newContent: next.newContent, version: next.version }
+  }
+  const delta = computeTextDelta(base, next.newContent, [...pending.edits, ...next.edits])
+  return { edits: [deltaToEdit(base, next.newContent, delta)], newContent: next.newContent, version: next.version }
+}
+
+function average(samples: number[]): number {
+  return samples.length === 0 ? 0 : samples.reduce((acc, sample) => acc + sample, 0) / samples.length
+}
+
 let DEFAULT_PARSERS: FiletypeParserOptions[] = getParsers()
 
 export function addDefaultParsers(parsers: FiletypeParserOptions[]): void {
@@ -55,15 +105,20 @@ const isUrl = (path: string) => path.startsWith("http://") || path.startsWith("h
 // TODO: TreeSitterClient should have a setOptions method, passing it on to the worker etc.
 export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
   private initialized = false
-  private worker: Worker | undefined
+  private workers: WorkerSlot[] = []
+  private pendingInitCount = 0
   private buffers: Map<number, BufferState> = new Map()
   private initializePromise: Promise<void> | undefined
   private initializeResolvers:
     | { resolve: () => void; reject: (error: Error) => void; timeoutId: ReturnType<typeof setTimeout> }
     | undefined
   private messageCallbacks: Map<string, (response: any) => void> = new Map()
+  private partialCallbacks: Map<string, NonNullable<HighlightOnceOptions["onPartial"]>> = new Map()
+  private prioritizedRequests: Map<HighlightOnceOptions, { messageId: string; slot: WorkerSlot }> = new Map()
   private messageIdCounter: number = 0
-  private editQueues: Map<number, ProcessQueue<EditQueueItem>> = new Map()
+  private messageSeq: number = 0
+  private channels: Map<number, BufferChannel> = new Map()
+  private seqBuffers: Map<number, number> = new Map()
   private debouncer: DebounceController
   private options: TreeSitterClientOptions
 
@@ -71,7 +126,7 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
     super()
     this.options = options
     this.debouncer = createDebounce("tree-sitter-client")
-    this.startWorker()
+    this.startWorkers()
   }
 
   private emitError(error: string, bufferId?: number): void {
@@ -86,60 +141,76 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
     }
   }
 
-  private startWorker() {
-    if (this.worker) {
+  private resolveWorkerPath(): string | URL {
+    if (env.OTUI_TREE_SITTER_WORKER_PATH) {
+      return env.OTUI_TREE_SITTER_WORKER_PATH
+    } else if (typeof OTUI_TREE_SITTER_WORKER_PATH !== "undefined") {
+      return OTUI_TREE_SITTER_WORKER_PATH
+    } else if (this.options.workerPath) {
+      return this.options.workerPath
+    }
+
+    let worker_path: string | URL = new URL("./parser.worker.js", import.meta.url).href
+    if (!existsSync(resolve(import.meta.dirname, "parser.worker.js"))) {
+      worker_path = new URL("./parser.worker.ts", import.meta.url).href
+    }
+    return worker_path
+  }
+
+  private startWorkers() {
+    if (this.workers.length > 0) {
       return
     }
 
-    let worker_path: string | URL
+    const worker_path = this.resolveWorkerPath()
+    const workerCount = Math.max(1, Math.floor(this.options.workerCount ?? 1))
 
-    if (env.OTUI_TREE_SITTER_WORKER_PATH) {
-      worker_path = env.OTUI_TREE_SITTER_WORKER_PATH
-    } else if (typeof OTUI_TREE_SITTER_WORKER_PATH !== "undefined") {
-      worker_path = OTUI_TREE_SITTER_WORKER_PATH
-    } else if (this.options.workerPath) {
-      worker_path = this.options.workerPath
-    } else {
-      worker_path = new URL("./parser.worker.js", import.meta.url).href
-      if (!existsSync(resolve(import.meta.dirname, "parser.worker.js"))) {
-        worker_path = new URL("./parser.worker.ts", import.meta.url).href
+    for (let index = 0; index < workerCount; index++) {
+      const slot: WorkerSlot = {
+        index,
+        worker: new Worker(worker_path),
+        inflight: new Map(),
+        latencies: [],
+        averageLatency: 0,
+        filetypes: new Set(),
+        bufferCount: 0,
       }
-    }
 
-    this.worker = new Worker(worker_path)
+      // @ts-ignore - onmessage exists
+      slot.worker.onmessage = (event: MessageEvent) => this.handleWorkerMessage(slot, event)
 
-    // @ts-ignore - onmessage exists
-    this.worker.onmessage = this.handleWorkerMessage.bind(this)
+      // @ts-ignore - onerror exists
+      slot.worker.onerror = (error: ErrorEvent) => {
+        console.error("TreeSitter worker error:", error.message)
 
-    // @ts-ignore - onerror exists
-    this.worker.onerror = (error: ErrorEvent) => {
-      console.error("TreeSitter worker error:", error.message)
+        // If we're still initializing, reject the init promise
+        if (this.initializeResolvers) {
+          clearTimeout(this.initializeResolvers.timeoutId)
+          this.initializeResolvers.reject(new Error(`Worker error: ${error.message}`))
+          this.initializeResolvers = undefined
+        }
 
-      // If we're still initializing, reject the init promise
-      if (this.initializeResolvers) {
-        clearTimeout(this.initializeResolvers.timeoutId)
-        this.initializeResolvers.reject(new Error(`Worker error: ${error.message}`))
-        this.initializeResolvers = undefined
+        this.emitError(`Worker error: ${error.message}`)
       }
 
-      this.emitError(`Worker error: ${error.message}`)
+      this.workers.push(slot)
     }
   }
 
-  private stopWorker() {
-    if (!this.worker) {
-      return
+  private stopWorkers() {
+    for (const slot of this.workers) {
+      slot.worker.terminate()
     }
-
-    this.worker.terminate()
-    this.worker = undefined
+    this.workers = []
+    this.channels.clear()
+    this.seqBuffers.clear()
   }
 
   // NOTE: Unused, but useful for debugging and testing
   private handleReset() {
     this.buffers.clear()
-    this.stopWorker()
-    this.startWorker()
+    this.stopWorkers()
+    this.startWorkers()
     this.initializePromise = undefined
     this.initializeResolvers = undefined
     return this.initialize()
@@ -160,7 +231,8 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
       }, timeoutMs)
 
       this.initializeResolvers = { resolve, reject, timeoutId }
-      this.worker?.postMessage({
+      this.pendingInitCount = this.workers.length
+      this.broadcast({
         type: "INIT",
         dataPath: this.options.dataPath,
       })
@@ -172,6 +244,81 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
     return this.initializePromise
   }
 
+  private broadcast(message: any): void {
+    for (const slot of this.workers) {
+      slot.worker.postMessage(message)
+    }
+  }
+
+  /** Post to every worker and wait for each one's reply to its own messageId */
+  private requestAll<T>(message: any, prefix: string): Promise<T[]> {
+    return Promise.all(
+      this.workers.map(
+        (slot) =>
+          new Promise<T>((resolve) => {
+            const messageId = `${prefix}_${this.messageIdCounter++}`
+            this.messageCallbacks.set(messageId, resolve)
+            slot.worker.postMessage({ ...message, messageId })
+          }),
+      ),
+    )
+  }
+
+  /** Post a message the worker reports as finished, counting it toward queue depth and latency */
+  private postTracked(slot: WorkerSlot, message: any): number {
+    const seq = this.messageSeq++
+    slot.inflight.set(seq, performance.now())
+    slot.worker.postMessage({ ...message, seq })
+    return seq
+  }
+
+  private finishMessage(slot: WorkerSlot, seq: number): void {
+    const sentAt = slot.inflight.get(seq)
+    if (sentAt === undefined) return
+    slot.inflight.delete(seq)
+
+    slot.latencies.push(performance.now() - sentAt)
+    if (slot.latencies.length > MAX_LATENCY_SAMPLES) {
+      slot.latencies.shift()
+    }
+    slot.averageLatency = average(slot.latencies)
+
+    const bufferId = this.seqBuffers.get(seq)
+    if (bufferId === undefined) return
+    this.seqBuffers.delete(seq)
+
+    const channel = this.channels.get(bufferId)
+    if (channel && channel.inflightSeq === seq) {
+      channel.inflightSeq = undefined
+      this.flushUpdate(bufferId, channel)
+    }
+  }
+
+  private workerLoad(slot: WorkerSlot): number {
+    return slot.inflight.size + slot.bufferCount
+  }
+
+  /**
+   * Route work for a filetype: prefer a worker that already has its parser and
+   * queries loaded, unless that worker is clearly busier than the least busy one
+   */
+  private pickWorker(filetype: string): WorkerSlot | undefined {
+    let leastBusy: WorkerSlot | undefined
+    let warm: WorkerSlot | undefined
+    for (const slot of this.workers) {
+      if (!leastBusy || this.workerLoad(slot) < this.workerLoad(leastBusy)) {
+        leastBusy = slot
+      }
+      if (slot.filetypes.has(filetype) && (!warm || this.workerLoad(slot) < this.workerLoad(warm))) {
+        warm = slot
+      }
+    }
+
+    const slot = warm && this.workerLoad(warm) <= this.workerLoad(leastBusy!) + AFFINITY_SLACK ? warm : leastBusy
+    slot?.filetypes.add(filetype)
+    return slot
+  }
+
   private async registerDefaultParsers(): Promise<void> {
     for (const parser of DEFAULT_PARSERS) {
       this.addFiletypeParser(parser)
@@ -200,21 +347,48 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
         injections: filetypeParser.queries.injections?.map((path) => this.resolvePath(path)),
       },
     }
-    this.worker?.postMessage({ type: "ADD_FILETYPE_PARSER", filetypeParser: resolvedParser })
+    this.broadcast({ type: "ADD_FILETYPE_PARSER", filetypeParser: resolvedParser })
   }
 
-  public async getPerformance(): Promise<PerformanceStats> {
-    const messageId = `performance_${this.messageIdCounter++}`
-    return new Promise<PerformanceStats>((resolve) => {
-      this.messageCallbacks.set(messageId, resolve)
-      this.worker?.postMessage({ type: "GET_PERFORMANCE", messageId })
-    })
+  public async getPerformance(): Promise<ClientPerformanceStats> {
+    const perWorker = await this.requestAll<PerformanceStats>({ type: "GET_PERFORMANCE" }, "performance")
+
+    const parseTimes = perWorker.flatMap((stats) => stats.parseTimes)
+    const queryTimes = perWorker.flatMap((stats) => stats.queryTimes)
+    const transferTimes = perWorker.flatMap((stats) => stats.transferTimes)
+    let pendingUpdates = 0
+    for (const channel of this.channels.values()) {
+      if (channel.pending) pendingUpdates++
+    }
+
+    return {
+      averageParseTime: average(parseTimes),
+      parseTimes,
+      averageQueryTime: average(queryTimes),
+      queryTimes,
+      averageTransferTime: average(transferTimes),
+      transferTimes,
+      deltaUpdates: perWorker.reduce((acc, stats) => acc + stats.deltaUpdates, 0),
+      fullUpdates: perWorker.reduce((acc, stats) => acc + stats.fullUpdates, 0),
+      resyncs: perWorker.reduce((acc, stats) => acc + stats.resyncs, 0),
+      queueDepth: this.workers.reduce((acc, slot) => acc + slot.inflight.size, pendingUpdates),
+      workers: this.workers.map((slot, index) => ({
+        index: slot.index,
+        queueDepth: slot.inflight.size,
+        averageLatency: slot.averageLatency,
+        latencies: [...slot.latencies],
+        filetypes: Array.from(slot.filetypes),
+        bufferCount: slot.bufferCount,
+        performance: perWorker[index],
+      })),
+    }
   }
 
   public async highlightOnce(
     content: string,
     filetype: string,
-  ): Promise<{ highlights?: SimpleHighlight[]; warning?: string; error?: string }> {
+    options?: HighlightOnceOptions,
+  ): Promise<{ highlights?: SimpleHighlight[]; warning?: string; error?: string; cancelled?: boolean }> {
     if (!this.initialized) {
       try {
         await this.initialize()
@@ -223,41 +397,102 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
       }
     }
 
+    const priorityRange = options?.priorityRange
+    if (options?.signal?.aborted) {
+      return { cancelled: true }
+    }
+
+    const slot = this.pickWorker(filetype)
+    if (!slot) {
+      return { error: "Could not highlight because the client has no workers" }
+    }
+
     const messageId = `oneshot_${this.messageIdCounter++}`
     return new Promise((resolve) => {
-      this.messageCallbacks.set(messageId, resolve)
-      this.worker?.postMessage({
+      if (!options || !priorityRange) {
+        this.messageCallbacks.set(messageId, resolve)
+        this.postTracked(slot, {
+          type: "ONESHOT_HIGHLIGHT",
+          content,
+          filetype,
+          messageId,
+        })
+        return
+      }
+
+      const onAbort = () => slot.worker.postMessage({ type: "CANCEL_HIGHLIGHT", messageId })
+      this.messageCallbacks.set(messageId, (response) => {
+        options.signal?.removeEventListener("abort", onAbort)
+        this.partialCallbacks.delete(messageId)
+        this.prioritizedRequests.delete(options)
+        resolve(response)
+      })
+      if (options.onPartial) {
+        this.partialCallbacks.set(messageId, options.onPartial)
+      }
+      this.prioritizedRequests.set(options, { messageId, slot })
+      options.signal?.addEventListener("abort", onAbort, { once: true })
+
+      this.postTracked(slot, {
         type: "ONESHOT_HIGHLIGHT",
         content,
         filetype,
         messageId,
+        priorityRange,
       })
     })
   }
 
-  private handleWorkerMessage(event: MessageEvent) {
-    const { type, bufferId, error, highlights, warning, messageId, hasParser, performance, version } = event.data
+  /** Move the priority range of a running prioritized highlightOnce, e.g. when the viewport scrolls */
+  public setHighlightPriority(options: HighlightOnceOptions, priorityRange: HighlightLineRange): void {
+    const request = this.prioritizedRequests.get(options)
+    if (!request) return
+    options.priorityRange = priorityRange
+    request.slot.worker.postMessage({ type: "SET_HIGHLIGHT_PRIORITY", messageId: request.messageId, priorityRange })
+  }
+
+  private handleWorkerMessage(slot: WorkerSlot, event: MessageEvent) {
+    const { type, bufferId, error, highlights, lineRanges, warning, messageId, hasParser, performance, version } =
+      event.data
+
+    if (type === "MESSAGE_DONE") {
+      this.finishMessage(slot, event.data.seq)
+      return
+    }
 
     if (type === "HIGHLIGHT_RESPONSE") {
       const buffer = this.buffers.get(bufferId)
       if (!buffer || !buffer.hasParser) return
       if (buffer.version !== version) {
+        // Deltas for newer versions are already on their way to the worker
+        if (this.options.editTransfer !== "full") return
         this.resetBuffer(bufferId, buffer.version, buffer.content)
         return
       }
-      this.emit("highlights:response", bufferId, version, highlights)
+      this.emit("highlights:response", bufferId, version, highlights, lineRanges)
+    }
+
+    if (type === "RESYNC_REQUEST") {
+      const buffer = this.buffers.get(bufferId)
+      if (!buffer || !buffer.hasParser) return
+      this.resetBuffer(bufferId, buffer.version, buffer.content)
+      return
     }
 
     if (type === "INIT_RESPONSE") {
       if (this.initializeResolvers) {
-        clearTimeout(this.initializeResolvers.timeoutId)
         if (error) {
+          clearTimeout(this.initializeResolvers.timeoutId)
           console.error("TreeSitter client initialization failed:", error)
           this.initializeResolvers.reject(new Error(error))
-        } else {
-          this.initialized = true
-          this.initializeResolvers.resolve()
+          this.initializeResolvers = undefined
+          return
         }
+        // Ready once every worker is
+        if (--this.pendingInitCount > 0) return
+        clearTimeout(this.initializeResolvers.timeoutId)
+        this.initialized = true
+        this.initializeResolvers.resolve()
         this.initializeResolvers = undefined
         return
       }
@@ -300,11 +535,16 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
       return
     }
 
+    if (type === "ONESHOT_HIGHLIGHT_PARTIAL") {
+      this.partialCallbacks.get(messageId)?.(highlights, event.data.range)
+      return
+    }
+
     if (type === "ONESHOT_HIGHLIGHT_RESPONSE") {
       const callback = this.messageCallbacks.get(messageId)
       if (callback) {
         this.messageCallbacks.delete(messageId)
-        callback({ highlights, warning, error })
+        callback(event.data.cancelled ? { cancelled: true } : { highlights, warning, error })
       }
       return
     }
@@ -355,10 +595,11 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
   }
 
   public async preloadParser(filetype: string): Promise<boolean> {
+    const slot = this.pickWorker(filetype)
     const messageId = `has_parser_${this.messageIdCounter++}`
     const response = await new Promise<{ hasParser: boolean; warning?: string; error?: string }>((resolve) => {
       this.messageCallbacks.set(messageId, resolve)
-      this.worker?.postMessage({
+      slot?.worker.postMessage({
         type: "PRELOAD_PARSER",
         filetype,
         messageId,
@@ -394,10 +635,21 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
     // Set buffer state immediately to avoid race conditions
     this.buffers.set(id, { id, content, filetype, version, hasParser: false })
 
+    const slot = this.pickWorker(filetype)
+    if (!slot) {
+      this.emitError("Could not create buffer because the client has no workers")
+      return false
+    }
+
+    // Updates wait for the initial parse like they wait for any earlier update
+    const channel: BufferChannel = { slot, sentContent: content, sentVersion: version }
+    slot.bufferCount++
+    this.channels.set(id, channel)
+
     const messageId = `init_${this.messageIdCounter++}`
     const response = await new Promise<{ hasParser: boolean; warning?: string; error?: string }>((resolve) => {
       this.messageCallbacks.set(messageId, resolve)
-      this.worker?.postMessage({
+      channel.inflightSeq = this.postTracked(slot, {
         type: "INITIALIZE_PARSER",
         bufferId: id,
         version,
@@ -405,9 +657,14 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
         filetype,
         messageId,
       })
+      this.seqBuffers.set(channel.inflightSeq, id)
     })
 
     if (!response.hasParser) {
+      if (this.channels.get(id) === channel) {
+        this.channels.delete(id)
+        slot.bufferCount--
+      }
       this.emit("buffer:initialized", id, false)
       if (filetype !== "plaintext") {
         this.emitWarning(response.warning || response.error || "Buffer has no parser", id)
@@ -436,33 +693,54 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
     // Update buffer state
     this.buffers.set(id, { ...buffer, content: newContent, version })
 
-    if (!this.editQueues.has(id)) {
-      this.editQueues.set(
-        id,
-        new ProcessQueue<EditQueueItem>((item) =>
-          this.processEdit(id, item.edits, item.newContent, item.version, item.isReset),
-        ),
-      )
-    }
+    this.enqueueUpdate(id, { edits, newContent, version })
+  }
+
+  private enqueueUpdate(bufferId: number, item: EditQueueItem): void {
+    const channel = this.channels.get(bufferId)
+    if (!channel) return
 
-    const bufferQueue = this.editQueues.get(id)!
-    bufferQueue.enqueue({ edits, newContent, version })
+    channel.pending = channel.pending ? mergeUpdates(channel.pending, item, channel.sentContent) : item
+    if (channel.inflightSeq === undefined) {
+      this.flushUpdate(bufferId, channel)
+    }
   }
 
-  private async processEdit(
-    bufferId: number,
-    edits: Edit[],
-    newContent: string,
-    version: number,
-    isReset = false,
-  ): Promise<void> {
-    this.worker?.postMessage({
-      type: isReset ? "RESET_BUFFER" : "HANDLE_EDITS",
-      bufferId,
-      version,
-      content: newContent,
-      edits,
-    })
+  private flushUpdate(bufferId: number, channel: BufferChannel): void {
+    const item = channel.pending
+    if (!item) return
+    channel.pending = undefined
+
+    const sentAt = performance.timeOrigin + performance.now()
+    let message: any
+    if (item.isReset || this.options.editTransfer === "full") {
+      message = {
+        type: item.isReset ? "RESET_BUFFER" : "HANDLE_EDITS",
+        bufferId,
+        version: item.version,
+        content: item.newContent,
+        edits: item.edits,
+        sentAt,
+      }
+    } else {
+      // The worker holds the content that was sent last, so the change since
+      // then is all it needs
+      message = {
+        type: "HANDLE_EDITS",
+        bufferId,
+        version: item.version,
+        baseVersion: channel.sentVersion,
+        delta: computeTextDelta(channel.sentContent, item.newContent, item.edits),
+        contentLength: item.newContent.length,
+        edits: item.edits,
+        sentAt,
+      }
+    }
+
+    channel.sentContent = item.newContent
+    channel.sentVersion = item.version
+    channel.inflightSeq = this.postTracked(channel.slot, message)
+    this.seqBuffers.set(channel.inflightSeq, bufferId)
   }
 
   public async removeBuffer(bufferId: number): Promise<void> {
@@ -472,17 +750,19 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
 
     this.buffers.delete(bufferId)
 
-    if (this.editQueues.has(bufferId)) {
-      this.editQueues.get(bufferId)?.clear()
-      this.editQueues.delete(bufferId)
+    const channel = this.channels.get(bufferId)
+    if (channel) {
+      this.channels.delete(bufferId)
+      channel.slot.bufferCount--
     }
 
-    if (this.worker) {
+    const slot = channel?.slot ?? this.workers[0]
+    if (slot) {
       await new Promise<boolean>((resolve) => {
         const messageId = `dispose_${bufferId}`
         this.messageCallbacks.set(messageId, resolve)
         try {
-          this.worker!.postMessage({
+          slot.worker.postMessage({
             type: "DISPOSE_BUFFER",
             bufferId,
           })
@@ -523,14 +803,15 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
       }
     }
     this.messageCallbacks.clear()
+    this.partialCallbacks.clear()
+    this.prioritizedRequests.clear()
 
     clearDebounceScope("tree-sitter-client")
     this.debouncer.clear()
 
-    this.editQueues.clear()
     this.buffers.clear()
 
-    this.stopWorker()
+    this.stopWorkers()
 
     this.initialized = false
     this.initializePromise = undefined
@@ -551,7 +832,9 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
     this.buffers.set(bufferId, { ...buffer, content, version })
 
     // Use debouncer to avoid excessive resets
-    this.debouncer.debounce(`reset-${bufferId}`, 10, () => this.processEdit(bufferId, [], content, version, true))
+    this.debouncer.debounce(`reset-${bufferId}`, 10, () =>
+      this.enqueueUpdate(bufferId, { edits: [], newContent: content, version, isReset: true }),
+    )
   }
 
   public getBuffer(bufferId: number): BufferState | undefined {
@@ -573,43 +856,31 @@ export class TreeSitterClient extends EventEmitter<TreeSitterClientEvents> {
 
     this.options.dataPath = dataPath
 
-    if (this.initialized && this.worker) {
-      const messageId = `update_datapath_${this.messageIdCounter++}`
-      return new Promise<void>((resolve, reject) => {
-        this.messageCallbacks.set(messageId, (response: any) => {
-          if (response.error) {
-            reject(new Error(response.error))
-          } else {
-            resolve()
-          }
-        })
-        this.worker!.postMessage({
-          type: "UPDATE_DATA_PATH",
-          dataPath,
-          messageId,
-        })
-      })
+    if (this.initialized && this.workers.length > 0) {
+      const responses = await this.requestAll<{ error?: string }>(
+        { type: "UPDATE_DATA_PATH", dataPath },
+        "update_datapath",
+      )
+      const failed = responses.find((response) => response.error)
+      if (failed) {
+        throw new Error(failed.error)
+      }
     }
   }
 
   public async clearCache(): Promise<void> {
-    if (!this.initialized || !this.worker) {
+    if (!this.initialized || this.workers.length === 0) {
       throw new Error("Cannot clear cache: client is not initialized")
     }
 
-    const messageId = `clear_cache_${this.messageIdCounter++}`
-    return new Promise<void>((resolve, reject) => {
-      this.messageCallbacks.set(messageId, (response: any) => {
-        if (response.error) {
-          reject(new Error(response.error))
-        } else {
-          resolve()
-        }
-      })
-      this.worker!.postMessage({
-        type: "CLEAR_CACHE",
-        messageId,
-      })
-    })
+    const responses = await this.requestAll<{ error?: string }>({ type: "CLEAR_CACHE" }, "clear_cache")
+    // Workers dropped their loaded parsers, so none is warm for any filetype
+    for (const slot of this.workers) {
+      slot.filetypes.clear()
+    }
+    const failed = responses.find((response) => response.error)
+    if (failed) {
+      throw new Error(failed.error)
+    }
   }
 }
@@ -1,5 +1,5 @@
 import { Parser, Query, Tree, Language } from "web-tree-sitter"
-import type { Edit, QueryCapture, Range } from "web-tree-sitter"
+import type { Edit, Point, QueryCapture, Range } from "web-tree-sitter"
 import { mkdir } from "fs/promises"
 import * as path from "path"
 import type {
@@ -9,8 +9,11 @@ import type {
   FiletypeParserOptions,
   PerformanceStats,
   InjectionMapping,
+  TextDelta,
+  HighlightLineRange,
 } from "./types"
 import { DownloadUtils } from "./download-utils"
+import { applyTextDelta } from "./text-delta"
 import { isMainThread } from "worker_threads"
 import { isBunfsPath, normalizeBunfsPath } from "../bunfs"
 
@@ -25,7 +28,102 @@ type ParserState = {
   }
   filetype: string
   content: string
+  version: number
   injectionMapping?: InjectionMapping
+  injections: InjectionEntry[]
+}
+
+// Highlight captures of one injected region, positioned relative to its start
+interface InjectionEntry {
+  language: string
+  query: Query
+  startIndex: number
+  endIndex: number
+  startPosition: Point
+  endPosition: Point
+  captures: Array<{
+    name: string
+    patternIndex: number
+    id: number
+    startIndex: number
+    endIndex: number
+    startPosition: Point
+    endPosition: Point
+  }>
+}
+
+// Buffer text an update applies to: a full snapshot, or a delta against baseVersion
+type EditContent = { content: string } | { delta: TextDelta; baseVersion: number; contentLength: number }
+
+const MAX_TIMING_SAMPLES = 10
+
+function pushTiming(samples: number[], time: number): number {
+  samples.push(time)
+  if (samples.length > MAX_TIMING_SAMPLES) {
+    samples.shift()
+  }
+  return samples.reduce((acc, sample) => acc + sample, 0) / samples.length
+}
+
+// Prioritized one-shot highlighting works through the document in slices of
+// this many lines, yielding to the message loop between them
+const BACKFILL_SLICE_LINES = 2000
+// Lines above the viewport parsed with it for the first, approximate pass
+const FIRST_PAINT_CONTEXT_LINES = 100
+
+function yieldToMessages(): Promise<void> {
+  return new Promise((resolve) => setTimeout(resolve, 0))
+}
+
+function computeLineStarts(content: string): number[] {
+  const lineStarts = [0]
+  let index = content.indexOf("\n")
+  while (index !== -1) {
+    lineStarts.push(index + 1)
+    index = content.indexOf("\n", index + 1)
+  }
+  return lineStarts
+}
+
+// Concatenate highlight lists, dropping the duplicates of nodes that were
+// captured by more than one slice, and sort by start offset
+function mergeSimpleHighlights(lists: SimpleHighlight[][]): SimpleHighlight[] {
+  const seen = new Set<string>()
+  const merged: SimpleHighlight[] = []
+  for (const list of lists) {
+    for (const highlight of list) {
+      const key = `${highlight[0]}:${highlight[1]}:${highlight[2]}`
+      if (seen.has(key)) continue
+      seen.add(key)
+      merged.push(highlight)
+    }
+  }
+  merged.sort((a, b) => a[0] - b[0])
+  return merged
+}
+
+// Where a point of the text before `edit` ends up after it. Points inside the
+// replaced text go to its start, or to the end of the new text for `isEnd`.
+function mapThroughEdit(index: number, position: Point, edit: Edit, isEnd: boolean): [number, Point] {
+  if (index <= edit.startIndex) {
+    return [index, position]
+  }
+  if (index < edit.oldEndIndex) {
+    return isEnd ? [edit.newEndIndex, edit.newEndPosition] : [edit.startIndex, edit.startPosition]
+  }
+  const column =
+    position.row === edit.oldEndPosition.row
+      ? position.column - edit.oldEndPosition.column + edit.newEndPosition.column
+      : position.column
+  return [
+    index - edit.oldEndIndex + edit.newEndIndex,
+    { row: position.row - edit.oldEndPosition.row + edit.newEndPosition.row, column },
+  ]
+}
+
+interface PrioritizedRequest {
+  priorityRange: HighlightLineRange
+  cancelled: boolean
 }
 
 interface FiletypeParser {
@@ -54,6 +152,7 @@ class ParserWorker {
   private filetypeParserPromises: Map<string, Promise<FiletypeParser | undefined>> = new Map()
   private reusableParsers: Map<string, ReusableParserState> = new Map()
   private reusableParserPromises: Map<string, Promise<ReusableParserState | undefined>> = new Map()
+  private prioritizedRequests: Map<string, PrioritizedRequest> = new Map()
   private initializePromise: Promise<void> | undefined
   public performance: PerformanceStats
   private dataPath: string | undefined
@@ -66,9 +165,24 @@ class ParserWorker {
       parseTimes: [],
       averageQueryTime: 0,
       queryTimes: [],
+      averageTransferTime: 0,
+      transferTimes: [],
+      deltaUpdates: 0,
+      fullUpdates: 0,
+      resyncs: 0,
     }
   }
 
+  public recordTransfer(sentAt: number | undefined): void {
+    if (typeof sentAt !== "number") return
+    const transferTime = performance.timeOrigin + performance.now() - sentAt
+    this.performance.averageTransferTime = pushTiming(this.performance.transferTimes, transferTime)
+  }
+
+  private recordParse(parseTime: number): void {
+    this.performance.averageParseTime = pushTiming(this.performance.parseTimes, parseTime)
+  }
+
   private async fetchQueries(sources: string[], filetype: string): Promise<string> {
     if (!this.tsDataPath) {
       return ""
@@ -313,7 +427,9 @@ class ParserWorker {
       queries: filetypeParser.queries,
       filetype,
       content,
+      version,
       injectionMapping: filetypeParser.injectionMapping,
+      injections: [],
     }
     this.bufferParsers.set(bufferId, parserState)
 
@@ -350,8 +466,14 @@ class ParserWorker {
     return content.substring(node.startIndex, node.endIndex)
   }
 
+  /**
+   * Highlight captures of injected languages. Without `lineRanges` every
+   * injection is parsed again; with them, only injections on those lines are,
+   * and the cached captures of the rest are reused.
+   */
   private async processInjections(
     parserState: ParserState,
+    lineRanges?: HighlightLineRange[],
   ): Promise<{ captures: QueryCapture[]; injectionRanges: Map<string, Array<{ start: number; end: number }>> }> {
     const injectionMatches: QueryCapture[] = []
     const injectionRanges = new Map<string, Array<{ start: number; end: number }>>()
@@ -360,17 +482,101 @@ class ParserWorker {
       return { captures: injectionMatches, injectionRanges }
     }
 
+    const overlaps = (entry: InjectionEntry) =>
+      !lineRanges ||
+      lineRanges.some((range) => entry.startPosition.row < range.endLine && entry.endPosition.row >= range.startLine)
+
+    parserState.injections = parserState.injections.filter((entry) => !overlaps(entry))
+
+    const found = this.findInjections(parserState, lineRanges)
+    for (const [language, nodes] of found.entries()) {
+      const injectedParser = await this.getReusableParser(language)
+
+      if (!injectedParser) {
+        console.warn(`No parser found for injection language: ${language}`)
+        continue
+      }
+
+      for (const injectionNode of nodes) {
+        const entry = this.parseInjection(parserState, language, injectionNode, injectedParser)
+        if (entry) {
+          parserState.injections.push(entry)
+        }
+      }
+    }
+
+    for (const entry of parserState.injections) {
+      if (!overlaps(entry)) continue
+
+      if (!injectionRanges.has(entry.language)) {
+        injectionRanges.set(entry.language, [])
+      }
+      injectionRanges.get(entry.language)!.push({ start: entry.startIndex, end: entry.endIndex })
+
+      for (const capture of entry.captures) {
+        // Shift the cached capture from the injection's start to its place in the host buffer
+        const offsetCapture: QueryCapture & { _injectedQuery?: Query } = {
+          name: capture.name,
+          patternIndex: capture.patternIndex,
+          _injectedQuery: entry.query, // Store the correct query reference
+          node: {
+            id: capture.id,
+            startPosition: {
+              row: capture.startPosition.row + entry.startPosition.row,
+              column:
+                capture.startPosition.row === 0
+                  ? capture.startPosition.column + entry.startPosition.column
+                  : capture.startPosition.column,
+            },
+            endPosition: {
+              row: capture.endPosition.row + entry.startPosition.row,
+              column:
+                capture.endPosition.row === 0
+                  ? capture.endPosition.column + entry.startPosition.column
+                  : capture.endPosition.column,
+            },
+            startIndex: capture.startIndex + entry.startIndex,
+            endIndex: capture.endIndex + entry.startIndex,
+          } as any, // Cast to any since we're creating a pseudo-node
+        }
+
+        injectionMatches.push(offsetCapture)
+      }
+    }
+
+    return { captures: injectionMatches, injectionRanges }
+  }
+
+  /** Injection nodes on the given lines (or in the whole tree), grouped by target language */
+  private findInjections(parserState: ParserState, lineRanges?: HighlightLineRange[]): Map<string, any[]> {
+    const languageGroups = new Map<string, any[]>()
+    const injectionsQuery = parserState.queries.injections
+    if (!injectionsQuery) {
+      return languageGroups
+    }
+
     const content = parserState.content
-    const injectionCaptures = parserState.queries.injections.captures(parserState.tree.rootNode)
-    const languageGroups = new Map<string, Array<{ node: any; name: string }>>()
+    const rootNode = parserState.tree.rootNode
+    const injectionCaptures = lineRanges
+      ? lineRanges.flatMap((range) =>
+          injectionsQuery.captures(rootNode, {
+            startPosition: { row: range.startLine, column: 0 },
+            endPosition: { row: range.endLine, column: 0 },
+          }),
+        )
+      : injectionsQuery.captures(rootNode)
 
     // Use the injection mapping stored in the parser state
     const injectionMapping = parserState.injectionMapping
+    const seen = new Set<number>()
 
     for (const capture of injectionCaptures) {
       const captureName = capture.name
 
       if (captureName === "injection.content" || captureName.includes("injection")) {
+        if (seen.has(capture.node.id)) continue
+        seen.add(capture.node.id)
+
         const nodeType = capture.node.type
         let targetLanguage: string | undefined
 
@@ -401,218 +607,216 @@ class ParserWorker {
           if (!languageGroups.has(targetLanguage)) {
             languageGroups.set(targetLanguage, [])
           }
-          languageGroups.get(targetLanguage)!.push({ node: capture.node, name: capture.name })
+          languageGroups.get(targetLanguage)!.push(capture.node)
         }
       }
     }
 
-    // Process each language group
-    for (const [language, captures] of languageGroups.entries()) {
-      const injectedParser = await this.getReusableParser(language)
-
-      if (!injectedParser) {
-        console.warn(`No parser found for injection language: ${language}`)
-        continue
-      }
+    return languageGroups
+  }
 
-      // Track injection ranges for this language
-      if (!injectionRanges.has(language)) {
-        injectionRanges.set(language, [])
+  private parseInjection(
+    parserState: ParserState,
+    language: string,
+    injectionNode: any,
+    injectedParser: ReusableParserState,
+  ): InjectionEntry | undefined {
+    try {
+      const injectionContent = this.getNodeText(injectionNode, parserState.content)
+      const tree = injectedParser.parser.parse(injectionContent)
+      if (!tree) {
+        return undefined
       }
 
-      const parser = injectedParser.parser
-      for (const { node: injectionNode } of captures) {
-        try {
-          // Record the injection range
-          injectionRanges.get(language)!.push({
-            start: injectionNode.startIndex,
-            end: injectionNode.endIndex,
-          })
-
-          const injectionContent = this.getNodeText(injectionNode, content)
-          const tree = parser.parse(injectionContent)
-
-          if (tree) {
-            const matches = injectedParser.queries.highlights.captures(tree.rootNode)
-
-            // Create new QueryCapture objects with offset positions
-            for (const match of matches) {
-              // Calculate offset positions by creating a new capture with adjusted node properties
-              // Store the injected query reference so we can look up properties correctly
-              const offsetCapture: QueryCapture & { _injectedQuery?: Query } = {
-                name: match.name,
-                patternIndex: match.patternIndex,
-                _injectedQuery: injectedParser.queries.highlights, // Store the correct query reference
-                node: {
-                  ...match.node,
-                  startPosition: {
-                    row: match.node.startPosition.row + injectionNode.startPosition.row,
-                    column:
-                      match.node.startPosition.row === 0
-                        ? match.node.startPosition.column + injectionNode.startPosition.column
-                        : match.node.startPosition.column,
-                  },
-                  endPosition: {
-                    row: match.node.endPosition.row + injectionNode.startPosition.row,
-                    column:
-                      match.node.endPosition.row === 0
-                        ? match.node.endPosition.column + injectionNode.startPosition.column
-                        : match.node.endPosition.column,
-                  },
-                  startIndex: match.node.startIndex + injectionNode.startIndex,
-                  endIndex: match.node.endIndex + injectionNode.startIndex,
-                } as any, // Cast to any since we're creating a pseudo-node
-              }
-
-              injectionMatches.push(offsetCapture)
-            }
-
-            tree.delete()
-          }
-        } catch (error) {
-          console.error(`Error processing injection for language ${language}:`, error)
+      try {
+        const captures = injectedParser.queries.highlights.captures(tree.rootNode).map((match) => ({
+          name: match.name,
+          patternIndex: match.patternIndex,
+          id: match.node.id,
+          startIndex: match.node.startIndex,
+          endIndex: match.node.endIndex,
+          startPosition: match.node.startPosition,
+          endPosition: match.node.endPosition,
+        }))
+
+        return {
+          language,
+          query: injectedParser.queries.highlights,
+          startIndex: injectionNode.startIndex,
+          endIndex: injectionNode.endIndex,
+          startPosition: injectionNode.startPosition,
+          endPosition: injectionNode.endPosition,
+          captures,
         }
+      } finally {
+        // NOTE: Do NOT call parser.delete() here - this is a reusable parser!
+        tree.delete()
       }
-
-      // NOTE: Do NOT call parser.delete() here - this is a reusable parser!
+    } catch (error) {
+      console.error(`Error processing injection for language ${language}:`, error)
+      return undefined
     }
+  }
 
-    return { captures: injectionMatches, injectionRanges }
+  /**
+   * Keep cached injections valid across an edit: ones before it stay, ones
+   * after it move with the text, and ones it touches are dropped so the next
+   * injection pass parses them again.
+   */
+  private shiftInjections(parserState: ParserState, edit: Edit): void {
+    const indexDelta = edit.newEndIndex - edit.oldEndIndex
+    const rowDelta = edit.newEndPosition.row - edit.oldEndPosition.row
+
+    parserState.injections = parserState.injections.filter((entry) => {
+      if (entry.endIndex < edit.startIndex) {
+        return true
+      }
+      if (entry.startIndex > edit.oldEndIndex && entry.startPosition.row > edit.oldEndPosition.row) {
+        entry.startIndex += indexDelta
+        entry.endIndex += indexDelta
+        entry.startPosition = { row: entry.startPosition.row + rowDelta, column: entry.startPosition.column }
+        entry.endPosition = { row: entry.endPosition.row + rowDelta, column: entry.endPosition.column }
+        return true
+      }
+      return false
+    })
   }
 
-  private editToRange(edit: Edit): Range {
-    return {
-      startPosition: {
-        column: edit.startPosition.column,
-        row: edit.startPosition.row,
-      },
-      endPosition: {
-        column: edit.newEndPosition.column,
-        row: edit.newEndPosition.row,
-      },
-      startIndex: edit.startIndex,
-      endIndex: edit.newEndIndex,
-    }
+  /**
+   * The text each edit inserted, as ranges of the final content. An edit is in
+   * the coordinates of the text right after it, so it is carried through the
+   * edits that follow it; one that adds or removes lines above moves it.
+   */
+  private editRanges(edits: Edit[]): Range[] {
+    return edits.map((edit, i) => {
+      let start: [number, Point] = [edit.startIndex, edit.startPosition]
+      let end: [number, Point] = [edit.newEndIndex, edit.newEndPosition]
+      for (const later of edits.slice(i + 1)) {
+        start = mapThroughEdit(start[0], start[1], later, false)
+        end = mapThroughEdit(end[0], end[1], later, true)
+      }
+      return {
+        startPosition: { row: start[1].row, column: start[1].column },
+        endPosition: { row: end[1].row, column: end[1].column },
+        startIndex: start[0],
+        endIndex: end[0],
+      }
+    })
   }
 
   async handleEdits(
     bufferId: number,
-    content: string,
+    version: number,
+    update: EditContent,
     edits: Edit[],
-  ): Promise<{ highlights?: HighlightResponse[]; warning?: string; error?: string }> {
+  ): Promise<{
+    highlights?: HighlightResponse[]
+    lineRanges?: HighlightLineRange[]
+    warning?: string
+    error?: string
+    resync?: boolean
+  }> {
     const parserState = this.bufferParsers.get(bufferId)
     if (!parserState) {
       return { warning: "No parser state found for buffer" }
     }
 
+    let content: string
+    if ("delta" in update) {
+      // A delta is only valid against the exact version it was computed from
+      if (parserState.version !== update.baseVersion) {
+        this.performance.resyncs++
+        return { resync: true }
+      }
+      content = applyTextDelta(parserState.content, update.delta)
+      if (content.length !== update.contentLength) {
+        this.performance.resyncs++
+        return { resync: true }
+      }
+      this.performance.deltaUpdates++
+    } else {
+      content = update.content
+      this.performance.fullUpdates++
+    }
+
     parserState.content = content
+    parserState.version = version
 
     for (const edit of edits) {
       parserState.tree.edit(edit)
+      this.shiftInjections(parserState, edit)
     }
 
     const startParse = performance.now()
 
     const newTree = parserState.parser.parse(content, parserState.tree)
 
-    const endParse = performance.now()
-    const parseTime = endParse - startParse
-    this.performance.parseTimes.push(parseTime)
-    if (this.performance.parseTimes.length > 10) {
-      this.performance.parseTimes.shift()
-    }
-    this.performance.averageParseTime =
-      this.performance.parseTimes.reduce((acc, time) => acc + time, 0) / this.performance.parseTimes.length
+    this.recordParse(performance.now() - startParse)
 
     if (!newTree) {
       return { error: "Failed to parse buffer" }
     }
 
-    const changedRanges = parserState.tree.getChangedRanges(newTree)
+    // Changed structure plus the edited text, widened to whole lines
+    const lineRanges = this.toLineRanges([
+      ...parserState.tree.getChangedRanges(newTree),
+      ...this.editRanges(edits),
+    ])
     parserState.tree = newTree
 
     const startQuery = performance.now()
     const matches: QueryCapture[] = []
+    const seen = new Set<string>()
 
-    if (changedRanges.length === 0) {
-      edits.forEach((edit) => {
-        const range = this.editToRange(edit)
-        changedRanges.push(range)
+    for (const range of lineRanges) {
+      const rangeCaptures = parserState.queries.highlights.captures(parserState.tree.rootNode, {
+        startPosition: { row: range.startLine, column: 0 },
+        endPosition: { row: range.endLine, column: 0 },
       })
-    }
-
-    for (const range of changedRanges) {
-      let node = parserState.tree.rootNode.descendantForPosition(range.startPosition, range.endPosition)
-
-      if (!node) {
-        continue
-      }
-
-      // If we got the root node, query with range to limit scope
-      if (node.equals(parserState.tree.rootNode)) {
-        // WHY ARE RANGES NOT WORKING!?
-        // The changed ranges are not returning anything in some cases
-        // Even this shit somehow returns many lines before the actual range,
-        // and even though expanded by 1000 bytes it does not capture much beyond the actual range.
-        // So freaking weird.
-        const rangeCaptures = parserState.queries.highlights.captures(
-          node,
-          // WTF!?
-          {
-            startIndex: range.startIndex - 100,
-            endIndex: range.endIndex + 1000,
-          },
-        )
-        matches.push(...rangeCaptures)
-        continue
-      }
-
-      while (node && !this.nodeContainsRange(node, range)) {
-        node = node.parent
-      }
-
-      if (!node) {
-        node = parserState.tree.rootNode
+      for (const capture of rangeCaptures) {
+        // Nodes spanning several ranges are captured once per range
+        const key = `${capture.node.id}:${capture.patternIndex}:${capture.name}`
+        if (seen.has(key)) continue
+        seen.add(key)
+        matches.push(capture)
       }
-
-      const nodeCaptures = parserState.queries.highlights.captures(node)
-      matches.push(...nodeCaptures)
     }
 
     let injectionRanges = new Map<string, Array<{ start: number; end: number }>>()
     if (parserState.queries.injections) {
-      const injectionResult = await this.processInjections(parserState)
-      // Only add injection matches that are in the changed ranges
-      // This is a simplification - ideally we'd only process injections in changed ranges
+      const injectionResult = await this.processInjections(parserState, lineRanges)
       matches.push(...injectionResult.captures)
       injectionRanges = injectionResult.injectionRanges
     }
 
-    const endQuery = performance.now()
-    const queryTime = endQuery - startQuery
-    this.performance.queryTimes.push(queryTime)
-    if (this.performance.queryTimes.length > 10) {
-      this.performance.queryTimes.shift()
-    }
-    this.performance.averageQueryTime =
-      this.performance.queryTimes.reduce((acc, time) => acc + time, 0) / this.performance.queryTimes.length
+    this.performance.averageQueryTime = pushTiming(this.performance.queryTimes, performance.now() - startQuery)
 
-    return this.getHighlights(parserState, matches, injectionRanges)
+    return { ...this.getHighlights(parserState, matches, injectionRanges, lineRanges), lineRanges }
   }
 
-  private nodeContainsRange(node: any, range: any): boolean {
-    return (
-      node.startPosition.row <= range.startPosition.row &&
-      node.endPosition.row >= range.endPosition.row &&
-      (node.startPosition.row < range.startPosition.row || node.startPosition.column <= range.startPosition.column) &&
-      (node.endPosition.row > range.endPosition.row || node.endPosition.column >= range.endPosition.column)
-    )
+  /** Sorted, merged [startLine, endLine) ranges covering every row the ranges touch */
+  private toLineRanges(ranges: Range[]): HighlightLineRange[] {
+    const sorted = ranges
+      .map((range) => ({ startLine: range.startPosition.row, endLine: range.endPosition.row + 1 }))
+      .sort((a, b) => a.startLine - b.startLine)
+
+    const merged: HighlightLineRange[] = []
+    for (const range of sorted) {
+      const last = merged[merged.length - 1]
+      if (last && range.startLine <= last.endLine) {
+        last.endLine = Math.max(last.endLine, range.endLine)
+      } else {
+        merged.push(range)
+      }
+    }
+    return merged
   }
 
   private getHighlights(
     parserState: ParserState,
     matches: QueryCapture[],
     injectionRanges?: Map<string, Array<{ start: number; end: number }>>,
+    lineRanges?: HighlightLineRange[],
   ): { highlights: HighlightResponse[] } {
     const lineHighlights: Map<number, Map<number, HighlightRange>> = new Map()
     const droppedHighlights: Map<number, Map<number, HighlightRange>> = new Map()
@@ -652,8 +856,13 @@ class ParserWorker {
       }
     }
 
+    // Nodes reaching outside the patched lines must not touch the lines beyond it
+    const entries = Array.from(lineHighlights.entries()).filter(
+      ([line]) => !lineRanges || lineRanges.some((range) => line >= range.startLine && line < range.endLine),
+    )
+
     return {
-      highlights: Array.from(lineHighlights.entries()).map(([line, lineHighlights]) => ({
+      highlights: entries.map(([line, lineHighlights]) => ({
         line,
         highlights: Array.from(lineHighlights.values()),
         droppedHighlights: droppedHighlights.get(line) ? Array.from(droppedHighlights.get(line)!.values()) : [],
@@ -735,8 +944,12 @@ class ParserWorker {
     }
 
     parserState.content = content
+    parserState.version = version
+    this.performance.fullUpdates++
 
+    const startParse = performance.now()
     const newTree = parserState.parser.parse(content)
+    this.recordParse(performance.now() - startParse)
 
     if (!newTree) {
       return { error: "Failed to parse buffer during reset" }
@@ -807,7 +1020,9 @@ class ParserWorker {
           queries: reusableState.filetypeParser.queries,
           filetype,
           content,
+          version: 0,
           injectionMapping: reusableState.filetypeParser.injectionMapping,
+          injections: [],
         }
         const injectionResult = await this.processInjections(parserState)
 
@@ -828,6 +1043,224 @@ class ParserWorker {
     }
   }
 
+  /**
+   * One-shot highlighting that answers the priority range (the viewport) first.
+   * A quick parse of just the lines around it is sent right away, then the
+   * whole document is parsed and highlighted slice by slice, nearest the
+   * priority range first. Partial results, each carrying the lines it covers,
+   * go out whenever the slices covering the current priority range are done;
+   * the full result ends the request.
+   */
+  async handlePrioritizedHighlight(
+    content: string,
+    filetype: string,
+    messageId: string,
+    priorityRange: HighlightLineRange,
+  ): Promise<void> {
+    const reusableState = await this.getReusableParser(filetype)
+
+    if (!reusableState) {
+      self.postMessage({
+        type: "ONESHOT_HIGHLIGHT_RESPONSE",
+        messageId,
+        hasParser: false,
+        warning: `No parser available for filetype ${filetype}`,
+      })
+      return
+    }
+
+    const request: PrioritizedRequest = { priorityRange, cancelled: false }
+    this.prioritizedRequests.set(messageId, request)
+
+    try {
+      const lineStarts = computeLineStarts(content)
+      const lineCount = lineStarts.length
+      const clampRange = (range: HighlightLineRange): HighlightLineRange => {
+        const startLine = Math.min(Math.max(0, range.startLine), lineCount - 1)
+        return { startLine, endLine: Math.min(Math.max(startLine + 1, range.endLine), lineCount) }
+      }
+
+      const firstPaintRange = clampRange(request.priorityRange)
+      const firstPaint = await this.highlightWindow(reusableState, filetype, content, lineStarts, firstPaintRange)
+      self.postMessage({ type: "ONESHOT_HIGHLIGHT_PARTIAL", messageId, highlights: firstPaint, range: firstPaintRange })
+
+      await yieldToMessages()
+      if (request.cancelled) {
+        self.postMessage({ type: "ONESHOT_HIGHLIGHT_RESPONSE", messageId, hasParser: true, cancelled: true })
+        return
+      }
+
+      // Markdown Parser BUG: see handleOneShotHighlight
+      const parseContent = filetype === "markdown" && content.endsWith("```") ? content + "\n" : content
+      const tree = reusableState.parser.parse(parseContent)
+
+      if (!tree) {
+        self.postMessage({
+          type: "ONESHOT_HIGHLIGHT_RESPONSE",
+          messageId,
+          hasParser: false,
+          error: "Failed to parse content",
+        })
+        return
+      }
+
+      try {
+        const parserState: ParserState = {
+          parser: reusableState.parser,
+          tree,
+          queries: reusableState.filetypeParser.queries,
+          filetype,
+          content,
+          version: 0,
+          injectionMapping: reusableState.filetypeParser.injectionMapping,
+          injections: [],
+        }
+
+        const sliceCount = Math.ceil(lineCount / BACKFILL_SLICE_LINES)
+        const slices: Array<SimpleHighlight[] | undefined> = new Array(sliceCount)
+        const announced = new Set<number>()
+        let remaining = sliceCount
+
+        while (remaining > 0) {
+          if (request.cancelled) {
+            self.postMessage({ type: "ONESHOT_HIGHLIGHT_RESPONSE", messageId, hasParser: true, cancelled: true })
+            return
+          }
+
+          const priority = clampRange(request.priorityRange)
+          const firstSlice = Math.floor(priority.startLine / BACKFILL_SLICE_LINES)
+          const lastSlice = Math.floor((priority.endLine - 1) / BACKFILL_SLICE_LINES)
+
+          // Undone slice nearest the priority range
+          let next = -1
+          let nextDistance = Infinity
+          for (let slice = 0; slice < sliceCount; slice++) {
+            if (slices[slice]) continue
+            const distance = slice < firstSlice ? firstSlice - slice : slice > lastSlice ? slice - lastSlice : 0
+            if (distance < nextDistance) {
+              next = slice
+              nextDistance = distance
+            }
+          }
+
+          slices[next] = await this.highlightLines(parserState, {
+            startLine: next * BACKFILL_SLICE_LINES,
+            endLine: Math.min((next + 1) * BACKFILL_SLICE_LINES, lineCount),
+          })
+          remaining--
+
+          let priorityDone = true
+          let priorityAnnounced = true
+          for (let slice = firstSlice; slice <= lastSlice; slice++) {
+            if (!slices[slice]) priorityDone = false
+            if (!announced.has(slice)) priorityAnnounced = false
+          }
+          if (priorityDone && !priorityAnnounced && remaining > 0) {
+            for (let slice = firstSlice; slice <= lastSlice; slice++) {
+              announced.add(slice)
+            }
+            // Only the priority slices; lines colored by earlier partials stay as they are
+            const highlights = mergeSimpleHighlights(slices.slice(firstSlice, lastSlice + 1) as SimpleHighlight[][])
+            const range: HighlightLineRange = {
+              startLine: firstSlice * BACKFILL_SLICE_LINES,
+              endLine: Math.min((lastSlice + 1) * BACKFILL_SLICE_LINES, lineCount),
+            }
+            self.postMessage({ type: "ONESHOT_HIGHLIGHT_PARTIAL", messageId, highlights, range })
+          }
+
+          if (remaining > 0) {
+            await yieldToMessages()
+          }
+        }
+
+        self.postMessage({
+          type: "ONESHOT_HIGHLIGHT_RESPONSE",
+          messageId,
+          hasParser: true,
+          highlights: mergeSimpleHighlights(slices as SimpleHighlight[][]),
+        })
+      } finally {
+        tree.delete()
+      }
+    } finally {
+      this.prioritizedRequests.delete(messageId)
+    }
+  }
+
+  /** Approximate highlights for `range` from parsing only the lines around it */
+  private async highlightWindow(
+    reusableState: ReusableParserState,
+    filetype: string,
+    content: string,
+    lineStarts: number[],
+    range: HighlightLineRange,
+  ): Promise<SimpleHighlight[]> {
+    const windowStartLine = Math.max(0, range.startLine - FIRST_PAINT_CONTEXT_LINES)
+    const windowStart = lineStarts[windowStartLine]
+    const windowEnd = range.endLine < lineStarts.length ? lineStarts[range.endLine] : content.length
+    const windowContent = content.slice(windowStart, windowEnd)
+
+    const parseContent =
+      filetype === "markdown" && windowContent.endsWith("```") ? windowContent + "\n" : windowContent
+    const tree = reusableState.parser.parse(parseContent)
+    if (!tree) {
+      return []
+    }
+
+    try {
+      const parserState: ParserState = {
+        parser: reusableState.parser,
+        tree,
+        queries: reusableState.filetypeParser.queries,
+        filetype,
+        content: windowContent,
+        version: 0,
+        injectionMapping: reusableState.filetypeParser.injectionMapping,
+        injections: [],
+      }
+      const highlights = await this.highlightLines(parserState, {
+        startLine: range.startLine - windowStartLine,
+        endLine: range.endLine - windowStartLine,
+      })
+      return highlights.map(
+        ([start, end, group, meta]): SimpleHighlight =>
+          meta ? [start + windowStart, end + windowStart, group, meta] : [start + windowStart, end + windowStart, group],
+      )
+    } finally {
+      tree.delete()
+    }
+  }
+
+  private async highlightLines(parserState: ParserState, range: HighlightLineRange): Promise<SimpleHighlight[]> {
+    const matches = parserState.queries.highlights.captures(parserState.tree.rootNode, {
+      startPosition: { row: range.startLine, column: 0 },
+      endPosition: { row: range.endLine, column: 0 },
+    })
+
+    let injectionRanges = new Map<string, Array<{ start: number; end: number }>>()
+    if (parserState.queries.injections) {
+      const injectionResult = await this.processInjections(parserState, [range])
+      matches.push(...injectionResult.captures)
+      injectionRanges = injectionResult.injectionRanges
+    }
+
+    return this.getSimpleHighlights(matches, injectionRanges)
+  }
+
+  cancelHighlight(messageId: string): void {
+    const request = this.prioritizedRequests.get(messageId)
+    if (request) {
+      request.cancelled = true
+    }
+  }
+
+  setHighlightPriority(messageId: string, priorityRange: HighlightLineRange): void {
+    const request = this.prioritizedRequests.get(messageId)
+    if (request) {
+      request.priorityRange = priorityRange
+    }
+  }
+
   async updateDataPath(dataPath: string): Promise<void> {
     this.dataPath = dataPath
     this.tsDataPath = path.join(dataPath, "tree-sitter")
@@ -880,7 +1313,9 @@ if (!isMainThread) {
 
   // @ts-ignore - we'll fix this in the future for sure
   self.onmessage = async (e: MessageEvent) => {
-    const { type, bufferId, version, content, filetype, edits, filetypeParser, messageId, dataPath } = e.data
+    const { type, bufferId, version, content, filetype, edits, filetypeParser, messageId, dataPath, priorityRange } =
+      e.data
+    worker.recordTransfer(e.data.sentAt)
 
     try {
       switch (type) {
@@ -910,8 +1345,15 @@ if (!isMainThread) {
           break
 
         case "HANDLE_EDITS":
-          const response = await worker.handleEdits(bufferId, content, edits)
-          if (response.highlights && response.highlights.length > 0) {
+          const { delta, baseVersion, contentLength } = e.data
+          const update: EditContent = delta ? { delta, baseVersion, contentLength } : { content }
+          const response = await worker.handleEdits(bufferId, version, update, edits)
+          if (response.resync) {
+            self.postMessage({ type: "RESYNC_REQUEST", bufferId })
+          } else if (response.lineRanges && response.lineRanges.length > 0) {
+            // An empty patch still clears the highlights of its lines
+            self.postMessage({ type: "HIGHLIGHT_RESPONSE", bufferId, version, ...response })
+          } else if (response.highlights && response.highlights.length > 0) {
             self.postMessage({ type: "HIGHLIGHT_RESPONSE", bufferId, version, ...response })
           } else if (response.warning) {
             self.postMessage({ type: "WARNING", bufferId, warning: response.warning })
@@ -941,7 +1383,19 @@ if (!isMainThread) {
           break
 
         case "ONESHOT_HIGHLIGHT":
-          await worker.handleOneShotHighlight(content, filetype, messageId)
+          if (priorityRange) {
+            await worker.handlePrioritizedHighlight(content, filetype, messageId, priorityRange)
+          } else {
+            await worker.handleOneShotHighlight(content, filetype, messageId)
+          }
+          break
+
+        case "CANCEL_HIGHLIGHT":
+          worker.cancelHighlight(messageId)
+          break
+
+        case "SET_HIGHLIGHT_PRIORITY":
+          worker.setHighlightPriority(messageId, priorityRange)
           break
 
         case "UPDATE_DATA_PATH":
@@ -983,6 +1437,11 @@ if (!isMainThread) {
         bufferId,
         error: error instanceof Error ? error.stack || error.message : String(error),
       })
+    } finally {
+      // Lets the client track queue depth and latency, and send the next update
+      if (typeof e.data.seq === "number") {
+        self.postMessage({ type: "MESSAGE_DONE", seq: e.data.seq })
+      }
     }
   }
 }
@@ -0,0 +1,64 @@
+import { test, expect, describe } from "bun:test"
+import { computeTextDelta, applyTextDelta, deltaToEdit } from "./text-delta"
+import type { Edit } from "./types"
+
+function edit(startIndex: number, oldEndIndex: number, newEndIndex: number): Edit {
+  const position = { row: 0, column: 0 }
+  return {
+    startIndex,
+    oldEndIndex,
+    newEndIndex,
+    startPosition: position,
+    oldEndPosition: position,
+    newEndPosition: position,
+  }
+}
+
+describe("text deltas", () => {
+  test("uses a single edit's range for the inserted text", () => {
+    const oldContent = "const a = 1;"
+    const newContent = "const abc = 1;"
+    const delta = computeTextDelta(oldContent, newContent, [edit(7, 7, 9)])
+
+    expect(delta).toEqual({ start: 7, oldEnd: 7, text: "bc" })
+    expect(applyTextDelta(oldContent, delta)).toBe(newContent)
+  })
+
+  test("falls back to a prefix and suffix diff for several edits", () => {
+    const oldContent = "one two three"
+    const newContent = "one TWO thr"
+    const delta = computeTextDelta(oldContent, newContent, [edit(4, 7, 7), edit(8, 13, 11)])
+
+    expect(delta.start).toBe(4)
+    expect(applyTextDelta(oldContent, delta)).toBe(newContent)
+  })
+
+  test("falls back when the edit does not match the content lengths", () => {
+    const oldContent = "hello world"
+    const newContent = "hello there world"
+    const delta = computeTextDelta(oldContent, newContent, [edit(0, 0, 1)])
+
+    expect(delta).toEqual({ start: 6, oldEnd: 6, text: "there " })
+    expect(applyTextDelta(oldContent, delta)).toBe(newContent)
+  })
+
+  test("handles deletions and unchanged content", () => {
+    expect(applyTextDelta("abcdef", computeTextDelta("abcdef", "af", []))).toBe("af")
+    expect(computeTextDelta("same", "same", [])).toEqual({ start: 4, oldEnd: 4, text: "" })
+  })
+
+  test("turns a delta into an edit with rows in the old and new content", () => {
+    const oldContent = "a\nb = 3\nc"
+    const newContent = "a\nx\ny\nb = 34\nc"
+    const delta = computeTextDelta(oldContent, newContent, [])
+
+    expect(deltaToEdit(oldContent, newContent, delta)).toEqual({
+      startIndex: 2,
+      oldEndIndex: 7,
+      newEndIndex: 12,
+      startPosition: { row: 1, column: 0 },
+      oldEndPosition: { row: 1, column: 5 },
+      newEndPosition: { row: 3, column: 6 },
+    })
+  })
+})
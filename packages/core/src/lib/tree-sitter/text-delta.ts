@@ -0,0 +1,65 @@
+import type { Edit, TextDelta } from "./types"
+
+/**
+ * Describe how `newContent` differs from `oldContent` as a single replaced span.
+ * A single edit is trusted when its lengths add up; anything else falls back to
+ * trimming the common prefix and suffix.
+ */
+export function computeTextDelta(oldContent: string, newContent: string, edits: Edit[]): TextDelta {
+  if (edits.length === 1) {
+    const edit = edits[0]
+    const removed = edit.oldEndIndex - edit.startIndex
+    const inserted = edit.newEndIndex - edit.startIndex
+    if (removed >= 0 && inserted >= 0 && oldContent.length - removed + inserted === newContent.length) {
+      return {
+        start: edit.startIndex,
+        oldEnd: edit.oldEndIndex,
+        text: newContent.slice(edit.startIndex, edit.newEndIndex),
+      }
+    }
+  }
+
+  const maxPrefix = Math.min(oldContent.length, newContent.length)
+  let start = 0
+  while (start < maxPrefix && oldContent.charCodeAt(start) === newContent.charCodeAt(start)) {
+    start++
+  }
+
+  let oldEnd = oldContent.length
+  let newEnd = newContent.length
+  while (oldEnd > start && newEnd > start && oldContent.charCodeAt(oldEnd - 1) === newContent.charCodeAt(newEnd - 1)) {
+    oldEnd--
+    newEnd--
+  }
+
+  return { start, oldEnd, text: newContent.slice(start, newEnd) }
+}
+
+export function applyTextDelta(content: string, delta: TextDelta): string {
+  return content.slice(0, delta.start) + delta.text + content.slice(delta.oldEnd)
+}
+
+function positionAt(content: string, index: number): { row: number; column: number } {
+  let row = 0
+  let lineStart = 0
+  let newline = content.indexOf("\n")
+  while (newline !== -1 && newline < index) {
+    row++
+    lineStart = newline + 1
+    newline = content.indexOf("\n", lineStart)
+  }
+  return { row, column: index - lineStart }
+}
+
+/** A single tree-sitter edit turning `oldContent` into `newContent` as `delta` describes */
+export function deltaToEdit(oldContent: string, newContent: string, delta: TextDelta): Edit {
+  const newEndIndex = delta.start + delta.text.length
+  return {
+    startIndex: delta.start,
+    oldEndIndex: delta.oldEnd,
+    newEndIndex,
+    startPosition: positionAt(oldContent, delta.start),
+    oldEndPosition: positionAt(oldContent, delta.oldEnd),
+    newEndPosition: positionAt(newContent, newEndIndex),
+  }
+}
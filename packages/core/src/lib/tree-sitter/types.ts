@@ -10,6 +10,13 @@ export interface HighlightResponse {
   droppedHighlights: HighlightRange[]
 }
 
+// Lines [startLine, endLine) whose highlights a response replaces; lines in the
+// range without a HighlightResponse have none left
+export interface HighlightLineRange {
+  startLine: number
+  endLine: number
+}
+
 export interface HighlightMeta {
   isInjection?: boolean
   injectionLang?: string
@@ -20,6 +27,17 @@ export interface HighlightMeta {
 
 export type SimpleHighlight = [number, number, string, HighlightMeta?]
 
+export interface HighlightOnceOptions {
+  // Lines highlighted and delivered first, typically the viewport; the rest is
+  // backfilled. Without it the whole document is highlighted in one go.
+  priorityRange?: HighlightLineRange
+  // Highlights for the lines in range, sorted by start offset; they supersede
+  // earlier partials for those lines only
+  onPartial?: (highlights: SimpleHighlight[], range: HighlightLineRange) => void
+  // Stops the backfill; the request then resolves with cancelled: true
+  signal?: AbortSignal
+}
+
 export interface InjectionMapping {
   // Maps tree-sitter node types to target filetypes
   nodeTypes?: { [nodeType: string]: string }
@@ -50,7 +68,13 @@ export interface ParsedBuffer extends BufferState {
 }
 
 export interface TreeSitterClientEvents {
-  "highlights:response": [bufferId: number, version: number, highlights: HighlightResponse[]]
+  // lineRanges is omitted when the highlights cover the whole buffer
+  "highlights:response": [
+    bufferId: number,
+    version: number,
+    highlights: HighlightResponse[],
+    lineRanges?: HighlightLineRange[],
+  ]
   "buffer:initialized": [bufferId: number, hasParser: boolean]
   "buffer:disposed": [bufferId: number]
   "worker:log": [logType: "log" | "error", message: string]
@@ -62,6 +86,8 @@ export interface TreeSitterClientOptions {
   dataPath: string // Directory for storing downloaded parsers and queries
   workerPath?: string | URL
   initTimeout?: number // Timeout in milliseconds for worker initialization, defaults to 10000
+  editTransfer?: "delta" | "full" // How buffer updates reach the worker, defaults to "delta"
+  workerCount?: number // Parser workers to spread buffers and one-shot highlights over, defaults to 1
 }
 
 export interface Edit {
@@ -73,9 +99,37 @@ export interface Edit {
   newEndPosition: { row: number; column: number }
 }
 
+// Replaces content[start, oldEnd) with text, in string indices
+export interface TextDelta {
+  start: number
+  oldEnd: number
+  text: string
+}
+
 export interface PerformanceStats {
   averageParseTime: number
   parseTimes: number[]
   averageQueryTime: number
   queryTimes: number[]
+  averageTransferTime: number // Milliseconds from posting an update to the worker receiving it
+  transferTimes: number[]
+  deltaUpdates: number
+  fullUpdates: number
+  resyncs: number
+}
+
+export interface WorkerStats {
+  index: number
+  queueDepth: number // Messages posted to the worker and not yet finished
+  averageLatency: number // Milliseconds from posting a message to the worker finishing it
+  latencies: number[]
+  filetypes: string[] // Filetypes routed to this worker, whose parsers it keeps loaded
+  bufferCount: number
+  performance: PerformanceStats
+}
+
+// Parse and query stats summed over all workers, plus the pool's own
+export interface ClientPerformanceStats extends PerformanceStats {
+  queueDepth: number // Messages in flight plus buffer updates waiting for their previous one
+  workers: WorkerStats[]
 }
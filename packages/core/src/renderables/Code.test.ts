@@ -4,7 +4,7 @@ import { SyntaxStyle } from "../syntax-style"
 import { RGBA } from "../lib/RGBA"
 import { createTestRenderer, type TestRenderer, MockTreeSitterClient, type MockMouse } from "../testing"
 import { TreeSitterClient } from "../lib/tree-sitter"
-import type { SimpleHighlight } from "../lib/tree-sitter/types"
+import type { HighlightOnceOptions, SimpleHighlight } from "../lib/tree-sitter/types"
 import { BoxRenderable } from "./Box"
 
 let currentRenderer: TestRenderer
@@ -1803,3 +1803,102 @@ test("CodeRenderable - streaming with drawUnstyledText=false falls back to unsty
 
   currentRenderer.stop()
 })
+
+test("CodeRenderable - large content is highlighted viewport first and cancelled when replaced", async () => {
+  const syntaxStyle = SyntaxStyle.fromStyles({
+    default: { fg: RGBA.fromValues(1, 1, 1, 1) },
+    keyword: { fg: RGBA.fromValues(0, 0, 1, 1) },
+  })
+
+  const mockClient = new MockTreeSitterClient()
+  const requests: Array<HighlightOnceOptions | undefined> = []
+  mockClient.highlightOnce = async (content: string, filetype: string, options?: HighlightOnceOptions) => {
+    requests.push(options)
+    return new Promise(() => {})
+  }
+
+  const content = Array.from({ length: 3000 }, (_, i) => `const v${i} = ${i};`).join("\n")
+  const codeRenderable = new CodeRenderable(currentRenderer, {
+    id: "test-code",
+    content,
+    filetype: "javascript",
+    syntaxStyle,
+    treeSitterClient: mockClient,
+    conceal: false,
+    wrapMode: "none",
+    left: 0,
+    top: 0,
+    width: 40,
+    height: 10,
+  })
+
+  currentRenderer.root.add(codeRenderable)
+  await renderOnce()
+
+  expect(requests).toHaveLength(1)
+  const options = requests[0]!
+  expect(options.priorityRange).toEqual({ startLine: 0, endLine: 10 })
+
+  options.onPartial!([[0, 5, "keyword"]], { startLine: 0, endLine: 10 })
+  expect(codeRenderable.getLineHighlights(0)).toHaveLength(1)
+  expect(codeRenderable.getLineHighlights(0)[0]).toMatchObject({ start: 0, end: 5 })
+
+  // A later partial recolors only its own lines
+  const line25 = content.indexOf("const v25 ")
+  options.onPartial!([[line25, line25 + 5, "keyword"]], { startLine: 20, endLine: 30 })
+  expect(codeRenderable.getLineHighlights(0)).toHaveLength(1)
+  expect(codeRenderable.getLineHighlights(25)).toHaveLength(1)
+  expect(codeRenderable.getLineHighlights(25)[0]).toMatchObject({ start: 0, end: 5 })
+  expect(codeRenderable.plainText).toBe(content)
+
+  codeRenderable.content = content + "\n"
+  expect(options.signal!.aborted).toBe(true)
+})
+
+test("CodeRenderable - partial highlights after tabs and wide graphemes use buffer columns", async () => {
+  const syntaxStyle = SyntaxStyle.fromStyles({
+    default: { fg: RGBA.fromValues(1, 1, 1, 1) },
+    keyword: { fg: RGBA.fromValues(0, 0, 1, 1) },
+  })
+
+  const mockClient = new MockTreeSitterClient()
+  const requests: Array<HighlightOnceOptions | undefined> = []
+  mockClient.highlightOnce = async (content: string, filetype: string, options?: HighlightOnceOptions) => {
+    requests.push(options)
+    return new Promise(() => {})
+  }
+
+  const lines = Array.from({ length: 3000 }, (_, i) => `\tconst v${i} = ${i};`)
+  lines[1] = `\t\tx := "👋"; return`
+  const content = lines.join("\n")
+  const codeRenderable = new CodeRenderable(currentRenderer, {
+    id: "test-code",
+    content,
+    filetype: "go",
+    syntaxStyle,
+    treeSitterClient: mockClient,
+    conceal: false,
+    wrapMode: "none",
+    left: 0,
+    top: 0,
+    width: 40,
+    height: 10,
+  })
+
+  currentRenderer.root.add(codeRenderable)
+  await renderOnce()
+
+  const options = requests[0]!
+  const returnOffset = content.indexOf("return")
+  options.onPartial!(
+    [
+      [1, 6, "keyword"],
+      [returnOffset, returnOffset + 6, "keyword"],
+    ],
+    { startLine: 0, endLine: 10 },
+  )
+
+  // A tab is 2 columns and the emoji 2 cells wide in the buffer
+  expect(codeRenderable.getLineHighlights(0)[0]).toMatchObject({ start: 2, end: 7 })
+  expect(codeRenderable.getLineHighlights(1)[0]).toMatchObject({ start: 15, end: 21 })
+})
@@ -1,11 +1,42 @@
-import { type RenderContext } from "../types"
+import { type Highlight, type RenderContext } from "../types"
 import { StyledText } from "../lib/styled-text"
 import { SyntaxStyle } from "../syntax-style"
 import { getTreeSitterClient, treeSitterToStyledText, TreeSitterClient } from "../lib/tree-sitter"
 import { TextBufferRenderable, type TextBufferOptions } from "./TextBufferRenderable"
 import type { OptimizedBuffer } from "../buffer"
-import type { SimpleHighlight } from "../lib/tree-sitter/types"
-import { treeSitterToTextChunks } from "../lib/tree-sitter-styled-text"
+import type { HighlightLineRange, HighlightOnceOptions, SimpleHighlight } from "../lib/tree-sitter/types"
+import { getSpecificity, treeSitterToTextChunks } from "../lib/tree-sitter-styled-text"
+
+// Content with at least this many lines is highlighted viewport first
+const PRIORITIZED_HIGHLIGHT_MIN_LINES = 2000
+
+// Line starts as string offsets and as UTF-8 byte offsets (line breaks
+// counting as one byte), built lazily for the content of one highlight snapshot
+interface PartialLineIndex {
+  snapshotId: number
+  offsets: number[]
+  bytes: number[]
+}
+
+const utf8Encoder = new TextEncoder()
+
+/** UTF-8 length of content[start, end), not counting a "\r" that ends it */
+function utf8LineLength(content: string, start: number, end: number): number {
+  if (end > start && content.charCodeAt(end - 1) === 13) end--
+  for (let i = start; i < end; i++) {
+    if (content.charCodeAt(i) > 0x7f) return utf8Encoder.encode(content.slice(start, end)).length
+  }
+  return end - start
+}
+
+function hasAtLeastLines(content: string, lines: number): boolean {
+  let index = -1
+  for (let line = 1; line < lines; line++) {
+    index = content.indexOf("\n", index + 1)
+    if (index === -1) return false
+  }
+  return true
+}
 
 export interface CodeOptions extends TextBufferOptions {
   content?: string
@@ -31,6 +62,9 @@ export class CodeRenderable extends TextBufferRenderable {
   private _streaming: boolean
   private _hadInitialContent: boolean = false
   private _lastHighlights: SimpleHighlight[] = []
+  private _highlightRequest: HighlightOnceOptions | undefined
+  private _highlightAbort: AbortController | undefined
+  private _partialLines: PartialLineIndex | undefined
 
   protected _contentDefaultOptions = {
     content: "",
@@ -68,6 +102,7 @@ export class CodeRenderable extends TextBufferRenderable {
       this._content = value
       this._highlightsDirty = true
       this._highlightSnapshotId++
+      this.cancelHighlightBackfill()
 
       if (this._streaming && !this._drawUnstyledText && this._filetype) {
         return
@@ -173,6 +208,118 @@ export class CodeRenderable extends TextBufferRenderable {
     }
   }
 
+  /** Logical lines currently in view */
+  private visibleLineRange(): HighlightLineRange {
+    const height = Math.max(1, this.height)
+    if (this._wrapMode === "none") {
+      return { startLine: this._scrollY, endLine: this._scrollY + height }
+    }
+    const lineSources = this.textBufferView.lineInfo.lineSources
+    const startLine = lineSources[this._scrollY] ?? this._scrollY
+    const endLine = (lineSources[Math.min(this._scrollY + height, lineSources.length) - 1] ?? startLine) + 1
+    return { startLine, endLine }
+  }
+
+  private cancelHighlightBackfill(): void {
+    this._highlightAbort?.abort()
+    this._highlightAbort = undefined
+    this._highlightRequest = undefined
+    this._partialLines = undefined
+  }
+
+  protected updateViewportOffset(): void {
+    super.updateViewportOffset()
+    if (this._highlightRequest) {
+      this._treeSitterClient.setHighlightPriority(this._highlightRequest, this.visibleLineRange())
+    }
+  }
+
+  /** Line starts of the content being highlighted, up to at least endLine */
+  private partialLineIndex(snapshotId: number, content: string, endLine: number): PartialLineIndex {
+    let index = this._partialLines
+    if (!index || index.snapshotId !== snapshotId) {
+      index = { snapshotId, offsets: [0], bytes: [0] }
+      this._partialLines = index
+    }
+
+    const { offsets, bytes } = index
+    while (offsets.length <= endLine) {
+      const start = offsets[offsets.length - 1]
+      const newline = content.indexOf("\n", start)
+      if (newline === -1) break
+      offsets.push(newline + 1)
+      bytes.push(bytes[bytes.length - 1] + utf8LineLength(content, start, newline) + 1)
+    }
+    return index
+  }
+
+  // Partials only recolor their own lines; the text is already in the buffer,
+  // so neither the other lines nor the text are rebuilt. Conceal and style
+  // merging wait for the final response.
+  private applyPartialHighlights(
+    snapshotId: number,
+    content: string,
+    highlights: SimpleHighlight[],
+    range: HighlightLineRange,
+  ): void {
+    if (snapshotId !== this._highlightSnapshotId || this.isDestroyed) return
+
+    if (!this._shouldRenderTextBuffer) {
+      this.textBuffer.setText(content)
+      this._shouldRenderTextBuffer = true
+      this.updateTextInfo()
+    }
+
+    const { offsets, bytes } = this.partialLineIndex(snapshotId, content, range.endLine)
+    if (range.startLine >= offsets.length) return
+    const rangeStart = offsets[range.startLine]
+    const rangeEnd = range.endLine < offsets.length ? offsets[range.endLine] : content.length
+    const baseByte = bytes[range.startLine]
+
+    // String offset to UTF-8 bytes from the range start, line breaks counting
+    // as one; the buffer turns these into columns with its own tab width and
+    // width method
+    const toBytes = (offset: number): number => {
+      let lo = range.startLine
+      let hi = offsets.length
+      while (hi - lo > 1) {
+        const mid = (lo + hi) >> 1
+        if (offsets[mid] <= offset) lo = mid
+        else hi = mid
+      }
+      return bytes[lo] - baseByte + utf8LineLength(content, offsets[lo], offset)
+    }
+
+    const bufferStyle = this.textBuffer.getSyntaxStyle()
+    const styleIds = new Map<string, number | null>()
+    const resolved: Highlight[] = []
+    for (const [start, end, group] of highlights) {
+      const clampedStart = Math.max(start, rangeStart)
+      const clampedEnd = Math.min(end, rangeEnd)
+      if (clampedStart >= clampedEnd) continue
+
+      let styleId = styleIds.get(group)
+      if (styleId === undefined) {
+        const style =
+          this._syntaxStyle.getStyle(group) ??
+          (group.includes(".") ? this._syntaxStyle.getStyle(group.split(".")[0]) : undefined)
+        styleId = style && bufferStyle ? bufferStyle.registerStyle(group, style) : null
+        styleIds.set(group, styleId)
+      }
+      if (styleId === null) continue
+
+      resolved.push({
+        start: toBytes(clampedStart),
+        end: toBytes(clampedEnd),
+        styleId,
+        priority: getSpecificity(group),
+      })
+    }
+
+    this.textBuffer.setHighlightsInLineRangeByBytes(range.startLine, range.endLine, resolved)
+    this.requestRender()
+  }
+
   private async startHighlight(): Promise<void> {
     const content = this._content
     const filetype = this._filetype
@@ -187,10 +334,30 @@ export class CodeRenderable extends TextBufferRenderable {
 
     this._isHighlighting = true
 
+    // Large documents get their viewport colored first while the rest is backfilled
+    this.cancelHighlightBackfill()
+    let options: HighlightOnceOptions | undefined
+    if (!this._streaming && hasAtLeastLines(content, PRIORITIZED_HIGHLIGHT_MIN_LINES)) {
+      const abort = new AbortController()
+      options = {
+        priorityRange: this.visibleLineRange(),
+        onPartial: (highlights, range) => this.applyPartialHighlights(snapshotId, content, highlights, range),
+        signal: abort.signal,
+      }
+      this._highlightAbort = abort
+      this._highlightRequest = options
+    }
+
     try {
-      const result = await this._treeSitterClient.highlightOnce(content, filetype)
+      const result = await this._treeSitterClient.highlightOnce(content, filetype, options)
 
-      if (snapshotId !== this._highlightSnapshotId) {
+      if (options && this._highlightRequest === options) {
+        this._highlightRequest = undefined
+        this._highlightAbort = undefined
+        this._partialLines = undefined
+      }
+
+      if (snapshotId !== this._highlightSnapshotId || result.cancelled) {
         return
       }
 
@@ -231,6 +398,11 @@ export class CodeRenderable extends TextBufferRenderable {
     }
   }
 
+  destroy(): void {
+    this.cancelHighlightBackfill()
+    super.destroy()
+  }
+
   public getLineHighlights(lineIdx: number) {
     return this.textBuffer.getLineHighlights(lineIdx)
   }
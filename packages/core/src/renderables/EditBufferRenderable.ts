@@ -667,6 +667,11 @@ export abstract class EditBufferRenderable extends Renderable implements LineInf
     this.requestRender()
   }
 
+  public setHighlightsInLineRange(startLine: number, endLine: number, highlights: Highlight[]): void {
+    this.editBuffer.setHighlightsInLineRange(startLine, endLine, highlights)
+    this.requestRender()
+  }
+
   public removeHighlightsByRef(hlRef: number): void {
     this.editBuffer.removeHighlightsByRef(hlRef)
     this.requestRender()
@@ -1,11 +1,12 @@
 import { type RenderableOptions, Renderable } from "../Renderable"
 import { OptimizedBuffer } from "../buffer"
-import type { RenderContext } from "../types"
+import type { ColorStorage, RenderContext } from "../types"
 
 export interface FrameBufferOptions extends RenderableOptions<FrameBufferRenderable> {
   width: number
   height: number
   respectAlpha?: boolean
+  colorStorage?: ColorStorage
 }
 
 export class FrameBufferRenderable extends Renderable {
@@ -18,6 +19,7 @@ export class FrameBufferRenderable extends Renderable {
     this.frameBuffer = OptimizedBuffer.create(options.width, options.height, this._ctx.widthMethod, {
       respectAlpha: this.respectAlpha,
       id: options.id || `framebufferrenderable-${this.id}`,
+      colorStorage: options.colorStorage,
     })
   }
 
@@ -17,6 +17,8 @@ export interface TextBufferOptions extends RenderableOptions<TextBufferRenderabl
   selectable?: boolean
   attributes?: number
   wrapMode?: "none" | "char" | "word"
+  /** Wrap lazily around the viewport; for large read-only content */
+  lazyWrap?: boolean
   tabIndicator?: string | number
   tabIndicatorColor?: string | RGBA
 }
@@ -30,6 +32,7 @@ export abstract class TextBufferRenderable extends Renderable implements LineInf
   protected _selectionBg: RGBA | undefined
   protected _selectionFg: RGBA | undefined
   protected _wrapMode: "none" | "char" | "word" = "word"
+  protected _lazyWrap: boolean = false
   protected lastLocalSelection: LocalSelectionBounds | null = null
   protected _tabIndicator?: string | number
   protected _tabIndicatorColor?: RGBA
@@ -47,6 +50,7 @@ export abstract class TextBufferRenderable extends Renderable implements LineInf
     selectable: true,
     attributes: 0,
     wrapMode: "word" as "none" | "char" | "word",
+    lazyWrap: false,
     tabIndicator: undefined,
     tabIndicatorColor: undefined,
   } satisfies Partial<TextBufferOptions>
@@ -61,6 +65,7 @@ export abstract class TextBufferRenderable extends Renderable implements LineInf
     this._selectionFg = options.selectionFg ? parseColor(options.selectionFg) : this._defaultOptions.selectionFg
     this.selectable = options.selectable ?? this._defaultOptions.selectable
     this._wrapMode = options.wrapMode ?? this._defaultOptions.wrapMode
+    this._lazyWrap = options.lazyWrap ?? this._defaultOptions.lazyWrap
     this._tabIndicator = options.tabIndicator ?? this._defaultOptions.tabIndicator
     this._tabIndicatorColor = options.tabIndicatorColor
       ? parseColor(options.tabIndicatorColor)
@@ -73,6 +78,9 @@ export abstract class TextBufferRenderable extends Renderable implements LineInf
     this.textBuffer.setSyntaxStyle(style)
 
     this.textBufferView.setWrapMode(this._wrapMode)
+    if (this._lazyWrap) {
+      this.textBufferView.setLazyWrap(true)
+    }
     this.setupMeasureFunc()
 
     this.textBuffer.setDefaultFg(this._defaultFg)
@@ -168,6 +176,10 @@ export abstract class TextBufferRenderable extends Renderable implements LineInf
   }
 
   public get scrollHeight(): number {
+    // Lazily wrapped views only hold the lines wrapped so far; the count includes an estimate for the rest
+    if (this._lazyWrap) {
+      return this.textBufferView.getVirtualLineCount()
+    }
     return this.lineInfo.lineStarts.length
   }
 
@@ -282,6 +294,19 @@ export abstract class TextBufferRenderable extends Renderable implements LineInf
     }
   }
 
+  get lazyWrap(): boolean {
+    return this._lazyWrap
+  }
+
+  set lazyWrap(value: boolean) {
+    if (this._lazyWrap !== value) {
+      this._lazyWrap = value
+      this.textBufferView.setLazyWrap(value)
+      this.yogaNode.markDirty()
+      this.requestRender()
+    }
+  }
+
   get tabIndicator(): string | number | undefined {
     return this._tabIndicator
   }
@@ -1,6 +1,7 @@
 import { ANSI } from "./ansi"
 import { Renderable, RootRenderable } from "./Renderable"
 import {
+  type ColorDepth,
   type CursorStyle,
   DebugOverlayCorner,
   type RenderContext,
@@ -78,6 +79,10 @@ export interface CliRendererConfig {
   maxFps?: number
   memorySnapshotInterval?: number
   useThread?: boolean
+  outputBufferSize?: number
+  colorDepth?: ColorDepth
+  /** Keep each frame and redraw only regions damaged by changed renderables */
+  retainedMode?: boolean
   gatherStats?: boolean
   maxStatSamples?: number
   consoleOptions?: ConsoleOptions
@@ -268,6 +273,12 @@ export async function createCliRenderer(config: CliRendererConfig = {}): Promise
     config.useThread = false
   }
   ziglib.setUseThread(rendererPtr, config.useThread)
+  if (config.outputBufferSize !== undefined) {
+    ziglib.setOutputBufferSize(rendererPtr, config.outputBufferSize)
+  }
+  if (config.colorDepth !== undefined) {
+    ziglib.setColorDepth(rendererPtr, config.colorDepth)
+  }
 
   const kittyConfig = config.useKittyKeyboard ?? {}
   const kittyFlags = buildKittyKeyboardFlags(kittyConfig)
@@ -327,6 +338,8 @@ export class CliRenderer extends EventEmitter implements RenderContext {
   private maxStatSamples: number = 300
   private postProcessFns: ((buffer: OptimizedBuffer, deltaTime: number) => void)[] = []
   private backgroundColor: RGBA = RGBA.fromInts(0, 0, 0, 0)
+  private _retainedMode: boolean = false
+  private retainedConsoleVisible: boolean = false
   private waitingForPixelResolution: boolean = false
 
   private rendering: boolean = false
@@ -522,6 +535,9 @@ export class CliRenderer extends EventEmitter implements RenderContext {
     this.prependedInputHandlers = config.prependInputHandlers || []
 
     this.root = new RootRenderable(this)
+    if (config.retainedMode) {
+      this.applyRetainedMode(true)
+    }
 
     if (this.memorySnapshotInterval > 0) {
       this.startMemorySnapshotTimer()
@@ -951,6 +967,33 @@ export class CliRenderer extends EventEmitter implements RenderContext {
     this.lib.setUseThread(this.rendererPtr, useThread)
   }
 
+  public get retainedMode(): boolean {
+    return this._retainedMode
+  }
+
+  /**
+   * In retained mode each frame starts from the previous one instead of a cleared
+   * buffer. Only regions damaged by dirty, moved, added or removed renderables are
+   * cleared and redrawn, and only the renderables overlapping them render again.
+   * Content drawn outside the renderable tree must be reported with root.addDamage.
+   */
+  public set retainedMode(enabled: boolean) {
+    if (this._retainedMode === enabled) return
+    this.applyRetainedMode(enabled)
+    this.requestRender()
+  }
+
+  private applyRetainedMode(enabled: boolean): void {
+    this._retainedMode = enabled
+    this.lib.setRetainFrames(this.rendererPtr, enabled)
+    this.root.setRetained(enabled)
+    if (!enabled) {
+      // The next buffer still holds the retained frame
+      this.nextRenderBuffer.clear(this.backgroundColor)
+      this.lib.addToHitGrid(this.rendererPtr, 0, 0, this.width, this.height, 0)
+    }
+  }
+
   // TODO: All input management may move to native when zig finally has async io support again,
   // without rolling a full event loop
   public async setupTerminal(): Promise<void> {
@@ -1340,6 +1383,7 @@ export class CliRenderer extends EventEmitter implements RenderContext {
     this.lib.setBackgroundColor(this.rendererPtr, parsedColor as RGBA)
     this.backgroundColor = parsedColor as RGBA
     this.nextRenderBuffer.clear(parsedColor as RGBA)
+    this.root.setClearColor(parsedColor as RGBA)
     this.requestRender()
   }
 
@@ -1359,6 +1403,8 @@ export class CliRenderer extends EventEmitter implements RenderContext {
     this.debugOverlay.enabled = !this.debugOverlay.enabled
     this.lib.setDebugOverlay(this.rendererPtr, this.debugOverlay.enabled, this.debugOverlay.corner)
     this.emit(CliRenderEvents.DEBUG_OVERLAY_TOGGLE, this.debugOverlay.enabled)
+    // A retained frame still shows the overlay where it was drawn
+    this.root.invalidate()
     this.requestRender()
   }
 
@@ -1366,6 +1412,7 @@ export class CliRenderer extends EventEmitter implements RenderContext {
     this.debugOverlay.enabled = options.enabled ?? this.debugOverlay.enabled
     this.debugOverlay.corner = options.corner ?? this.debugOverlay.corner
     this.lib.setDebugOverlay(this.rendererPtr, this.debugOverlay.enabled, this.debugOverlay.corner)
+    this.root.invalidate()
     this.requestRender()
   }
 
@@ -1732,11 +1779,24 @@ export class CliRenderer extends EventEmitter implements RenderContext {
       const end = performance.now()
       this.renderStats.frameCallbackTime = end - start
 
+      if (this._retainedMode) {
+        // Post-processing rewrites the whole frame, and a closed console leaves its area behind
+        const consoleVisible = this._console.visible
+        if (this.postProcessFns.length > 0 || (this.retainedConsoleVisible && !consoleVisible)) {
+          this.root.invalidate()
+        }
+        this.retainedConsoleVisible = consoleVisible
+      }
+
       this.root.render(this.nextRenderBuffer, deltaTime)
 
       for (const postProcessFn of this.postProcessFns) {
         postProcessFn(this.nextRenderBuffer, deltaTime)
       }
+      if (this.postProcessFns.length > 0) {
+        // Post-process filters write the typed arrays directly, which row tracking cannot see
+        this.nextRenderBuffer.markRowsDirty()
+      }
 
       this._console.renderToBuffer(this.nextRenderBuffer)
 
@@ -88,6 +88,12 @@ async function setupTestRenderer(config: TestRendererOptions) {
     config.useThread = false
   }
   ziglib.setUseThread(rendererPtr, config.useThread)
+  if (config.outputBufferSize !== undefined) {
+    ziglib.setOutputBufferSize(rendererPtr, config.outputBufferSize)
+  }
+  if (config.colorDepth !== undefined) {
+    ziglib.setColorDepth(rendererPtr, config.colorDepth)
+  }
 
   const renderer = new CliRenderer(ziglib, rendererPtr, stdin, stdout, width, height, config)
 
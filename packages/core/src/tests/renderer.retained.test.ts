@@ -0,0 +1,118 @@
+import { test, expect, beforeEach, afterEach, describe } from "bun:test"
+import { Renderable, type RenderableOptions } from "../Renderable"
+import { createTestRenderer, type TestRenderer } from "../testing/test-renderer"
+import { RGBA } from "../lib/RGBA"
+import type { OptimizedBuffer } from "../buffer"
+import type { RenderContext } from "../types"
+
+class LabelRenderable extends Renderable {
+  public renders = 0
+  private _label: string
+
+  constructor(ctx: RenderContext, options: RenderableOptions<LabelRenderable> & { label: string }) {
+    super(ctx, options)
+    this._label = options.label
+  }
+
+  public set label(value: string) {
+    this._label = value
+    this.requestRender()
+  }
+
+  protected renderSelf(buffer: OptimizedBuffer): void {
+    this.renders++
+    buffer.drawText(this._label, this.x, this.y, RGBA.fromInts(255, 255, 255, 255))
+  }
+}
+
+let testRenderer: TestRenderer
+let renderOnce: () => Promise<void>
+let captureFrame: () => string
+
+beforeEach(async () => {
+  ;({
+    renderer: testRenderer,
+    renderOnce,
+    captureCharFrame: captureFrame,
+  } = await createTestRenderer({ width: 30, height: 6, retainedMode: true }))
+})
+
+afterEach(() => {
+  testRenderer.destroy()
+})
+
+function createLabel(id: string, label: string, left: number, top: number): LabelRenderable {
+  const renderable = new LabelRenderable(testRenderer, {
+    id,
+    label,
+    position: "absolute",
+    left,
+    top,
+    width: 10,
+    height: 1,
+  })
+  testRenderer.root.add(renderable)
+  return renderable
+}
+
+function row(frame: string, index: number): string {
+  return frame.split("\n")[index]
+}
+
+describe("Renderer - retained mode", () => {
+  test("redraws only renderables that overlap damage", async () => {
+    const first = createLabel("first", "alpha", 0, 0)
+    const second = createLabel("second", "beta", 0, 3)
+
+    await renderOnce()
+    expect(first.renders).toBe(1)
+    expect(second.renders).toBe(1)
+
+    second.label = "gamma"
+    await renderOnce()
+
+    expect(first.renders).toBe(1)
+    expect(second.renders).toBe(2)
+    const frame = captureFrame()
+    expect(row(frame, 0)).toContain("alpha")
+    expect(row(frame, 3)).toContain("gamma")
+    expect(frame).not.toContain("beta")
+  })
+
+  test("a frame without changes renders nothing", async () => {
+    const label = createLabel("idle", "still", 2, 1)
+
+    await renderOnce()
+    await renderOnce()
+
+    expect(label.renders).toBe(1)
+    expect(row(captureFrame(), 1)).toContain("still")
+  })
+
+  test("moved and removed renderables leave no trace", async () => {
+    const moving = createLabel("moving", "mover", 0, 0)
+    const removed = createLabel("removed", "gone", 0, 4)
+
+    await renderOnce()
+
+    moving.left = 15
+    testRenderer.root.remove(removed.id)
+    await renderOnce()
+
+    const frame = captureFrame()
+    expect(row(frame, 0).indexOf("mover")).toBe(15)
+    expect(frame).not.toContain("gone")
+  })
+
+  test("disabling retained mode returns to full redraws", async () => {
+    const label = createLabel("full", "full", 0, 0)
+
+    await renderOnce()
+    testRenderer.retainedMode = false
+    await renderOnce()
+    await renderOnce()
+
+    expect(label.renders).toBe(3)
+    expect(row(captureFrame(), 0)).toContain("full")
+  })
+})
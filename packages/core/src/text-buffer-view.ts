@@ -111,6 +111,26 @@ export class TextBufferView {
     this.lib.textBufferViewSetWrapMode(this.viewPtr, mode)
   }
 
+  /**
+   * Wrap only the lines around the viewport and extend on demand. Meant for large
+   * read-only views; until wrapping completes the virtual line count is an estimate.
+   */
+  public setLazyWrap(lazy: boolean): void {
+    this.guard()
+    this.lib.textBufferViewSetLazyWrap(this.viewPtr, lazy)
+  }
+
+  /** Wraps up to `maxLines` more lines of a lazily wrapped view. Returns true once all lines are wrapped. */
+  public wrapMoreLines(maxLines: number): boolean {
+    this.guard()
+    return this.lib.textBufferViewWrapMoreLines(this.viewPtr, maxLines)
+  }
+
+  public isWrapComplete(): boolean {
+    this.guard()
+    return this.lib.textBufferViewIsWrapComplete(this.viewPtr)
+  }
+
   public setViewportSize(width: number, height: number): void {
     this.guard()
     this.lib.textBufferViewSetViewportSize(this.viewPtr, width, height)
@@ -71,6 +71,39 @@ export class TextBuffer {
     this._lineInfo = undefined
   }
 
+  /**
+   * Append through the native streaming arena, for high-rate tails such as logs.
+   * The bytes are copied natively, so nothing needs to be kept alive here.
+   */
+  public appendStreaming(text: string): void {
+    this.guard()
+    this.lib.textBufferAppendStreaming(this.bufferPtr, this.lib.encoder.encode(text))
+    this._length = this.lib.textBufferGetLength(this.bufferPtr)
+    this._byteSize = this.lib.textBufferGetByteSize(this.bufferPtr)
+    this._lineInfo = undefined
+  }
+
+  /**
+   * Cap the buffer at `maxLines` lines; streaming appends drop the oldest lines
+   * beyond it. `null` removes the cap.
+   */
+  public setMaxLines(maxLines: number | null): void {
+    this.guard()
+    this.lib.textBufferSetMaxLines(this.bufferPtr, maxLines)
+    this._length = this.lib.textBufferGetLength(this.bufferPtr)
+    this._byteSize = this.lib.textBufferGetByteSize(this.bufferPtr)
+    this._lineInfo = undefined
+  }
+
+  /**
+   * Cap the memory used for cached per-chunk grapheme and wrap metadata. Chunks
+   * least recently drawn or wrapped are evicted first. `null` removes the cap.
+   */
+  public setChunkCacheLimit(maxBytes: number | null): void {
+    this.guard()
+    this.lib.textBufferSetChunkCacheLimit(this.bufferPtr, maxBytes)
+  }
+
   public loadFile(path: string): void {
     this.guard()
     const success = this.lib.textBufferLoadFile(this.bufferPtr, path)
@@ -183,6 +216,26 @@ export class TextBuffer {
     this.lib.textBufferAddHighlight(this.bufferPtr, lineIdx, highlight)
   }
 
+  /**
+   * Replace the highlights of lines [startLine, endLine) in one native call.
+   * start/end in each highlight are absolute character positions, as in
+   * addHighlightByCharRange. endLine is clamped to the line count.
+   */
+  public setHighlightsInLineRange(startLine: number, endLine: number, highlights: Highlight[]): void {
+    this.guard()
+    this.lib.textBufferSetHighlightsInLineRange(this.bufferPtr, startLine, endLine, highlights)
+  }
+
+  /**
+   * Like setHighlightsInLineRange, but start/end are UTF-8 byte offsets from
+   * the start of startLine, each line break counting as one byte. They are
+   * measured natively with the buffer's tab width and width method.
+   */
+  public setHighlightsInLineRangeByBytes(startLine: number, endLine: number, highlights: Highlight[]): void {
+    this.guard()
+    this.lib.textBufferSetHighlightsInLineRangeByBytes(this.bufferPtr, startLine, endLine, highlights)
+  }
+
   public removeHighlightsByRef(hlRef: number): void {
     this.guard()
     this.lib.textBufferRemoveHighlightsByRef(this.bufferPtr, hlRef)
@@ -44,6 +44,16 @@ export enum DebugOverlayCorner {
 
 export type WidthMethod = "wcwidth" | "unicode"
 
+/**
+ * How a buffer stores cell colors. "rgba8" packs each color into a u32, a
+ * quarter of the "float32" footprint, but its color arrays cannot be mapped
+ * from TypeScript.
+ */
+export type ColorStorage = "float32" | "rgba8"
+
+/** Output color depth. "auto" follows terminal detection. */
+export type ColorDepth = "auto" | "truecolor" | "ansi256" | "ansi16"
+
 export interface RendererEvents {
   resize: (width: number, height: number) => void
   key: (data: Buffer) => void
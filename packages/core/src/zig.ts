@@ -1,7 +1,15 @@
 import { dlopen, toArrayBuffer, JSCallback, ptr, type Pointer } from "bun:ffi"
 import { existsSync } from "fs"
 import { EventEmitter } from "events"
-import { type CursorStyle, type DebugOverlayCorner, type WidthMethod, type Highlight, type LineInfo } from "./types"
+import {
+  type ColorDepth,
+  type ColorStorage,
+  type CursorStyle,
+  type DebugOverlayCorner,
+  type WidthMethod,
+  type Highlight,
+  type LineInfo,
+} from "./types"
 export type { LineInfo }
 
 import { RGBA } from "./lib/RGBA"
@@ -93,6 +101,18 @@ function getOpenTUILib(libPath?: string) {
       args: ["ptr", "bool"],
       returns: "void",
     },
+    setOutputBufferSize: {
+      args: ["ptr", "u32"],
+      returns: "void",
+    },
+    setRetainFrames: {
+      args: ["ptr", "bool"],
+      returns: "void",
+    },
+    setColorDepth: {
+      args: ["ptr", "u8"],
+      returns: "void",
+    },
     setBackgroundColor: {
       args: ["ptr", "ptr"],
       returns: "void",
@@ -128,7 +148,7 @@ function getOpenTUILib(libPath?: string) {
     },
 
     createOptimizedBuffer: {
-      args: ["u32", "u32", "bool", "u8", "ptr", "usize"],
+      args: ["u32", "u32", "bool", "u8", "u8", "ptr", "usize"],
       returns: "ptr",
     },
     destroyOptimizedBuffer: {
@@ -176,6 +196,30 @@ function getOpenTUILib(libPath?: string) {
       args: ["ptr", "bool"],
       returns: "void",
     },
+    bufferSetRowTracking: {
+      args: ["ptr", "bool"],
+      returns: "bool",
+    },
+    bufferIsRowDirty: {
+      args: ["ptr", "u32"],
+      returns: "bool",
+    },
+    bufferGetDirtyRowCount: {
+      args: ["ptr"],
+      returns: "u32",
+    },
+    bufferMarkRowsDirty: {
+      args: ["ptr", "u32", "u32"],
+      returns: "void",
+    },
+    bufferClearDirtyRows: {
+      args: ["ptr"],
+      returns: "void",
+    },
+    bufferGetRowHash: {
+      args: ["ptr", "u32"],
+      returns: "u64",
+    },
     bufferGetId: {
       args: ["ptr", "ptr", "usize"],
       returns: "usize",
@@ -205,6 +249,10 @@ function getOpenTUILib(libPath?: string) {
       args: ["ptr", "u32", "u32", "u32", "u32", "ptr"],
       returns: "void",
     },
+    bufferClearRect: {
+      args: ["ptr", "u32", "u32", "u32", "u32", "ptr"],
+      returns: "void",
+    },
     bufferResize: {
       args: ["ptr", "u32", "u32"],
       returns: "void",
@@ -440,7 +488,7 @@ function getOpenTUILib(libPath?: string) {
       returns: "u16",
     },
     textBufferReplaceMemBuffer: {
-      args: ["ptr", "u8", "ptr", "usize", "bool"],
+      args: ["ptr", "u16", "ptr", "usize", "bool"],
       returns: "bool",
     },
     textBufferClearMemRegistry: {
@@ -448,7 +496,7 @@ function getOpenTUILib(libPath?: string) {
       returns: "void",
     },
     textBufferSetTextFromMem: {
-      args: ["ptr", "u8"],
+      args: ["ptr", "u16"],
       returns: "void",
     },
     textBufferAppend: {
@@ -456,7 +504,19 @@ function getOpenTUILib(libPath?: string) {
       returns: "void",
     },
     textBufferAppendFromMemId: {
-      args: ["ptr", "u8"],
+      args: ["ptr", "u16"],
+      returns: "void",
+    },
+    textBufferAppendStreaming: {
+      args: ["ptr", "ptr", "usize"],
+      returns: "void",
+    },
+    textBufferSetMaxLines: {
+      args: ["ptr", "u32"],
+      returns: "void",
+    },
+    textBufferSetChunkCacheLimit: {
+      args: ["ptr", "usize"],
       returns: "void",
     },
     textBufferLoadFile: {
@@ -483,6 +543,14 @@ function getOpenTUILib(libPath?: string) {
       args: ["ptr", "u32", "ptr"],
       returns: "void",
     },
+    textBufferSetHighlightsInLineRange: {
+      args: ["ptr", "u32", "u32", "ptr", "usize"],
+      returns: "void",
+    },
+    textBufferSetHighlightsInLineRangeByBytes: {
+      args: ["ptr", "u32", "u32", "ptr", "usize"],
+      returns: "void",
+    },
     textBufferRemoveHighlightsByRef: {
       args: ["ptr", "u16"],
       returns: "void",
@@ -565,6 +633,18 @@ function getOpenTUILib(libPath?: string) {
       args: ["ptr", "u8"],
       returns: "void",
     },
+    textBufferViewSetLazyWrap: {
+      args: ["ptr", "bool"],
+      returns: "void",
+    },
+    textBufferViewWrapMoreLines: {
+      args: ["ptr", "u32"],
+      returns: "bool",
+    },
+    textBufferViewIsWrapComplete: {
+      args: ["ptr"],
+      returns: "bool",
+    },
     textBufferViewSetViewportSize: {
       args: ["ptr", "u32", "u32"],
       returns: "void",
@@ -678,7 +758,7 @@ function getOpenTUILib(libPath?: string) {
       returns: "void",
     },
     editBufferSetTextFromMem: {
-      args: ["ptr", "u8"],
+      args: ["ptr", "u16"],
       returns: "void",
     },
     editBufferReplaceText: {
@@ -686,7 +766,7 @@ function getOpenTUILib(libPath?: string) {
       returns: "void",
     },
     editBufferReplaceTextFromMem: {
-      args: ["ptr", "u8"],
+      args: ["ptr", "u16"],
       returns: "void",
     },
     editBufferGetText: {
@@ -753,6 +833,18 @@ function getOpenTUILib(libPath?: string) {
       args: ["ptr", "u32"],
       returns: "void",
     },
+    editBufferAddCursor: {
+      args: ["ptr", "u32", "u32"],
+      returns: "void",
+    },
+    editBufferClearExtraCursors: {
+      args: ["ptr"],
+      returns: "void",
+    },
+    editBufferGetCursorCount: {
+      args: ["ptr"],
+      returns: "u32",
+    },
     editBufferGetCursorPosition: {
       args: ["ptr", "ptr"],
       returns: "void",
@@ -1230,6 +1322,9 @@ export interface RenderLib {
   createRenderer: (width: number, height: number, options?: { testing: boolean }) => Pointer | null
   destroyRenderer: (renderer: Pointer) => void
   setUseThread: (renderer: Pointer, useThread: boolean) => void
+  setOutputBufferSize: (renderer: Pointer, size: number) => void
+  setRetainFrames: (renderer: Pointer, retain: boolean) => void
+  setColorDepth: (renderer: Pointer, depth: ColorDepth) => void
   setBackgroundColor: (renderer: Pointer, color: RGBA) => void
   setRenderOffset: (renderer: Pointer, offset: number) => void
   updateStats: (renderer: Pointer, time: number, fps: number, frameCallbackTime: number) => void
@@ -1243,6 +1338,7 @@ export interface RenderLib {
     widthMethod: WidthMethod,
     respectAlpha?: boolean,
     id?: string,
+    colorStorage?: ColorStorage,
   ) => OptimizedBuffer
   destroyOptimizedBuffer: (bufferPtr: Pointer) => void
   drawFrameBuffer: (
@@ -1264,6 +1360,12 @@ export interface RenderLib {
   bufferGetAttributesPtr: (buffer: Pointer) => Pointer
   bufferGetRespectAlpha: (buffer: Pointer) => boolean
   bufferSetRespectAlpha: (buffer: Pointer, respectAlpha: boolean) => void
+  bufferSetRowTracking: (buffer: Pointer, enabled: boolean) => boolean
+  bufferIsRowDirty: (buffer: Pointer, y: number) => boolean
+  bufferGetDirtyRowCount: (buffer: Pointer) => number
+  bufferMarkRowsDirty: (buffer: Pointer, start: number, end: number) => void
+  bufferClearDirtyRows: (buffer: Pointer) => void
+  bufferGetRowHash: (buffer: Pointer, y: number) => bigint
   bufferGetId: (buffer: Pointer) => string
   bufferGetRealCharSize: (buffer: Pointer) => number
   bufferWriteResolvedChars: (buffer: Pointer, outputBuffer: Uint8Array, addLineBreaks: boolean) => number
@@ -1295,6 +1397,7 @@ export interface RenderLib {
     attributes?: number,
   ) => void
   bufferFillRect: (buffer: Pointer, x: number, y: number, width: number, height: number, color: RGBA) => void
+  bufferClearRect: (buffer: Pointer, x: number, y: number, width: number, height: number, color: RGBA) => void
   bufferDrawSuperSampleBuffer: (
     buffer: Pointer,
     x: number,
@@ -1376,6 +1479,9 @@ export interface RenderLib {
   textBufferSetTextFromMem: (buffer: Pointer, memId: number) => void
   textBufferAppend: (buffer: Pointer, bytes: Uint8Array) => void
   textBufferAppendFromMemId: (buffer: Pointer, memId: number) => void
+  textBufferAppendStreaming: (buffer: Pointer, bytes: Uint8Array) => void
+  textBufferSetMaxLines: (buffer: Pointer, maxLines: number | null) => void
+  textBufferSetChunkCacheLimit: (buffer: Pointer, maxBytes: number | null) => void
   textBufferLoadFile: (buffer: Pointer, path: string) => boolean
   textBufferSetStyledText: (
     buffer: Pointer,
@@ -1438,6 +1544,9 @@ export interface RenderLib {
   textBufferViewResetLocalSelection: (view: Pointer) => void
   textBufferViewSetWrapWidth: (view: Pointer, width: number) => void
   textBufferViewSetWrapMode: (view: Pointer, mode: "none" | "char" | "word") => void
+  textBufferViewSetLazyWrap: (view: Pointer, lazy: boolean) => void
+  textBufferViewWrapMoreLines: (view: Pointer, maxLines: number) => boolean
+  textBufferViewIsWrapComplete: (view: Pointer) => boolean
   textBufferViewSetViewportSize: (view: Pointer, width: number, height: number) => void
   textBufferViewSetViewport: (view: Pointer, x: number, y: number, width: number, height: number) => void
   textBufferViewGetLineInfo: (view: Pointer) => LineInfo
@@ -1481,6 +1590,9 @@ export interface RenderLib {
   editBufferSetCursor: (buffer: Pointer, line: number, col: number) => void
   editBufferSetCursorToLineCol: (buffer: Pointer, line: number, col: number) => void
   editBufferSetCursorByOffset: (buffer: Pointer, offset: number) => void
+  editBufferAddCursor: (buffer: Pointer, line: number, col: number) => void
+  editBufferClearExtraCursors: (buffer: Pointer) => void
+  editBufferGetCursorCount: (buffer: Pointer) => number
   editBufferGetCursorPosition: (buffer: Pointer) => LogicalCursor
   editBufferGetId: (buffer: Pointer) => number
   editBufferGetTextBuffer: (buffer: Pointer) => Pointer
@@ -1592,6 +1704,18 @@ export interface RenderLib {
   bufferClearOpacity: (buffer: Pointer) => void
   textBufferAddHighlightByCharRange: (buffer: Pointer, highlight: Highlight) => void
   textBufferAddHighlight: (buffer: Pointer, lineIdx: number, highlight: Highlight) => void
+  textBufferSetHighlightsInLineRange: (
+    buffer: Pointer,
+    startLine: number,
+    endLine: number,
+    highlights: Highlight[],
+  ) => void
+  textBufferSetHighlightsInLineRangeByBytes: (
+    buffer: Pointer,
+    startLine: number,
+    endLine: number,
+    highlights: Highlight[],
+  ) => void
   textBufferRemoveHighlightsByRef: (buffer: Pointer, hlRef: number) => void
   textBufferClearLineHighlights: (buffer: Pointer, lineIdx: number) => void
   textBufferClearAllHighlights: (buffer: Pointer) => void
@@ -1763,6 +1887,19 @@ class FFIRenderLib implements RenderLib {
     this.opentui.symbols.setUseThread(renderer, useThread)
   }
 
+  public setOutputBufferSize(renderer: Pointer, size: number) {
+    this.opentui.symbols.setOutputBufferSize(renderer, size)
+  }
+
+  public setRetainFrames(renderer: Pointer, retain: boolean) {
+    this.opentui.symbols.setRetainFrames(renderer, retain)
+  }
+
+  public setColorDepth(renderer: Pointer, depth: ColorDepth) {
+    const depthCode = depth === "truecolor" ? 1 : depth === "ansi256" ? 2 : depth === "ansi16" ? 3 : 0
+    this.opentui.symbols.setColorDepth(renderer, depthCode)
+  }
+
   public setBackgroundColor(renderer: Pointer, color: RGBA) {
     this.opentui.symbols.setBackgroundColor(renderer, color.buffer)
   }
@@ -1843,6 +1980,30 @@ class FFIRenderLib implements RenderLib {
     this.opentui.symbols.bufferSetRespectAlpha(buffer, respectAlpha)
   }
 
+  public bufferSetRowTracking(buffer: Pointer, enabled: boolean): boolean {
+    return this.opentui.symbols.bufferSetRowTracking(buffer, enabled)
+  }
+
+  public bufferIsRowDirty(buffer: Pointer, y: number): boolean {
+    return this.opentui.symbols.bufferIsRowDirty(buffer, y)
+  }
+
+  public bufferGetDirtyRowCount(buffer: Pointer): number {
+    return this.opentui.symbols.bufferGetDirtyRowCount(buffer)
+  }
+
+  public bufferMarkRowsDirty(buffer: Pointer, start: number, end: number): void {
+    this.opentui.symbols.bufferMarkRowsDirty(buffer, start, end)
+  }
+
+  public bufferClearDirtyRows(buffer: Pointer): void {
+    this.opentui.symbols.bufferClearDirtyRows(buffer)
+  }
+
+  public bufferGetRowHash(buffer: Pointer, y: number): bigint {
+    return BigInt(this.opentui.symbols.bufferGetRowHash(buffer, y))
+  }
+
   public bufferGetId(buffer: Pointer): string {
     const maxLen = 256
     const outBuffer = new Uint8Array(maxLen)
@@ -1931,6 +2092,11 @@ class FFIRenderLib implements RenderLib {
     this.opentui.symbols.bufferFillRect(buffer, x, y, width, height, bg)
   }
 
+  public bufferClearRect(buffer: Pointer, x: number, y: number, width: number, height: number, color: RGBA) {
+    const bg = color.buffer
+    this.opentui.symbols.bufferClearRect(buffer, x, y, width, height, bg)
+  }
+
   public bufferDrawSuperSampleBuffer(
     buffer: Pointer,
     x: number,
@@ -2075,6 +2241,7 @@ class FFIRenderLib implements RenderLib {
     widthMethod: WidthMethod,
     respectAlpha: boolean = false,
     id?: string,
+    colorStorage: ColorStorage = "float32",
   ): OptimizedBuffer {
     if (Number.isNaN(width) || Number.isNaN(height)) {
       console.error(new Error(`Invalid dimensions for OptimizedBuffer: ${width}x${height}`).stack)
@@ -2088,6 +2255,7 @@ class FFIRenderLib implements RenderLib {
       height,
       respectAlpha,
       widthMethodCode,
+      colorStorage === "rgba8" ? 1 : 0,
       idBytes,
       idBytes.length,
     )
@@ -2095,7 +2263,7 @@ class FFIRenderLib implements RenderLib {
       throw new Error(`Failed to create optimized buffer: ${width}x${height}`)
     }
 
-    return new OptimizedBuffer(this, bufferPtr, width, height, { respectAlpha, id, widthMethod })
+    return new OptimizedBuffer(this, bufferPtr, width, height, { respectAlpha, id, widthMethod, colorStorage })
   }
 
   public destroyOptimizedBuffer(bufferPtr: Pointer) {
@@ -2312,6 +2480,18 @@ class FFIRenderLib implements RenderLib {
     this.opentui.symbols.textBufferAppendFromMemId(buffer, memId)
   }
 
+  public textBufferAppendStreaming(buffer: Pointer, bytes: Uint8Array): void {
+    this.opentui.symbols.textBufferAppendStreaming(buffer, bytes, bytes.length)
+  }
+
+  public textBufferSetMaxLines(buffer: Pointer, maxLines: number | null): void {
+    this.opentui.symbols.textBufferSetMaxLines(buffer, maxLines ?? 0)
+  }
+
+  public textBufferSetChunkCacheLimit(buffer: Pointer, maxBytes: number | null): void {
+    this.opentui.symbols.textBufferSetChunkCacheLimit(buffer, maxBytes ?? 0)
+  }
+
   public textBufferLoadFile(buffer: Pointer, path: string): boolean {
     const pathBytes = this.encoder.encode(path)
     return this.opentui.symbols.textBufferLoadFile(buffer, pathBytes, pathBytes.length)
@@ -2514,6 +2694,18 @@ class FFIRenderLib implements RenderLib {
     this.opentui.symbols.textBufferViewSetWrapMode(view, modeValue)
   }
 
+  public textBufferViewSetLazyWrap(view: Pointer, lazy: boolean): void {
+    this.opentui.symbols.textBufferViewSetLazyWrap(view, lazy)
+  }
+
+  public textBufferViewWrapMoreLines(view: Pointer, maxLines: number): boolean {
+    return this.opentui.symbols.textBufferViewWrapMoreLines(view, maxLines)
+  }
+
+  public textBufferViewIsWrapComplete(view: Pointer): boolean {
+    return this.opentui.symbols.textBufferViewIsWrapComplete(view)
+  }
+
   public textBufferViewSetViewportSize(view: Pointer, width: number, height: number): void {
     this.opentui.symbols.textBufferViewSetViewportSize(view, width, height)
   }
@@ -2627,6 +2819,38 @@ class FFIRenderLib implements RenderLib {
     this.opentui.symbols.textBufferAddHighlight(buffer, lineIdx, ptr(packedHighlight))
   }
 
+  public textBufferSetHighlightsInLineRange(
+    buffer: Pointer,
+    startLine: number,
+    endLine: number,
+    highlights: Highlight[],
+  ): void {
+    const packedHighlights = highlights.length > 0 ? HighlightStruct.packList(highlights) : null
+    this.opentui.symbols.textBufferSetHighlightsInLineRange(
+      buffer,
+      startLine,
+      endLine,
+      packedHighlights ? ptr(packedHighlights) : null,
+      highlights.length,
+    )
+  }
+
+  public textBufferSetHighlightsInLineRangeByBytes(
+    buffer: Pointer,
+    startLine: number,
+    endLine: number,
+    highlights: Highlight[],
+  ): void {
+    const packedHighlights = highlights.length > 0 ? HighlightStruct.packList(highlights) : null
+    this.opentui.symbols.textBufferSetHighlightsInLineRangeByBytes(
+      buffer,
+      startLine,
+      endLine,
+      packedHighlights ? ptr(packedHighlights) : null,
+      highlights.length,
+    )
+  }
+
   public textBufferRemoveHighlightsByRef(buffer: Pointer, hlRef: number): void {
     this.opentui.symbols.textBufferRemoveHighlightsByRef(buffer, hlRef)
   }
@@ -2877,6 +3101,18 @@ class FFIRenderLib implements RenderLib {
     this.opentui.symbols.editBufferSetCursorByOffset(buffer, offset)
   }
 
+  public editBufferAddCursor(buffer: Pointer, line: number, col: number): void {
+    this.opentui.symbols.editBufferAddCursor(buffer, line, col)
+  }
+
+  public editBufferClearExtraCursors(buffer: Pointer): void {
+    this.opentui.symbols.editBufferClearExtraCursors(buffer)
+  }
+
+  public editBufferGetCursorCount(buffer: Pointer): number {
+    return this.opentui.symbols.editBufferGetCursorCount(buffer)
+  }
+
   public editBufferGetCursorPosition(buffer: Pointer): LogicalCursor {
     const cursorBuffer = new ArrayBuffer(LogicalCursorStruct.size)
     this.opentui.symbols.editBufferGetCursorPosition(buffer, ptr(cursorBuffer))
@@ -127,6 +127,21 @@ pub const ANSI = struct {
     pub const reverseIndex = "\x1bM";
     pub const eraseBelowCursor = "\x1b[J";
 
+    // Scroll regions (DECSTBM) and scrolling (SU/SD)
+    pub const resetScrollRegion = "\x1b[r";
+
+    pub fn setScrollRegionOutput(writer: anytype, top: u32, bottom: u32) AnsiError!void {
+        writer.print("\x1b[{d};{d}r", .{ top, bottom }) catch return AnsiError.WriteFailed;
+    }
+
+    pub fn scrollUpOutput(writer: anytype, lines: u32) AnsiError!void {
+        writer.print("\x1b[{d}S", .{lines}) catch return AnsiError.WriteFailed;
+    }
+
+    pub fn scrollDownOutput(writer: anytype, lines: u32) AnsiError!void {
+        writer.print("\x1b[{d}T", .{lines}) catch return AnsiError.WriteFailed;
+    }
+
     // OSC 0 - Set window title
     pub const setTerminalTitle = "\x1b]0;{s}\x07";
 
@@ -200,6 +215,266 @@ pub const TextAttributes = struct {
     }
 };
 
+/// Tracks the terminal's cursor position and SGR state as of the bytes written so
+/// far in a frame, so the renderer only emits the motion and style that changed.
+/// Coordinates are 1-based terminal columns and rows, as in moveToOutput.
+pub const Pen = struct {
+    col: u32 = 1,
+    row: u32 = 1,
+    cursorKnown: bool = false,
+    style: Style = .{},
+    styleKnown: bool = false,
+
+    pub const Color = union(enum) {
+        default,
+        rgb: [3]u8,
+        // xterm-256 palette index; 0-15 are emitted as the short 16-color codes
+        indexed: u8,
+
+        pub fn eql(a: Color, b: Color) bool {
+            return switch (a) {
+                .default => b == .default,
+                .rgb => |ac| switch (b) {
+                    .rgb => |bc| ac[0] == bc[0] and ac[1] == bc[1] and ac[2] == bc[2],
+                    else => false,
+                },
+                .indexed => |ai| switch (b) {
+                    .indexed => |bi| ai == bi,
+                    else => false,
+                },
+            };
+        }
+    };
+
+    pub const Style = struct {
+        fg: Color = .default,
+        bg: Color = .default,
+        attributes: u8 = 0,
+
+        pub fn eql(a: Style, b: Style) bool {
+            return a.attributes == b.attributes and a.fg.eql(b.fg) and a.bg.eql(b.bg);
+        }
+    };
+
+    pub fn isAt(self: *const Pen, col: u32, row: u32) bool {
+        return self.cursorKnown and self.col == col and self.row == row;
+    }
+
+    /// Forget the cursor position, e.g. after writing into the last column where
+    /// terminals disagree about pending-wrap behaviour.
+    pub fn invalidateCursor(self: *Pen) void {
+        self.cursorKnown = false;
+    }
+
+    /// Record that `columns` cells were written at the cursor.
+    pub fn advance(self: *Pen, columns: u32) void {
+        self.col += columns;
+    }
+
+    /// Record that a full SGR reset was written.
+    pub fn resetStyle(self: *Pen) void {
+        self.style = .{};
+        self.styleKnown = true;
+    }
+
+    /// Byte cost of the cheapest sequence moving the cursor to (col, row).
+    pub fn moveCost(self: *const Pen, col: u32, row: u32) u32 {
+        return self.planMove(col, row).cost;
+    }
+
+    /// Move the cursor to (col, row) using the cheapest of an absolute CUP,
+    /// relative CUU/CUD/CUF/CUB, or CR/LF.
+    pub fn moveTo(self: *Pen, writer: anytype, col: u32, row: u32) AnsiError!void {
+        if (self.isAt(col, row)) return;
+        const plan = self.planMove(col, row);
+        switch (plan.kind) {
+            .absolute => {
+                if (col == 1 and row == 1) {
+                    writer.writeAll(ANSI.home) catch return AnsiError.WriteFailed;
+                } else if (col == 1) {
+                    writer.print("\x1b[{d}H", .{row}) catch return AnsiError.WriteFailed;
+                } else {
+                    try ANSI.moveToOutput(writer, col, row);
+                }
+            },
+            .line_feed => {
+                writer.writeByte('\r') catch return AnsiError.WriteFailed;
+                var r = self.row;
+                while (r < row) : (r += 1) {
+                    writer.writeByte('\n') catch return AnsiError.WriteFailed;
+                }
+                try relativeOutput(writer, col - 1, 'C');
+            },
+            .vertical => {
+                if (row > self.row) {
+                    try relativeOutput(writer, row - self.row, 'B');
+                } else if (row < self.row) {
+                    try relativeOutput(writer, self.row - row, 'A');
+                }
+                try self.horizontalOutput(writer, col);
+            },
+        }
+        self.col = col;
+        self.row = row;
+        self.cursorKnown = true;
+    }
+
+    /// Switch to `style`, writing only the SGR parameters that changed, or a
+    /// reset plus the full style when that is shorter.
+    pub fn setStyle(self: *Pen, writer: anytype, style: Style) AnsiError!void {
+        if (self.styleKnown and self.style.eql(style)) return;
+
+        var full = SgrParams{};
+        full.add(0);
+        appendAttributesOn(&full, style.attributes);
+        if (style.fg != .default) appendColor(&full, style.fg, false);
+        if (style.bg != .default) appendColor(&full, style.bg, true);
+
+        var params = full;
+        if (self.styleKnown) {
+            var delta = SgrParams{};
+            const removed = self.style.attributes & ~style.attributes;
+            var added = style.attributes & ~self.style.attributes;
+            if (removed & (TextAttributes.BOLD | TextAttributes.DIM) != 0) {
+                // 22 clears both bold and dim, so re-enable whichever is kept
+                delta.add(22);
+                added |= style.attributes & (TextAttributes.BOLD | TextAttributes.DIM);
+            }
+            if (removed & TextAttributes.ITALIC != 0) delta.add(23);
+            if (removed & TextAttributes.UNDERLINE != 0) delta.add(24);
+            if (removed & TextAttributes.BLINK != 0) delta.add(25);
+            if (removed & TextAttributes.INVERSE != 0) delta.add(27);
+            if (removed & TextAttributes.HIDDEN != 0) delta.add(28);
+            if (removed & TextAttributes.STRIKETHROUGH != 0) delta.add(29);
+            appendAttributesOn(&delta, added);
+            if (!self.style.fg.eql(style.fg)) appendColor(&delta, style.fg, false);
+            if (!self.style.bg.eql(style.bg)) appendColor(&delta, style.bg, true);
+
+            if (delta.len < full.len) params = delta;
+        }
+
+        writer.print("\x1b[{s}m", .{params.slice()}) catch return AnsiError.WriteFailed;
+        self.style = style;
+        self.styleKnown = true;
+    }
+
+    const MoveKind = enum { absolute, line_feed, vertical };
+    const MovePlan = struct { kind: MoveKind, cost: u32 };
+
+    fn planMove(self: *const Pen, col: u32, row: u32) MovePlan {
+        var best = MovePlan{ .kind = .absolute, .cost = absoluteCost(col, row) };
+        if (!self.cursorKnown) return best;
+
+        if (row >= self.row) {
+            // CR, then LF for each row down; LF never scrolls since the target row is on screen
+            const lfCost = 1 + (row - self.row) + relativeCost(col - 1);
+            if (lfCost < best.cost) best = .{ .kind = .line_feed, .cost = lfCost };
+        }
+
+        const verticalCost = relativeCost(if (row > self.row) row - self.row else self.row - row) +
+            self.horizontalCost(col);
+        if (verticalCost < best.cost) best = .{ .kind = .vertical, .cost = verticalCost };
+
+        return best;
+    }
+
+    fn horizontalCost(self: *const Pen, col: u32) u32 {
+        if (col >= self.col) return relativeCost(col - self.col);
+        return @min(relativeCost(self.col - col), 1 + relativeCost(col - 1));
+    }
+
+    fn horizontalOutput(self: *const Pen, writer: anytype, col: u32) AnsiError!void {
+        if (col >= self.col) return relativeOutput(writer, col - self.col, 'C');
+        if (relativeCost(self.col - col) <= 1 + relativeCost(col - 1)) {
+            return relativeOutput(writer, self.col - col, 'D');
+        }
+        writer.writeByte('\r') catch return AnsiError.WriteFailed;
+        try relativeOutput(writer, col - 1, 'C');
+    }
+
+    fn absoluteCost(col: u32, row: u32) u32 {
+        if (col == 1 and row == 1) return 3;
+        if (col == 1) return 3 + digitCount(row);
+        return 4 + digitCount(row) + digitCount(col);
+    }
+
+    fn relativeCost(n: u32) u32 {
+        if (n == 0) return 0;
+        if (n == 1) return 3;
+        return 3 + digitCount(n);
+    }
+
+    fn relativeOutput(writer: anytype, n: u32, final: u8) AnsiError!void {
+        if (n == 0) return;
+        if (n == 1) {
+            writer.print("\x1b[{c}", .{final}) catch return AnsiError.WriteFailed;
+        } else {
+            writer.print("\x1b[{d}{c}", .{ n, final }) catch return AnsiError.WriteFailed;
+        }
+    }
+
+    fn digitCount(n: u32) u32 {
+        var count: u32 = 1;
+        var v = n;
+        while (v >= 10) : (v /= 10) count += 1;
+        return count;
+    }
+
+    fn appendAttributesOn(params: *SgrParams, attributes: u8) void {
+        if (attributes & TextAttributes.BOLD != 0) params.add(1);
+        if (attributes & TextAttributes.DIM != 0) params.add(2);
+        if (attributes & TextAttributes.ITALIC != 0) params.add(3);
+        if (attributes & TextAttributes.UNDERLINE != 0) params.add(4);
+        if (attributes & TextAttributes.BLINK != 0) params.add(5);
+        if (attributes & TextAttributes.INVERSE != 0) params.add(7);
+        if (attributes & TextAttributes.HIDDEN != 0) params.add(8);
+        if (attributes & TextAttributes.STRIKETHROUGH != 0) params.add(9);
+    }
+
+    fn appendColor(params: *SgrParams, color: Color, background: bool) void {
+        switch (color) {
+            .default => params.add(if (background) 49 else 39),
+            .rgb => |c| {
+                params.add(if (background) 48 else 38);
+                params.add(2);
+                params.add(c[0]);
+                params.add(c[1]);
+                params.add(c[2]);
+            },
+            .indexed => |i| {
+                if (i < 8) {
+                    params.add(@as(u32, if (background) 40 else 30) + i);
+                } else if (i < 16) {
+                    params.add(@as(u32, if (background) 100 else 90) + i - 8);
+                } else {
+                    params.add(if (background) 48 else 38);
+                    params.add(5);
+                    params.add(i);
+                }
+            },
+        }
+    }
+};
+
+/// Semicolon-separated SGR parameter list built on the stack.
+const SgrParams = struct {
+    buf: [96]u8 = undefined,
+    len: usize = 0,
+
+    fn add(self: *SgrParams, value: u32) void {
+        if (self.len > 0) {
+            self.buf[self.len] = ';';
+            self.len += 1;
+        }
+        const written = std.fmt.bufPrint(self.buf[self.len..], "{d}", .{value}) catch unreachable;
+        self.len += written.len;
+    }
+
+    fn slice(self: *const SgrParams) []const u8 {
+        return self.buf[0..self.len];
+    }
+};
+
 const HSV_SECTOR_COUNT = 6;
 const HUE_SECTOR_DEGREES = 60.0;
 
@@ -45,6 +45,10 @@ const styled_text_bench = @import("bench/styled-text_bench.zig");
 const buffer_draw_text_buffer_bench = @import("bench/buffer-draw-text-buffer_bench.zig");
 const utf8_bench = @import("bench/utf8_bench.zig");
 const text_chunk_graphemes_bench = @import("bench/text-chunk-graphemes_bench.zig");
+const renderer_bench = @import("bench/renderer_bench.zig");
+const mem_registry_bench = @import("bench/mem-registry_bench.zig");
+const text_buffer_load_bench = @import("bench/text-buffer-load_bench.zig");
+const text_buffer_highlights_bench = @import("bench/text-buffer-highlights_bench.zig");
 
 const BenchModule = struct {
     name: []const u8,
@@ -93,6 +97,10 @@ pub fn main() !void {
         .{ .name = buffer_draw_text_buffer_bench.benchName, .run = buffer_draw_text_buffer_bench.run },
         .{ .name = utf8_bench.benchName, .run = utf8_bench.run },
         .{ .name = text_chunk_graphemes_bench.benchName, .run = text_chunk_graphemes_bench.run },
+        .{ .name = renderer_bench.benchName, .run = renderer_bench.run },
+        .{ .name = mem_registry_bench.benchName, .run = mem_registry_bench.run },
+        .{ .name = text_buffer_load_bench.benchName, .run = text_buffer_load_bench.run },
+        .{ .name = text_buffer_highlights_bench.benchName, .run = text_buffer_highlights_bench.run },
     };
 
     const args = try std.process.argsAlloc(allocator);
@@ -413,6 +413,122 @@ fn benchWordBoundaryOperations(
     return try results.toOwnedSlice(allocator);
 }
 
+fn multiCursorBuffer(allocator: std.mem.Allocator, pool: *gp.GraphemePool, text: []const u8, cursor_count: u32, line_step: u32) !*EditBuffer {
+    var eb = try EditBuffer.init(allocator, pool, .unicode);
+    errdefer eb.deinit();
+    try eb.setText(text);
+    try eb.setCursor(0, 4);
+    for (1..cursor_count) |i| {
+        try eb.addCursor(@as(u32, @intCast(i)) * line_step, 4);
+    }
+    return eb;
+}
+
+fn benchMultiCursorOperations(
+    allocator: std.mem.Allocator,
+    pool: *gp.GraphemePool,
+    iterations: usize,
+    show_mem: bool,
+) ![]BenchResult {
+    _ = show_mem;
+    var results: std.ArrayListUnmanaged(BenchResult) = .{};
+    errdefer results.deinit(allocator);
+
+    const line_count: u32 = 10_000;
+    const cursor_count: u32 = 100;
+    const line_step = line_count / cursor_count;
+
+    var text: std.ArrayListUnmanaged(u8) = .{};
+    defer text.deinit(allocator);
+    for (0..line_count) |i| {
+        try text.writer(allocator).print("let value_{d} = {d};\n", .{ i, i });
+    }
+
+    // Baseline: the same keystrokes applied one cursor at a time
+    {
+        var stats = BenchStats{};
+
+        for (0..iterations) |_| {
+            var eb = try EditBuffer.init(allocator, pool, .unicode);
+            defer eb.deinit();
+            try eb.setText(text.items);
+
+            var timer = try std.time.Timer.start();
+            for (0..20) |keystroke| {
+                var i: u32 = cursor_count;
+                while (i > 0) {
+                    i -= 1;
+                    try eb.setCursor(i * line_step, 4 + @as(u32, @intCast(keystroke)));
+                    try eb.insertText("x");
+                }
+            }
+            stats.record(timer.read());
+        }
+
+        try results.append(allocator, BenchResult{
+            .name = "EditBuffer type 20 chars at 100 lines one at a time (10k lines)",
+            .min_ns = stats.min_ns,
+            .avg_ns = stats.avg(),
+            .max_ns = stats.max_ns,
+            .total_ns = stats.total_ns,
+            .iterations = iterations,
+            .mem_stats = null,
+        });
+    }
+
+    {
+        var stats = BenchStats{};
+
+        for (0..iterations) |_| {
+            var eb = try multiCursorBuffer(allocator, pool, text.items, cursor_count, line_step);
+            defer eb.deinit();
+
+            var timer = try std.time.Timer.start();
+            for (0..20) |_| {
+                try eb.insertText("x");
+            }
+            stats.record(timer.read());
+        }
+
+        try results.append(allocator, BenchResult{
+            .name = "EditBuffer type 20 chars at 100 cursors (10k lines)",
+            .min_ns = stats.min_ns,
+            .avg_ns = stats.avg(),
+            .max_ns = stats.max_ns,
+            .total_ns = stats.total_ns,
+            .iterations = iterations,
+            .mem_stats = null,
+        });
+    }
+
+    {
+        var stats = BenchStats{};
+
+        for (0..iterations) |_| {
+            var eb = try multiCursorBuffer(allocator, pool, text.items, cursor_count, line_step);
+            defer eb.deinit();
+
+            var timer = try std.time.Timer.start();
+            for (0..4) |_| {
+                try eb.backspace();
+            }
+            stats.record(timer.read());
+        }
+
+        try results.append(allocator, BenchResult{
+            .name = "EditBuffer backspace 4 chars at 100 cursors (10k lines)",
+            .min_ns = stats.min_ns,
+            .avg_ns = stats.avg(),
+            .max_ns = stats.max_ns,
+            .total_ns = stats.total_ns,
+            .iterations = iterations,
+            .mem_stats = null,
+        });
+    }
+
+    return try results.toOwnedSlice(allocator);
+}
+
 pub fn run(
     allocator: std.mem.Allocator,
     show_mem: bool,
@@ -438,5 +554,8 @@ pub fn run(
     const word_boundary_results = try benchWordBoundaryOperations(allocator, pool, iterations, show_mem);
     try all_results.appendSlice(allocator, word_boundary_results);
 
+    const multi_cursor_results = try benchMultiCursorOperations(allocator, pool, iterations, show_mem);
+    try all_results.appendSlice(allocator, multi_cursor_results);
+
     return try all_results.toOwnedSlice(allocator);
 }
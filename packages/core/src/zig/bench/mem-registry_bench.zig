@@ -0,0 +1,146 @@
+const std = @import("std");
+const bench_utils = @import("../bench-utils.zig");
+const mem_registry_mod = @import("../mem-registry.zig");
+const text_buffer = @import("../text-buffer.zig");
+const edit_buffer = @import("../edit-buffer.zig");
+const gp = @import("../grapheme.zig");
+
+const MemRegistry = mem_registry_mod.MemRegistry;
+const MemId = mem_registry_mod.MemId;
+const TextBuffer = text_buffer.UnifiedTextBuffer;
+const EditBuffer = edit_buffer.EditBuffer;
+const BenchResult = bench_utils.BenchResult;
+const BenchStats = bench_utils.BenchStats;
+const MemStat = bench_utils.MemStat;
+
+pub const benchName = "MemRegistry";
+
+fn makeResult(
+    allocator: std.mem.Allocator,
+    name: []const u8,
+    stats: BenchStats,
+    slots: usize,
+    show_mem: bool,
+) !BenchResult {
+    const mem_stats: ?[]const MemStat = if (show_mem) blk: {
+        const mem_stat_slice = try allocator.alloc(MemStat, 1);
+        mem_stat_slice[0] = .{ .name = "Slots", .bytes = slots * @sizeOf(mem_registry_mod.MemBuffer) };
+        break :blk mem_stat_slice;
+    } else null;
+
+    return BenchResult{
+        .name = name,
+        .min_ns = stats.min_ns,
+        .avg_ns = stats.avg(),
+        .max_ns = stats.max_ns,
+        .total_ns = stats.total_ns,
+        .iterations = stats.count,
+        .mem_stats = mem_stats,
+    };
+}
+
+/// Raw registry throughput: fill, release every other slot, refill through the free list.
+fn benchRegisterCycle(allocator: std.mem.Allocator, count: usize, iterations: usize, show_mem: bool) !BenchResult {
+    var stats = BenchStats{};
+    var slots: usize = 0;
+
+    const ids = try allocator.alloc(MemId, count);
+    defer allocator.free(ids);
+
+    for (0..iterations) |_| {
+        var registry = MemRegistry.init(allocator);
+        defer registry.deinit();
+
+        var timer = try std.time.Timer.start();
+        for (ids) |*id| {
+            id.* = try registry.register("registered text", false);
+        }
+        var i: usize = 0;
+        while (i < count) : (i += 2) {
+            try registry.unregister(ids[i]);
+        }
+        i = 0;
+        while (i < count) : (i += 2) {
+            ids[i] = try registry.register("reused text", false);
+        }
+        stats.record(timer.read());
+        slots = registry.getSlotCount();
+    }
+
+    const name = try std.fmt.allocPrint(allocator, "register/unregister/reuse {d} buffers", .{count});
+    return makeResult(allocator, name, stats, slots, show_mem);
+}
+
+/// Repeated TextBuffer.setText + append: every call registers a buffer and
+/// sweeps reclaim the ones the rope no longer references.
+fn benchTextBufferReclaim(allocator: std.mem.Allocator, pool: *gp.GraphemePool, count: usize, iterations: usize, show_mem: bool) !BenchResult {
+    var stats = BenchStats{};
+    var slots: usize = 0;
+
+    for (0..iterations) |_| {
+        var tb = try TextBuffer.init(allocator, pool, .unicode);
+        defer tb.deinit();
+
+        var timer = try std.time.Timer.start();
+        for (0..count) |_| {
+            try tb.setText("const value = compute(input);\n");
+            try tb.append("return value;");
+        }
+        stats.record(timer.read());
+        slots = tb.mem_registry.getSlotCount();
+    }
+
+    const name = try std.fmt.allocPrint(allocator, "TextBuffer setText+append x{d} (reclaiming)", .{count});
+    return makeResult(allocator, name, stats, slots, show_mem);
+}
+
+/// EditBuffer.replaceText keeps every version alive through undo history, so
+/// sweeps have to walk the history and the registry grows with it.
+fn benchEditBufferReplaceText(allocator: std.mem.Allocator, pool: *gp.GraphemePool, count: usize, iterations: usize, show_mem: bool) !BenchResult {
+    var stats = BenchStats{};
+    var slots: usize = 0;
+
+    for (0..iterations) |_| {
+        var eb = try EditBuffer.init(allocator, pool, .unicode);
+        defer eb.deinit();
+
+        var text_buf: [64]u8 = undefined;
+        var timer = try std.time.Timer.start();
+        for (0..count) |i| {
+            const text = try std.fmt.bufPrint(&text_buf, "fn version_{d}() void {{}}\n", .{i});
+            try eb.replaceText(text);
+        }
+        stats.record(timer.read());
+        slots = eb.tb.mem_registry.getSlotCount();
+    }
+
+    const name = try std.fmt.allocPrint(allocator, "EditBuffer replaceText x{d} (with history)", .{count});
+    return makeResult(allocator, name, stats, slots, show_mem);
+}
+
+pub fn run(
+    allocator: std.mem.Allocator,
+    show_mem: bool,
+) ![]BenchResult {
+    // Global pool and unicode data are initialized once in bench.zig
+    const pool = gp.initGlobalPool(allocator);
+
+    var results: std.ArrayListUnmanaged(BenchResult) = .{};
+    errdefer results.deinit(allocator);
+
+    const iterations: usize = 10;
+
+    for ([_]usize{ 1_000, 10_000, 60_000 }) |count| {
+        try results.append(allocator, try benchRegisterCycle(allocator, count, iterations, show_mem));
+    }
+
+    for ([_]usize{ 1_000, 10_000 }) |count| {
+        try results.append(allocator, try benchTextBufferReclaim(allocator, pool, count, iterations, show_mem));
+    }
+
+    for ([_]usize{ 1_000, 5_000 }) |count| {
+        try results.append(allocator, try benchEditBufferReplaceText(allocator, pool, count, iterations, show_mem));
+    }
+
+    return try results.toOwnedSlice(allocator);
+}
@@ -0,0 +1,218 @@
+const std = @import("std");
+const bench_utils = @import("../bench-utils.zig");
+const renderer = @import("../renderer.zig");
+const buffer = @import("../buffer.zig");
+const gp = @import("../grapheme.zig");
+
+const CliRenderer = renderer.CliRenderer;
+const OptimizedBuffer = buffer.OptimizedBuffer;
+const RGBA = buffer.RGBA;
+const BenchResult = bench_utils.BenchResult;
+const BenchStats = bench_utils.BenchStats;
+
+pub const benchName = "Renderer Frame Diff";
+
+const WIDTH: u32 = 300;
+const HEIGHT: u32 = 90;
+const SPARSE_CHANGES: u32 = 8;
+const COLOR_EPSILON: f32 = 0.00001;
+
+const FrameKind = enum { sparse, full };
+
+fn drawBaseFrame(buf: *OptimizedBuffer, variant: u32) !void {
+    const bg = RGBA{ 0.05, 0.05, 0.1, 1.0 };
+    try buf.clear(bg, null);
+
+    const patterns = [_][]const u8{
+        "The quick brown fox jumps over the lazy dog. ",
+        "function render(frame) { return frame.cells; } ",
+        "[info] request handled in 12ms status=200 ",
+    };
+
+    var line: [WIDTH]u8 = undefined;
+    for (0..HEIGHT) |uy| {
+        const pattern = patterns[(uy + variant) % patterns.len];
+        for (&line, 0..) |*c, i| {
+            c.* = pattern[(i + variant) % pattern.len];
+        }
+        const shade = @as(f32, @floatFromInt((uy + variant) % 8)) / 8.0;
+        try buf.drawText(&line, 0, @intCast(uy), .{ 0.8, shade, 0.6, 1.0 }, bg, 0);
+    }
+}
+
+fn applySparseChanges(buf: *OptimizedBuffer, iteration: usize) !void {
+    var i: u32 = 0;
+    while (i < SPARSE_CHANGES) : (i += 1) {
+        const x: u32 = @intCast((iteration * 37 + i * 53) % WIDTH);
+        const y: u32 = @intCast((iteration * 11 + i * 17) % HEIGHT);
+        const ch: u32 = 'A' + @as(u32, @intCast((iteration + i) % 26));
+        try buf.drawChar(ch, x, y, .{ 1.0, 1.0, 0.0, 1.0 }, .{ 0.2, 0.0, 0.0, 1.0 }, 0);
+    }
+}
+
+// The pre-existing diff: one get() per cell on both buffers plus epsilon compares
+fn scanPerCell(current: *const OptimizedBuffer, next: *const OptimizedBuffer) u32 {
+    var dirty: u32 = 0;
+    for (0..current.height) |uy| {
+        for (0..current.width) |ux| {
+            const a = current.get(@intCast(ux), @intCast(uy)) orelse continue;
+            const b = next.get(@intCast(ux), @intCast(uy)) orelse continue;
+            if (a.char != b.char or a.attributes != b.attributes or
+                !buffer.rgbaEqual(a.fg, b.fg, COLOR_EPSILON) or
+                !buffer.rgbaEqual(a.bg, b.bg, COLOR_EPSILON))
+            {
+                dirty += 1;
+            }
+        }
+    }
+    return dirty;
+}
+
+fn benchDiffScan(
+    allocator: std.mem.Allocator,
+    pool: *gp.GraphemePool,
+    kind: FrameKind,
+    iterations: usize,
+) ![]BenchResult {
+    var results: std.ArrayListUnmanaged(BenchResult) = .{};
+    errdefer results.deinit(allocator);
+
+    const current = try OptimizedBuffer.init(allocator, WIDTH, HEIGHT, .{ .pool = pool, .id = "bench current" });
+    defer current.deinit();
+    const next = try OptimizedBuffer.init(allocator, WIDTH, HEIGHT, .{ .pool = pool, .id = "bench next" });
+    defer next.deinit();
+
+    try drawBaseFrame(current, 0);
+    switch (kind) {
+        .sparse => {
+            try drawBaseFrame(next, 0);
+            try applySparseChanges(next, 1);
+        },
+        .full => try drawBaseFrame(next, 1),
+    }
+
+    const kind_str = switch (kind) {
+        .sparse => "sparse",
+        .full => "full",
+    };
+
+    {
+        var stats = BenchStats{};
+        var dirty: u32 = 0;
+        for (0..iterations) |_| {
+            var timer = try std.time.Timer.start();
+            dirty = scanPerCell(current, next);
+            std.mem.doNotOptimizeAway(dirty);
+            stats.record(timer.read());
+        }
+
+        try results.append(allocator, BenchResult{
+            .name = try std.fmt.allocPrint(allocator, "Per-cell get() scan, {s} change ({d}x{d}, {d} dirty cells)", .{ kind_str, WIDTH, HEIGHT, dirty }),
+            .min_ns = stats.min_ns,
+            .avg_ns = stats.avg(),
+            .max_ns = stats.max_ns,
+            .total_ns = stats.total_ns,
+            .iterations = iterations,
+            .mem_stats = null,
+        });
+    }
+
+    {
+        var spans: std.ArrayListUnmanaged(renderer.DirtySpan) = .{};
+        defer spans.deinit(allocator);
+        try spans.ensureTotalCapacity(allocator, renderer.maxDirtySpans(WIDTH, HEIGHT));
+
+        var stats = BenchStats{};
+        for (0..iterations) |_| {
+            var timer = try std.time.Timer.start();
+            renderer.collectDirtySpans(current, next, COLOR_EPSILON, &spans);
+            std.mem.doNotOptimizeAway(spans.items.len);
+            stats.record(timer.read());
+        }
+
+        try results.append(allocator, BenchResult{
+            .name = try std.fmt.allocPrint(allocator, "Vectorized span scan, {s} change ({d}x{d}, {d} spans)", .{ kind_str, WIDTH, HEIGHT, spans.items.len }),
+            .min_ns = stats.min_ns,
+            .avg_ns = stats.avg(),
+            .max_ns = stats.max_ns,
+            .total_ns = stats.total_ns,
+            .iterations = iterations,
+            .mem_stats = null,
+        });
+    }
+
+    return try results.toOwnedSlice(allocator);
+}
+
+fn benchRenderFrame(
+    allocator: std.mem.Allocator,
+    pool: *gp.GraphemePool,
+    kind: FrameKind,
+    iterations: usize,
+) !BenchResult {
+    var cli_renderer = try CliRenderer.create(allocator, WIDTH, HEIGHT, pool, true);
+    defer cli_renderer.destroy();
+
+    // Prime the front buffer so the measured frames diff against real content
+    try drawBaseFrame(cli_renderer.getNextBuffer(), 0);
+    cli_renderer.render(false);
+
+    var stats = BenchStats{};
+    var total_bytes: usize = 0;
+    for (0..iterations) |i| {
+        const next = cli_renderer.getNextBuffer();
+        switch (kind) {
+            .sparse => {
+                try drawBaseFrame(next, 0);
+                try applySparseChanges(next, i);
+            },
+            .full => try drawBaseFrame(next, @intCast((i + 1) % 2)),
+        }
+
+        var timer = try std.time.Timer.start();
+        cli_renderer.render(false);
+        stats.record(timer.read());
+        total_bytes += cli_renderer.renderStats.outputBytes;
+    }
+
+    const kind_str = switch (kind) {
+        .sparse => "sparse",
+        .full => "full",
+    };
+
+    return BenchResult{
+        .name = try std.fmt.allocPrint(allocator, "render() {s} change ({d}x{d}, {d} bytes/frame)", .{ kind_str, WIDTH, HEIGHT, total_bytes / iterations }),
+        .min_ns = stats.min_ns,
+        .avg_ns = stats.avg(),
+        .max_ns = stats.max_ns,
+        .total_ns = stats.total_ns,
+        .iterations = iterations,
+        .mem_stats = null,
+    };
+}
+
+pub fn run(
+    allocator: std.mem.Allocator,
+    show_mem: bool,
+) ![]BenchResult {
+    _ = show_mem;
+
+    // Global pool and unicode data are initialized once in bench.zig
+    const pool = gp.initGlobalPool(allocator);
+
+    var all_results: std.ArrayListUnmanaged(BenchResult) = .{};
+    errdefer all_results.deinit(allocator);
+
+    const iterations: usize = 200;
+
+    const sparse_scan_results = try benchDiffScan(allocator, pool, .sparse, iterations);
+    try all_results.appendSlice(allocator, sparse_scan_results);
+
+    const full_scan_results = try benchDiffScan(allocator, pool, .full, iterations);
+    try all_results.appendSlice(allocator, full_scan_results);
+
+    try all_results.append(allocator, try benchRenderFrame(allocator, pool, .sparse, iterations));
+    try all_results.append(allocator, try benchRenderFrame(allocator, pool, .full, iterations));
+
+    return try all_results.toOwnedSlice(allocator);
+}
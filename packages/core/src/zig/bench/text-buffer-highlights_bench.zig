@@ -0,0 +1,92 @@
+const std = @import("std");
+const bench_utils = @import("../bench-utils.zig");
+const edit_buffer = @import("../edit-buffer.zig");
+const gp = @import("../grapheme.zig");
+
+const EditBuffer = edit_buffer.EditBuffer;
+const BenchResult = bench_utils.BenchResult;
+const BenchStats = bench_utils.BenchStats;
+
+pub const benchName = "TextBuffer Highlights";
+
+fn generateLines(allocator: std.mem.Allocator, line_count: usize) ![]u8 {
+    var buffer: std.ArrayListUnmanaged(u8) = .{};
+    errdefer buffer.deinit(allocator);
+    for (0..line_count) |i| {
+        try buffer.writer(allocator).print("const value_{d} = compute({d});\n", .{ i, i });
+    }
+    return try buffer.toOwnedSlice(allocator);
+}
+
+/// Two highlights per line; every 100th line also gets one with ref 1
+fn highlightAll(eb: *EditBuffer, line_count: usize) !void {
+    const tb = eb.getTextBuffer();
+    tb.startHighlightsTransaction();
+    defer tb.endHighlightsTransaction();
+    for (0..line_count) |line| {
+        try tb.addHighlight(line, 0, 5, 1, 0, 0);
+        try tb.addHighlight(line, 6, 11, 2, 0, 0);
+        if (line % 100 == 0) try tb.addHighlight(line, 14, 21, 3, 1, 1);
+    }
+}
+
+fn makeResult(name: []const u8, stats: BenchStats) BenchResult {
+    return BenchResult{
+        .name = name,
+        .min_ns = stats.min_ns,
+        .avg_ns = stats.avg(),
+        .max_ns = stats.max_ns,
+        .total_ns = stats.total_ns,
+        .iterations = stats.count,
+        .mem_stats = null,
+    };
+}
+
+pub fn run(
+    allocator: std.mem.Allocator,
+    show_mem: bool,
+) ![]BenchResult {
+    _ = show_mem;
+    // Global pool and unicode data are initialized once in bench.zig
+    const pool = gp.initGlobalPool(allocator);
+
+    var results: std.ArrayListUnmanaged(BenchResult) = .{};
+    errdefer results.deinit(allocator);
+
+    const iterations: usize = 5;
+
+    for ([_]usize{ 10_000, 100_000 }) |line_count| {
+        const text = try generateLines(allocator, line_count);
+        defer allocator.free(text);
+
+        var add_stats = BenchStats{};
+        var insert_stats = BenchStats{};
+        var remove_stats = BenchStats{};
+
+        for (0..iterations) |_| {
+            var eb = try EditBuffer.init(allocator, pool, .unicode);
+            defer eb.deinit();
+            try eb.setText(text);
+
+            var timer = try std.time.Timer.start();
+            try highlightAll(eb, line_count);
+            add_stats.record(timer.read());
+
+            // Typing newlines at the top moves every line's highlights
+            try eb.setCursor(0, 0);
+            timer.reset();
+            for (0..100) |_| try eb.insertText("\n");
+            insert_stats.record(timer.read());
+
+            timer.reset();
+            eb.getTextBuffer().removeHighlightsByRef(1);
+            remove_stats.record(timer.read());
+        }
+
+        try results.append(allocator, makeResult(try std.fmt.allocPrint(allocator, "add highlights on {d} lines", .{line_count}), add_stats));
+        try results.append(allocator, makeResult(try std.fmt.allocPrint(allocator, "100 newlines above {d} highlighted lines", .{line_count}), insert_stats));
+        try results.append(allocator, makeResult(try std.fmt.allocPrint(allocator, "removeHighlightsByRef 1% of {d} lines", .{line_count}), remove_stats));
+    }
+
+    return try results.toOwnedSlice(allocator);
+}
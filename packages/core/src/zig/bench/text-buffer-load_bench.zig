@@ -0,0 +1,107 @@
+const std = @import("std");
+const bench_utils = @import("../bench-utils.zig");
+const text_buffer = @import("../text-buffer.zig");
+const gp = @import("../grapheme.zig");
+
+const TextBuffer = text_buffer.UnifiedTextBuffer;
+const BenchResult = bench_utils.BenchResult;
+const BenchStats = bench_utils.BenchStats;
+const MemStat = bench_utils.MemStat;
+
+pub const benchName = "TextBuffer Load";
+
+fn generateSource(allocator: std.mem.Allocator, size: usize) ![]u8 {
+    const lines = [_][]const u8{
+        "const std = @import(\"std\");\n",
+        "pub fn main() !void {\n",
+        "\tconst greeting = \"Hello, 世界! 🌍\";\n",
+        "\t// Αυτό είναι ελληνικό. Это русский.\n",
+        "\tstd.debug.print(\"{s}\\n\", .{greeting});\n",
+        "}\n",
+        "\n",
+    };
+
+    var buffer: std.ArrayListUnmanaged(u8) = .{};
+    errdefer buffer.deinit(allocator);
+    try buffer.ensureTotalCapacity(allocator, size);
+
+    var i: usize = 0;
+    while (buffer.items.len < size) : (i += 1) {
+        try buffer.appendSlice(allocator, lines[i % lines.len]);
+    }
+
+    return try buffer.toOwnedSlice(allocator);
+}
+
+fn benchLoad(
+    allocator: std.mem.Allocator,
+    pool: *gp.GraphemePool,
+    text: []const u8,
+    threads: u32,
+    iterations: usize,
+    show_mem: bool,
+) !BenchResult {
+    var stats = BenchStats{};
+
+    for (0..iterations) |_| {
+        var tb = try TextBuffer.init(allocator, pool, .unicode);
+        defer tb.deinit();
+        tb.load_threads = threads;
+
+        var timer = try std.time.Timer.start();
+        try tb.setText(text);
+        stats.record(timer.read());
+    }
+
+    const mb = @as(f64, @floatFromInt(text.len)) / (1024.0 * 1024.0);
+    const avg_s = @as(f64, @floatFromInt(stats.avg())) / std.time.ns_per_s;
+    const throughput = if (avg_s > 0) mb / avg_s else 0;
+
+    const mode = if (threads == 1) "single-threaded" else "parallel";
+    const name = try std.fmt.allocPrint(
+        allocator,
+        "setText {d:.0}MB {s} ({d:.0} MB/s)",
+        .{ mb, mode, throughput },
+    );
+
+    const mem_stats: ?[]const MemStat = if (show_mem) blk: {
+        const mem_stat_slice = try allocator.alloc(MemStat, 1);
+        mem_stat_slice[0] = .{ .name = "Text", .bytes = text.len };
+        break :blk mem_stat_slice;
+    } else null;
+
+    return BenchResult{
+        .name = name,
+        .min_ns = stats.min_ns,
+        .avg_ns = stats.avg(),
+        .max_ns = stats.max_ns,
+        .total_ns = stats.total_ns,
+        .iterations = iterations,
+        .mem_stats = mem_stats,
+    };
+}
+
+pub fn run(
+    allocator: std.mem.Allocator,
+    show_mem: bool,
+) ![]BenchResult {
+    // Global pool and unicode data are initialized once in bench.zig
+    const pool = gp.initGlobalPool(allocator);
+
+    var results: std.ArrayListUnmanaged(BenchResult) = .{};
+    errdefer results.deinit(allocator);
+
+    const iterations: usize = 5;
+
+    for ([_]usize{ 10 * 1024 * 1024, 100 * 1024 * 1024 }) |size| {
+        const text = try generateSource(allocator, size);
+        defer allocator.free(text);
+
+        // 1 forces the serial path, 0 uses every available core
+        for ([_]u32{ 1, 0 }) |threads| {
+            try results.append(allocator, try benchLoad(allocator, pool, text, threads, iterations, show_mem));
+        }
+    }
+
+    return try results.toOwnedSlice(allocator);
+}
@@ -2,10 +2,12 @@ const std = @import("std");
 const bench_utils = @import("../bench-utils.zig");
 const text_buffer = @import("../text-buffer.zig");
 const text_buffer_view = @import("../text-buffer-view.zig");
+const edit_buffer = @import("../edit-buffer.zig");
 const gp = @import("../grapheme.zig");
 
 const UnifiedTextBuffer = text_buffer.UnifiedTextBuffer;
 const UnifiedTextBufferView = text_buffer_view.UnifiedTextBufferView;
+const EditBuffer = edit_buffer.EditBuffer;
 const WrapMode = text_buffer.WrapMode;
 const BenchResult = bench_utils.BenchResult;
 const BenchStats = bench_utils.BenchStats;
@@ -258,8 +260,8 @@ fn benchMeasureForDimensionsLayout(
 
         view.setWrapMode(.word);
 
-        var token_mem_id: u8 = 0;
-        var newline_mem_id: u8 = 0;
+        var token_mem_id: text_buffer.MemId = 0;
+        var newline_mem_id: text_buffer.MemId = 0;
         if (streaming) {
             token_mem_id = try tb.registerMemBuffer(token, false);
             newline_mem_id = try tb.registerMemBuffer(newline, false);
@@ -305,6 +307,127 @@ fn benchMeasureForDimensionsLayout(
     };
 }
 
+fn benchKeystroke(
+    allocator: std.mem.Allocator,
+    pool: *gp.GraphemePool,
+    line_count: u32,
+    iterations: usize,
+    show_mem: bool,
+) !BenchResult {
+    const keystrokes: usize = 20;
+
+    const text = try generateLargeText(allocator, line_count, std.math.maxInt(usize));
+    defer allocator.free(text);
+
+    var stats = BenchStats{};
+    var final_tb_mem: usize = 0;
+    var final_view_mem: usize = 0;
+
+    for (0..iterations) |i| {
+        var eb = try EditBuffer.init(allocator, pool, .unicode);
+        defer eb.deinit();
+
+        try eb.setText(text);
+
+        var view = try UnifiedTextBufferView.init(allocator, eb.getTextBuffer());
+        defer view.deinit();
+
+        view.setWrapMode(.word);
+        view.setWrapWidth(80);
+        _ = view.getVirtualLineCount();
+
+        try eb.setCursor(line_count / 2, 10);
+
+        // Each keystroke is timed on its own: the edit plus the view catching up
+        for (0..keystrokes) |_| {
+            var timer = try std.time.Timer.start();
+            try eb.insertText("x");
+            _ = view.getVirtualLineCount();
+            stats.record(timer.read());
+        }
+
+        if (i == iterations - 1 and show_mem) {
+            final_tb_mem = eb.getTextBuffer().getArenaAllocatedBytes();
+            final_view_mem = view.getArenaAllocatedBytes();
+        }
+    }
+
+    const mem_stats: ?[]const MemStat = if (show_mem) blk: {
+        const mem = try allocator.alloc(MemStat, 2);
+        mem[0] = .{ .name = "TB", .bytes = final_tb_mem };
+        mem[1] = .{ .name = "View", .bytes = final_view_mem };
+        break :blk mem;
+    } else null;
+
+    return .{
+        .name = try std.fmt.allocPrint(allocator, "TextBufferView keystroke rewrap (word, width=80, {d} lines)", .{line_count}),
+        .min_ns = stats.min_ns,
+        .avg_ns = stats.avg(),
+        .max_ns = stats.max_ns,
+        .total_ns = stats.total_ns,
+        .iterations = iterations * keystrokes,
+        .mem_stats = mem_stats,
+    };
+}
+
+fn benchStreamingTail(
+    allocator: std.mem.Allocator,
+    pool: *gp.GraphemePool,
+    max_lines: u32,
+    iterations: usize,
+    show_mem: bool,
+) !BenchResult {
+    const appends: usize = 20_000;
+
+    var stats = BenchStats{};
+    var final_tb_mem: usize = 0;
+    var final_view_mem: usize = 0;
+    var line: [128]u8 = undefined;
+
+    for (0..iterations) |i| {
+        var tb = try UnifiedTextBuffer.init(allocator, pool, .unicode);
+        defer tb.deinit();
+        try tb.setMaxLines(max_lines);
+
+        var view = try UnifiedTextBufferView.init(allocator, tb);
+        defer view.deinit();
+
+        view.setWrapMode(.word);
+        view.setWrapWidth(80);
+
+        // Each append is timed on its own: the append plus the view catching up
+        for (0..appends) |n| {
+            const text = try std.fmt.bufPrint(&line, "\n[{d:0>6}] request handled in {d}ms, status=200 path=/api/v1/items", .{ n, n % 97 });
+            var timer = try std.time.Timer.start();
+            try tb.appendStreaming(text);
+            _ = view.getVirtualLineCount();
+            stats.record(timer.read());
+        }
+
+        if (i == iterations - 1 and show_mem) {
+            final_tb_mem = tb.getArenaAllocatedBytes();
+            final_view_mem = view.getArenaAllocatedBytes();
+        }
+    }
+
+    const mem_stats: ?[]const MemStat = if (show_mem) blk: {
+        const mem = try allocator.alloc(MemStat, 2);
+        mem[0] = .{ .name = "TB", .bytes = final_tb_mem };
+        mem[1] = .{ .name = "View", .bytes = final_view_mem };
+        break :blk mem;
+    } else null;
+
+    return .{
+        .name = try std.fmt.allocPrint(allocator, "TextBuffer streaming append (word, width=80, cap {d} lines)", .{max_lines}),
+        .min_ns = stats.min_ns,
+        .avg_ns = stats.avg(),
+        .max_ns = stats.max_ns,
+        .total_ns = stats.total_ns,
+        .iterations = iterations * appends,
+        .mem_stats = mem_stats,
+    };
+}
+
 pub fn run(
     allocator: std.mem.Allocator,
     show_mem: bool,
@@ -405,5 +528,17 @@ pub fn run(
         try all_results.append(allocator, bench_result);
     }
 
+    // Single keystroke cost should stay flat as the document grows
+    const keystroke_line_counts = [_]u32{ 1_000, 10_000, 50_000 };
+    for (keystroke_line_counts) |line_count| {
+        try all_results.append(allocator, try benchKeystroke(allocator, pool, line_count, iterations, show_mem));
+    }
+
+    // A capped tail should cost the same per append whatever the cap
+    const tail_caps = [_]u32{ 1_000, 10_000 };
+    for (tail_caps) |max_lines| {
+        try all_results.append(allocator, try benchStreamingTail(allocator, pool, max_lines, iterations, show_mem));
+    }
+
     return try all_results.toOwnedSlice(allocator);
 }
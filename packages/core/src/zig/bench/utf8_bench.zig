@@ -4,6 +4,7 @@ const utf8 = @import("../utf8.zig");
 
 const BenchResult = bench_utils.BenchResult;
 const BenchStats = bench_utils.BenchStats;
+const WidthMethod = utf8.WidthMethod;
 
 pub const benchName = "UTF-8 Operations";
 
@@ -666,6 +667,37 @@ fn benchCalculateTextWidth(results_alloc: std.mem.Allocator, iterations: usize)
         });
     }
 
+    // CJK and Cyrillic prose, the shape the run kernels target
+    inline for (.{
+        .{ "calculateTextWidth: CJK (10KB)", "漢字仮名交じり文한국어", WidthMethod.unicode },
+        .{ "calculateTextWidth: CJK wcwidth (10KB)", "漢字仮名交じり文한국어", WidthMethod.wcwidth },
+        .{ "calculateTextWidth: Cyrillic (10KB)", "Съешь же ещё этих мягких булок ", WidthMethod.unicode },
+    }) |case| {
+        var temp = std.heap.ArenaAllocator.init(std.heap.page_allocator);
+        defer temp.deinit();
+        var text: std.ArrayListUnmanaged(u8) = .{};
+        while (text.items.len < 10 * 1024) {
+            try text.appendSlice(temp.allocator(), case[1]);
+        }
+
+        var stats = BenchStats{};
+        for (0..iterations) |_| {
+            var timer = try std.time.Timer.start();
+            _ = utf8.calculateTextWidth(text.items, 4, false, case[2]);
+            stats.record(timer.read());
+        }
+
+        try results.append(results_alloc, BenchResult{
+            .name = case[0],
+            .min_ns = stats.min_ns,
+            .avg_ns = stats.avg(),
+            .max_ns = stats.max_ns,
+            .total_ns = stats.total_ns,
+            .iterations = iterations,
+            .mem_stats = null,
+        });
+    }
+
     return results.toOwnedSlice(results_alloc);
 }
 
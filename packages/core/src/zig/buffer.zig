@@ -82,6 +82,41 @@ pub fn rgbaEqual(a: RGBA, b: RGBA, epsilon: f32) bool {
     return @reduce(.And, diff < eps);
 }
 
+pub fn rgbaComponentToU8(component: f32) u8 {
+    if (!std.math.isFinite(component)) return 0;
+
+    const clamped = std.math.clamp(component, 0.0, 1.0);
+    return @intFromFloat(@round(clamped * 255.0));
+}
+
+/// Pack a float color into RGBA8, red in the lowest byte
+pub fn packRGBA8(color: RGBA) u32 {
+    return @as(u32, rgbaComponentToU8(color[0])) |
+        (@as(u32, rgbaComponentToU8(color[1])) << 8) |
+        (@as(u32, rgbaComponentToU8(color[2])) << 16) |
+        (@as(u32, rgbaComponentToU8(color[3])) << 24);
+}
+
+pub fn unpackRGBA8(color: u32) RGBA {
+    // Divide rather than multiply by INV_255 so 0 and 255 map to exactly 0.0 and 1.0
+    return .{
+        @as(f32, @floatFromInt(color & 0xFF)) / 255.0,
+        @as(f32, @floatFromInt((color >> 8) & 0xFF)) / 255.0,
+        @as(f32, @floatFromInt((color >> 16) & 0xFF)) / 255.0,
+        @as(f32, @floatFromInt(color >> 24)) / 255.0,
+    };
+}
+
+/// How an OptimizedBuffer stores its fg/bg colors.
+pub const ColorStorage = enum {
+    /// One RGBA (4 x f32) per cell. TypeScript maps these arrays directly.
+    float32,
+    /// One packed RGBA8 u32 per cell, a quarter of the float32 footprint.
+    /// Colors are quantized on write and expanded on read, so blending still
+    /// happens in float at the edges. getFgPtr/getBgPtr return null in this mode.
+    rgba8,
+};
+
 pub const Cell = struct {
     char: u32,
     fg: RGBA,
@@ -89,6 +124,14 @@ pub const Cell = struct {
     attributes: u32,
 };
 
+fn moveWithin(comptime T: type, items: []T, dst: usize, src: usize, len: usize) void {
+    if (dst < src) {
+        std.mem.copyForwards(T, items[dst..][0..len], items[src..][0..len]);
+    } else if (dst > src) {
+        std.mem.copyBackwards(T, items[dst..][0..len], items[src..][0..len]);
+    }
+}
+
 fn isRGBAWithAlpha(color: RGBA) bool {
     return color[3] < 1.0;
 }
@@ -126,7 +169,11 @@ pub const OptimizedBuffer = struct {
         fg: []RGBA,
         bg: []RGBA,
         attributes: []u32,
+        // Only allocated with .rgba8 storage; fg/bg are empty in that mode
+        fg8: []u32,
+        bg8: []u32,
     },
+    color_storage: ColorStorage,
     width: u32,
     height: u32,
     respectAlpha: bool,
@@ -141,12 +188,24 @@ pub const OptimizedBuffer = struct {
     scissor_stack: std.ArrayListUnmanaged(ClipRect),
     opacity_stack: std.ArrayListUnmanaged(f32),
 
+    // Optional per-row change tracking, see setRowTracking
+    row_tracking: bool = false,
+    rows_dirty: std.DynamicBitSetUnmanaged = .{},
+    row_hashes_stale: std.DynamicBitSetUnmanaged = .{},
+    row_hashes: []u64 = &[_]u64{},
+    // Rows written since the last clear, and the fill that clear left, so a
+    // repeated clear with the same fill only resets (and dirties) those rows
+    rows_written: std.DynamicBitSetUnmanaged = .{},
+    cleared_with: ?struct { bg: RGBA, char: u32 } = null,
+
     const InitOptions = struct {
         respectAlpha: bool = false,
         pool: *gp.GraphemePool,
         width_method: utf8.WidthMethod = .unicode,
         id: []const u8 = "unnamed buffer",
         link_pool: ?*link.LinkPool = null,
+        color_storage: ColorStorage = .float32,
+        track_rows: bool = false,
     };
 
     pub fn init(allocator: Allocator, width: u32, height: u32, options: InitOptions) BufferError!*OptimizedBuffer {
@@ -171,13 +230,18 @@ pub const OptimizedBuffer = struct {
 
         const lp = options.link_pool orelse link.initGlobalLinkPool(allocator);
 
+        const packed_colors = options.color_storage == .rgba8;
+
         self.* = .{
             .buffer = .{
                 .char = allocator.alloc(u32, size) catch return BufferError.OutOfMemory,
-                .fg = allocator.alloc(RGBA, size) catch return BufferError.OutOfMemory,
-                .bg = allocator.alloc(RGBA, size) catch return BufferError.OutOfMemory,
+                .fg = if (packed_colors) &[_]RGBA{} else allocator.alloc(RGBA, size) catch return BufferError.OutOfMemory,
+                .bg = if (packed_colors) &[_]RGBA{} else allocator.alloc(RGBA, size) catch return BufferError.OutOfMemory,
                 .attributes = allocator.alloc(u32, size) catch return BufferError.OutOfMemory,
+                .fg8 = if (packed_colors) allocator.alloc(u32, size) catch return BufferError.OutOfMemory else &[_]u32{},
+                .bg8 = if (packed_colors) allocator.alloc(u32, size) catch return BufferError.OutOfMemory else &[_]u32{},
             },
+            .color_storage = options.color_storage,
             .width = width,
             .height = height,
             .respectAlpha = options.respectAlpha,
@@ -195,8 +259,14 @@ pub const OptimizedBuffer = struct {
         @memset(self.buffer.char, 0);
         @memset(self.buffer.fg, .{ 0.0, 0.0, 0.0, 0.0 });
         @memset(self.buffer.bg, .{ 0.0, 0.0, 0.0, 0.0 });
+        @memset(self.buffer.fg8, 0);
+        @memset(self.buffer.bg8, 0);
         @memset(self.buffer.attributes, 0);
 
+        if (options.track_rows) {
+            try self.setRowTracking(true);
+        }
+
         return self;
     }
 
@@ -204,11 +274,15 @@ pub const OptimizedBuffer = struct {
         return self.buffer.char.ptr;
     }
 
-    pub fn getFgPtr(self: *OptimizedBuffer) [*]RGBA {
+    /// Null for .rgba8 buffers, which keep no float colors to map
+    pub fn getFgPtr(self: *OptimizedBuffer) ?[*]RGBA {
+        if (self.color_storage != .float32) return null;
         return self.buffer.fg.ptr;
     }
 
-    pub fn getBgPtr(self: *OptimizedBuffer) [*]RGBA {
+    /// Null for .rgba8 buffers, which keep no float colors to map
+    pub fn getBgPtr(self: *OptimizedBuffer) ?[*]RGBA {
+        if (self.color_storage != .float32) return null;
         return self.buffer.bg.ptr;
     }
 
@@ -216,6 +290,46 @@ pub const OptimizedBuffer = struct {
         return self.buffer.attributes.ptr;
     }
 
+    pub fn getFgAt(self: *const OptimizedBuffer, index: usize) RGBA {
+        return switch (self.color_storage) {
+            .float32 => self.buffer.fg[index],
+            .rgba8 => unpackRGBA8(self.buffer.fg8[index]),
+        };
+    }
+
+    pub fn getBgAt(self: *const OptimizedBuffer, index: usize) RGBA {
+        return switch (self.color_storage) {
+            .float32 => self.buffer.bg[index],
+            .rgba8 => unpackRGBA8(self.buffer.bg8[index]),
+        };
+    }
+
+    fn setColorsAt(self: *OptimizedBuffer, index: usize, fg: RGBA, bg: RGBA) void {
+        switch (self.color_storage) {
+            .float32 => {
+                self.buffer.fg[index] = fg;
+                self.buffer.bg[index] = bg;
+            },
+            .rgba8 => {
+                self.buffer.fg8[index] = packRGBA8(fg);
+                self.buffer.bg8[index] = packRGBA8(bg);
+            },
+        }
+    }
+
+    fn fillColors(self: *OptimizedBuffer, start: usize, end: usize, fg: RGBA, bg: RGBA) void {
+        switch (self.color_storage) {
+            .float32 => {
+                @memset(self.buffer.fg[start..end], fg);
+                @memset(self.buffer.bg[start..end], bg);
+            },
+            .rgba8 => {
+                @memset(self.buffer.fg8[start..end], packRGBA8(fg));
+                @memset(self.buffer.bg8[start..end], packRGBA8(bg));
+            },
+        }
+    }
+
     pub fn deinit(self: *OptimizedBuffer) void {
         self.opacity_stack.deinit(self.allocator);
         self.scissor_stack.deinit(self.allocator);
@@ -224,7 +338,10 @@ pub const OptimizedBuffer = struct {
         self.allocator.free(self.buffer.char);
         self.allocator.free(self.buffer.fg);
         self.allocator.free(self.buffer.bg);
+        self.allocator.free(self.buffer.fg8);
+        self.allocator.free(self.buffer.bg8);
         self.allocator.free(self.buffer.attributes);
+        self.freeRowTracking();
         self.allocator.free(self.id);
         self.allocator.destroy(self);
     }
@@ -346,13 +463,26 @@ pub const OptimizedBuffer = struct {
         const size = width * height;
 
         self.buffer.char = self.allocator.realloc(self.buffer.char, size) catch return BufferError.OutOfMemory;
-        self.buffer.fg = self.allocator.realloc(self.buffer.fg, size) catch return BufferError.OutOfMemory;
-        self.buffer.bg = self.allocator.realloc(self.buffer.bg, size) catch return BufferError.OutOfMemory;
+        switch (self.color_storage) {
+            .float32 => {
+                self.buffer.fg = self.allocator.realloc(self.buffer.fg, size) catch return BufferError.OutOfMemory;
+                self.buffer.bg = self.allocator.realloc(self.buffer.bg, size) catch return BufferError.OutOfMemory;
+            },
+            .rgba8 => {
+                self.buffer.fg8 = self.allocator.realloc(self.buffer.fg8, size) catch return BufferError.OutOfMemory;
+                self.buffer.bg8 = self.allocator.realloc(self.buffer.bg8, size) catch return BufferError.OutOfMemory;
+            },
+        }
         self.buffer.attributes = self.allocator.realloc(self.buffer.attributes, size) catch return BufferError.OutOfMemory;
 
         self.width = width;
         self.height = height;
 
+        if (self.row_tracking) {
+            try self.resizeRowTracking(height);
+        }
+        self.cleared_with = null;
+
         // Always clear after resize to initialize cells (realloc doesn't zero memory)
         // This handles both growing (new cells are garbage) and shrinking (grapheme cleanup)
         try self.clear(.{ 0.0, 0.0, 0.0, 1.0 }, null);
@@ -373,24 +503,167 @@ pub const OptimizedBuffer = struct {
         const cellChar = char orelse DEFAULT_SPACE_CHAR;
         self.link_tracker.clear();
         self.grapheme_tracker.clear();
-        @memset(self.buffer.char, @intCast(cellChar));
-        @memset(self.buffer.attributes, 0);
-        @memset(self.buffer.fg, .{ 1.0, 1.0, 1.0, 1.0 });
-        @memset(self.buffer.bg, bg);
+
+        // Rows nobody wrote since the last identical clear already hold this fill
+        if (self.row_tracking) {
+            if (self.cleared_with) |prev| {
+                if (prev.char == cellChar and std.mem.eql(f32, &prev.bg, &bg)) {
+                    var it = self.rows_written.iterator(.{});
+                    while (it.next()) |row| {
+                        const y: u32 = @intCast(row);
+                        self.fillRows(y, y + 1, cellChar, bg);
+                        self.markRowDirty(y);
+                    }
+                    self.rows_written.unsetAll();
+                    return;
+                }
+            }
+        }
+
+        self.fillRows(0, self.height, cellChar, bg);
+        self.markRowsDirty(0, self.height);
+        if (self.row_tracking) {
+            self.rows_written.unsetAll();
+            self.cleared_with = .{ .bg = bg, .char = cellChar };
+        }
+    }
+
+    fn fillRows(self: *OptimizedBuffer, start: u32, end: u32, char: u32, bg: RGBA) void {
+        const from = start * self.width;
+        const to = end * self.width;
+        @memset(self.buffer.char[from..to], char);
+        @memset(self.buffer.attributes[from..to], 0);
+        self.fillColors(from, to, .{ 1.0, 1.0, 1.0, 1.0 }, bg);
+    }
+
+    /// Enable or disable per-row change tracking. While enabled every write through
+    /// this API sets the row's dirty bit, getRowHash only rehashes rows written
+    /// since their hash was last computed, and clear only resets rows written
+    /// since the previous clear with the same fill. Writes through the raw
+    /// pointers (getCharPtr and friends) must be reported with markRowsDirty.
+    ///
+    /// Row hashes are computed on read rather than rolled forward on every cell
+    /// write: draw paths write cells one at a time, often several times per
+    /// frame, and only scroll detection reads the hashes.
+    pub fn setRowTracking(self: *OptimizedBuffer, enabled: bool) BufferError!void {
+        if (enabled == self.row_tracking) return;
+        if (enabled) {
+            try self.resizeRowTracking(self.height);
+            self.row_tracking = true;
+            self.cleared_with = null;
+            self.markRowsDirty(0, self.height);
+        } else {
+            self.row_tracking = false;
+            self.freeRowTracking();
+        }
+    }
+
+    pub fn getRowTracking(self: *const OptimizedBuffer) bool {
+        return self.row_tracking;
+    }
+
+    fn resizeRowTracking(self: *OptimizedBuffer, height: u32) BufferError!void {
+        self.rows_dirty.resize(self.allocator, height, true) catch return BufferError.OutOfMemory;
+        self.row_hashes_stale.resize(self.allocator, height, true) catch return BufferError.OutOfMemory;
+        self.rows_written.resize(self.allocator, height, true) catch return BufferError.OutOfMemory;
+        if (self.row_hashes.len == 0) {
+            self.row_hashes = self.allocator.alloc(u64, height) catch return BufferError.OutOfMemory;
+        } else {
+            self.row_hashes = self.allocator.realloc(self.row_hashes, height) catch return BufferError.OutOfMemory;
+        }
+    }
+
+    fn freeRowTracking(self: *OptimizedBuffer) void {
+        self.rows_dirty.deinit(self.allocator);
+        self.row_hashes_stale.deinit(self.allocator);
+        self.rows_written.deinit(self.allocator);
+        if (self.row_hashes.len > 0) self.allocator.free(self.row_hashes);
+        self.rows_dirty = .{};
+        self.row_hashes_stale = .{};
+        self.rows_written = .{};
+        self.row_hashes = &[_]u64{};
+    }
+
+    /// Mark rows [start, end) as changed. No-op unless row tracking is enabled.
+    pub fn markRowsDirty(self: *OptimizedBuffer, start: u32, end: u32) void {
+        if (!self.row_tracking) return;
+        const clampedEnd = @min(end, self.height);
+        if (start >= clampedEnd) return;
+        self.rows_dirty.setRangeValue(.{ .start = start, .end = clampedEnd }, true);
+        self.row_hashes_stale.setRangeValue(.{ .start = start, .end = clampedEnd }, true);
+        self.rows_written.setRangeValue(.{ .start = start, .end = clampedEnd }, true);
+    }
+
+    inline fn markRowDirty(self: *OptimizedBuffer, y: u32) void {
+        if (!self.row_tracking) return;
+        self.rows_dirty.set(y);
+        self.row_hashes_stale.set(y);
+        self.rows_written.set(y);
+    }
+
+    /// Whether row `y` was written since the last clearDirtyRows. Always true
+    /// when row tracking is disabled.
+    pub fn isRowDirty(self: *const OptimizedBuffer, y: u32) bool {
+        if (!self.row_tracking) return true;
+        if (y >= self.height) return false;
+        return self.rows_dirty.isSet(y);
+    }
+
+    pub fn getDirtyRowCount(self: *const OptimizedBuffer) u32 {
+        if (!self.row_tracking) return self.height;
+        return @intCast(self.rows_dirty.count());
+    }
+
+    pub fn clearDirtyRows(self: *OptimizedBuffer) void {
+        if (!self.row_tracking) return;
+        self.rows_dirty.unsetAll();
+    }
+
+    /// Content hash of row `y`. Rows hash equal only when bitwise identical.
+    /// Cached between writes when row tracking is enabled.
+    pub fn getRowHash(self: *OptimizedBuffer, y: u32) u64 {
+        if (y >= self.height) return 0;
+        if (self.row_tracking and !self.row_hashes_stale.isSet(y)) return self.row_hashes[y];
+
+        const hash = self.computeRowHash(y);
+        if (self.row_tracking) {
+            self.row_hashes[y] = hash;
+            self.row_hashes_stale.unset(y);
+        }
+        return hash;
+    }
+
+    fn computeRowHash(self: *const OptimizedBuffer, y: u32) u64 {
+        const start = y * self.width;
+        const end = start + self.width;
+        var hasher = std.hash.Wyhash.init(0);
+        hasher.update(std.mem.sliceAsBytes(self.buffer.char[start..end]));
+        hasher.update(std.mem.sliceAsBytes(self.buffer.attributes[start..end]));
+        switch (self.color_storage) {
+            .float32 => {
+                hasher.update(std.mem.sliceAsBytes(self.buffer.fg[start..end]));
+                hasher.update(std.mem.sliceAsBytes(self.buffer.bg[start..end]));
+            },
+            .rgba8 => {
+                hasher.update(std.mem.sliceAsBytes(self.buffer.fg8[start..end]));
+                hasher.update(std.mem.sliceAsBytes(self.buffer.bg8[start..end]));
+            },
+        }
+        return hasher.final();
     }
 
     pub fn setRaw(self: *OptimizedBuffer, x: u32, y: u32, cell: Cell) void {
         if (x >= self.width or y >= self.height) return;
         if (!self.isPointInScissor(@intCast(x), @intCast(y))) return;
         const index = self.coordsToIndex(x, y);
+        self.markRowDirty(y);
 
         const prev_attr = self.buffer.attributes[index];
         const prev_link_id = ansi.TextAttributes.getLinkId(prev_attr);
         const new_link_id = ansi.TextAttributes.getLinkId(cell.attributes);
 
         self.buffer.char[index] = cell.char;
-        self.buffer.fg[index] = cell.fg;
-        self.buffer.bg[index] = cell.bg;
+        self.setColorsAt(index, cell.fg, cell.bg);
         self.buffer.attributes[index] = cell.attributes;
 
         if (prev_link_id != 0 and prev_link_id != new_link_id) {
@@ -401,11 +674,60 @@ pub const OptimizedBuffer = struct {
         }
     }
 
+    /// Move the content of rows [top, end) up by `lines` rows, or down when negative,
+    /// filling the rows left uncovered with `fill`. Mirrors a terminal scroll region.
+    /// Like setRaw, this does not track graphemes; link references of rows scrolled
+    /// out are released and `fill` must not carry a link.
+    pub fn scrollRowsRaw(self: *OptimizedBuffer, top: u32, end: u32, lines: i32, fill: Cell) void {
+        const bottom = @min(end, self.height);
+        if (top >= bottom or lines == 0) return;
+
+        const w = self.width;
+        const span = bottom - top;
+        const amount: u32 = @intCast(@min(@abs(lines), span));
+        const keep = span - amount;
+        const up = lines > 0;
+        self.markRowsDirty(top, bottom);
+
+        if (self.link_tracker.hasAny()) {
+            const droppedStart = if (up) top else bottom - amount;
+            for (self.buffer.attributes[droppedStart * w .. (droppedStart + amount) * w]) |attr| {
+                const link_id = ansi.TextAttributes.getLinkId(attr);
+                if (link_id != 0) self.link_tracker.removeCellRef(link_id);
+            }
+        }
+
+        if (keep > 0) {
+            const src: usize = (if (up) top + amount else top) * w;
+            const dst: usize = (if (up) top else top + amount) * w;
+            const len: usize = keep * w;
+            moveWithin(u32, self.buffer.char, dst, src, len);
+            moveWithin(u32, self.buffer.attributes, dst, src, len);
+            switch (self.color_storage) {
+                .float32 => {
+                    moveWithin(RGBA, self.buffer.fg, dst, src, len);
+                    moveWithin(RGBA, self.buffer.bg, dst, src, len);
+                },
+                .rgba8 => {
+                    moveWithin(u32, self.buffer.fg8, dst, src, len);
+                    moveWithin(u32, self.buffer.bg8, dst, src, len);
+                },
+            }
+        }
+
+        const fillStart: usize = (if (up) top + keep else top) * w;
+        const fillEnd: usize = fillStart + amount * w;
+        @memset(self.buffer.char[fillStart..fillEnd], fill.char);
+        @memset(self.buffer.attributes[fillStart..fillEnd], ansi.TextAttributes.getBaseAttributes(fill.attributes));
+        self.fillColors(fillStart, fillEnd, fill.fg, fill.bg);
+    }
+
     pub fn set(self: *OptimizedBuffer, x: u32, y: u32, cell: Cell) void {
         if (x >= self.width or y >= self.height) return;
         if (!self.isPointInScissor(@intCast(x), @intCast(y))) return;
 
         const index = self.coordsToIndex(x, y);
+        self.markRowDirty(y);
         const prev_char = self.buffer.char[index];
         const prev_attr = self.buffer.attributes[index];
         const prev_link_id = ansi.TextAttributes.getLinkId(prev_attr);
@@ -451,8 +773,7 @@ pub const OptimizedBuffer = struct {
                 }
                 @memset(self.buffer.char[index..end_of_line], @intCast(DEFAULT_SPACE_CHAR));
                 @memset(self.buffer.attributes[index..end_of_line], cell.attributes);
-                @memset(self.buffer.fg[index..end_of_line], cell.fg);
-                @memset(self.buffer.bg[index..end_of_line], cell.bg);
+                self.fillColors(index, end_of_line, cell.fg, cell.bg);
                 const new_link_id = ansi.TextAttributes.getLinkId(cell.attributes);
                 if (new_link_id != 0) {
                     const cells_written = end_of_line - index;
@@ -465,8 +786,7 @@ pub const OptimizedBuffer = struct {
             }
 
             self.buffer.char[index] = cell.char;
-            self.buffer.fg[index] = cell.fg;
-            self.buffer.bg[index] = cell.bg;
+            self.setColorsAt(index, cell.fg, cell.bg);
             self.buffer.attributes[index] = cell.attributes;
 
             const id: u32 = gp.graphemeIdFromChar(cell.char);
@@ -492,8 +812,7 @@ pub const OptimizedBuffer = struct {
                         }
                     }
 
-                    @memset(self.buffer.fg[index + 1 .. index + 1 + max_right], cell.fg);
-                    @memset(self.buffer.bg[index + 1 .. index + 1 + max_right], cell.bg);
+                    self.fillColors(index + 1, index + 1 + max_right, cell.fg, cell.bg);
                     @memset(self.buffer.attributes[index + 1 .. index + 1 + max_right], cell.attributes);
                     var k: u32 = 1;
                     while (k <= max_right) : (k += 1) {
@@ -507,8 +826,7 @@ pub const OptimizedBuffer = struct {
             }
         } else {
             self.buffer.char[index] = cell.char;
-            self.buffer.fg[index] = cell.fg;
-            self.buffer.bg[index] = cell.bg;
+            self.setColorsAt(index, cell.fg, cell.bg);
             self.buffer.attributes[index] = cell.attributes;
 
             const new_link_id = ansi.TextAttributes.getLinkId(cell.attributes);
@@ -527,8 +845,8 @@ pub const OptimizedBuffer = struct {
         const index = self.coordsToIndex(x, y);
         return Cell{
             .char = self.buffer.char[index],
-            .fg = self.buffer.fg[index],
-            .bg = self.buffer.bg[index],
+            .fg = self.getFgAt(index),
+            .bg = self.getBgAt(index),
             .attributes = self.buffer.attributes[index],
         };
     }
@@ -803,24 +1121,53 @@ pub const OptimizedBuffer = struct {
             }
         } else {
             // For non-alpha (fully opaque) backgrounds with no graphemes or links, we can do direct filling
+            self.markRowsDirty(clippedStartY, clippedEndY + 1);
             var fillY = clippedStartY;
             while (fillY <= clippedEndY) : (fillY += 1) {
                 const rowStartIndex = self.coordsToIndex(@intCast(clippedStartX), @intCast(fillY));
                 const rowWidth = clippedEndX - clippedStartX + 1;
 
                 const rowSliceChar = self.buffer.char[rowStartIndex .. rowStartIndex + rowWidth];
-                const rowSliceFg = self.buffer.fg[rowStartIndex .. rowStartIndex + rowWidth];
-                const rowSliceBg = self.buffer.bg[rowStartIndex .. rowStartIndex + rowWidth];
                 const rowSliceAttrs = self.buffer.attributes[rowStartIndex .. rowStartIndex + rowWidth];
 
                 @memset(rowSliceChar, @intCast(DEFAULT_SPACE_CHAR));
-                @memset(rowSliceFg, .{ 1.0, 1.0, 1.0, 1.0 });
-                @memset(rowSliceBg, bg);
+                self.fillColors(rowStartIndex, rowStartIndex + rowWidth, .{ 1.0, 1.0, 1.0, 1.0 }, bg);
                 @memset(rowSliceAttrs, 0);
             }
         }
     }
 
+    /// Reset a rectangle to blank cells of `bg`. Unlike fillRect nothing is
+    /// blended, so a transparent `bg` still replaces what was there. Honors the
+    /// scissor stack.
+    pub fn clearRect(self: *OptimizedBuffer, x: u32, y: u32, width: u32, height: u32, bg: RGBA) void {
+        const endX = @min(self.width, x +| width);
+        const endY = @min(self.height, y +| height);
+        if (x >= endX or y >= endY) return;
+
+        const blank = Cell{ .char = DEFAULT_SPACE_CHAR, .fg = .{ 1.0, 1.0, 1.0, 1.0 }, .bg = bg, .attributes = 0 };
+        if (self.grapheme_tracker.hasAny() or self.link_tracker.hasAny() or self.getCurrentScissorRect() != null) {
+            var cy = y;
+            while (cy < endY) : (cy += 1) {
+                var cx = x;
+                while (cx < endX) : (cx += 1) {
+                    self.set(cx, cy, blank);
+                }
+            }
+            return;
+        }
+
+        self.markRowsDirty(y, endY);
+        var cy = y;
+        while (cy < endY) : (cy += 1) {
+            const rowStart = self.coordsToIndex(x, cy);
+            const rowEnd = rowStart + (endX - x);
+            @memset(self.buffer.char[rowStart..rowEnd], @intCast(DEFAULT_SPACE_CHAR));
+            @memset(self.buffer.attributes[rowStart..rowEnd], 0);
+            self.fillColors(rowStart, rowEnd, blank.fg, bg);
+        }
+    }
+
     pub fn drawText(
         self: *OptimizedBuffer,
         text: []const u8,
@@ -943,6 +1290,31 @@ pub const OptimizedBuffer = struct {
         }
     }
 
+    /// Copy `len` cells of fg/bg from `src`, converting when the storage modes differ
+    fn copyColorsFrom(self: *OptimizedBuffer, src: *const OptimizedBuffer, destStart: usize, srcStart: usize, len: usize) void {
+        if (self.color_storage == src.color_storage) {
+            switch (self.color_storage) {
+                .float32 => {
+                    @memcpy(self.buffer.fg[destStart .. destStart + len], src.buffer.fg[srcStart .. srcStart + len]);
+                    @memcpy(self.buffer.bg[destStart .. destStart + len], src.buffer.bg[srcStart .. srcStart + len]);
+                },
+                .rgba8 => {
+                    @memcpy(self.buffer.fg8[destStart .. destStart + len], src.buffer.fg8[srcStart .. srcStart + len]);
+                    @memcpy(self.buffer.bg8[destStart .. destStart + len], src.buffer.bg8[srcStart .. srcStart + len]);
+                },
+            }
+            return;
+        }
+
+        for (0..len) |i| {
+            self.setColorsAt(destStart + i, src.getFgAt(srcStart + i), src.getBgAt(srcStart + i));
+        }
+    }
+
+    pub fn getColorStorage(self: *const OptimizedBuffer) ColorStorage {
+        return self.color_storage;
+    }
+
     pub fn drawFrameBuffer(self: *OptimizedBuffer, destX: i32, destY: i32, frameBuffer: *OptimizedBuffer, sourceX: ?u32, sourceY: ?u32, sourceWidth: ?u32, sourceHeight: ?u32) void {
         if (self.width == 0 or self.height == 0 or frameBuffer.width == 0 or frameBuffer.height == 0) return;
 
@@ -981,6 +1353,7 @@ pub const OptimizedBuffer = struct {
 
         if (!graphemeAware and !frameBuffer.respectAlpha and !linkAware) {
             // Fast path: direct memory copy
+            self.markRowsDirty(@intCast(clippedStartY), @intCast(clippedEndY + 1));
             var dY = clippedStartY;
 
             while (dY <= clippedEndY) : (dY += 1) {
@@ -999,8 +1372,7 @@ pub const OptimizedBuffer = struct {
                 const actualCopyWidth = @min(@as(u32, @intCast(clippedEndX - clippedStartX + 1)), frameBuffer.width - sX);
 
                 @memcpy(self.buffer.char[destRowStart .. destRowStart + actualCopyWidth], frameBuffer.buffer.char[srcRowStart .. srcRowStart + actualCopyWidth]);
-                @memcpy(self.buffer.fg[destRowStart .. destRowStart + actualCopyWidth], frameBuffer.buffer.fg[srcRowStart .. srcRowStart + actualCopyWidth]);
-                @memcpy(self.buffer.bg[destRowStart .. destRowStart + actualCopyWidth], frameBuffer.buffer.bg[srcRowStart .. srcRowStart + actualCopyWidth]);
+                self.copyColorsFrom(frameBuffer, destRowStart, srcRowStart, actualCopyWidth);
                 @memcpy(self.buffer.attributes[destRowStart .. destRowStart + actualCopyWidth], frameBuffer.buffer.attributes[srcRowStart .. srcRowStart + actualCopyWidth]);
             }
             return;
@@ -1023,8 +1395,8 @@ pub const OptimizedBuffer = struct {
                 if (srcIndex >= frameBuffer.buffer.char.len) continue;
 
                 const srcChar = frameBuffer.buffer.char[srcIndex];
-                const srcFg = frameBuffer.buffer.fg[srcIndex];
-                const srcBg = frameBuffer.buffer.bg[srcIndex];
+                const srcFg = frameBuffer.getFgAt(srcIndex);
+                const srcBg = frameBuffer.getBgAt(srcIndex);
                 const srcAttr = frameBuffer.buffer.attributes[srcIndex];
 
                 if (srcBg[3] == 0.0 and srcFg[3] == 0.0) continue;
@@ -1146,7 +1518,8 @@ pub const OptimizedBuffer = struct {
             for (vline.chunks.items) |vchunk| {
                 const chunk = vchunk.chunk;
                 const chunk_bytes = chunk.getBytes(&text_buffer.mem_registry);
-                const specials = chunk.getGraphemes(&text_buffer.mem_registry, text_buffer.allocator, text_buffer.tab_width, text_buffer.width_method) catch continue;
+                var specials = chunk.getGraphemes(&text_buffer.chunk_cache, &text_buffer.mem_registry, text_buffer.tab_width, text_buffer.width_method) catch continue;
+                var next_special = specials.next();
 
                 if (currentX >= @as(i32, @intCast(self.width))) {
                     globalCharPos += vchunk.width;
@@ -1155,7 +1528,6 @@ pub const OptimizedBuffer = struct {
                 }
                 const col_end = vchunk.grapheme_start + vchunk.width;
                 var col = vchunk.grapheme_start;
-                var special_idx: usize = 0;
                 var byte_offset: u32 = 0;
 
                 if (vchunk.grapheme_start > 0) {
@@ -1164,31 +1536,25 @@ pub const OptimizedBuffer = struct {
                     const pos_result = utf8.findPosByWidth(chunk_bytes, vchunk.grapheme_start, text_buffer.tab_width, is_ascii_only, false, text_buffer.width_method);
                     byte_offset = pos_result.byte_offset;
 
-                    // Advance special_idx to match the skipped columns
-                    var init_col: u32 = 0;
-                    while (init_col < vchunk.grapheme_start and special_idx < specials.len) {
-                        const g = specials[special_idx];
-                        if (g.col_offset < vchunk.grapheme_start) {
-                            special_idx += 1;
-                            init_col = g.col_offset + g.width;
-                        } else {
-                            break;
-                        }
+                    // Advance past the specials in the skipped columns
+                    while (next_special) |g| {
+                        if (g.col_offset >= vchunk.grapheme_start) break;
+                        next_special = specials.next();
                     }
                 }
 
                 while (col < col_end) {
-                    const at_special = special_idx < specials.len and specials[special_idx].col_offset == col;
+                    const at_special = if (next_special) |g| g.col_offset == col else false;
 
                     var grapheme_bytes: []const u8 = undefined;
                     var g_width: u8 = undefined;
 
                     if (at_special) {
-                        const g = specials[special_idx];
+                        const g = next_special.?;
                         grapheme_bytes = chunk_bytes[g.byte_offset .. g.byte_offset + g.byte_len];
                         g_width = g.width;
                         byte_offset = g.byte_offset + g.byte_len;
-                        special_idx += 1;
+                        next_special = specials.next();
                     } else {
                         if (byte_offset >= chunk_bytes.len) break;
                         // Read the next UTF-8 grapheme properly
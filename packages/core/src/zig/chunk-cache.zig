@@ -0,0 +1,308 @@
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const utf8 = @import("utf8.zig");
+const mem_registry_mod = @import("mem-registry.zig");
+
+const MemRegistry = mem_registry_mod.MemRegistry;
+const MemId = mem_registry_mod.MemId;
+const GraphemeInfo = utf8.GraphemeInfo;
+const WrapBreak = utf8.WrapBreak;
+
+/// Identifies a chunk by the bytes it covers rather than by the chunk value,
+/// so the copies rope edits make of a chunk share one cache entry
+pub const ChunkKey = struct {
+    mem_id: MemId,
+    byte_start: u32,
+    byte_end: u32,
+};
+
+const Entry = struct {
+    data: []u8,
+    /// MemRegistry generation of the slot when encoded; a mismatch means the
+    /// bytes behind the key changed
+    generation: u32,
+    last_used: u64,
+};
+
+const ENTRY_OVERHEAD = @sizeOf(ChunkKey) + @sizeOf(Entry);
+
+// Grapheme record tag byte: bits 0-4 byte length (0 = explicit byte follows),
+// bit 5 set when the grapheme starts where the previous one ended, bits 6-7
+// width (3 = explicit byte follows). A run of CJK costs one byte per grapheme.
+const TAG_LEN_MASK: u8 = 0x1F;
+const TAG_ADJACENT: u8 = 0x20;
+const TAG_WIDTH_SHIFT = 6;
+const TAG_WIDTH_ESCAPE: u8 = 3;
+
+fn appendVarint(list: *std.ArrayListUnmanaged(u8), allocator: Allocator, value: u32) !void {
+    var v = value;
+    while (v >= 0x80) : (v >>= 7) {
+        try list.append(allocator, @as(u8, @truncate(v)) | 0x80);
+    }
+    try list.append(allocator, @truncate(v));
+}
+
+fn readVarint(data: []const u8, pos: *usize) u32 {
+    var value: u32 = 0;
+    var shift: u5 = 0;
+    while (true) {
+        const b = data[pos.*];
+        pos.* += 1;
+        value |= @as(u32, b & 0x7F) << shift;
+        if (b < 0x80) return value;
+        shift += 7;
+    }
+}
+
+/// Decodes a chunk's cached special graphemes in order
+pub const GraphemeIterator = struct {
+    data: []const u8,
+    pos: usize = 0,
+    byte_end: u32 = 0,
+    col_end: u32 = 0,
+
+    pub const empty: GraphemeIterator = .{ .data = &.{} };
+
+    pub fn next(self: *GraphemeIterator) ?GraphemeInfo {
+        if (self.pos >= self.data.len) return null;
+        const tag = self.data[self.pos];
+        self.pos += 1;
+
+        var byte_len: u8 = tag & TAG_LEN_MASK;
+        if (byte_len == 0) {
+            byte_len = self.data[self.pos];
+            self.pos += 1;
+        }
+        var width: u8 = tag >> TAG_WIDTH_SHIFT;
+        if (width == TAG_WIDTH_ESCAPE) {
+            width = self.data[self.pos];
+            self.pos += 1;
+        }
+
+        var byte_offset = self.byte_end;
+        var col_offset = self.col_end;
+        if (tag & TAG_ADJACENT == 0) {
+            byte_offset += readVarint(self.data, &self.pos);
+            col_offset += readVarint(self.data, &self.pos);
+        }
+
+        self.byte_end = byte_offset + byte_len;
+        self.col_end = col_offset + width;
+        return .{ .byte_offset = byte_offset, .byte_len = byte_len, .width = width, .col_offset = col_offset };
+    }
+};
+
+/// Decodes a chunk's cached wrap breaks in order
+pub const WrapBreakIterator = struct {
+    data: []const u8,
+    pos: usize = 0,
+    byte_offset: u32 = 0,
+    char_offset: u32 = 0,
+
+    pub const empty: WrapBreakIterator = .{ .data = &.{} };
+
+    pub fn next(self: *WrapBreakIterator) ?WrapBreak {
+        if (self.pos >= self.data.len) return null;
+        self.byte_offset += readVarint(self.data, &self.pos);
+        self.char_offset += readVarint(self.data, &self.pos);
+        return .{ .byte_offset = self.byte_offset, .char_offset = self.char_offset };
+    }
+};
+
+/// Side table of per-chunk grapheme and wrap-break metadata, delta-encoded.
+/// Entries are validated against the MemRegistry slot generation, and once
+/// `max_bytes` is exceeded the least recently used entries are evicted, which
+/// drops chunks that have not been drawn or wrapped in a while.
+pub const ChunkCache = struct {
+    allocator: Allocator,
+    graphemes: std.AutoHashMapUnmanaged(ChunkKey, Entry),
+    wrap_breaks: std.AutoHashMapUnmanaged(ChunkKey, Entry),
+    scratch: std.ArrayListUnmanaged(u8),
+    bytes: usize,
+    max_bytes: ?usize,
+    clock: u64,
+
+    pub fn init(allocator: Allocator) ChunkCache {
+        return .{
+            .allocator = allocator,
+            .graphemes = .{},
+            .wrap_breaks = .{},
+            .scratch = .{},
+            .bytes = 0,
+            .max_bytes = null,
+            .clock = 0,
+        };
+    }
+
+    pub fn deinit(self: *ChunkCache) void {
+        self.clear();
+        self.graphemes.deinit(self.allocator);
+        self.wrap_breaks.deinit(self.allocator);
+        self.scratch.deinit(self.allocator);
+    }
+
+    pub fn clear(self: *ChunkCache) void {
+        freeEntries(self.allocator, &self.graphemes);
+        freeEntries(self.allocator, &self.wrap_breaks);
+        self.bytes = 0;
+    }
+
+    /// Grapheme columns depend on the tab width; wrap breaks do not
+    pub fn clearGraphemes(self: *ChunkCache) void {
+        var it = self.graphemes.valueIterator();
+        while (it.next()) |entry| self.bytes -= entry.data.len + ENTRY_OVERHEAD;
+        freeEntries(self.allocator, &self.graphemes);
+    }
+
+    fn freeEntries(allocator: Allocator, map: *std.AutoHashMapUnmanaged(ChunkKey, Entry)) void {
+        var it = map.valueIterator();
+        while (it.next()) |entry| allocator.free(entry.data);
+        map.clearRetainingCapacity();
+    }
+
+    /// Bytes held by cached entries, including per-entry bookkeeping
+    pub fn getBytes(self: *const ChunkCache) usize {
+        return self.bytes;
+    }
+
+    /// Cap the cache; null keeps every entry until the buffer changes
+    pub fn setMaxBytes(self: *ChunkCache, max_bytes: ?usize) void {
+        self.max_bytes = max_bytes;
+        self.evict();
+    }
+
+    /// Drop entries whose mem slot was released or rewritten
+    pub fn dropStale(self: *ChunkCache, registry: *const MemRegistry) void {
+        for ([_]*std.AutoHashMapUnmanaged(ChunkKey, Entry){ &self.graphemes, &self.wrap_breaks }) |map| {
+            var it = map.iterator();
+            while (it.next()) |kv| {
+                const key = kv.key_ptr.*;
+                if (registry.get(key.mem_id) != null and registry.getGeneration(key.mem_id) == kv.value_ptr.generation) continue;
+                self.bytes -= kv.value_ptr.data.len + ENTRY_OVERHEAD;
+                self.allocator.free(kv.value_ptr.data);
+                // Removal only tombstones the slot, so the iterator stays valid
+                map.removeByPtr(kv.key_ptr);
+            }
+        }
+    }
+
+    fn lookup(self: *ChunkCache, map: *std.AutoHashMapUnmanaged(ChunkKey, Entry), key: ChunkKey, generation: u32) ?[]const u8 {
+        const entry = map.getPtr(key) orelse return null;
+        if (entry.generation != generation) return null;
+        self.clock += 1;
+        entry.last_used = self.clock;
+        return entry.data;
+    }
+
+    fn store(self: *ChunkCache, map: *std.AutoHashMapUnmanaged(ChunkKey, Entry), key: ChunkKey, generation: u32) ![]const u8 {
+        // Evict first so the entry handed back is never the one evicted
+        self.evict();
+
+        const data = try self.allocator.dupe(u8, self.scratch.items);
+        errdefer self.allocator.free(data);
+
+        const gop = try map.getOrPut(self.allocator, key);
+        if (gop.found_existing) {
+            self.bytes -= gop.value_ptr.data.len;
+            self.allocator.free(gop.value_ptr.data);
+        } else {
+            self.bytes += ENTRY_OVERHEAD;
+        }
+        self.clock += 1;
+        gop.value_ptr.* = .{ .data = data, .generation = generation, .last_used = self.clock };
+        self.bytes += data.len;
+        return data;
+    }
+
+    pub fn getGraphemes(self: *ChunkCache, key: ChunkKey, generation: u32) ?GraphemeIterator {
+        const data = self.lookup(&self.graphemes, key, generation) orelse return null;
+        return .{ .data = data };
+    }
+
+    pub fn putGraphemes(self: *ChunkCache, key: ChunkKey, generation: u32, graphemes: []const GraphemeInfo) !GraphemeIterator {
+        self.scratch.clearRetainingCapacity();
+        var byte_end: u32 = 0;
+        var col_end: u32 = 0;
+        for (graphemes) |g| {
+            const adjacent = g.byte_offset == byte_end and g.col_offset == col_end;
+            var tag: u8 = if (adjacent) TAG_ADJACENT else 0;
+            if (g.byte_len <= TAG_LEN_MASK) tag |= g.byte_len;
+            const width_bits: u8 = @min(g.width, TAG_WIDTH_ESCAPE);
+            tag |= width_bits << TAG_WIDTH_SHIFT;
+
+            try self.scratch.append(self.allocator, tag);
+            if (g.byte_len > TAG_LEN_MASK) try self.scratch.append(self.allocator, g.byte_len);
+            if (g.width >= TAG_WIDTH_ESCAPE) try self.scratch.append(self.allocator, g.width);
+            if (!adjacent) {
+                try appendVarint(&self.scratch, self.allocator, g.byte_offset - byte_end);
+                try appendVarint(&self.scratch, self.allocator, g.col_offset - col_end);
+            }
+
+            byte_end = g.byte_offset + g.byte_len;
+            col_end = g.col_offset + g.width;
+        }
+        return .{ .data = try self.store(&self.graphemes, key, generation) };
+    }
+
+    pub fn getWrapBreaks(self: *ChunkCache, key: ChunkKey, generation: u32) ?WrapBreakIterator {
+        const data = self.lookup(&self.wrap_breaks, key, generation) orelse return null;
+        return .{ .data = data };
+    }
+
+    pub fn putWrapBreaks(self: *ChunkCache, key: ChunkKey, generation: u32, breaks: []const WrapBreak) !WrapBreakIterator {
+        self.scratch.clearRetainingCapacity();
+        var byte_offset: u32 = 0;
+        var char_offset: u32 = 0;
+        for (breaks) |b| {
+            try appendVarint(&self.scratch, self.allocator, b.byte_offset - byte_offset);
+            try appendVarint(&self.scratch, self.allocator, b.char_offset - char_offset);
+            byte_offset = b.byte_offset;
+            char_offset = b.char_offset;
+        }
+        return .{ .data = try self.store(&self.wrap_breaks, key, generation) };
+    }
+
+    /// Evict least recently used entries down to 3/4 of the budget, so steady
+    /// scrolling does not evict on every insert. Best effort: gives up quietly
+    /// if it cannot allocate its working list.
+    fn evict(self: *ChunkCache) void {
+        const max_bytes = self.max_bytes orelse return;
+        if (self.bytes <= max_bytes) return;
+        const target = max_bytes / 4 * 3;
+
+        const Use = struct { last_used: u64, size: usize };
+        var uses: std.ArrayListUnmanaged(Use) = .{};
+        defer uses.deinit(self.allocator);
+        uses.ensureTotalCapacity(self.allocator, self.graphemes.count() + self.wrap_breaks.count()) catch return;
+
+        for ([_]*std.AutoHashMapUnmanaged(ChunkKey, Entry){ &self.graphemes, &self.wrap_breaks }) |map| {
+            var it = map.valueIterator();
+            while (it.next()) |entry| {
+                uses.appendAssumeCapacity(.{ .last_used = entry.last_used, .size = entry.data.len + ENTRY_OVERHEAD });
+            }
+        }
+        std.mem.sort(Use, uses.items, {}, struct {
+            fn lessThan(_: void, a: Use, b: Use) bool {
+                return a.last_used < b.last_used;
+            }
+        }.lessThan);
+
+        var remaining = self.bytes;
+        var cutoff: u64 = 0;
+        for (uses.items) |use| {
+            if (remaining <= target) break;
+            remaining -= use.size;
+            cutoff = use.last_used;
+        }
+
+        for ([_]*std.AutoHashMapUnmanaged(ChunkKey, Entry){ &self.graphemes, &self.wrap_breaks }) |map| {
+            var it = map.iterator();
+            while (it.next()) |kv| {
+                if (kv.value_ptr.last_used > cutoff) continue;
+                self.bytes -= kv.value_ptr.data.len + ENTRY_OVERHEAD;
+                self.allocator.free(kv.value_ptr.data);
+                map.removeByPtr(kv.key_ptr);
+            }
+        }
+    }
+};
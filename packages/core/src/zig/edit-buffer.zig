@@ -11,6 +11,7 @@ const event_bus = @import("event-bus.zig");
 
 const UnifiedTextBuffer = tb.UnifiedTextBuffer;
 const TextChunk = seg_mod.TextChunk;
+const MemId = tb.MemId;
 const Segment = seg_mod.Segment;
 const UnifiedRope = seg_mod.UnifiedRope;
 
@@ -36,7 +37,7 @@ pub const Cursor = struct {
 const CursorCoords = struct { row: u32, col: u32 };
 
 const AddBuffer = struct {
-    mem_id: u8,
+    mem_id: MemId,
     ptr: [*]u8,
     len: usize,
     cap: usize,
@@ -58,17 +59,22 @@ const AddBuffer = struct {
     fn ensureCapacity(self: *AddBuffer, text_buffer: *UnifiedTextBuffer, need: usize) !void {
         if (self.len + need <= self.cap) return;
 
-        // TODO: Create a new buffer, register the new buffer and use the new mem_id for subsequent inserts
+        // Inserts already made keep pointing into the old buffer, so it is retired
+        // rather than freed: the registry releases it once no segment refers to it.
         const new_cap = @max(self.cap * 2, self.len + need);
         const new_mem = try self.allocator.alloc(u8, new_cap);
-        const new_mem_id = try text_buffer.registerMemBuffer(new_mem, true);
+        const new_mem_id = text_buffer.registerMemBuffer(new_mem, true) catch |err| {
+            self.allocator.free(new_mem);
+            return err;
+        };
+        text_buffer.mem_registry.markReclaimable(self.mem_id) catch {};
         self.mem_id = new_mem_id;
         self.ptr = new_mem.ptr;
         self.len = 0;
         self.cap = new_mem.len;
     }
 
-    fn append(self: *AddBuffer, bytes: []const u8) struct { mem_id: u8, start: u32, end: u32 } {
+    fn append(self: *AddBuffer, bytes: []const u8) struct { mem_id: MemId, start: u32, end: u32 } {
         std.debug.assert(self.len + bytes.len <= self.cap);
         const start: u32 = @intCast(self.len);
 
@@ -161,7 +167,46 @@ pub const EditBuffer = struct {
         return self.cursors.items[0];
     }
 
+    pub fn getCursorCount(self: *const EditBuffer) usize {
+        return self.cursors.items.len;
+    }
+
     pub fn setCursor(self: *EditBuffer, row: u32, col: u32) !void {
+        const cursor = self.clampCursor(row, col);
+
+        if (self.cursors.items.len == 0) {
+            try self.cursors.append(self.allocator, cursor);
+        } else {
+            self.cursors.items[0] = cursor;
+        }
+
+        self.events.emit(.cursorChanged);
+        self.emitNativeEvent("cursor-changed");
+    }
+
+    /// Adds a secondary cursor. Inserts and deletes then apply at every cursor;
+    /// a cursor landing on an existing one is dropped.
+    pub fn addCursor(self: *EditBuffer, row: u32, col: u32) !void {
+        const cursor = self.clampCursor(row, col);
+        for (self.cursors.items) |existing| {
+            if (existing.row == cursor.row and existing.col == cursor.col) return;
+        }
+        try self.cursors.append(self.allocator, cursor);
+
+        self.events.emit(.cursorChanged);
+        self.emitNativeEvent("cursor-changed");
+    }
+
+    /// Drops every cursor but the primary one
+    pub fn clearExtraCursors(self: *EditBuffer) void {
+        if (self.cursors.items.len <= 1) return;
+        self.cursors.shrinkRetainingCapacity(1);
+
+        self.events.emit(.cursorChanged);
+        self.emitNativeEvent("cursor-changed");
+    }
+
+    fn clampCursor(self: *EditBuffer, row: u32, col: u32) Cursor {
         const line_count = self.tb.lineCount();
         const clamped_row = @min(row, line_count -| 1);
 
@@ -169,15 +214,12 @@ pub const EditBuffer = struct {
         const clamped_col = @min(col, line_width);
 
         const offset = iter_mod.coordsToOffset(&self.tb.rope, clamped_row, clamped_col) orelse 0;
+        return .{ .row = clamped_row, .col = clamped_col, .desired_col = clamped_col, .offset = offset };
+    }
 
-        if (self.cursors.items.len == 0) {
-            try self.cursors.append(self.allocator, .{ .row = clamped_row, .col = clamped_col, .desired_col = clamped_col, .offset = offset });
-        } else {
-            self.cursors.items[0] = .{ .row = clamped_row, .col = clamped_col, .desired_col = clamped_col, .offset = offset };
-        }
-
-        self.events.emit(.cursorChanged);
-        self.emitNativeEvent("cursor-changed");
+    fn cursorAtOffset(self: *EditBuffer, offset: u32) Cursor {
+        const coords = iter_mod.offsetToCoords(&self.tb.rope, offset) orelse iter_mod.Coords{ .row = 0, .col = 0 };
+        return .{ .row = coords.row, .col = coords.col, .desired_col = coords.col, .offset = offset };
     }
 
     pub fn setCursorByOffset(self: *EditBuffer, offset: u32) !void {
@@ -256,6 +298,7 @@ pub const EditBuffer = struct {
     pub fn insertText(self: *EditBuffer, bytes: []const u8) !void {
         if (bytes.len == 0) return;
         if (self.cursors.items.len == 0) return;
+        if (self.cursors.items.len > 1) return self.insertTextAtCursors(bytes);
 
         try self.autoStoreUndo();
 
@@ -310,7 +353,8 @@ pub const EditBuffer = struct {
             };
         }
 
-        self.tb.markViewsDirty();
+        const inserted_lines: u32 = @intCast(num_breaks);
+        self.tb.markLinesDirty(cursor.row, cursor.row + 1, cursor.row + 1 + inserted_lines);
         self.events.emit(.cursorChanged);
         self.emitNativeEvent("cursor-changed");
         self.emitNativeEvent("content-changed");
@@ -336,7 +380,7 @@ pub const EditBuffer = struct {
 
         try self.tb.rope.deleteRangeByWeight(start_offset, end_offset, &self.segment_splitter);
 
-        self.tb.markViewsDirty();
+        self.tb.markLinesDirty(start.row, end.row + 1, start.row + 1);
 
         if (self.cursors.items.len > 0) {
             const line_count = self.tb.lineCount();
@@ -355,6 +399,7 @@ pub const EditBuffer = struct {
 
     pub fn backspace(self: *EditBuffer) !void {
         if (self.cursors.items.len == 0) return;
+        if (self.cursors.items.len > 1) return self.deleteAtCursors(.backward);
         const cursor = self.cursors.items[0];
 
         if (cursor.row == 0 and cursor.col == 0) return;
@@ -383,6 +428,7 @@ pub const EditBuffer = struct {
 
     pub fn deleteForward(self: *EditBuffer) !void {
         if (self.cursors.items.len == 0) return;
+        if (self.cursors.items.len > 1) return self.deleteAtCursors(.forward);
         const cursor = self.cursors.items[0];
 
         try self.autoStoreUndo();
@@ -408,6 +454,206 @@ pub const EditBuffer = struct {
         }
     }
 
+    /// Inserts `bytes` at every cursor as one undo step. The text goes into the
+    /// add buffer once and every insert reuses its segments; inserts run back
+    /// to front so the offsets of the cursors still to go stay valid.
+    fn insertTextAtCursors(self: *EditBuffer, bytes: []const u8) !void {
+        const order = try self.sortedCursorOrder();
+        defer self.allocator.free(order);
+
+        try self.autoStoreUndo();
+        try self.ensureAddCapacity(bytes.len);
+
+        const chunk_ref = self.add_buffer.append(bytes);
+        var result = try self.tb.textToSegments(self.allocator, bytes, chunk_ref.mem_id, chunk_ref.start, false);
+        defer result.segments.deinit(result.allocator);
+        if (result.segments.items.len == 0) return;
+
+        var num_breaks: u32 = 0;
+        var inserted_weight: u32 = 0;
+        for (result.segments.items) |seg| {
+            if (seg.isBreak()) {
+                num_breaks += 1;
+                inserted_weight += 1;
+            } else if (seg.asText()) |chunk| {
+                inserted_weight += chunk.width;
+            }
+        }
+
+        const edits = try self.allocator.alloc(tb.DirtyLineRange, order.len);
+        defer self.allocator.free(edits);
+
+        for (edits, 0..) |*edit, i| {
+            const cursor = self.cursors.items[order[order.len - 1 - i]];
+            try self.tb.rope.insertSliceByWeight(cursor.offset, result.segments.items, &self.segment_splitter);
+            edit.* = .{ .start = cursor.row, .end = cursor.row + 1 + num_breaks, .line_delta = @intCast(num_breaks) };
+        }
+
+        // Each cursor moves past its own insert and every insert before it
+        for (order, 1..) |idx, inserts_up_to| {
+            const offset = self.cursors.items[idx].offset + inserted_weight * @as(u32, @intCast(inserts_up_to));
+            self.cursors.items[idx] = self.cursorAtOffset(offset);
+        }
+
+        self.tb.markLineEditsDirty(edits);
+        self.events.emit(.cursorChanged);
+        self.emitNativeEvent("cursor-changed");
+        self.emitNativeEvent("content-changed");
+    }
+
+    const DeleteDirection = enum { backward, forward };
+
+    /// Weight range removed by one cursor's delete and the rows it spans
+    const DeleteSpan = struct { start: u32, end: u32, start_row: u32, end_row: u32 };
+
+    /// Backspace or delete-forward at every cursor as one undo step. Spans of
+    /// neighbouring cursors that touch are merged so no text is removed twice.
+    fn deleteAtCursors(self: *EditBuffer, direction: DeleteDirection) !void {
+        const order = try self.sortedCursorOrder();
+        defer self.allocator.free(order);
+
+        var spans: std.ArrayListUnmanaged(DeleteSpan) = .{};
+        defer spans.deinit(self.allocator);
+        try spans.ensureTotalCapacity(self.allocator, order.len);
+
+        for (order) |idx| {
+            const cursor = self.cursors.items[idx];
+            const span = switch (direction) {
+                .backward => self.backspaceSpan(cursor),
+                .forward => self.deleteForwardSpan(cursor),
+            } orelse continue;
+
+            if (spans.items.len > 0) {
+                const last = &spans.items[spans.items.len - 1];
+                if (span.start <= last.end) {
+                    last.end = @max(last.end, span.end);
+                    last.end_row = @max(last.end_row, span.end_row);
+                    continue;
+                }
+            }
+            spans.appendAssumeCapacity(span);
+        }
+        if (spans.items.len == 0) return;
+
+        try self.autoStoreUndo();
+
+        const edits = try self.allocator.alloc(tb.DirtyLineRange, spans.items.len);
+        defer self.allocator.free(edits);
+
+        for (edits, 0..) |*edit, i| {
+            const span = spans.items[spans.items.len - 1 - i];
+            try self.tb.rope.deleteRangeByWeight(span.start, span.end, &self.segment_splitter);
+            edit.* = .{
+                .start = span.start_row,
+                .end = span.start_row + 1,
+                .line_delta = -@as(i32, @intCast(span.end_row - span.start_row)),
+            };
+        }
+
+        // One ascending pass maps every cursor through the removed spans
+        var removed: u32 = 0;
+        var next_span: usize = 0;
+        for (order) |idx| {
+            const offset = self.cursors.items[idx].offset;
+            while (next_span < spans.items.len and spans.items[next_span].end <= offset) : (next_span += 1) {
+                removed += spans.items[next_span].end - spans.items[next_span].start;
+            }
+            const kept = if (next_span < spans.items.len and spans.items[next_span].start < offset)
+                spans.items[next_span].start
+            else
+                offset;
+            self.cursors.items[idx] = self.cursorAtOffset(kept - removed);
+        }
+
+        // Cursors whose spans merged now share a position
+        self.sortCursorIndices(order);
+        _ = try self.dropDuplicateCursors(order);
+
+        self.tb.markLineEditsDirty(edits);
+        self.events.emit(.cursorChanged);
+        self.emitNativeEvent("cursor-changed");
+        self.emitNativeEvent("content-changed");
+    }
+
+    fn backspaceSpan(self: *EditBuffer, cursor: Cursor) ?DeleteSpan {
+        if (cursor.col == 0) {
+            if (cursor.row == 0) return null;
+            return .{ .start = cursor.offset - 1, .end = cursor.offset, .start_row = cursor.row - 1, .end_row = cursor.row };
+        }
+
+        const width = iter_mod.getPrevGraphemeWidth(&self.tb.rope, &self.tb.mem_registry, cursor.row, cursor.col, self.tb.tab_width, self.tb.width_method);
+        if (width == 0) return null;
+        return .{ .start = cursor.offset - width, .end = cursor.offset, .start_row = cursor.row, .end_row = cursor.row };
+    }
+
+    fn deleteForwardSpan(self: *EditBuffer, cursor: Cursor) ?DeleteSpan {
+        const line_width = iter_mod.lineWidthAt(&self.tb.rope, cursor.row);
+        if (cursor.col >= line_width) {
+            if (cursor.row + 1 >= self.tb.lineCount()) return null;
+            return .{ .start = cursor.offset, .end = cursor.offset + 1, .start_row = cursor.row, .end_row = cursor.row + 1 };
+        }
+
+        const width = iter_mod.getGraphemeWidthAt(&self.tb.rope, &self.tb.mem_registry, cursor.row, cursor.col, self.tb.tab_width, self.tb.width_method);
+        if (width == 0) return null;
+        return .{ .start = cursor.offset, .end = cursor.offset + width, .start_row = cursor.row, .end_row = cursor.row };
+    }
+
+    /// Re-clamps every cursor to the text, drops duplicates and returns the
+    /// cursor indices in offset order. Caller owns the returned slice.
+    fn sortedCursorOrder(self: *EditBuffer) ![]u32 {
+        for (self.cursors.items) |*cursor| {
+            cursor.* = self.clampCursor(cursor.row, cursor.col);
+        }
+
+        var order = try self.allocator.alloc(u32, self.cursors.items.len);
+        errdefer self.allocator.free(order);
+        self.sortCursorIndices(order);
+
+        if (try self.dropDuplicateCursors(order)) {
+            order = try self.allocator.realloc(order, self.cursors.items.len);
+            self.sortCursorIndices(order);
+        }
+        return order;
+    }
+
+    fn sortCursorIndices(self: *const EditBuffer, order: []u32) void {
+        for (order, 0..) |*idx, i| idx.* = @intCast(i);
+        std.mem.sort(u32, order, @as([]const Cursor, self.cursors.items), cursorIndexLessThan);
+    }
+
+    fn cursorIndexLessThan(cursors: []const Cursor, a: u32, b: u32) bool {
+        if (cursors[a].offset != cursors[b].offset) return cursors[a].offset < cursors[b].offset;
+        return a < b;
+    }
+
+    /// Removes cursors sharing an offset with a lower-indexed one, so the
+    /// primary cursor always survives. `order` must come from sortCursorIndices.
+    fn dropDuplicateCursors(self: *EditBuffer, order: []const u32) !bool {
+        if (order.len < 2) return false;
+
+        const dropped = try self.allocator.alloc(bool, self.cursors.items.len);
+        defer self.allocator.free(dropped);
+        @memset(dropped, false);
+
+        var any = false;
+        for (order[1..], order[0 .. order.len - 1]) |idx, prev| {
+            if (self.cursors.items[idx].offset == self.cursors.items[prev].offset) {
+                dropped[idx] = true;
+                any = true;
+            }
+        }
+        if (!any) return false;
+
+        var kept: usize = 0;
+        for (self.cursors.items, dropped) |cursor, drop| {
+            if (drop) continue;
+            self.cursors.items[kept] = cursor;
+            kept += 1;
+        }
+        self.cursors.shrinkRetainingCapacity(kept);
+        return true;
+    }
+
     pub fn moveLeft(self: *EditBuffer) void {
         if (self.cursors.items.len == 0) {
             return;
@@ -496,14 +742,19 @@ pub const EditBuffer = struct {
     /// Set text and completely reset the buffer state (clears history, resets add_buffer)
     pub fn setText(self: *EditBuffer, text: []const u8) !void {
         const owned_text = try self.allocator.dupe(u8, text);
-        const mem_id = try self.tb.registerMemBuffer(owned_text, true);
+        const mem_id = self.tb.registerReclaimable(owned_text, true) catch |err| {
+            self.allocator.free(owned_text);
+            return err;
+        };
         try self.setTextFromMemId(mem_id);
     }
 
     /// Set text from memory ID and completely reset the buffer state (clears history, resets add_buffer)
-    pub fn setTextFromMemId(self: *EditBuffer, mem_id: u8) !void {
+    pub fn setTextFromMemId(self: *EditBuffer, mem_id: MemId) !void {
         self.tb.rope.clear_history();
         self.add_buffer.len = 0;
+        // The add buffer's bytes get rewritten from the start; drop cached chunk metadata
+        self.tb.mem_registry.touch(self.add_buffer.mem_id);
 
         try self.tb.setTextFromMemId(mem_id);
         try self.setCursor(0, 0);
@@ -514,12 +765,15 @@ pub const EditBuffer = struct {
     /// Replace text while preserving undo history (creates an undo point)
     pub fn replaceText(self: *EditBuffer, text: []const u8) !void {
         const owned_text = try self.allocator.dupe(u8, text);
-        const mem_id = try self.tb.registerMemBuffer(owned_text, true);
+        const mem_id = self.tb.registerReclaimable(owned_text, true) catch |err| {
+            self.allocator.free(owned_text);
+            return err;
+        };
         try self.replaceTextFromMemId(mem_id);
     }
 
     /// Replace text from memory ID while preserving undo history (creates an undo point)
-    pub fn replaceTextFromMemId(self: *EditBuffer, mem_id: u8) !void {
+    pub fn replaceTextFromMemId(self: *EditBuffer, mem_id: MemId) !void {
         try self.autoStoreUndo();
 
         try self.tb.setTextFromMemId(mem_id);
@@ -552,8 +806,6 @@ pub const EditBuffer = struct {
                 .{ .row = cursor.row, .col = curr_line_width },
             );
 
-            self.tb.markViewsDirty();
-
             const new_row = cursor.row - 1;
             const new_col = prev_line_width;
             const new_offset = iter_mod.coordsToOffset(&self.tb.rope, new_row, new_col) orelse 0;
@@ -667,7 +919,7 @@ pub const EditBuffer = struct {
 
                 // Check this chunk if cursor is within it OR if we've already passed the cursor
                 if (cursor.col < next_cols or passed_cursor) {
-                    const wrap_offsets = chunk.getWrapOffsets(&self.tb.mem_registry, self.tb.allocator, self.tb.width_method) catch {
+                    var wrap_offsets = chunk.getWrapOffsets(&self.tb.chunk_cache, &self.tb.mem_registry, self.tb.width_method) catch {
                         cols_before = next_cols;
                         passed_cursor = true;
                         continue;
@@ -676,7 +928,7 @@ pub const EditBuffer = struct {
                     // For chunks containing or after the cursor, find the first break after cursor position
                     const local_cursor_col = if (cursor.col > cols_before) cursor.col - cols_before else 0;
 
-                    for (wrap_offsets) |wrap_break| {
+                    while (wrap_offsets.next()) |wrap_break| {
                         const break_col = @as(u32, wrap_break.char_offset);
                         // If we've passed the cursor chunk, any break is valid
                         // If we're in the cursor chunk, break must be after cursor position
@@ -722,12 +974,12 @@ pub const EditBuffer = struct {
             if (seg.asText()) |chunk| {
                 const next_cols = cols_before + chunk.width;
 
-                const wrap_offsets = chunk.getWrapOffsets(&self.tb.mem_registry, self.tb.allocator, self.tb.width_method) catch {
+                var wrap_offsets = chunk.getWrapOffsets(&self.tb.chunk_cache, &self.tb.mem_registry, self.tb.width_method) catch {
                     cols_before = next_cols;
                     continue;
                 };
 
-                for (wrap_offsets) |wrap_break| {
+                while (wrap_offsets.next()) |wrap_break| {
                     const break_col = cols_before + @as(u32, wrap_break.char_offset) + 1;
                     if (break_col < cursor.col) {
                         last_boundary = break_col;
@@ -0,0 +1,313 @@
+const std = @import("std");
+const Allocator = std.mem.Allocator;
+const seg_mod = @import("text-buffer-segment.zig");
+
+const Highlight = seg_mod.Highlight;
+const StyleSpan = seg_mod.StyleSpan;
+
+const NONE: u32 = std.math.maxInt(u32);
+
+/// Highlights and style spans of one line
+pub const LineEntry = struct {
+    line: u32,
+    /// Line shift not yet applied to this node and its subtree
+    shift: i32 = 0,
+    priority: u32,
+    left: u32 = NONE,
+    right: u32 = NONE,
+    parent: u32 = NONE,
+    highlights: std.ArrayListUnmanaged(Highlight) = .{},
+    spans: std.ArrayListUnmanaged(StyleSpan) = .{},
+};
+
+/// Per-line highlights for the lines that have any, kept in a treap ordered
+/// by line. Inserting or deleting lines shifts every later line with one lazy
+/// tag, so edits near the top of a large file cost O(log n) instead of moving
+/// every line's lists. Lines are found in O(log n), and `hl_ref` maps to the
+/// lines holding highlights with that ref so removal skips the others.
+pub const HighlightIndex = struct {
+    allocator: Allocator,
+    nodes: std.ArrayListUnmanaged(LineEntry),
+    free_nodes: std.ArrayListUnmanaged(u32),
+    root: u32,
+    /// hl_ref -> node -> number of that node's highlights with the ref
+    by_ref: std.AutoHashMapUnmanaged(u16, std.AutoHashMapUnmanaged(u32, u32)),
+    highlight_count: u32,
+    prng: std.Random.DefaultPrng,
+
+    pub fn init(allocator: Allocator) HighlightIndex {
+        return .{
+            .allocator = allocator,
+            .nodes = .{},
+            .free_nodes = .{},
+            .root = NONE,
+            .by_ref = .{},
+            .highlight_count = 0,
+            .prng = std.Random.DefaultPrng.init(0x9E3779B97F4A7C15),
+        };
+    }
+
+    pub fn deinit(self: *HighlightIndex) void {
+        for (self.nodes.items) |*node| {
+            node.highlights.deinit(self.allocator);
+            node.spans.deinit(self.allocator);
+        }
+        self.nodes.deinit(self.allocator);
+        self.free_nodes.deinit(self.allocator);
+        var it = self.by_ref.valueIterator();
+        while (it.next()) |nodes| nodes.deinit(self.allocator);
+        self.by_ref.deinit(self.allocator);
+    }
+
+    /// Drop every highlight
+    pub fn clear(self: *HighlightIndex) void {
+        for (self.nodes.items) |*node| {
+            node.highlights.deinit(self.allocator);
+            node.spans.deinit(self.allocator);
+        }
+        self.nodes.clearRetainingCapacity();
+        self.free_nodes.clearRetainingCapacity();
+        self.root = NONE;
+        var it = self.by_ref.valueIterator();
+        while (it.next()) |nodes| nodes.deinit(self.allocator);
+        self.by_ref.clearRetainingCapacity();
+        self.highlight_count = 0;
+    }
+
+    pub fn getHighlightCount(self: *const HighlightIndex) u32 {
+        return self.highlight_count;
+    }
+
+    pub fn get(self: *const HighlightIndex, line: u32) ?*const LineEntry {
+        const idx = self.find(line);
+        if (idx == NONE) return null;
+        return &self.nodes.items[idx];
+    }
+
+    pub fn getMut(self: *HighlightIndex, line: u32) ?*LineEntry {
+        const idx = self.find(line);
+        if (idx == NONE) return null;
+        return &self.nodes.items[idx];
+    }
+
+    pub fn getHighlights(self: *const HighlightIndex, line: u32) []const Highlight {
+        const entry = self.get(line) orelse return &[_]Highlight{};
+        return entry.highlights.items;
+    }
+
+    pub fn getSpans(self: *const HighlightIndex, line: u32) []const StyleSpan {
+        const entry = self.get(line) orelse return &[_]StyleSpan{};
+        return entry.spans.items;
+    }
+
+    pub fn add(self: *HighlightIndex, line: u32, hl: Highlight) Allocator.Error!void {
+        const idx = try self.getOrInsert(line);
+        try self.nodes.items[idx].highlights.append(self.allocator, hl);
+        errdefer _ = self.nodes.items[idx].highlights.pop();
+        try self.indexRef(hl.hl_ref, idx);
+        self.highlight_count += 1;
+    }
+
+    /// Remove the line's highlights and spans
+    pub fn clearLine(self: *HighlightIndex, line: u32) void {
+        self.clearLines(line, line + 1);
+    }
+
+    /// Remove every highlight with `hl_ref`, appending the lines that lost
+    /// any to `affected`. Lines left without highlights keep an empty entry
+    /// until their spans are rebuilt.
+    pub fn removeByRef(self: *HighlightIndex, hl_ref: u16, affected: *std.ArrayListUnmanaged(u32), affected_allocator: Allocator) Allocator.Error!void {
+        const nodes = self.by_ref.get(hl_ref) orelse return;
+        try affected.ensureUnusedCapacity(affected_allocator, nodes.count());
+
+        var entry = self.by_ref.fetchRemove(hl_ref).?;
+        defer entry.value.deinit(self.allocator);
+
+        var it = entry.value.keyIterator();
+        while (it.next()) |node_idx| {
+            const node = &self.nodes.items[node_idx.*];
+            var kept: usize = 0;
+            for (node.highlights.items) |hl| {
+                if (hl.hl_ref == hl_ref) continue;
+                node.highlights.items[kept] = hl;
+                kept += 1;
+            }
+            self.highlight_count -= @intCast(node.highlights.items.len - kept);
+            node.highlights.shrinkRetainingCapacity(kept);
+            affected.appendAssumeCapacity(self.lineOf(node_idx.*));
+        }
+    }
+
+    /// An edit replaced lines up to `old_end` with lines up to `new_end`: lines
+    /// from `old_end` on move to start at `new_end`, and when lines were removed
+    /// the ones in [new_end, old_end) lose their highlights. Lines rewritten in
+    /// place keep theirs until re-highlighted.
+    pub fn moveLines(self: *HighlightIndex, old_end: u32, new_end: u32) void {
+        if (new_end < old_end) self.clearLines(new_end, old_end);
+        if (new_end == old_end or self.root == NONE) return;
+
+        var lower: u32 = NONE;
+        var upper: u32 = NONE;
+        self.split(self.root, old_end, &lower, &upper);
+        if (upper != NONE) {
+            self.nodes.items[upper].shift += @as(i32, @intCast(new_end)) - @as(i32, @intCast(old_end));
+        }
+        self.root = self.merge(lower, upper);
+        self.setParent(self.root, NONE);
+    }
+
+    /// Remove the entries of lines [start, end) without moving later lines
+    pub fn clearLines(self: *HighlightIndex, start: u32, end: u32) void {
+        if (self.root == NONE or start >= end) return;
+
+        var lower: u32 = NONE;
+        var rest: u32 = NONE;
+        var middle: u32 = NONE;
+        var upper: u32 = NONE;
+        self.split(self.root, start, &lower, &rest);
+        self.split(rest, end, &middle, &upper);
+        self.freeSubtree(middle);
+        self.root = self.merge(lower, upper);
+        self.setParent(self.root, NONE);
+    }
+
+    fn find(self: *const HighlightIndex, line: u32) u32 {
+        var idx = self.root;
+        var shift: i64 = 0;
+        while (idx != NONE) {
+            const node = &self.nodes.items[idx];
+            shift += node.shift;
+            const node_line = @as(i64, node.line) + shift;
+            if (line == node_line) return idx;
+            idx = if (line < node_line) node.left else node.right;
+        }
+        return NONE;
+    }
+
+    fn lineOf(self: *const HighlightIndex, idx: u32) u32 {
+        var line: i64 = self.nodes.items[idx].line;
+        var n = idx;
+        while (n != NONE) : (n = self.nodes.items[n].parent) {
+            line += self.nodes.items[n].shift;
+        }
+        return @intCast(line);
+    }
+
+    fn getOrInsert(self: *HighlightIndex, line: u32) Allocator.Error!u32 {
+        const found = self.find(line);
+        if (found != NONE) return found;
+
+        const idx = try self.allocNode(line);
+        var lower: u32 = NONE;
+        var upper: u32 = NONE;
+        self.split(self.root, line, &lower, &upper);
+        self.root = self.merge(self.merge(lower, idx), upper);
+        self.setParent(self.root, NONE);
+        return idx;
+    }
+
+    fn allocNode(self: *HighlightIndex, line: u32) Allocator.Error!u32 {
+        const priority = self.prng.random().int(u32);
+        if (self.free_nodes.pop()) |idx| {
+            const node = &self.nodes.items[idx];
+            node.* = .{
+                .line = line,
+                .priority = priority,
+                .highlights = node.highlights,
+                .spans = node.spans,
+            };
+            return idx;
+        }
+        const idx: u32 = @intCast(self.nodes.items.len);
+        try self.nodes.append(self.allocator, .{ .line = line, .priority = priority });
+        return idx;
+    }
+
+    fn freeSubtree(self: *HighlightIndex, idx: u32) void {
+        if (idx == NONE) return;
+        const node = &self.nodes.items[idx];
+        const left = node.left;
+        const right = node.right;
+        for (node.highlights.items) |hl| self.unindexRef(hl.hl_ref, idx);
+        self.highlight_count -= @intCast(node.highlights.items.len);
+        node.highlights.clearRetainingCapacity();
+        node.spans.clearRetainingCapacity();
+        // A failed append only leaks the slot, never its lists
+        self.free_nodes.append(self.allocator, idx) catch {};
+        self.freeSubtree(left);
+        self.freeSubtree(right);
+    }
+
+    fn indexRef(self: *HighlightIndex, hl_ref: u16, idx: u32) Allocator.Error!void {
+        const gop = try self.by_ref.getOrPut(self.allocator, hl_ref);
+        if (!gop.found_existing) gop.value_ptr.* = .{};
+        const count = try gop.value_ptr.getOrPut(self.allocator, idx);
+        count.value_ptr.* = if (count.found_existing) count.value_ptr.* + 1 else 1;
+    }
+
+    fn unindexRef(self: *HighlightIndex, hl_ref: u16, idx: u32) void {
+        const nodes = self.by_ref.getPtr(hl_ref) orelse return;
+        const count = nodes.getPtr(idx) orelse return;
+        count.* -= 1;
+        if (count.* > 0) return;
+        _ = nodes.remove(idx);
+        if (nodes.count() > 0) return;
+        nodes.deinit(self.allocator);
+        _ = self.by_ref.remove(hl_ref);
+    }
+
+    fn push(self: *HighlightIndex, idx: u32) void {
+        const node = &self.nodes.items[idx];
+        if (node.shift == 0) return;
+        node.line = @intCast(@as(i64, node.line) + node.shift);
+        if (node.left != NONE) self.nodes.items[node.left].shift += node.shift;
+        if (node.right != NONE) self.nodes.items[node.right].shift += node.shift;
+        node.shift = 0;
+    }
+
+    fn setParent(self: *HighlightIndex, idx: u32, parent: u32) void {
+        if (idx != NONE) self.nodes.items[idx].parent = parent;
+    }
+
+    /// Split into lines < line and lines >= line
+    fn split(self: *HighlightIndex, idx: u32, line: u32, lower: *u32, upper: *u32) void {
+        if (idx == NONE) {
+            lower.* = NONE;
+            upper.* = NONE;
+            return;
+        }
+        self.push(idx);
+        const node = &self.nodes.items[idx];
+        if (node.line < line) {
+            var right: u32 = NONE;
+            self.split(node.right, line, &right, upper);
+            self.nodes.items[idx].right = right;
+            self.setParent(right, idx);
+            lower.* = idx;
+        } else {
+            var left: u32 = NONE;
+            self.split(node.left, line, lower, &left);
+            self.nodes.items[idx].left = left;
+            self.setParent(left, idx);
+            upper.* = idx;
+        }
+    }
+
+    /// Join two treaps where every line in `lower` precedes every line in `upper`
+    fn merge(self: *HighlightIndex, lower: u32, upper: u32) u32 {
+        if (lower == NONE) return upper;
+        if (upper == NONE) return lower;
+        if (self.nodes.items[lower].priority > self.nodes.items[upper].priority) {
+            self.push(lower);
+            const right = self.merge(self.nodes.items[lower].right, upper);
+            self.nodes.items[lower].right = right;
+            self.setParent(right, lower);
+            return lower;
+        }
+        self.push(upper);
+        const left = self.merge(lower, self.nodes.items[upper].left);
+        self.nodes.items[upper].left = left;
+        self.setParent(left, upper);
+        return upper;
+    }
+};
@@ -57,6 +57,24 @@ export fn setUseThread(rendererPtr: *renderer.CliRenderer, useThread: bool) void
     rendererPtr.setUseThread(useThread);
 }
 
+export fn setRetainFrames(rendererPtr: *renderer.CliRenderer, retain: bool) void {
+    rendererPtr.setRetainFrames(retain);
+}
+
+export fn setOutputBufferSize(rendererPtr: *renderer.CliRenderer, size: u32) void {
+    rendererPtr.setOutputBufferSize(size);
+}
+
+export fn setColorDepth(rendererPtr: *renderer.CliRenderer, depth: u8) void {
+    const depthEnum: ?renderer.ColorDepth = switch (depth) {
+        1 => .truecolor,
+        2 => .ansi256,
+        3 => .ansi16,
+        else => null,
+    };
+    rendererPtr.setColorDepth(depthEnum);
+}
+
 export fn destroyRenderer(rendererPtr: *renderer.CliRenderer) void {
     rendererPtr.destroy();
 }
@@ -116,7 +134,7 @@ export fn render(rendererPtr: *renderer.CliRenderer, force: bool) void {
     rendererPtr.render(force);
 }
 
-export fn createOptimizedBuffer(width: u32, height: u32, respectAlpha: bool, widthMethod: u8, idPtr: [*]const u8, idLen: usize) ?*buffer.OptimizedBuffer {
+export fn createOptimizedBuffer(width: u32, height: u32, respectAlpha: bool, widthMethod: u8, colorStorage: u8, idPtr: [*]const u8, idLen: usize) ?*buffer.OptimizedBuffer {
     if (width == 0 or height == 0) {
         logger.warn("Invalid buffer dimensions: {}x{}", .{ width, height });
         return null;
@@ -133,6 +151,7 @@ export fn createOptimizedBuffer(width: u32, height: u32, respectAlpha: bool, wid
         .width_method = wMethod,
         .id = id,
         .link_pool = link_pool,
+        .color_storage = if (colorStorage == 1) .rgba8 else .float32,
     }) catch |err| {
         logger.err("Failed to create optimized buffer: {}", .{err});
         return null;
@@ -290,11 +309,11 @@ export fn bufferGetCharPtr(bufferPtr: *buffer.OptimizedBuffer) [*]u32 {
     return bufferPtr.getCharPtr();
 }
 
-export fn bufferGetFgPtr(bufferPtr: *buffer.OptimizedBuffer) [*]RGBA {
+export fn bufferGetFgPtr(bufferPtr: *buffer.OptimizedBuffer) ?[*]RGBA {
     return bufferPtr.getFgPtr();
 }
 
-export fn bufferGetBgPtr(bufferPtr: *buffer.OptimizedBuffer) [*]RGBA {
+export fn bufferGetBgPtr(bufferPtr: *buffer.OptimizedBuffer) ?[*]RGBA {
     return bufferPtr.getBgPtr();
 }
 
@@ -310,6 +329,31 @@ export fn bufferSetRespectAlpha(bufferPtr: *buffer.OptimizedBuffer, respectAlpha
     bufferPtr.setRespectAlpha(respectAlpha);
 }
 
+export fn bufferSetRowTracking(bufferPtr: *buffer.OptimizedBuffer, enabled: bool) bool {
+    bufferPtr.setRowTracking(enabled) catch return false;
+    return true;
+}
+
+export fn bufferIsRowDirty(bufferPtr: *buffer.OptimizedBuffer, y: u32) bool {
+    return bufferPtr.isRowDirty(y);
+}
+
+export fn bufferGetDirtyRowCount(bufferPtr: *buffer.OptimizedBuffer) u32 {
+    return bufferPtr.getDirtyRowCount();
+}
+
+export fn bufferMarkRowsDirty(bufferPtr: *buffer.OptimizedBuffer, start: u32, end: u32) void {
+    bufferPtr.markRowsDirty(start, end);
+}
+
+export fn bufferClearDirtyRows(bufferPtr: *buffer.OptimizedBuffer) void {
+    bufferPtr.clearDirtyRows();
+}
+
+export fn bufferGetRowHash(bufferPtr: *buffer.OptimizedBuffer, y: u32) u64 {
+    return bufferPtr.getRowHash(y);
+}
+
 export fn bufferGetId(bufferPtr: *buffer.OptimizedBuffer, outPtr: [*]u8, maxLen: usize) usize {
     const id = bufferPtr.getId();
     const copyLen = @min(id.len, maxLen);
@@ -355,6 +399,10 @@ export fn bufferFillRect(bufferPtr: *buffer.OptimizedBuffer, x: u32, y: u32, wid
     bufferPtr.fillRect(x, y, width, height, rgbaBg) catch {};
 }
 
+export fn bufferClearRect(bufferPtr: *buffer.OptimizedBuffer, x: u32, y: u32, width: u32, height: u32, bg: [*]const f32) void {
+    bufferPtr.clearRect(x, y, width, height, utils.f32PtrToRGBA(bg));
+}
+
 export fn bufferDrawPackedBuffer(bufferPtr: *buffer.OptimizedBuffer, data: [*]const u8, dataLen: usize, posX: u32, posY: u32, terminalWidthCells: u32, terminalHeightCells: u32) void {
     bufferPtr.drawPackedBuffer(data, dataLen, posX, posY, terminalWidthCells, terminalHeightCells);
 }
@@ -602,11 +650,10 @@ export fn textBufferSetTabWidth(tb: *text_buffer.UnifiedTextBuffer, width: u8) v
 
 export fn textBufferRegisterMemBuffer(tb: *text_buffer.UnifiedTextBuffer, dataPtr: [*]const u8, dataLen: usize, owned: bool) u16 {
     const data = dataPtr[0..dataLen];
-    const mem_id = tb.mem_registry.register(data, owned) catch return 0xFFFF;
-    return @intCast(mem_id);
+    return tb.registerMemBuffer(data, owned) catch return 0xFFFF;
 }
 
-export fn textBufferReplaceMemBuffer(tb: *text_buffer.UnifiedTextBuffer, id: u8, dataPtr: [*]const u8, dataLen: usize, owned: bool) bool {
+export fn textBufferReplaceMemBuffer(tb: *text_buffer.UnifiedTextBuffer, id: u16, dataPtr: [*]const u8, dataLen: usize, owned: bool) bool {
     const data = dataPtr[0..dataLen];
     tb.mem_registry.replace(id, data, owned) catch return false;
     return true;
@@ -616,7 +663,7 @@ export fn textBufferClearMemRegistry(tb: *text_buffer.UnifiedTextBuffer) void {
     tb.mem_registry.clear();
 }
 
-export fn textBufferSetTextFromMem(tb: *text_buffer.UnifiedTextBuffer, id: u8) void {
+export fn textBufferSetTextFromMem(tb: *text_buffer.UnifiedTextBuffer, id: u16) void {
     tb.setTextFromMemId(id) catch {};
 }
 
@@ -625,10 +672,25 @@ export fn textBufferAppend(tb: *text_buffer.UnifiedTextBuffer, dataPtr: [*]const
     tb.append(data) catch {};
 }
 
-export fn textBufferAppendFromMemId(tb: *text_buffer.UnifiedTextBuffer, id: u8) void {
+export fn textBufferAppendFromMemId(tb: *text_buffer.UnifiedTextBuffer, id: u16) void {
     tb.appendFromMemId(id) catch {};
 }
 
+export fn textBufferAppendStreaming(tb: *text_buffer.UnifiedTextBuffer, dataPtr: [*]const u8, dataLen: usize) void {
+    const data = dataPtr[0..dataLen];
+    tb.appendStreaming(data) catch {};
+}
+
+/// 0 removes the cap
+export fn textBufferSetMaxLines(tb: *text_buffer.UnifiedTextBuffer, maxLines: u32) void {
+    tb.setMaxLines(if (maxLines == 0) null else maxLines) catch {};
+}
+
+/// 0 removes the limit
+export fn textBufferSetChunkCacheLimit(tb: *text_buffer.UnifiedTextBuffer, maxBytes: usize) void {
+    tb.setChunkCacheLimit(if (maxBytes == 0) null else maxBytes);
+}
+
 export fn textBufferLoadFile(tb: *text_buffer.UnifiedTextBuffer, pathPtr: [*]const u8, pathLen: usize) bool {
     const path = pathPtr[0..pathLen];
     tb.loadFile(path) catch return false;
@@ -716,6 +778,18 @@ export fn textBufferViewSetWrapMode(view: *text_buffer_view.UnifiedTextBufferVie
     view.setWrapMode(wrapMode);
 }
 
+export fn textBufferViewSetLazyWrap(view: *text_buffer_view.UnifiedTextBufferView, lazy: bool) void {
+    view.setLazyWrap(lazy);
+}
+
+export fn textBufferViewWrapMoreLines(view: *text_buffer_view.UnifiedTextBufferView, maxLines: u32) bool {
+    return view.wrapMoreLines(maxLines);
+}
+
+export fn textBufferViewIsWrapComplete(view: *text_buffer_view.UnifiedTextBufferView) bool {
+    return view.isWrapComplete();
+}
+
 export fn textBufferViewSetViewportSize(view: *text_buffer_view.UnifiedTextBufferView, width: u32, height: u32) void {
     view.setViewportSize(width, height);
 }
@@ -871,6 +945,18 @@ export fn editBufferSetCursorByOffset(edit_buffer: *edit_buffer_mod.EditBuffer,
     edit_buffer.setCursorByOffset(offset) catch {};
 }
 
+export fn editBufferAddCursor(edit_buffer: *edit_buffer_mod.EditBuffer, row: u32, col: u32) void {
+    edit_buffer.addCursor(row, col) catch {};
+}
+
+export fn editBufferClearExtraCursors(edit_buffer: *edit_buffer_mod.EditBuffer) void {
+    edit_buffer.clearExtraCursors();
+}
+
+export fn editBufferGetCursorCount(edit_buffer: *edit_buffer_mod.EditBuffer) u32 {
+    return @intCast(edit_buffer.getCursorCount());
+}
+
 export fn editBufferGetNextWordBoundary(edit_buffer: *edit_buffer_mod.EditBuffer, outPtr: *ExternalLogicalCursor) void {
     const cursor = edit_buffer.getNextWordBoundary();
     outPtr.* = .{
@@ -934,7 +1020,7 @@ export fn editBufferSetText(edit_buffer: *edit_buffer_mod.EditBuffer, textPtr: [
     edit_buffer.setText(text) catch {};
 }
 
-export fn editBufferSetTextFromMem(edit_buffer: *edit_buffer_mod.EditBuffer, mem_id: u8) void {
+export fn editBufferSetTextFromMem(edit_buffer: *edit_buffer_mod.EditBuffer, mem_id: u16) void {
     edit_buffer.setTextFromMemId(mem_id) catch {};
 }
 
@@ -943,7 +1029,7 @@ export fn editBufferReplaceText(edit_buffer: *edit_buffer_mod.EditBuffer, textPt
     edit_buffer.replaceText(text) catch {};
 }
 
-export fn editBufferReplaceTextFromMem(edit_buffer: *edit_buffer_mod.EditBuffer, mem_id: u8) void {
+export fn editBufferReplaceTextFromMem(edit_buffer: *edit_buffer_mod.EditBuffer, mem_id: u16) void {
     edit_buffer.replaceTextFromMemId(mem_id) catch {};
 }
 
@@ -1336,6 +1422,56 @@ export fn textBufferAddHighlight(
     tb.addHighlight(line_idx, hl.start, hl.end, hl.style_id, hl.priority, hl.hl_ref) catch {};
 }
 
+/// Replaces the highlights of lines [start_line, end_line) with `count` char
+/// range highlights in one call. end_line is clamped to the line count.
+export fn textBufferSetHighlightsInLineRange(
+    tb: *text_buffer.UnifiedTextBuffer,
+    start_line: u32,
+    end_line: u32,
+    hl_ptr: ?[*]const ExternalHighlight,
+    count: usize,
+) void {
+    const external: []const ExternalHighlight = if (hl_ptr) |p| p[0..count] else &.{};
+    const highlights = globalAllocator.alloc(text_buffer.CharRangeHighlight, external.len) catch return;
+    defer globalAllocator.free(highlights);
+
+    for (external, highlights) |hl, *out| {
+        out.* = .{
+            .char_start = hl.start,
+            .char_end = hl.end,
+            .style_id = hl.style_id,
+            .priority = hl.priority,
+            .hl_ref = hl.hl_ref,
+        };
+    }
+    tb.setHighlightsInLineRange(start_line, end_line, highlights) catch {};
+}
+
+/// Like textBufferSetHighlightsInLineRange, with start/end as UTF-8 byte
+/// offsets from the start of start_line (line breaks count as one byte)
+export fn textBufferSetHighlightsInLineRangeByBytes(
+    tb: *text_buffer.UnifiedTextBuffer,
+    start_line: u32,
+    end_line: u32,
+    hl_ptr: ?[*]const ExternalHighlight,
+    count: usize,
+) void {
+    const external: []const ExternalHighlight = if (hl_ptr) |p| p[0..count] else &.{};
+    const highlights = globalAllocator.alloc(text_buffer.CharRangeHighlight, external.len) catch return;
+    defer globalAllocator.free(highlights);
+
+    for (external, highlights) |hl, *out| {
+        out.* = .{
+            .char_start = hl.start,
+            .char_end = hl.end,
+            .style_id = hl.style_id,
+            .priority = hl.priority,
+            .hl_ref = hl.hl_ref,
+        };
+    }
+    tb.setHighlightsInLineRangeByBytes(start_line, end_line, highlights) catch {};
+}
+
 export fn textBufferRemoveHighlightsByRef(tb: *text_buffer.UnifiedTextBuffer, hl_ref: u16) void {
     tb.removeHighlightsByRef(hl_ref);
 }
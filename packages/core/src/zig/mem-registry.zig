@@ -1,6 +1,16 @@
 const std = @import("std");
+const builtin = @import("builtin");
 const Allocator = std.mem.Allocator;
 
+const page_size_min = std.heap.page_size_min;
+
+/// Registry slot id. Every TextChunk carries one; u16 still fits in the
+/// chunk's padding, so widening it from u8 left TextChunk's size unchanged.
+pub const MemId = u16;
+
+/// Slot limit. maxInt(MemId) itself is kept free as the FFI's "no id" value.
+pub const MAX_BUFFERS: usize = std.math.maxInt(MemId);
+
 pub const MemRegistryError = error{
     OutOfMemory,
     InvalidMemId,
@@ -10,90 +20,133 @@ pub const MemRegistryError = error{
 pub const MemBuffer = struct {
     data: []const u8,
     owned: bool,
+    /// Memory-mapped file region, unmapped on release
+    mapped: bool = false,
+    /// Only rope segments refer to this slot, so it may be released once none do
+    reclaimable: bool = false,
+    /// Bumped whenever the slot's contents change, so caches keyed by id can tell
+    generation: u32 = 0,
     active: bool, // Track if slot is in use
 };
 
 /// Registry for multiple memory buffers
 pub const MemRegistry = struct {
     buffers: std.ArrayListUnmanaged(MemBuffer),
-    free_slots: std.ArrayListUnmanaged(u8), // Track free slot indices
+    free_slots: std.ArrayListUnmanaged(MemId), // Track free slot indices
+    reclaimable_count: usize,
+    /// Never reset, so a reused slot always gets a generation it has not had before
+    next_generation: u32,
     allocator: Allocator,
 
     pub fn init(allocator: Allocator) MemRegistry {
         return .{
             .buffers = .{},
             .free_slots = .{},
+            .reclaimable_count = 0,
+            .next_generation = 0,
             .allocator = allocator,
         };
     }
 
+    fn nextGeneration(self: *MemRegistry) u32 {
+        self.next_generation +%= 1;
+        return self.next_generation;
+    }
+
+    fn release(self: *MemRegistry, mem_buf: MemBuffer) void {
+        if (mem_buf.mapped) {
+            // Only loadFile maps regions, and never on Windows
+            if (comptime builtin.os.tag == .windows) unreachable;
+            const region: []align(page_size_min) const u8 = @alignCast(mem_buf.data);
+            std.posix.munmap(region);
+        } else if (mem_buf.owned) {
+            self.allocator.free(mem_buf.data);
+        }
+    }
+
     pub fn deinit(self: *MemRegistry) void {
         for (self.buffers.items) |mem_buf| {
-            if (mem_buf.active and mem_buf.owned) {
-                self.allocator.free(mem_buf.data);
+            if (mem_buf.active) {
+                self.release(mem_buf);
             }
         }
         self.buffers.deinit(self.allocator);
         self.free_slots.deinit(self.allocator);
     }
 
-    pub fn register(self: *MemRegistry, data: []const u8, owned: bool) MemRegistryError!u8 {
+    pub fn register(self: *MemRegistry, data: []const u8, owned: bool) MemRegistryError!MemId {
+        return self.registerBuffer(.{ .data = data, .owned = owned, .active = true });
+    }
+
+    /// Register a region returned by mmap. The registry takes ownership and
+    /// unmaps it when the slot is unregistered, replaced or cleared.
+    pub fn registerMapped(self: *MemRegistry, region: []align(page_size_min) const u8) MemRegistryError!MemId {
+        return self.registerBuffer(.{ .data = region, .owned = false, .mapped = true, .active = true });
+    }
+
+    fn registerBuffer(self: *MemRegistry, new_buf: MemBuffer) MemRegistryError!MemId {
+        var mem_buf = new_buf;
+        mem_buf.generation = self.nextGeneration();
+
         // Try to reuse a free slot first
         if (self.free_slots.items.len > 0) {
             const id = self.free_slots.items[self.free_slots.items.len - 1];
             _ = self.free_slots.pop();
-            self.buffers.items[id] = MemBuffer{
-                .data = data,
-                .owned = owned,
-                .active = true,
-            };
+            self.buffers.items[id] = mem_buf;
             return id;
         }
 
         // No free slots, allocate a new one
-        if (self.buffers.items.len >= 255) {
+        if (self.buffers.items.len >= MAX_BUFFERS) {
             return MemRegistryError.OutOfMemory;
         }
-        const id: u8 = @intCast(self.buffers.items.len);
-        try self.buffers.append(self.allocator, MemBuffer{
-            .data = data,
-            .owned = owned,
-            .active = true,
-        });
+        const id: MemId = @intCast(self.buffers.items.len);
+        try self.buffers.append(self.allocator, mem_buf);
         return id;
     }
 
-    pub fn get(self: *const MemRegistry, id: u8) ?[]const u8 {
+    pub fn get(self: *const MemRegistry, id: MemId) ?[]const u8 {
         if (id >= self.buffers.items.len) return null;
         const buf = self.buffers.items[id];
         if (!buf.active) return null;
         return buf.data;
     }
 
-    pub fn replace(self: *MemRegistry, id: u8, data: []const u8, owned: bool) MemRegistryError!void {
+    pub fn replace(self: *MemRegistry, id: MemId, data: []const u8, owned: bool) MemRegistryError!void {
         if (id >= self.buffers.items.len) return MemRegistryError.InvalidMemId;
         const prev = self.buffers.items[id];
         if (!prev.active) return MemRegistryError.InvalidMemId;
-        if (prev.owned) {
-            self.allocator.free(prev.data);
-        }
-        self.buffers.items[id] = .{ .data = data, .owned = owned, .active = true };
+        self.release(prev);
+        if (prev.reclaimable) self.reclaimable_count -= 1;
+        self.buffers.items[id] = .{ .data = data, .owned = owned, .generation = self.nextGeneration(), .active = true };
     }
 
-    pub fn unregister(self: *MemRegistry, id: u8) MemRegistryError!void {
+    /// Record that the slot's bytes were rewritten in place
+    pub fn touch(self: *MemRegistry, id: MemId) void {
+        if (id >= self.buffers.items.len) return;
+        self.buffers.items[id].generation = self.nextGeneration();
+    }
+
+    pub fn getGeneration(self: *const MemRegistry, id: MemId) u32 {
+        if (id >= self.buffers.items.len) return 0;
+        return self.buffers.items[id].generation;
+    }
+
+    pub fn unregister(self: *MemRegistry, id: MemId) MemRegistryError!void {
         if (id >= self.buffers.items.len) return MemRegistryError.InvalidMemId;
         var buf = &self.buffers.items[id];
         if (!buf.active) return MemRegistryError.InvalidMemId;
 
         // Free owned memory
-        if (buf.owned) {
-            self.allocator.free(buf.data);
-        }
+        self.release(buf.*);
+        if (buf.reclaimable) self.reclaimable_count -= 1;
 
         // Mark slot as inactive
         buf.active = false;
         buf.data = &[_]u8{};
         buf.owned = false;
+        buf.mapped = false;
+        buf.reclaimable = false;
 
         // Add to free slots list
         try self.free_slots.append(self.allocator, id);
@@ -101,12 +154,41 @@ pub const MemRegistry = struct {
 
     pub fn clear(self: *MemRegistry) void {
         for (self.buffers.items) |mem_buf| {
-            if (mem_buf.active and mem_buf.owned) {
-                self.allocator.free(mem_buf.data);
+            if (mem_buf.active) {
+                self.release(mem_buf);
             }
         }
         self.buffers.clearRetainingCapacity();
         self.free_slots.clearRetainingCapacity();
+        self.reclaimable_count = 0;
+    }
+
+    /// Hand the slot over to reclaimUnreferenced: it is released, and its
+    /// memory freed if owned, once no referenced set includes it.
+    pub fn markReclaimable(self: *MemRegistry, id: MemId) MemRegistryError!void {
+        if (id >= self.buffers.items.len) return MemRegistryError.InvalidMemId;
+        const buf = &self.buffers.items[id];
+        if (!buf.active) return MemRegistryError.InvalidMemId;
+        if (buf.reclaimable) return;
+        buf.reclaimable = true;
+        self.reclaimable_count += 1;
+    }
+
+    /// Unregister every reclaimable slot whose bit is unset in `referenced`.
+    /// Returns the number of slots released.
+    pub fn reclaimUnreferenced(self: *MemRegistry, referenced: *const std.DynamicBitSetUnmanaged) usize {
+        var released: usize = 0;
+        for (self.buffers.items, 0..) |buf, i| {
+            if (!buf.active or !buf.reclaimable) continue;
+            if (i < referenced.bit_length and referenced.isSet(i)) continue;
+            self.unregister(@intCast(i)) catch continue;
+            released += 1;
+        }
+        return released;
+    }
+
+    pub fn getSlotCount(self: *const MemRegistry) usize {
+        return self.buffers.items.len;
     }
 
     pub fn getUsedSlots(self: *const MemRegistry) usize {
@@ -119,7 +201,7 @@ pub const MemRegistry = struct {
     }
 
     pub fn getFreeSlots(self: *const MemRegistry) usize {
-        // Total capacity (255) minus buffers allocated plus explicitly freed slots
-        return 255 - self.buffers.items.len + self.free_slots.items.len;
+        // Total capacity minus buffers allocated plus explicitly freed slots
+        return MAX_BUFFERS - self.buffers.items.len + self.free_slots.items.len;
     }
 };
@@ -0,0 +1,128 @@
+const std = @import("std");
+
+/// Mapping of 24-bit colors onto the xterm 256-color and ANSI 16-color palettes,
+/// for terminals without truecolor support.
+pub const ColorDepth = enum(u8) {
+    truecolor,
+    ansi256,
+    ansi16,
+};
+
+// Channel levels of the 6x6x6 color cube (indices 16-231)
+const CUBE_LEVELS = [6]u8{ 0, 95, 135, 175, 215, 255 };
+
+// xterm defaults for the 16 base colors. Terminals theme these, so they are
+// only used as targets in 16-color mode.
+const ANSI16_RGB = [16][3]u8{
+    .{ 0, 0, 0 },
+    .{ 205, 0, 0 },
+    .{ 0, 205, 0 },
+    .{ 205, 205, 0 },
+    .{ 0, 0, 238 },
+    .{ 205, 0, 205 },
+    .{ 0, 205, 205 },
+    .{ 229, 229, 229 },
+    .{ 127, 127, 127 },
+    .{ 255, 0, 0 },
+    .{ 0, 255, 0 },
+    .{ 255, 255, 0 },
+    .{ 92, 92, 255 },
+    .{ 255, 0, 255 },
+    .{ 0, 255, 255 },
+    .{ 255, 255, 255 },
+};
+
+pub fn xterm256ToRgb(index: u8) [3]u8 {
+    if (index < 16) return ANSI16_RGB[index];
+    if (index < 232) {
+        const i = index - 16;
+        return .{ CUBE_LEVELS[i / 36], CUBE_LEVELS[(i / 6) % 6], CUBE_LEVELS[i % 6] };
+    }
+    const v: u8 = 8 + (index - 232) * 10;
+    return .{ v, v, v };
+}
+
+fn distanceSq(a: [3]u8, b: [3]u8) u32 {
+    const dr = @as(i32, a[0]) - @as(i32, b[0]);
+    const dg = @as(i32, a[1]) - @as(i32, b[1]);
+    const db = @as(i32, a[2]) - @as(i32, b[2]);
+    return @intCast(dr * dr + dg * dg + db * db);
+}
+
+fn cubeLevelIndex(v: u8) u8 {
+    if (v < 48) return 0;
+    if (v < 115) return 1;
+    return (v - 35) / 40;
+}
+
+/// Nearest entry in the color cube or grey ramp (16-255). The base 16 colors
+/// are skipped because their actual values depend on the terminal theme.
+pub fn nearest256(rgb: [3]u8) u8 {
+    const qr = cubeLevelIndex(rgb[0]);
+    const qg = cubeLevelIndex(rgb[1]);
+    const qb = cubeLevelIndex(rgb[2]);
+    const cubeIndex: u8 = 16 + 36 * qr + 6 * qg + qb;
+    const cubeRgb = [3]u8{ CUBE_LEVELS[qr], CUBE_LEVELS[qg], CUBE_LEVELS[qb] };
+    if (cubeRgb[0] == rgb[0] and cubeRgb[1] == rgb[1] and cubeRgb[2] == rgb[2]) return cubeIndex;
+
+    const avg: u32 = (@as(u32, rgb[0]) + rgb[1] + rgb[2]) / 3;
+    const greyStep: u8 = if (avg > 238) 23 else if (avg < 3) 0 else @intCast((avg - 3) / 10);
+    const greyLevel: u8 = 8 + greyStep * 10;
+    const greyIndex: u8 = 232 + greyStep;
+
+    if (distanceSq(.{ greyLevel, greyLevel, greyLevel }, rgb) < distanceSq(cubeRgb, rgb)) return greyIndex;
+    return cubeIndex;
+}
+
+/// Nearest of the 16 base colors (0-7 normal, 8-15 bright).
+pub fn nearest16(rgb: [3]u8) u8 {
+    var best: u8 = 0;
+    var bestDistance: u32 = std.math.maxInt(u32);
+    for (ANSI16_RGB, 0..) |candidate, i| {
+        const d = distanceSq(candidate, rgb);
+        if (d < bestDistance) {
+            bestDistance = d;
+            best = @intCast(i);
+        }
+    }
+    return best;
+}
+
+/// Direct-mapped memo of nearest-color lookups. Frames reuse a handful of colors
+/// across thousands of cells, so this avoids a palette search per cell.
+pub const PaletteCache = struct {
+    const SLOT_BITS = 10;
+    const SLOTS = 1 << SLOT_BITS;
+    const EMPTY: u32 = std.math.maxInt(u32);
+
+    keys: [SLOTS]u32 = [_]u32{EMPTY} ** SLOTS,
+    values: [SLOTS]u8 = [_]u8{0} ** SLOTS,
+    depth: ColorDepth = .ansi256,
+    hits: u64 = 0,
+    misses: u64 = 0,
+
+    pub fn lookup(self: *PaletteCache, depth: ColorDepth, rgb: [3]u8) u8 {
+        std.debug.assert(depth != .truecolor);
+        if (depth != self.depth) {
+            self.clear();
+            self.depth = depth;
+        }
+
+        const key = (@as(u32, rgb[0]) << 16) | (@as(u32, rgb[1]) << 8) | rgb[2];
+        const slot = (key *% 0x9E3779B1) >> (32 - SLOT_BITS);
+        if (self.keys[slot] == key) {
+            self.hits += 1;
+            return self.values[slot];
+        }
+
+        self.misses += 1;
+        const index = if (depth == .ansi16) nearest16(rgb) else nearest256(rgb);
+        self.keys[slot] = key;
+        self.values[slot] = index;
+        return index;
+    }
+
+    pub fn clear(self: *PaletteCache) void {
+        @memset(&self.keys, EMPTY);
+    }
+};
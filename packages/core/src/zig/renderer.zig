@@ -1,6 +1,7 @@
 const std = @import("std");
 const Allocator = std.mem.Allocator;
 const ansi = @import("ansi.zig");
+const palette = @import("palette.zig");
 const buf = @import("buffer.zig");
 const gp = @import("grapheme.zig");
 const link = @import("link.zig");
@@ -11,13 +12,28 @@ pub const RGBA = ansi.RGBA;
 pub const OptimizedBuffer = buf.OptimizedBuffer;
 pub const TextAttributes = ansi.TextAttributes;
 pub const CursorStyle = Terminal.CursorStyle;
+pub const ColorDepth = palette.ColorDepth;
 
 const CLEAR_CHAR = '\u{0a00}';
 const MAX_STAT_SAMPLES = 30;
 const STAT_SAMPLE_CAPACITY = 30;
 
 const COLOR_EPSILON_DEFAULT: f32 = 0.00001;
-const OUTPUT_BUFFER_SIZE = 1024 * 1024 * 2; // 2MB
+
+// Longest run of unchanged cells the emitter rewrites instead of moving the cursor
+const MAX_GAP_FILL = 8;
+const OUTPUT_BUFFER_SIZE = 1024 * 1024 * 2; // 2MB high-water mark per frame buffer
+const OUTPUT_BUFFER_INITIAL_SIZE = 64 * 1024;
+const MIN_OUTPUT_BUFFER_SIZE = 4 * 1024;
+
+// Row shifts considered by scroll detection, and rows a scroll must save to be used
+const MAX_SCROLL_SHIFT = 128;
+const MIN_SCROLL_GAIN = 2;
+
+// Number of cells compared per vector step in the frame diff pre-pass
+const DIFF_LANES = 8;
+const DiffU32Vec = @Vector(DIFF_LANES, u32);
+const DiffF32Vec = @Vector(DIFF_LANES * 4, f32);
 
 pub const RendererError = error{
     OutOfMemory,
@@ -26,13 +42,301 @@ pub const RendererError = error{
     WriteFailed,
 };
 
-fn rgbaComponentToU8(component: f32) u8 {
-    if (!std.math.isFinite(component)) return 0;
+const rgbaComponentToU8 = buf.rgbaComponentToU8;
+
+/// A run of cells on row `y` that differs between two buffers.
+/// `start` is inclusive, `end` is exclusive.
+pub const DirtySpan = struct {
+    y: u32,
+    start: u32,
+    end: u32,
+};
+
+/// Upper bound on the number of spans collectDirtySpans can produce for a frame.
+/// Spans are separated by at least one clean step, and a row has at most
+/// width / DIFF_LANES vector steps plus fewer than DIFF_LANES scalar tail steps.
+pub fn maxDirtySpans(width: u32, height: u32) usize {
+    return @as(usize, height) * (@as(usize, width) / DIFF_LANES + DIFF_LANES);
+}
+
+fn cellEqualAt(current: *const OptimizedBuffer, currentIndex: usize, next: *const OptimizedBuffer, nextIndex: usize, epsilon: f32) bool {
+    if (current.buffer.char[currentIndex] != next.buffer.char[nextIndex] or
+        current.buffer.attributes[currentIndex] != next.buffer.attributes[nextIndex]) return false;
+
+    if (current.color_storage == .rgba8 and next.color_storage == .rgba8) {
+        return current.buffer.fg8[currentIndex] == next.buffer.fg8[nextIndex] and
+            current.buffer.bg8[currentIndex] == next.buffer.bg8[nextIndex];
+    }
+
+    return buf.rgbaEqual(current.getFgAt(currentIndex), next.getFgAt(nextIndex), epsilon) and
+        buf.rgbaEqual(current.getBgAt(currentIndex), next.getBgAt(nextIndex), epsilon);
+}
+
+// Packed RGBA8 colors are quantized already, so the block compare is exact
+fn packedBlockEqualAt(current: *const OptimizedBuffer, currentIndex: usize, next: *const OptimizedBuffer, nextIndex: usize) bool {
+    const charA: DiffU32Vec = current.buffer.char[currentIndex..][0..DIFF_LANES].*;
+    const charB: DiffU32Vec = next.buffer.char[nextIndex..][0..DIFF_LANES].*;
+    const attrA: DiffU32Vec = current.buffer.attributes[currentIndex..][0..DIFF_LANES].*;
+    const attrB: DiffU32Vec = next.buffer.attributes[nextIndex..][0..DIFF_LANES].*;
+    const fgA: DiffU32Vec = current.buffer.fg8[currentIndex..][0..DIFF_LANES].*;
+    const fgB: DiffU32Vec = next.buffer.fg8[nextIndex..][0..DIFF_LANES].*;
+    const bgA: DiffU32Vec = current.buffer.bg8[currentIndex..][0..DIFF_LANES].*;
+    const bgB: DiffU32Vec = next.buffer.bg8[nextIndex..][0..DIFF_LANES].*;
+    return @reduce(.And, charA == charB) and @reduce(.And, attrA == attrB) and
+        @reduce(.And, fgA == fgB) and @reduce(.And, bgA == bgB);
+}
+
+fn blockEqualAt(current: *const OptimizedBuffer, currentIndex: usize, next: *const OptimizedBuffer, nextIndex: usize, epsilon: f32) bool {
+    if (current.color_storage != next.color_storage) {
+        for (0..DIFF_LANES) |i| {
+            if (!cellEqualAt(current, currentIndex + i, next, nextIndex + i, epsilon)) return false;
+        }
+        return true;
+    }
+
+    return switch (current.color_storage) {
+        .float32 => floatBlockEqualAt(current, currentIndex, next, nextIndex, epsilon),
+        .rgba8 => packedBlockEqualAt(current, currentIndex, next, nextIndex),
+    };
+}
+
+fn floatBlockEqualAt(current: *const OptimizedBuffer, currentIndex: usize, next: *const OptimizedBuffer, nextIndex: usize, epsilon: f32) bool {
+    const charA: DiffU32Vec = current.buffer.char[currentIndex..][0..DIFF_LANES].*;
+    const charB: DiffU32Vec = next.buffer.char[nextIndex..][0..DIFF_LANES].*;
+    const attrA: DiffU32Vec = current.buffer.attributes[currentIndex..][0..DIFF_LANES].*;
+    const attrB: DiffU32Vec = next.buffer.attributes[nextIndex..][0..DIFF_LANES].*;
+    if (!@reduce(.And, charA == charB) or !@reduce(.And, attrA == attrB)) return false;
+
+    // RGBA is [4]f32, so DIFF_LANES cells are DIFF_LANES * 4 contiguous floats
+    const eps: DiffF32Vec = @splat(epsilon);
+    const fgA: DiffF32Vec = @as(*const [DIFF_LANES * 4]f32, @ptrCast(current.buffer.fg[currentIndex..][0..DIFF_LANES])).*;
+    const fgB: DiffF32Vec = @as(*const [DIFF_LANES * 4]f32, @ptrCast(next.buffer.fg[nextIndex..][0..DIFF_LANES])).*;
+    if (!@reduce(.And, @abs(fgA - fgB) < eps)) return false;
+
+    const bgA: DiffF32Vec = @as(*const [DIFF_LANES * 4]f32, @ptrCast(current.buffer.bg[currentIndex..][0..DIFF_LANES])).*;
+    const bgB: DiffF32Vec = @as(*const [DIFF_LANES * 4]f32, @ptrCast(next.buffer.bg[nextIndex..][0..DIFF_LANES])).*;
+    return @reduce(.And, @abs(bgA - bgB) < eps);
+}
+
+/// Compare two buffers row by row and append the changed spans to `spans`.
+///
+/// Rows are compared DIFF_LANES cells at a time with vector loads over the
+/// char/attributes/fg/bg arrays; the tail of each row falls back to scalar
+/// compares. Buffers with .rgba8 color storage compare colors exactly.
+/// Span bounds have block granularity, so a span can include clean cells at
+/// its edges and callers still compare cell by cell inside a span.
+/// Rows that neither buffer marked dirty (see OptimizedBuffer.setRowTracking)
+/// are skipped without reading them.
+///
+/// `spans` is cleared first and must have capacity for
+/// maxDirtySpans(min width, min height) entries.
+pub fn collectDirtySpans(
+    current: *const OptimizedBuffer,
+    next: *const OptimizedBuffer,
+    epsilon: f32,
+    spans: *std.ArrayListUnmanaged(DirtySpan),
+) void {
+    spans.clearRetainingCapacity();
+
+    const width = @min(current.width, next.width);
+    const height = @min(current.height, next.height);
+
+    for (0..height) |uy| {
+        const y: u32 = @intCast(uy);
+        // Rows neither buffer wrote since the last frame still match
+        if (!current.isRowDirty(y) and !next.isRowDirty(y)) continue;
+
+        const currentRow = uy * current.width;
+        const nextRow = uy * next.width;
+
+        var spanStart: ?u32 = null;
+        var x: u32 = 0;
+        while (x < width) {
+            const step: u32 = if (width - x >= DIFF_LANES) DIFF_LANES else 1;
+            const equal = if (step == DIFF_LANES)
+                blockEqualAt(current, currentRow + x, next, nextRow + x, epsilon)
+            else
+                cellEqualAt(current, currentRow + x, next, nextRow + x, epsilon);
+
+            if (equal) {
+                if (spanStart) |start| {
+                    spans.appendAssumeCapacity(.{ .y = y, .start = start, .end = x });
+                    spanStart = null;
+                }
+            } else if (spanStart == null) {
+                spanStart = x;
+            }
+
+            x += step;
+        }
+
+        if (spanStart) |start| {
+            spans.appendAssumeCapacity(.{ .y = y, .start = start, .end = width });
+        }
+    }
+}
+
+/// Number of distinct rows in `spans`, which collectDirtySpans emits in row order.
+pub fn dirtySpanRowCount(spans: []const DirtySpan) u32 {
+    var count: u32 = 0;
+    var lastRow: ?u32 = null;
+    for (spans) |span| {
+        if (lastRow != null and lastRow.? == span.y) continue;
+        lastRow = span.y;
+        count += 1;
+    }
+    return count;
+}
+
+/// A vertical shift of whole rows, applied with a terminal scroll region.
+pub const RowShift = struct {
+    // First row of the scroll region
+    top: u32,
+    // One past the last row of the scroll region
+    end: u32,
+    // Positive scrolls content up (SU), negative scrolls it down (SD)
+    lines: i32,
+};
 
-    const clamped = std.math.clamp(component, 0.0, 1.0);
-    return @intFromFloat(@round(clamped * 255.0));
+fn rowsIdentical(a: *const OptimizedBuffer, ay: u32, b: *const OptimizedBuffer, by: u32) bool {
+    const w = a.width;
+    const aStart = ay * w;
+    const bStart = by * w;
+    const aEnd = aStart + w;
+    const bEnd = bStart + w;
+    if (!std.mem.eql(u32, a.buffer.char[aStart..aEnd], b.buffer.char[bStart..bEnd])) return false;
+    if (!std.mem.eql(u32, a.buffer.attributes[aStart..aEnd], b.buffer.attributes[bStart..bEnd])) return false;
+    return switch (a.color_storage) {
+        .float32 => std.mem.eql(u8, std.mem.sliceAsBytes(a.buffer.fg[aStart..aEnd]), std.mem.sliceAsBytes(b.buffer.fg[bStart..bEnd])) and
+            std.mem.eql(u8, std.mem.sliceAsBytes(a.buffer.bg[aStart..aEnd]), std.mem.sliceAsBytes(b.buffer.bg[bStart..bEnd])),
+        .rgba8 => std.mem.eql(u32, a.buffer.fg8[aStart..aEnd], b.buffer.fg8[bStart..bEnd]) and
+            std.mem.eql(u32, a.buffer.bg8[aStart..aEnd], b.buffer.bg8[bStart..bEnd]),
+    };
 }
 
+/// Find the row shift between two frames, given per-row hashes, that saves the
+/// most row repaints. Rows that already match in place don't count, and rows
+/// that were correct but get blanked by the scroll count against it.
+pub fn detectRowShift(current: []const u64, next: []const u64, maxShift: u32) ?RowShift {
+    const height: u32 = @intCast(@min(current.len, next.len));
+    if (height < 2) return null;
+
+    var best: ?RowShift = null;
+    var bestGain: i64 = MIN_SCROLL_GAIN - 1;
+
+    var d: u32 = 1;
+    while (d <= @min(maxShift, height - 1)) : (d += 1) {
+        inline for ([_]bool{ true, false }) |up| {
+            // Up: next[y] == current[y + d]; down: next[y] == current[y - d]
+            const limit: u32 = if (up) height - d else height;
+            var y: u32 = if (up) 0 else d;
+            var runStart: u32 = y;
+            var runGain: i64 = 0;
+
+            while (y <= limit) : (y += 1) {
+                const matches = y < limit and next[y] == (if (up) current[y + d] else current[y - d]);
+                if (matches) {
+                    if (next[y] != current[y]) runGain += 1;
+                    continue;
+                }
+
+                if (y > runStart and runGain > 0) {
+                    const exposedStart = if (up) y else runStart - d;
+                    var loss: i64 = 0;
+                    for (exposedStart..exposedStart + d) |ey| {
+                        if (next[ey] == current[ey]) loss += 1;
+                    }
+
+                    if (runGain - loss > bestGain) {
+                        bestGain = runGain - loss;
+                        best = if (up)
+                            .{ .top = runStart, .end = y + d, .lines = @intCast(d) }
+                        else
+                            .{ .top = runStart - d, .end = y, .lines = -@as(i32, @intCast(d)) };
+                    }
+                }
+
+                runStart = y + 1;
+                runGain = 0;
+            }
+        }
+    }
+
+    return best;
+}
+
+/// Triple-buffered, single-producer/single-consumer handoff of finished frames
+/// to the render thread. Each side owns one of three slots and the third is
+/// exchanged through a single atomic word, so neither side ever waits on the
+/// other. Slots are indices; the caller keeps the frame data.
+pub const FrameHandoff = struct {
+    pub const SLOTS = 3;
+
+    const INDEX_MASK: u32 = 0b11;
+    // Set while the shared slot holds a frame the consumer has not taken yet
+    const FRESH: u32 = 0b100;
+    // Set by interrupt() so a consumer about to sleep returns instead
+    const INTERRUPT: u32 = 0b1000;
+
+    // Shared slot index and FRESH flag. Also the futex word the consumer sleeps on.
+    state: std.atomic.Value(u32) = std.atomic.Value(u32).init(1),
+    // Only touched by the producer
+    back: u2 = 0,
+    // Only touched by the consumer
+    front: u2 = 2,
+
+    /// Producer: take back the shared slot before filling the back slot. Returns
+    /// the slot the producer now owns and whether it still holds a frame the
+    /// consumer never took, which the producer must either keep or discard.
+    pub fn reclaim(self: *FrameHandoff) struct { slot: u2, stale: bool } {
+        const prev = self.state.swap(self.back, .acq_rel);
+        self.back = @intCast(prev & INDEX_MASK);
+        return .{ .slot = self.back, .stale = prev & FRESH != 0 };
+    }
+
+    /// Producer: hand the back slot to the consumer and wake it.
+    pub fn publish(self: *FrameHandoff) void {
+        const prev = self.state.swap(@as(u32, self.back) | FRESH, .acq_rel);
+        // reclaim() cleared FRESH and the consumer only takes fresh slots
+        std.debug.assert(prev & FRESH == 0);
+        self.back = @intCast(prev & INDEX_MASK);
+        std.Thread.Futex.wake(&self.state, 1);
+    }
+
+    /// Consumer: take the latest published frame, or null when there is none.
+    pub fn acquire(self: *FrameHandoff) ?u2 {
+        var seen = self.state.load(.acquire);
+        while (seen & FRESH != 0) {
+            // Fails if the producer reclaimed the slot in between
+            seen = self.state.cmpxchgWeak(seen, self.front, .acq_rel, .acquire) orelse {
+                self.front = @intCast(seen & INDEX_MASK);
+                return self.front;
+            };
+        }
+        return null;
+    }
+
+    /// Consumer: block until a frame may have been published or interrupt() was
+    /// called. Spurious wakeups are allowed.
+    pub fn wait(self: *FrameHandoff) void {
+        const seen = self.state.load(.acquire);
+        if (seen & (FRESH | INTERRUPT) != 0) return;
+        std.Thread.Futex.wait(&self.state, seen);
+    }
+
+    /// Wake the consumer, e.g. to let it observe shutdown. Changing the word
+    /// ensures a consumer that has not reached the futex yet does not sleep.
+    pub fn interrupt(self: *FrameHandoff) void {
+        _ = self.state.fetchOr(INTERRUPT, .release);
+        std.Thread.Futex.wake(&self.state, 1);
+    }
+
+    /// Undo interrupt() once the consumer has stopped.
+    pub fn clearInterrupt(self: *FrameHandoff) void {
+        _ = self.state.fetchAnd(~INTERRUPT, .release);
+    }
+};
+
 pub const DebugOverlayCorner = enum {
     topLeft,
     topRight,
@@ -67,6 +371,21 @@ pub const CliRenderer = struct {
         heapTotal: u32,
         arrayBuffers: u32,
         frameCallbackTime: ?f64,
+        // Rows moved with a terminal scroll region in the last frame
+        linesScrolled: u32,
+        // Bytes emitted for the last frame, including chunks flushed early
+        outputBytes: usize,
+        // Chunks flushed early in the last frame because it hit the high-water mark
+        outputChunkFlushes: u32,
+        // Frames that did not fit in the output buffer since the renderer was created
+        outputOverflowFrames: u64,
+        // Frames appended to an earlier frame the render thread had not written yet
+        coalescedFrames: u64,
+        // Unwritten frames discarded in favour of a full repaint
+        droppedFrames: u64,
+        // Frames and bytes still waiting for the render thread when the last frame started
+        writerBacklog: u32,
+        writerBacklogBytes: usize,
     },
     statSamples: struct {
         lastFrameTime: std.ArrayListUnmanaged(f64),
@@ -88,15 +407,12 @@ pub const CliRenderer = struct {
         .enabled = false,
         .corner = .bottomRight,
     },
-    // Threading
+    // Threading. Finished frames reach the render thread through frameHandoff, so
+    // render() never waits for stdout.
     useThread: bool = false,
-    renderMutex: std.Thread.Mutex = .{},
-    renderCondition: std.Thread.Condition = .{},
-    renderRequested: bool = false,
-    shouldTerminate: bool = false,
-    renderInProgress: bool = false,
-    currentOutputBuffer: []u8 = &[_]u8{},
-    currentOutputLen: usize = 0,
+    frameHandoff: FrameHandoff = .{},
+    renderThreadStop: std.atomic.Value(bool) = std.atomic.Value(bool).init(false),
+    renderThreadStdoutBuffer: [4096]u8 = undefined,
 
     // Hit grid for mouse event dispatch.
     //
@@ -122,45 +438,158 @@ pub const CliRenderer = struct {
     hitGridHeight: u32,
     hitScissorStack: std.ArrayListUnmanaged(buf.ClipRect),
 
+    // Changed spans for the frame being prepared, filled by collectDirtySpans
+    dirtySpans: std.ArrayListUnmanaged(DirtySpan) = .{},
+
+    // Row shifts between frames are replayed with DECSTBM + SU/SD instead of repainting
+    useScrollRegions: bool = true,
+    currentRowHashes: std.ArrayListUnmanaged(u64) = .{},
+    nextRowHashes: std.ArrayListUnmanaged(u64) = .{},
+
+    // Retained mode: the next buffer and hit grid start each frame as a copy of the
+    // last one instead of being cleared, and the caller redraws only what changed
+    retainFrames: bool = false,
+
+    // Output color depth; null follows terminal detection
+    colorDepthOverride: ?ColorDepth = null,
+    paletteCache: palette.PaletteCache = .{},
+
     lastCursorStyleTag: ?u8 = null,
     lastCursorBlinking: ?bool = null,
     lastCursorColorRGB: ?[3]u8 = null,
 
-    // Preallocated output buffer
-    var outputBuffer: [OUTPUT_BUFFER_SIZE]u8 = undefined;
-    var outputBufferLen: usize = 0;
-    var outputBufferB: [OUTPUT_BUFFER_SIZE]u8 = undefined;
-    var outputBufferBLen: usize = 0;
-    var activeBuffer: enum { A, B } = .A;
-
-    const OutputBufferWriter = struct {
-        pub fn write(_: void, data: []const u8) !usize {
-            const bufferLen = if (activeBuffer == .A) &outputBufferLen else &outputBufferBLen;
-            const buffer = if (activeBuffer == .A) &outputBuffer else &outputBufferB;
-
-            if (bufferLen.* + data.len > buffer.len) {
-                // TODO: Resize buffer when necessary
-                return error.BufferFull;
-            }
+    // Output buffers, one per frameHandoff slot. The back slot collects the frame
+    // being prepared while the others are pending or being written by the render
+    // thread. Without the thread each grows on demand up to outputHighWaterMark;
+    // past that, completed chunks are flushed to stdout mid-frame instead of
+    // dropping output. With the thread a frame cannot be written early, so the
+    // back slot grows past the mark and the backlog limit applies instead.
+    outputBuffers: [FrameHandoff.SLOTS]std.ArrayListUnmanaged(u8) = .{ .{}, .{}, .{} },
+    // Frames held in each slot; more than one after coalescing
+    outputFrameCounts: [FrameHandoff.SLOTS]u32 = .{ 0, 0, 0 },
+    // Slots to release once the producer owns them again, after the mark shrank
+    outputTrimPending: [FrameHandoff.SLOTS]bool = .{ false, false, false },
+    // Slot holding the most recently prepared frame
+    lastOutput: u2 = 0,
+    // A threaded frame lost output to an allocation failure and the next one must repaint
+    outputLost: bool = false,
+    outputHighWaterMark: usize = OUTPUT_BUFFER_SIZE,
+
+    // TODO: std.io.GenericWriter is deprecated, however the "correct" option seems to be much more involved
+    // So I have simply used GenericWriter here, and then the proper migration can be done later
+    const OutputWriter = std.io.GenericWriter(*CliRenderer, error{WriteFailed}, writeOutput);
+
+    fn outputWriter(self: *CliRenderer) OutputWriter {
+        return .{ .context = self };
+    }
 
-            @memcpy(buffer.*[bufferLen.*..][0..data.len], data);
-            bufferLen.* += data.len;
+    fn writeOutput(self: *CliRenderer, data: []const u8) error{WriteFailed}!usize {
+        const out = &self.outputBuffers[self.frameHandoff.back];
+        self.renderStats.outputBytes += data.len;
 
+        if (self.useThread) {
+            out.appendSlice(self.allocator, data) catch {
+                self.outputLost = true;
+            };
             return data.len;
         }
 
-        // TODO: std.io.GenericWriter is deprecated, however the "correct" option seems to be much more involved
-        // So I have simply used GenericWriter here, and then the proper migration can be done later
-        pub fn writer() std.io.GenericWriter(void, error{BufferFull}, write) {
-            return .{ .context = {} };
+        if (out.items.len + data.len > self.outputHighWaterMark) {
+            self.flushOutputChunk();
+            if (data.len > self.outputHighWaterMark) {
+                self.writeOutputChunk(data);
+                return data.len;
+            }
+        }
+
+        if (out.items.len + data.len > out.capacity) {
+            const grown = @min(self.outputHighWaterMark, @max(out.items.len + data.len, out.capacity * 2));
+            out.ensureTotalCapacityPrecise(self.allocator, grown) catch {
+                // Can't grow: push out what we have and pass this write straight through
+                self.flushOutputChunk();
+                self.writeOutputChunk(data);
+                return data.len;
+            };
+        }
+
+        out.appendSliceAssumeCapacity(data);
+        return data.len;
+    }
+
+    /// Write part of a frame to stdout before the frame is complete.
+    /// In testing mode there is no stdout, so the chunk is only counted.
+    fn writeOutputChunk(self: *CliRenderer, data: []const u8) void {
+        if (data.len == 0) return;
+        self.renderStats.outputChunkFlushes += 1;
+        if (self.testing) return;
+
+        var stdoutWriter = std.fs.File.stdout().writer(&self.stdoutBuffer);
+        const w = &stdoutWriter.interface;
+        w.writeAll(data) catch {};
+        w.flush() catch {};
+    }
+
+    fn flushOutputChunk(self: *CliRenderer) void {
+        const out = &self.outputBuffers[self.frameHandoff.back];
+        self.writeOutputChunk(out.items);
+        out.clearRetainingCapacity();
+    }
+
+    /// Empty an output slot the producer owns, releasing it if the high-water mark shrank.
+    fn resetOutputSlot(self: *CliRenderer, slot: u2) void {
+        const out = &self.outputBuffers[slot];
+        if (self.outputTrimPending[slot]) {
+            self.outputTrimPending[slot] = false;
+            if (out.capacity > self.outputHighWaterMark) {
+                out.clearAndFree(self.allocator);
+            }
+        }
+        out.clearRetainingCapacity();
+        self.outputFrameCounts[slot] = 1;
+    }
+
+    /// Claim the back slot for the next threaded frame. Frames are diffs against
+    /// what the terminal shows, so a frame the render thread has not written yet
+    /// cannot simply be skipped: the new frame is appended to it instead. Once that
+    /// backlog passes the high-water mark it is discarded and a full repaint
+    /// replaces it. Returns true when the caller must repaint.
+    fn beginThreadedFrame(self: *CliRenderer) bool {
+        const claimed = self.frameHandoff.reclaim();
+        const out = &self.outputBuffers[claimed.slot];
+        const repaint = self.outputLost;
+        self.outputLost = false;
+
+        if (!claimed.stale) {
+            self.renderStats.writerBacklog = 0;
+            self.renderStats.writerBacklogBytes = 0;
+            self.resetOutputSlot(claimed.slot);
+            return repaint;
+        }
+
+        const backlog = self.outputFrameCounts[claimed.slot];
+        self.renderStats.writerBacklog = backlog;
+        self.renderStats.writerBacklogBytes = out.items.len;
+
+        if (!repaint and out.items.len <= self.outputHighWaterMark) {
+            self.outputFrameCounts[claimed.slot] = backlog + 1;
+            self.renderStats.coalescedFrames += 1;
+            return false;
         }
-    };
+
+        self.renderStats.droppedFrames += backlog;
+        self.resetOutputSlot(claimed.slot);
+        // The discarded bytes may have changed the cursor, so re-emit it
+        self.lastCursorStyleTag = null;
+        self.lastCursorBlinking = null;
+        self.lastCursorColorRGB = null;
+        return true;
+    }
 
     pub fn create(allocator: Allocator, width: u32, height: u32, pool: *gp.GraphemePool, testing: bool) !*CliRenderer {
         const self = try allocator.create(CliRenderer);
 
-        const currentBuffer = try OptimizedBuffer.init(allocator, width, height, .{ .pool = pool, .width_method = .unicode, .id = "current buffer" });
-        const nextBuffer = try OptimizedBuffer.init(allocator, width, height, .{ .pool = pool, .width_method = .unicode, .id = "next buffer" });
+        const currentBuffer = try OptimizedBuffer.init(allocator, width, height, .{ .pool = pool, .width_method = .unicode, .id = "current buffer", .track_rows = true });
+        const nextBuffer = try OptimizedBuffer.init(allocator, width, height, .{ .pool = pool, .width_method = .unicode, .id = "next buffer", .track_rows = true });
 
         // stat sample arrays
         var lastFrameTime: std.ArrayListUnmanaged(f64) = .{};
@@ -186,6 +615,11 @@ pub const CliRenderer = struct {
         @memset(nextHitGrid, 0);
         const hitScissorStack: std.ArrayListUnmanaged(buf.ClipRect) = .{};
 
+        var outputBuffers: [FrameHandoff.SLOTS]std.ArrayListUnmanaged(u8) = .{ .{}, .{}, .{} };
+        for (&outputBuffers) |*out| {
+            try out.ensureTotalCapacityPrecise(allocator, OUTPUT_BUFFER_INITIAL_SIZE);
+        }
+
         self.* = .{
             .width = width,
             .height = height,
@@ -214,6 +648,14 @@ pub const CliRenderer = struct {
                 .heapTotal = 0,
                 .arrayBuffers = 0,
                 .frameCallbackTime = null,
+                .linesScrolled = 0,
+                .outputBytes = 0,
+                .outputChunkFlushes = 0,
+                .outputOverflowFrames = 0,
+                .coalescedFrames = 0,
+                .droppedFrames = 0,
+                .writerBacklog = 0,
+                .writerBacklogBytes = 0,
             },
             .statSamples = .{
                 .lastFrameTime = lastFrameTime,
@@ -232,6 +674,7 @@ pub const CliRenderer = struct {
             .hitGridWidth = width,
             .hitGridHeight = height,
             .hitScissorStack = hitScissorStack,
+            .outputBuffers = outputBuffers,
         };
 
         try currentBuffer.clear(.{ self.backgroundColor[0], self.backgroundColor[1], self.backgroundColor[2], self.backgroundColor[3] }, CLEAR_CHAR);
@@ -241,19 +684,7 @@ pub const CliRenderer = struct {
     }
 
     pub fn destroy(self: *CliRenderer) void {
-        self.renderMutex.lock();
-        while (self.renderInProgress) {
-            self.renderCondition.wait(&self.renderMutex);
-        }
-
-        self.shouldTerminate = true;
-        self.renderRequested = true;
-        self.renderCondition.signal();
-        self.renderMutex.unlock();
-
-        if (self.renderThread) |thread| {
-            thread.join();
-        }
+        self.stopRenderThread();
 
         self.performShutdownSequence();
 
@@ -272,6 +703,12 @@ pub const CliRenderer = struct {
         self.allocator.free(self.currentHitGrid);
         self.allocator.free(self.nextHitGrid);
         self.hitScissorStack.deinit(self.allocator);
+        self.dirtySpans.deinit(self.allocator);
+        self.currentRowHashes.deinit(self.allocator);
+        self.nextRowHashes.deinit(self.allocator);
+        for (&self.outputBuffers) |*out| {
+            out.deinit(self.allocator);
+        }
 
         self.allocator.destroy(self);
     }
@@ -380,6 +817,19 @@ pub const CliRenderer = struct {
         }
     }
 
+    /// Set the output high-water mark for this renderer. Frames larger than this
+    /// are written out in chunks. Buffers already above the new size are released.
+    pub fn setOutputBufferSize(self: *CliRenderer, size: usize) void {
+        self.outputHighWaterMark = @max(size, MIN_OUTPUT_BUFFER_SIZE);
+        // The render thread may be reading any slot but the back one, so each is
+        // released when it next comes back to this side
+        @memset(&self.outputTrimPending, true);
+    }
+
+    pub fn getOutputBufferSize(self: *const CliRenderer) usize {
+        return self.outputHighWaterMark;
+    }
+
     pub fn setUseThread(self: *CliRenderer, useThread: bool) void {
         if (self.useThread == useThread) return;
 
@@ -392,28 +842,24 @@ pub const CliRenderer = struct {
                 };
             }
         } else {
-            if (self.renderThread) |thread| {
-                // Signal the render thread to terminate (same pattern as destroy)
-                self.renderMutex.lock();
-                while (self.renderInProgress) {
-                    self.renderCondition.wait(&self.renderMutex);
-                }
-                self.shouldTerminate = true;
-                self.renderRequested = true;
-                self.renderCondition.signal();
-                self.renderMutex.unlock();
-
-                thread.join();
-                self.renderThread = null;
-
-                // Reset termination flag so thread can be re-enabled later
-                self.shouldTerminate = false;
-            }
+            self.stopRenderThread();
         }
 
         self.useThread = useThread;
     }
 
+    /// Let the render thread write out any pending frame, then join it.
+    fn stopRenderThread(self: *CliRenderer) void {
+        const thread = self.renderThread orelse return;
+        self.renderThreadStop.store(true, .release);
+        self.frameHandoff.interrupt();
+        thread.join();
+        self.renderThread = null;
+        // Reset so the thread can be re-enabled later
+        self.frameHandoff.clearInterrupt();
+        self.renderThreadStop.store(false, .release);
+    }
+
     pub fn updateStats(self: *CliRenderer, time: f64, fps: u32, frameCallbackTime: f64) void {
         self.renderStats.overallFrameTime = time;
         self.renderStats.fps = fps;
@@ -471,35 +917,24 @@ pub const CliRenderer = struct {
 
     fn renderThreadFn(self: *CliRenderer) void {
         while (true) {
-            self.renderMutex.lock();
-            while (!self.renderRequested and !self.shouldTerminate) {
-                self.renderCondition.wait(&self.renderMutex);
-            }
-
-            if (self.shouldTerminate and !self.renderRequested) {
-                self.renderMutex.unlock();
-                break;
-            }
-
-            self.renderRequested = false;
-
-            const outputData = self.currentOutputBuffer;
-            const outputLen = self.currentOutputLen;
-
+            const slot = self.frameHandoff.acquire() orelse {
+                // Only stop once nothing is pending, so the last frame still reaches the terminal
+                if (self.renderThreadStop.load(.acquire)) break;
+                self.frameHandoff.wait();
+                continue;
+            };
+
+            const outputData = self.outputBuffers[slot].items;
             const writeStart = std.time.microTimestamp();
 
-            if (outputLen > 0 and !self.testing) {
-                var stdoutWriter = std.fs.File.stdout().writer(&self.stdoutBuffer);
+            if (outputData.len > 0 and !self.testing) {
+                var stdoutWriter = std.fs.File.stdout().writer(&self.renderThreadStdoutBuffer);
                 const w = &stdoutWriter.interface;
-                w.writeAll(outputData[0..outputLen]) catch {};
+                w.writeAll(outputData) catch {};
                 w.flush() catch {};
             }
 
-            // Signal that rendering is complete
             self.renderStats.stdoutWriteTime = @as(f64, @floatFromInt(std.time.microTimestamp() - writeStart));
-            self.renderInProgress = false;
-            self.renderCondition.signal();
-            self.renderMutex.unlock();
         }
     }
 
@@ -512,34 +947,21 @@ pub const CliRenderer = struct {
         self.lastRenderTime = now;
         self.renderDebugOverlay();
 
-        self.prepareRenderFrame(force);
-
         if (self.useThread) {
-            self.renderMutex.lock();
-            while (self.renderInProgress) {
-                self.renderCondition.wait(&self.renderMutex);
-            }
-
-            if (activeBuffer == .A) {
-                activeBuffer = .B;
-                self.currentOutputBuffer = &outputBuffer;
-                self.currentOutputLen = outputBufferLen;
-            } else {
-                activeBuffer = .A;
-                self.currentOutputBuffer = &outputBufferB;
-                self.currentOutputLen = outputBufferBLen;
-            }
-
-            self.renderRequested = true;
-            self.renderInProgress = true;
-            self.renderCondition.signal();
-            self.renderMutex.unlock();
+            const repaint = self.beginThreadedFrame();
+            self.prepareRenderFrame(force or repaint);
+            self.lastOutput = self.frameHandoff.back;
+            self.frameHandoff.publish();
         } else {
+            self.resetOutputSlot(self.frameHandoff.back);
+            self.prepareRenderFrame(force);
+            self.lastOutput = self.frameHandoff.back;
+
             const writeStart = std.time.microTimestamp();
             if (!self.testing) {
                 var stdoutWriter = std.fs.File.stdout().writer(&self.stdoutBuffer);
                 const w = &stdoutWriter.interface;
-                w.writeAll(outputBuffer[0..outputBufferLen]) catch {};
+                w.writeAll(self.outputBuffers[self.frameHandoff.back].items) catch {};
                 w.flush() catch {};
             }
             self.renderStats.stdoutWriteTime = @as(f64, @floatFromInt(std.time.microTimestamp() - writeStart));
@@ -569,37 +991,182 @@ pub const CliRenderer = struct {
         return self.currentRenderBuffer;
     }
 
+    /// Terminal style for a cell. A fully transparent background maps to the
+    /// terminal default rather than black.
+    fn penStyle(self: *CliRenderer, cell: buf.Cell, depth: ColorDepth) ansi.Pen.Style {
+        return .{
+            .fg = self.penColor(cell.fg, depth),
+            .bg = if (cell.bg[3] < 0.001) .default else self.penColor(cell.bg, depth),
+            .attributes = ansi.TextAttributes.getBaseAttributes(cell.attributes),
+        };
+    }
+
+    fn penColor(self: *CliRenderer, color: RGBA, depth: ColorDepth) ansi.Pen.Color {
+        const rgb = [3]u8{ rgbaComponentToU8(color[0]), rgbaComponentToU8(color[1]), rgbaComponentToU8(color[2]) };
+        return switch (depth) {
+            .truecolor => .{ .rgb = rgb },
+            .ansi256, .ansi16 => .{ .indexed = self.paletteCache.lookup(depth, rgb) },
+        };
+    }
+
+    /// Force a color depth for output, or pass null to follow terminal detection.
+    pub fn setColorDepth(self: *CliRenderer, depth: ?ColorDepth) void {
+        self.colorDepthOverride = depth;
+    }
+
+    pub fn getColorDepth(self: *CliRenderer) ColorDepth {
+        if (self.colorDepthOverride) |depth| return depth;
+        const caps = self.terminal.getCapabilities();
+        return if (caps.rgb) .truecolor else caps.color_depth;
+    }
+
+    /// Reach cell (x, y) by rewriting the unchanged cells between the cursor and
+    /// it, when that is shorter than a cursor movement. Only plain ASCII cells in
+    /// the pen's current style and link qualify. Returns false if nothing was written.
+    fn fillGapTo(self: *CliRenderer, writer: anytype, pen: *ansi.Pen, x: u32, y: u32, linkId: u32, hyperlinksEnabled: bool, depth: ColorDepth) bool {
+        const col = x + 1;
+        const row = y + 1 + self.renderOffset;
+        if (!pen.cursorKnown or !pen.styleKnown or pen.row != row or pen.col >= col) return false;
+
+        const gap = col - pen.col;
+        if (gap > MAX_GAP_FILL or gap >= pen.moveCost(col, row)) return false;
+
+        var bytes: [MAX_GAP_FILL]u8 = undefined;
+        for (0..gap) |i| {
+            const gx = pen.col - 1 + @as(u32, @intCast(i));
+            const cell = self.nextRenderBuffer.get(gx, y) orelse return false;
+            if (cell.char < 0x20 or cell.char > 0x7e) return false;
+            if (hyperlinksEnabled and ansi.TextAttributes.getLinkId(cell.attributes) != linkId) return false;
+            if (!self.penStyle(cell, depth).eql(pen.style)) return false;
+            bytes[i] = @intCast(cell.char);
+        }
+
+        writer.writeAll(bytes[0..gap]) catch {};
+        pen.advance(gap);
+        return true;
+    }
+
+    /// Replay a vertical shift of rows between the current and next frame with a
+    /// terminal scroll region, and shift currentRenderBuffer to match so the diff
+    /// only sees the rows that actually changed. Returns whether a shift was
+    /// applied. Row hashes are cached per buffer, so only rows written since
+    /// their last hash are rehashed.
+    fn applyRowShift(self: *CliRenderer, writer: anytype, pen: *ansi.Pen) bool {
+        const current = self.currentRenderBuffer;
+        const next = self.nextRenderBuffer;
+        // Scroll regions span full terminal rows
+        if (current.width != self.width or next.width != self.width) return false;
+        if (current.height != next.height or current.color_storage != next.color_storage) return false;
+
+        const height = current.height;
+        self.currentRowHashes.resize(self.allocator, height) catch return false;
+        self.nextRowHashes.resize(self.allocator, height) catch return false;
+
+        for (0..height) |uy| {
+            const y: u32 = @intCast(uy);
+            self.currentRowHashes.items[uy] = current.getRowHash(y);
+            self.nextRowHashes.items[uy] = next.getRowHash(y);
+        }
+
+        const shift = detectRowShift(self.currentRowHashes.items, self.nextRowHashes.items, MAX_SCROLL_SHIFT) orelse return false;
+        const lines: u32 = @abs(shift.lines);
+        const up = shift.lines > 0;
+
+        // Hashes only nominate the shift; check the rows before touching the terminal
+        var y: u32 = if (up) shift.top else shift.top + lines;
+        const runEnd: u32 = if (up) shift.end - lines else shift.end;
+        while (y < runEnd) : (y += 1) {
+            const source = if (up) y + lines else y - lines;
+            if (!rowsIdentical(next, y, current, source)) return false;
+        }
+
+        // Rows uncovered by the scroll take the current background, so reset it first
+        writer.writeAll(ansi.ANSI.reset) catch {};
+        pen.resetStyle();
+
+        ansi.ANSI.setScrollRegionOutput(writer, shift.top + 1 + self.renderOffset, shift.end + self.renderOffset) catch {};
+        if (up) {
+            ansi.ANSI.scrollUpOutput(writer, lines) catch {};
+        } else {
+            ansi.ANSI.scrollDownOutput(writer, lines) catch {};
+        }
+        writer.writeAll(ansi.ANSI.resetScrollRegion) catch {};
+        // DECSTBM homes the cursor
+        pen.invalidateCursor();
+
+        // Uncovered rows are blank with the default background, which a transparent bg models
+        current.scrollRowsRaw(shift.top, shift.end, shift.lines, .{
+            .char = ' ',
+            .fg = .{ 0.0, 0.0, 0.0, 0.0 },
+            .bg = .{ 0.0, 0.0, 0.0, 0.0 },
+            .attributes = 0,
+        });
+        self.renderStats.linesScrolled = lines;
+        return true;
+    }
+
     fn prepareRenderFrame(self: *CliRenderer, force: bool) void {
         const renderStartTime = std.time.microTimestamp();
         var cellsUpdated: u32 = 0;
 
-        if (activeBuffer == .A) {
-            outputBufferLen = 0;
-        } else {
-            outputBufferBLen = 0;
-        }
+        self.renderStats.outputBytes = 0;
+        self.renderStats.outputChunkFlushes = 0;
+        self.renderStats.linesScrolled = 0;
 
-        var writer = OutputBufferWriter.writer();
+        var writer = self.outputWriter();
 
         writer.writeAll(ansi.ANSI.syncSet) catch {};
         writer.writeAll(ansi.ANSI.hideCursor) catch {};
 
-        var currentFg: ?RGBA = null;
-        var currentBg: ?RGBA = null;
-        var currentAttributes: i32 = -1;
+        // Cursor and style are unknown at the start of a frame, so the first move is
+        // absolute and the first style starts with a reset.
+        var pen = ansi.Pen{};
+
         var currentLinkId: u32 = 0;
         var utf8Buf: [4]u8 = undefined;
 
         const colorEpsilon: f32 = COLOR_EPSILON_DEFAULT;
         const hyperlinksEnabled = self.terminal.getCapabilities().hyperlinks;
+        const colorDepth = self.getColorDepth();
+
+        const scanWidth = @min(self.currentRenderBuffer.width, self.nextRenderBuffer.width);
+        const scanHeight = @min(self.currentRenderBuffer.height, self.nextRenderBuffer.height);
+
+        // Set when some changes were not emitted, so row dirty bits must survive this frame
+        var framePending = self.currentRenderBuffer.width != self.nextRenderBuffer.width or
+            self.currentRenderBuffer.height != self.nextRenderBuffer.height;
+
+        if (self.dirtySpans.ensureTotalCapacity(self.allocator, maxDirtySpans(scanWidth, scanHeight))) |_| {
+            if (force) {
+                self.dirtySpans.clearRetainingCapacity();
+                for (0..scanHeight) |uy| {
+                    self.dirtySpans.appendAssumeCapacity(.{ .y = @intCast(uy), .start = 0, .end = scanWidth });
+                }
+            } else {
+                collectDirtySpans(self.currentRenderBuffer, self.nextRenderBuffer, colorEpsilon, &self.dirtySpans);
+                // Only a frame with enough changed rows can gain from a scroll
+                if (self.useScrollRegions and dirtySpanRowCount(self.dirtySpans.items) >= MIN_SCROLL_GAIN and
+                    self.applyRowShift(writer, &pen))
+                {
+                    // The shift moved currentRenderBuffer's rows, so diff again
+                    collectDirtySpans(self.currentRenderBuffer, self.nextRenderBuffer, colorEpsilon, &self.dirtySpans);
+                }
+            }
+        } else |err| {
+            // Skip emitting cells; currentRenderBuffer stays untouched so a later frame picks the changes up
+            logger.warn("Failed to allocate dirty spans: {}", .{err});
+            self.dirtySpans.clearRetainingCapacity();
+            framePending = true;
+        }
 
-        for (0..self.height) |uy| {
-            const y = @as(u32, @intCast(uy));
+        // Continuation cells already covered by a wide grapheme written this frame
+        var coveredRow: u32 = 0;
+        var coveredEnd: u32 = 0;
 
-            var runStart: i64 = -1;
-            var runLength: u32 = 0;
+        for (self.dirtySpans.items) |span| {
+            const y = span.y;
 
-            for (0..self.width) |ux| {
+            for (span.start..span.end) |ux| {
                 const x = @as(u32, @intCast(ux));
                 const currentCell = self.currentRenderBuffer.get(x, y);
                 const nextCell = self.nextRenderBuffer.get(x, y);
@@ -614,22 +1181,23 @@ pub const CliRenderer = struct {
                         buf.rgbaEqual(currentCell.?.fg, nextCell.?.fg, colorEpsilon) and
                         buf.rgbaEqual(currentCell.?.bg, nextCell.?.bg, colorEpsilon))
                     {
-                        if (runLength > 0) {
-                            writer.writeAll(ansi.ANSI.reset) catch {};
-                            runStart = -1;
-                            runLength = 0;
-                        }
                         continue;
                     }
                 }
 
                 const cell = nextCell.?;
 
-                const fgMatch = currentFg != null and buf.rgbaEqual(currentFg.?, cell.fg, colorEpsilon);
-                const bgMatch = currentBg != null and buf.rgbaEqual(currentBg.?, cell.bg, colorEpsilon);
-                const sameAttributes = fgMatch and bgMatch and @as(i32, @intCast(cell.attributes)) == currentAttributes;
+                if (gp.isContinuationChar(cell.char) and y == coveredRow and x < coveredEnd) {
+                    continue;
+                }
 
                 const linkId = if (hyperlinksEnabled) ansi.TextAttributes.getLinkId(cell.attributes) else 0;
+                const col = x + 1;
+                const row = y + 1 + self.renderOffset;
+
+                if (!pen.isAt(col, row) and !self.fillGapTo(writer, &pen, x, y, currentLinkId, hyperlinksEnabled, colorDepth)) {
+                    pen.moveTo(writer, col, row) catch {};
+                }
 
                 if (hyperlinksEnabled and linkId != currentLinkId) {
                     if (currentLinkId != 0) {
@@ -647,40 +1215,11 @@ pub const CliRenderer = struct {
                     }
                 }
 
-                if (!sameAttributes or runStart == -1) {
-                    if (runLength > 0) {
-                        writer.writeAll(ansi.ANSI.reset) catch {};
-                    }
-
-                    runStart = @intCast(x);
-                    runLength = 0;
-
-                    currentFg = cell.fg;
-                    currentBg = cell.bg;
-                    currentAttributes = @as(i32, @intCast(cell.attributes));
-
-                    ansi.ANSI.moveToOutput(writer, x + 1, y + 1 + self.renderOffset) catch {};
+                pen.setStyle(writer, self.penStyle(cell, colorDepth)) catch {};
 
-                    const fgR = rgbaComponentToU8(cell.fg[0]);
-                    const fgG = rgbaComponentToU8(cell.fg[1]);
-                    const fgB = rgbaComponentToU8(cell.fg[2]);
-
-                    const bgR = rgbaComponentToU8(cell.bg[0]);
-                    const bgG = rgbaComponentToU8(cell.bg[1]);
-                    const bgB = rgbaComponentToU8(cell.bg[2]);
-                    const bgA = cell.bg[3];
-
-                    ansi.ANSI.fgColorOutput(writer, fgR, fgG, fgB) catch {};
-
-                    // If alpha is 0 (transparent), use terminal default background instead of black
-                    if (bgA < 0.001) {
-                        writer.writeAll("\x1b[49m") catch {};
-                    } else {
-                        ansi.ANSI.bgColorOutput(writer, bgR, bgG, bgB) catch {};
-                    }
-
-                    ansi.TextAttributes.applyAttributesOutputWriter(writer, cell.attributes) catch {};
-                }
+                var cellWidth: u32 = 1;
+                // The terminal may draw a grapheme at another width than ours
+                var widthUnknown = false;
 
                 // Handle grapheme characters
                 if (gp.isGraphemeChar(cell.char)) {
@@ -689,15 +1228,18 @@ pub const CliRenderer = struct {
                         self.performShutdownSequence();
                         std.debug.panic("Fatal: no grapheme bytes in pool for gid {d}: {}", .{ gid, err });
                     };
+                    cellWidth = gp.charRightExtent(cell.char) + 1;
                     if (bytes.len > 0) {
                         const capabilities = self.terminal.getCapabilities();
                         if (capabilities.explicit_width) {
-                            const graphemeWidth = gp.charRightExtent(cell.char) + 1;
-                            ansi.ANSI.explicitWidthOutput(writer, graphemeWidth, bytes) catch {};
+                            ansi.ANSI.explicitWidthOutput(writer, cellWidth, bytes) catch {};
                         } else {
                             writer.writeAll(bytes) catch {};
+                            widthUnknown = true;
                         }
                     }
+                    coveredRow = y;
+                    coveredEnd = x + cellWidth;
                 } else if (gp.isContinuationChar(cell.char)) {
                     // Write a space for continuation cells to clear any previous content
                     writer.writeByte(' ') catch {};
@@ -705,7 +1247,13 @@ pub const CliRenderer = struct {
                     const len = std.unicode.utf8Encode(@intCast(cell.char), &utf8Buf) catch 1;
                     writer.writeAll(utf8Buf[0..len]) catch {};
                 }
-                runLength += 1;
+
+                pen.advance(cellWidth);
+                if (widthUnknown or x + cellWidth >= self.width) {
+                    // Writing the last column leaves the cursor in a pending-wrap
+                    // state; after an unsized grapheme its column is unknown
+                    pen.invalidateCursor();
+                }
 
                 // Update the current buffer with the new cell
                 self.currentRenderBuffer.setRaw(x, y, nextCell.?);
@@ -793,16 +1341,38 @@ pub const CliRenderer = struct {
 
         self.renderStats.cellsUpdated = cellsUpdated;
         self.renderStats.renderTime = renderTime;
+        if (self.renderStats.outputChunkFlushes > 0) {
+            self.renderStats.outputOverflowFrames += 1;
+        }
 
-        self.nextRenderBuffer.clear(.{ self.backgroundColor[0], self.backgroundColor[1], self.backgroundColor[2], self.backgroundColor[3] }, null) catch {};
+        // Both buffers now match, so later writes are the only changes the next diff needs to see
+        if (!framePending) {
+            self.currentRenderBuffer.clearDirtyRows();
+            self.nextRenderBuffer.clearDirtyRows();
+        }
+
+        // In retained mode nextRenderBuffer already holds what was just emitted
+        if (!self.retainFrames) {
+            self.nextRenderBuffer.clear(.{ self.backgroundColor[0], self.backgroundColor[1], self.backgroundColor[2], self.backgroundColor[3] }, null) catch {};
+        }
 
         // Swap hit grids: nextHitGrid (built this frame) becomes the active grid for
         // hit testing. The old currentHitGrid becomes nextHitGrid and is cleared for
-        // the next frame.
+        // the next frame, or seeded with this frame's grid in retained mode.
         const temp = self.currentHitGrid;
         self.currentHitGrid = self.nextHitGrid;
         self.nextHitGrid = temp;
-        @memset(self.nextHitGrid, 0);
+        if (self.retainFrames) {
+            @memcpy(self.nextHitGrid, self.currentHitGrid);
+        } else {
+            @memset(self.nextHitGrid, 0);
+        }
+    }
+
+    /// Keep the next buffer and hit grid between frames instead of clearing them.
+    /// The caller is then responsible for clearing whatever it redraws.
+    pub fn setRetainFrames(self: *CliRenderer, retain: bool) void {
+        self.retainFrames = retain;
     }
 
     pub fn setDebugOverlay(self: *CliRenderer, enabled: bool, corner: DebugOverlayCorner) void {
@@ -1042,16 +1612,13 @@ pub const CliRenderer = struct {
         writer.flush() catch {};
     }
 
-    pub fn getLastOutputForTest(_: *CliRenderer) []const u8 {
-        // In non-threaded mode, we want the current active buffer
-        // In threaded mode, we want the previously rendered buffer
-        const currentBuffer = if (activeBuffer == .A) &outputBuffer else &outputBufferB;
-        const currentLen = if (activeBuffer == .A) outputBufferLen else outputBufferBLen;
-        return currentBuffer.*[0..currentLen];
+    /// Output of the last frame. Chunks flushed early are not included. In threaded
+    /// mode this also holds earlier frames coalesced into it.
+    pub fn getLastOutputForTest(self: *CliRenderer) []const u8 {
+        return self.outputBuffers[self.lastOutput].items;
     }
 
     pub fn dumpStdoutBuffer(self: *CliRenderer, timestamp: i64) void {
-        _ = self;
         std.fs.cwd().makeDir("buffer_dump") catch |err| switch (err) {
             error.PathAlreadyExists => {},
             else => return,
@@ -1071,18 +1638,18 @@ pub const CliRenderer = struct {
         writer.writeAll("Last Rendered ANSI Output:\n") catch return;
         writer.writeAll("================\n") catch return;
 
-        const lastBuffer = if (activeBuffer == .A) &outputBufferB else &outputBuffer;
-        const lastLen = if (activeBuffer == .A) outputBufferBLen else outputBufferLen;
+        const lastOutput = self.outputBuffers[self.lastOutput].items;
+        const lastLen = lastOutput.len;
 
         if (lastLen > 0) {
-            writer.writeAll(lastBuffer.*[0..lastLen]) catch return;
+            writer.writeAll(lastOutput) catch return;
         } else {
             writer.writeAll("(no output rendered yet)\n") catch return;
         }
 
         writer.writeAll("\n================\n") catch return;
         writer.print("Buffer size: {d} bytes\n", .{lastLen}) catch return;
-        writer.print("Active buffer: {s}\n", .{if (activeBuffer == .A) "A" else "B"}) catch return;
+        writer.print("Output slot: {d}\n", .{self.lastOutput}) catch return;
         writer.flush() catch {};
     }
 
@@ -1281,7 +1848,10 @@ pub const CliRenderer = struct {
 
         // Is threaded?
         var isThreadedText: [64]u8 = undefined;
-        const isThreadedLen = std.fmt.bufPrint(&isThreadedText, "Threaded: {s}", .{if (self.useThread) "Yes" else "No"}) catch return;
+        const isThreadedLen = if (self.useThread)
+            std.fmt.bufPrint(&isThreadedText, "Threaded: Yes, backlog {d}, dropped {d}", .{ self.renderStats.writerBacklog, self.renderStats.droppedFrames }) catch return
+        else
+            std.fmt.bufPrint(&isThreadedText, "Threaded: No", .{}) catch return;
         self.nextRenderBuffer.drawText(isThreadedLen, x + 1, y + row, fg, bg, 0) catch {};
         row += 1;
     }
@@ -41,6 +41,12 @@ pub fn Rope(comptime T: type) type {
             positions: std.AutoHashMap(std.meta.Tag(T), std.ArrayListUnmanaged(MarkerPosition)),
             version: u64, // Rope version when cache was built
             allocator: Allocator,
+            // Dropping a prefix advances past its markers instead of rebuilding:
+            // entries before heads[i] are gone, and stored positions are relative
+            // to leaf_base/weight_base until the lists are compacted.
+            heads: [MarkerTagCount]u32 = [_]u32{0} ** MarkerTagCount,
+            leaf_base: u32 = 0,
+            weight_base: u32 = 0,
 
             pub fn init(allocator: Allocator) MarkerCache {
                 return .{
@@ -63,6 +69,56 @@ pub fn Rope(comptime T: type) type {
                 while (iter.next()) |list| {
                     list.clearRetainingCapacity();
                 }
+                self.heads = [_]u32{0} ** MarkerTagCount;
+                self.leaf_base = 0;
+                self.weight_base = 0;
+            }
+
+            fn tagSlot(tag: std.meta.Tag(T)) usize {
+                inline for (T.MarkerTypes, 0..) |mt, i| {
+                    if (tag == mt) return i;
+                }
+                unreachable;
+            }
+
+            fn live(self: *const MarkerCache, tag: std.meta.Tag(T)) []const MarkerPosition {
+                const list = self.positions.get(tag) orelse return &[_]MarkerPosition{};
+                return list.items[self.heads[tagSlot(tag)]..];
+            }
+
+            /// Forget the markers of a dropped prefix in O(1).
+            fn advance(self: *MarkerCache, dropped: Metrics) void {
+                inline for (&self.heads, 0..) |*head, i| {
+                    head.* += dropped.marker_counts[i];
+                }
+                self.leaf_base += dropped.count;
+                self.weight_base += dropped.weight();
+
+                // Compact once the dead entries outnumber the live ones, so the
+                // memmove is paid for by the drops that created them.
+                var dead: usize = 0;
+                var total: usize = 0;
+                inline for (T.MarkerTypes, 0..) |mt, i| {
+                    dead += self.heads[i];
+                    if (self.positions.get(mt)) |list| total += list.items.len;
+                }
+                if (dead * 2 <= total) return;
+
+                inline for (T.MarkerTypes, 0..) |mt, i| {
+                    if (self.positions.getPtr(mt)) |list| {
+                        const kept = list.items[self.heads[i]..];
+                        for (kept, 0..) |pos, j| {
+                            list.items[j] = .{
+                                .leaf_index = pos.leaf_index - self.leaf_base,
+                                .global_weight = pos.global_weight - self.weight_base,
+                            };
+                        }
+                        list.shrinkRetainingCapacity(kept.len);
+                    }
+                    self.heads[i] = 0;
+                }
+                self.leaf_base = 0;
+                self.weight_base = 0;
             }
         } else struct {
             pub fn init(_: Allocator) @This() {
@@ -1098,6 +1154,48 @@ pub fn Rope(comptime T: type) type {
             return self.redo_history != null and self.curr_history != null;
         }
 
+        /// Visit every item reachable from the current tree or the undo/redo
+        /// history. Versions share most of their nodes, so each distinct node
+        /// is visited once and shared subtrees are skipped.
+        pub fn walkReachable(self: *const Self, allocator: Allocator, ctx: *anyopaque, f: *const fn (ctx: *anyopaque, data: *const T) void) !void {
+            var history: std.ArrayListUnmanaged(*const UndoNode) = .{};
+            defer history.deinit(allocator);
+            var seen_history = std.AutoHashMapUnmanaged(*const UndoNode, void){};
+            defer seen_history.deinit(allocator);
+            var nodes: std.ArrayListUnmanaged(*const Node) = .{};
+            defer nodes.deinit(allocator);
+            var seen_nodes = std.AutoHashMapUnmanaged(*const Node, void){};
+            defer seen_nodes.deinit(allocator);
+
+            try nodes.append(allocator, self.root);
+            for ([_]?*UndoNode{ self.undo_history, self.redo_history, self.curr_history }) |start| {
+                if (start) |h| try history.append(allocator, h);
+            }
+
+            while (history.pop()) |h| {
+                if ((try seen_history.getOrPut(allocator, h)).found_existing) continue;
+                try nodes.append(allocator, h.root);
+                if (h.next) |next| try history.append(allocator, next);
+                var branch = h.branches;
+                while (branch) |b| : (branch = b.next) {
+                    try history.append(allocator, b.redo);
+                }
+            }
+
+            while (nodes.pop()) |node| {
+                if ((try seen_nodes.getOrPut(allocator, node)).found_existing) continue;
+                switch (node.*) {
+                    .branch => |*b| {
+                        try nodes.append(allocator, b.left);
+                        try nodes.append(allocator, b.right);
+                    },
+                    .leaf => |*l| {
+                        if (!l.is_sentinel) f(ctx, &l.data);
+                    },
+                }
+            }
+        }
+
         pub fn clear_history(self: *Self) void {
             self.undo_history = null;
             self.redo_history = null;
@@ -1134,64 +1232,148 @@ pub fn Rope(comptime T: type) type {
             self.version += 1;
         }
 
+        fn itemWeight(data: *const T) u32 {
+            if (@hasDecl(T, "Metrics")) {
+                if (@hasDecl(T, "measure")) {
+                    const metrics = data.measure();
+                    return if (@hasDecl(T.Metrics, "weight")) metrics.weight() else 1;
+                }
+            }
+            return 1;
+        }
+
+        const MarkerIndexContext = struct {
+            cache: *MarkerCache,
+            current_leaf: u32 = 0,
+            current_weight: u32 = 0,
+
+            fn walker(ctx: *anyopaque, data: *const T, idx: u32) Node.WalkerResult {
+                _ = idx;
+                const context = @as(*@This(), @ptrCast(@alignCast(ctx)));
+
+                const tag = std.meta.activeTag(data.*);
+
+                var is_marker = false;
+                inline for (T.MarkerTypes) |mt| {
+                    if (tag == mt) {
+                        is_marker = true;
+                        break;
+                    }
+                }
+
+                const leaf_weight = itemWeight(data);
+
+                if (is_marker) {
+                    const gop = context.cache.positions.getOrPut(tag) catch |e| {
+                        return .{ .keep_walking = false, .err = e };
+                    };
+                    if (!gop.found_existing) {
+                        gop.value_ptr.* = .{};
+                    }
+
+                    gop.value_ptr.append(context.cache.allocator, .{
+                        .leaf_index = context.current_leaf,
+                        .global_weight = context.current_weight,
+                    }) catch |e| {
+                        return .{ .keep_walking = false, .err = e };
+                    };
+                }
+
+                context.current_leaf += 1;
+                context.current_weight += leaf_weight;
+                return .{};
+            }
+        };
+
         fn rebuildMarkerCache(self: *Self) !void {
             if (!marker_enabled) return;
 
             self.marker_cache.clear();
 
-            const RebuildContext = struct {
-                cache: *MarkerCache,
-                current_leaf: u32 = 0,
-                current_weight: u32 = 0,
+            var ctx = MarkerIndexContext{ .cache = &self.marker_cache };
+            try self.walk(&ctx, MarkerIndexContext.walker);
 
-                fn walker(ctx: *anyopaque, data: *const T, idx: u32) Node.WalkerResult {
-                    _ = idx;
-                    const context = @as(*@This(), @ptrCast(@alignCast(ctx)));
+            self.marker_cache.version = self.version;
+        }
 
-                    const tag = std.meta.activeTag(data.*);
+        /// The cache is only worth keeping if it still agrees with the tree;
+        /// boundary rewrites at the front would have shifted every index.
+        fn markerCacheMatchesTree(self: *const Self) bool {
+            const counts = self.root.metrics().marker_counts;
+            inline for (T.MarkerTypes, 0..) |mt, i| {
+                if (self.marker_cache.live(mt).len != counts[i]) return false;
+            }
+            return true;
+        }
 
-                    var is_marker = false;
-                    inline for (T.MarkerTypes) |mt| {
-                        if (tag == mt) {
-                            is_marker = true;
-                            break;
+        /// Append items at the end. Unlike insert_slice, a current marker cache
+        /// stays current by indexing only the appended tail, so streaming appends
+        /// cost O(appended items) instead of a rebuild on the next line lookup.
+        pub fn appendSlice(self: *Self, items: []const T) !void {
+            const old_count = self.count();
+            if (comptime !marker_enabled) {
+                return self.insert_slice(old_count, items);
+            } else {
+                if (items.len == 0) return;
+
+                const keep_cache = self.marker_cache.version == self.version and old_count > 0;
+
+                // The boundary join may rewrite the old last leaf, so re-index from it
+                const reindex_leaf = if (keep_cache) old_count - 1 else 0;
+                const reindex_weight = if (keep_cache)
+                    self.root.metrics().weight() - itemWeight(self.get(reindex_leaf).?)
+                else
+                    0;
+
+                try self.insert_slice(old_count, items);
+
+                if (!keep_cache) return;
+
+                const cache = &self.marker_cache;
+                const abs_leaf = cache.leaf_base + reindex_leaf;
+                inline for (T.MarkerTypes, 0..) |mt, i| {
+                    if (cache.positions.getPtr(mt)) |list| {
+                        while (list.items.len > cache.heads[i] and list.items[list.items.len - 1].leaf_index >= abs_leaf) {
+                            list.items.len -= 1;
                         }
                     }
+                }
 
-                    const leaf_weight = if (@hasDecl(T, "Metrics")) blk: {
-                        if (@hasDecl(T, "measure")) {
-                            const metrics = data.measure();
-                            break :blk if (@hasDecl(T.Metrics, "weight")) metrics.weight() else 1;
-                        }
-                        break :blk 1;
-                    } else 1;
-
-                    if (is_marker) {
-                        const gop = context.cache.positions.getOrPut(tag) catch |e| {
-                            return .{ .keep_walking = false, .err = e };
-                        };
-                        if (!gop.found_existing) {
-                            gop.value_ptr.* = .{};
-                        }
-
-                        gop.value_ptr.append(context.cache.allocator, .{
-                            .leaf_index = context.current_leaf,
-                            .global_weight = context.current_weight,
-                        }) catch |e| {
-                            return .{ .keep_walking = false, .err = e };
-                        };
-                    }
+                var ctx = MarkerIndexContext{
+                    .cache = cache,
+                    .current_leaf = abs_leaf,
+                    .current_weight = cache.weight_base + reindex_weight,
+                };
+                // On failure the cache stays stale and is rebuilt on the next lookup
+                self.walk_from(reindex_leaf, &ctx, MarkerIndexContext.walker) catch return;
 
-                    context.current_leaf += 1;
-                    context.current_weight += leaf_weight;
-                    return .{};
+                if (self.markerCacheMatchesTree()) {
+                    cache.version = self.version;
                 }
-            };
+            }
+        }
 
-            var ctx = RebuildContext{ .cache = &self.marker_cache };
-            try self.walk(&ctx, RebuildContext.walker);
+        /// Remove the first n items. A current marker cache is kept current by
+        /// skipping past the dropped markers rather than rebuilding it.
+        pub fn deletePrefix(self: *Self, n: u32) !void {
+            if (n == 0) return;
 
-            self.marker_cache.version = self.version;
+            const keep_cache = if (comptime marker_enabled) self.marker_cache.version == self.version else false;
+
+            const split_result = try Node.split_at(self.root, n, self.allocator, self.empty_leaf);
+            self.root = split_result.right;
+
+            self.version += 1;
+            try self.applyEndsInvariant();
+
+            if (comptime marker_enabled) {
+                if (!keep_cache) return;
+
+                self.marker_cache.advance(split_result.left.metrics());
+                if (self.markerCacheMatchesTree()) {
+                    self.marker_cache.version = self.version;
+                }
+            }
         }
 
         pub fn markerCount(self: *Self, tag: std.meta.Tag(T)) u32 {
@@ -1201,8 +1383,7 @@ pub fn Rope(comptime T: type) type {
                 self.rebuildMarkerCache() catch return 0;
             }
 
-            const list = self.marker_cache.positions.get(tag) orelse return 0;
-            return @intCast(list.items.len);
+            return @intCast(self.marker_cache.live(tag).len);
         }
 
         pub fn getMarker(self: *Self, tag: std.meta.Tag(T), occurrence: u32) ?MarkerPosition {
@@ -1212,9 +1393,13 @@ pub fn Rope(comptime T: type) type {
                 self.rebuildMarkerCache() catch return null;
             }
 
-            const list = self.marker_cache.positions.get(tag) orelse return null;
-            if (occurrence >= list.items.len) return null;
-            return list.items[occurrence];
+            const live = self.marker_cache.live(tag);
+            if (occurrence >= live.len) return null;
+            const pos = live[occurrence];
+            return .{
+                .leaf_index = pos.leaf_index - self.marker_cache.leaf_base,
+                .global_weight = pos.global_weight - self.marker_cache.weight_base,
+            };
         }
     };
 }
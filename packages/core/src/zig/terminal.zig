@@ -4,6 +4,7 @@ const atomic = std.atomic;
 const assert = std.debug.assert;
 const ansi = @import("ansi.zig");
 const utf8 = @import("utf8.zig");
+const palette = @import("palette.zig");
 
 const WidthMethod = utf8.WidthMethod;
 
@@ -14,6 +15,8 @@ pub const Capabilities = struct {
     kitty_keyboard: bool = false,
     kitty_graphics: bool = false,
     rgb: bool = false,
+    // Palette depth for TERMs limited to 16 colors, used when rgb is not detected
+    color_depth: palette.ColorDepth = .truecolor,
     unicode: WidthMethod = .unicode,
     sgr_pixels: bool = false,
     color_scheme_updates: bool = false,
@@ -271,6 +274,21 @@ fn checkEnvironmentOverrides(self: *Terminal) void {
         }
     }
 
+    // *256color terminals usually render truecolor even when COLORTERM is not
+    // passed through (ssh, tmux), so only genuinely limited TERMs downgrade.
+    // 256-color output stays available through setColorDepth.
+    if (env_map.get("TERM")) |term| {
+        if (std.mem.eql(u8, term, "linux") or
+            std.mem.eql(u8, term, "ansi") or
+            std.mem.eql(u8, term, "cygwin") or
+            std.mem.startsWith(u8, term, "vt") or
+            std.mem.endsWith(u8, term, "-16color") or
+            std.mem.endsWith(u8, term, "-color"))
+        {
+            self.caps.color_depth = .ansi16;
+        }
+    }
+
     if (env_map.get("TERMUX_VERSION")) |_| {
         self.caps.unicode = .wcwidth;
     }
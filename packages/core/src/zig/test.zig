@@ -25,6 +25,7 @@ const segment_merge_tests = @import("tests/segment-merge.test.zig");
 const word_wrap_editing_tests = @import("tests/word-wrap-editing_test.zig");
 const renderer_tests = @import("tests/renderer_test.zig");
 const terminal_tests = @import("tests/terminal_test.zig");
+const palette_tests = @import("tests/palette_test.zig");
 const mem_registry_tests = @import("tests/mem-registry_test.zig");
 const memory_leak_regression_tests = @import("tests/memory_leak_regression_test.zig");
 const wrap_cache_perf_tests = @import("tests/wrap-cache-perf_test.zig");
@@ -57,6 +58,7 @@ comptime {
     _ = word_wrap_editing_tests;
     _ = renderer_tests;
     _ = terminal_tests;
+    _ = palette_tests;
     _ = mem_registry_tests;
     _ = memory_leak_regression_tests;
     _ = wrap_cache_perf_tests;
@@ -1569,3 +1569,256 @@ test "OptimizedBuffer - alpha blending with no link clears underlying link" {
     // Link should no longer be tracked
     try std.testing.expect(!ansi.TextAttributes.hasLink(result_cell.attributes));
 }
+
+test "OptimizedBuffer - rgba8 color storage round-trips quantized colors" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var buf = try OptimizedBuffer.init(
+        std.testing.allocator,
+        8,
+        4,
+        .{ .pool = pool, .id = "packed-buffer", .color_storage = .rgba8 },
+    );
+    defer buf.deinit();
+
+    try std.testing.expectEqual(buffer_mod.ColorStorage.rgba8, buf.getColorStorage());
+    try std.testing.expectEqual(@as(usize, 0), buf.buffer.fg.len);
+    try std.testing.expectEqual(@as(usize, 32), buf.buffer.fg8.len);
+    try std.testing.expect(buf.getFgPtr() == null);
+    try std.testing.expect(buf.getBgPtr() == null);
+
+    try buf.clear(.{ 0.0, 0.0, 0.0, 1.0 }, null);
+    try buf.drawText("Hi", 1, 1, .{ 1.0, 0.5, 0.25, 1.0 }, .{ 0.2, 0.4, 0.6, 1.0 }, 0);
+
+    const cell = buf.get(1, 1).?;
+    try std.testing.expectEqual(@as(u32, 'H'), cell.char);
+    try std.testing.expectApproxEqAbs(@as(f32, 1.0), cell.fg[0], 1.0 / 255.0);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.5), cell.fg[1], 1.0 / 255.0);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.25), cell.fg[2], 1.0 / 255.0);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.6), cell.bg[2], 1.0 / 255.0);
+    try std.testing.expectEqual(@as(f32, 1.0), cell.bg[3]);
+
+    try std.testing.expectEqual(buffer_mod.packRGBA8(.{ 1.0, 0.5, 0.25, 1.0 }), buf.buffer.fg8[1 * 8 + 1]);
+}
+
+test "OptimizedBuffer - rgba8 color storage blends and resizes" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var buf = try OptimizedBuffer.init(
+        std.testing.allocator,
+        4,
+        2,
+        .{ .pool = pool, .id = "packed-buffer", .color_storage = .rgba8 },
+    );
+    defer buf.deinit();
+
+    try buf.clear(.{ 0.0, 0.0, 1.0, 1.0 }, null);
+    try buf.fillRect(0, 0, 4, 2, .{ 1.0, 0.0, 0.0, 0.5 });
+
+    const blended = buf.get(0, 0).?;
+    try std.testing.expect(blended.bg[0] > 0.0);
+    try std.testing.expect(blended.bg[2] > 0.0);
+
+    try buf.resize(10, 3);
+    try std.testing.expectEqual(@as(usize, 30), buf.buffer.bg8.len);
+    const cell = buf.get(9, 2).?;
+    try std.testing.expectEqual(@as(u32, 32), cell.char);
+    try std.testing.expectEqual(@as(f32, 1.0), cell.bg[3]);
+}
+
+test "OptimizedBuffer - drawFrameBuffer converts between color storages" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var float_buf = try OptimizedBuffer.init(std.testing.allocator, 6, 2, .{ .pool = pool, .id = "float" });
+    defer float_buf.deinit();
+    var packed_buf = try OptimizedBuffer.init(std.testing.allocator, 6, 2, .{ .pool = pool, .id = "packed", .color_storage = .rgba8 });
+    defer packed_buf.deinit();
+
+    try float_buf.clear(.{ 0.0, 0.0, 0.0, 1.0 }, null);
+    try float_buf.drawText("abc", 0, 0, .{ 0.0, 1.0, 0.0, 1.0 }, .{ 0.5, 0.5, 0.5, 1.0 }, 0);
+
+    try packed_buf.clear(.{ 0.0, 0.0, 0.0, 1.0 }, null);
+    packed_buf.drawFrameBuffer(0, 0, float_buf, null, null, null, null);
+
+    const packed_cell = packed_buf.get(1, 0).?;
+    try std.testing.expectEqual(@as(u32, 'b'), packed_cell.char);
+    try std.testing.expectEqual(buffer_mod.packRGBA8(.{ 0.0, 1.0, 0.0, 1.0 }), packed_buf.buffer.fg8[1]);
+
+    try float_buf.clear(.{ 0.0, 0.0, 0.0, 1.0 }, null);
+    float_buf.drawFrameBuffer(0, 0, packed_buf, null, null, null, null);
+
+    const float_cell = float_buf.get(2, 0).?;
+    try std.testing.expectEqual(@as(u32, 'c'), float_cell.char);
+    try std.testing.expectApproxEqAbs(@as(f32, 0.5), float_cell.bg[0], 1.0 / 255.0);
+}
+
+test "OptimizedBuffer - scrollRowsRaw shifts rows and fills the uncovered ones" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var buf = try OptimizedBuffer.init(std.testing.allocator, 4, 5, .{ .pool = pool, .id = "scroll-buffer" });
+    defer buf.deinit();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+    try buf.clear(bg, null);
+    const rows = [_][]const u8{ "aaaa", "bbbb", "cccc", "dddd", "eeee" };
+    for (rows, 0..) |row, i| {
+        try buf.drawText(row, 0, @intCast(i), fg, bg, 0);
+    }
+
+    const fill = buffer_mod.Cell{ .char = ' ', .fg = .{ 0, 0, 0, 0 }, .bg = .{ 0, 0, 0, 0 }, .attributes = 0 };
+
+    // Scroll rows 1..4 up by one: b c d -> c d _
+    buf.scrollRowsRaw(1, 4, 1, fill);
+    try std.testing.expectEqual(@as(u32, 'a'), buf.get(0, 0).?.char);
+    try std.testing.expectEqual(@as(u32, 'c'), buf.get(3, 1).?.char);
+    try std.testing.expectEqual(@as(u32, 'd'), buf.get(0, 2).?.char);
+    try std.testing.expectEqual(@as(u32, ' '), buf.get(2, 3).?.char);
+    try std.testing.expectEqual(@as(f32, 0.0), buf.get(2, 3).?.bg[3]);
+    try std.testing.expectEqual(@as(u32, 'e'), buf.get(0, 4).?.char);
+
+    // And back down by two over the whole buffer
+    buf.scrollRowsRaw(0, 5, -2, fill);
+    try std.testing.expectEqual(@as(u32, ' '), buf.get(0, 0).?.char);
+    try std.testing.expectEqual(@as(u32, ' '), buf.get(0, 1).?.char);
+    try std.testing.expectEqual(@as(u32, 'a'), buf.get(0, 2).?.char);
+    try std.testing.expectEqual(@as(u32, 'c'), buf.get(0, 3).?.char);
+    try std.testing.expectEqual(@as(u32, 'd'), buf.get(0, 4).?.char);
+}
+
+test "OptimizedBuffer - row tracking marks written rows dirty" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var buf = try OptimizedBuffer.init(std.testing.allocator, 8, 6, .{ .pool = pool, .id = "rows", .track_rows = true });
+    defer buf.deinit();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+
+    // A fresh buffer starts fully dirty
+    try std.testing.expectEqual(@as(u32, 6), buf.getDirtyRowCount());
+    buf.clearDirtyRows();
+    try std.testing.expectEqual(@as(u32, 0), buf.getDirtyRowCount());
+
+    try buf.drawText("hi", 1, 1, fg, bg, 0);
+    try buf.fillRect(0, 3, 4, 2, bg);
+    try std.testing.expect(!buf.isRowDirty(0));
+    try std.testing.expect(buf.isRowDirty(1));
+    try std.testing.expect(!buf.isRowDirty(2));
+    try std.testing.expect(buf.isRowDirty(3));
+    try std.testing.expect(buf.isRowDirty(4));
+    try std.testing.expect(!buf.isRowDirty(5));
+    try std.testing.expectEqual(@as(u32, 3), buf.getDirtyRowCount());
+
+    var src = try OptimizedBuffer.init(std.testing.allocator, 8, 1, .{ .pool = pool, .id = "rows-src" });
+    defer src.deinit();
+    try src.clear(bg, null);
+
+    buf.clearDirtyRows();
+    buf.drawFrameBuffer(0, 5, src, null, null, null, null);
+    try std.testing.expectEqual(@as(u32, 1), buf.getDirtyRowCount());
+    try std.testing.expect(buf.isRowDirty(5));
+
+    buf.clearDirtyRows();
+    try buf.clear(bg, null);
+    try std.testing.expectEqual(@as(u32, 6), buf.getDirtyRowCount());
+}
+
+test "OptimizedBuffer - repeated clear only resets rows written since" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var buf = try OptimizedBuffer.init(std.testing.allocator, 8, 6, .{ .pool = pool, .id = "rows-clear", .track_rows = true });
+    defer buf.deinit();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+    try buf.clear(bg, null);
+    buf.clearDirtyRows();
+
+    // Nothing was drawn, so clearing again leaves every row clean
+    try buf.clear(bg, null);
+    try std.testing.expectEqual(@as(u32, 0), buf.getDirtyRowCount());
+
+    try buf.drawText("hi", 0, 2, fg, bg, 0);
+    buf.clearDirtyRows();
+    try buf.clear(bg, null);
+    try std.testing.expectEqual(@as(u32, 1), buf.getDirtyRowCount());
+    try std.testing.expect(buf.isRowDirty(2));
+    try std.testing.expectEqual(@as(u32, ' '), buf.get(0, 2).?.char);
+
+    // A different fill resets everything
+    buf.clearDirtyRows();
+    try buf.clear(.{ 0.1, 0.1, 0.1, 1.0 }, null);
+    try std.testing.expectEqual(@as(u32, 6), buf.getDirtyRowCount());
+}
+
+test "OptimizedBuffer - row hashes are cached and match identical rows" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var buf = try OptimizedBuffer.init(std.testing.allocator, 8, 3, .{ .pool = pool, .id = "hashes", .track_rows = true });
+    defer buf.deinit();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+    try buf.clear(bg, null);
+    try buf.drawText("same", 0, 0, fg, bg, 0);
+    try buf.drawText("same", 0, 1, fg, bg, 0);
+    try buf.drawText("diff", 0, 2, fg, bg, 0);
+
+    const h0 = buf.getRowHash(0);
+    try std.testing.expectEqual(h0, buf.getRowHash(1));
+    try std.testing.expect(h0 != buf.getRowHash(2));
+    try std.testing.expectEqual(h0, buf.getRowHash(0));
+
+    // A write invalidates only the cached hash of its own row
+    buf.setRaw(0, 1, .{ .char = 'S', .fg = fg, .bg = bg, .attributes = 0 });
+    try std.testing.expect(h0 != buf.getRowHash(1));
+    try std.testing.expectEqual(h0, buf.getRowHash(0));
+
+    // Without tracking the hash is computed on demand and agrees
+    try buf.setRowTracking(false);
+    try std.testing.expect(!buf.getRowTracking());
+    try std.testing.expectEqual(h0, buf.getRowHash(0));
+    try std.testing.expect(buf.isRowDirty(0));
+}
+
+test "OptimizedBuffer - clearRect replaces cells without blending" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var buf = try OptimizedBuffer.init(std.testing.allocator, 6, 3, .{ .pool = pool, .id = "clear-rect" });
+    defer buf.deinit();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.2, 0.2, 0.2, 1.0 };
+    const transparent = RGBA{ 0.0, 0.0, 0.0, 0.0 };
+    try buf.clear(bg, null);
+    try buf.drawText("abcdef", 0, 0, fg, bg, 0);
+    try buf.drawText("ghijkl", 0, 1, fg, bg, 0);
+
+    buf.clearRect(1, 0, 3, 2, transparent);
+    try std.testing.expectEqual(@as(u32, 'a'), buf.get(0, 0).?.char);
+    try std.testing.expectEqual(@as(u32, ' '), buf.get(1, 0).?.char);
+    try std.testing.expectEqual(@as(f32, 0.0), buf.get(2, 1).?.bg[3]);
+    try std.testing.expectEqual(@as(u32, 'e'), buf.get(4, 0).?.char);
+
+    // With a scissor active only the visible part is cleared
+    try buf.pushScissorRect(5, 0, 1, 1);
+    buf.clearRect(0, 0, 6, 2, transparent);
+    buf.popScissorRect();
+    try std.testing.expectEqual(@as(u32, 'e'), buf.get(4, 0).?.char);
+    try std.testing.expectEqual(@as(u32, ' '), buf.get(5, 0).?.char);
+    try std.testing.expectEqual(@as(u32, 'l'), buf.get(5, 1).?.char);
+
+    // Clipped to the buffer
+    buf.clearRect(4, 2, 10, 10, transparent);
+    try std.testing.expectEqual(@as(f32, 0.0), buf.get(5, 2).?.bg[3]);
+    try std.testing.expectEqual(@as(f32, 1.0), buf.get(3, 2).?.bg[3]);
+}
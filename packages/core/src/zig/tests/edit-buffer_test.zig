@@ -1343,3 +1343,145 @@ test "EditBuffer - setText resets add_buffer" {
     len = eb.getText(&buffer);
     try std.testing.expectEqualStrings("Reset More", buffer[0..len]);
 }
+
+test "EditBuffer - thousands of replaceText calls keep undo history intact" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var eb = try EditBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer eb.deinit();
+
+    var text_buf: [32]u8 = undefined;
+    var i: usize = 0;
+    while (i < 2000) : (i += 1) {
+        const text = try std.fmt.bufPrint(&text_buf, "version {d}", .{i});
+        try eb.replaceText(text);
+    }
+
+    // Every version is still reachable through undo, so nothing was released
+    try std.testing.expect(eb.tb.mem_registry.getUsedSlots() > 2000);
+
+    var out: [32]u8 = undefined;
+    _ = try eb.undo();
+    var len = eb.getText(&out);
+    try std.testing.expectEqualStrings("version 1998", out[0..len]);
+
+    // Dropping the history makes the old versions reclaimable
+    try eb.setText("fresh");
+    _ = try eb.tb.reclaimMemBuffers();
+    try std.testing.expectEqual(@as(usize, 2), eb.tb.mem_registry.getUsedSlots());
+
+    len = eb.getText(&out);
+    try std.testing.expectEqualStrings("fresh", out[0..len]);
+}
+
+test "EditBuffer - insertText applies at every cursor as one undo step" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var eb = try EditBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer eb.deinit();
+
+    try eb.setText("abc\ndef\nghi");
+    try eb.setCursor(0, 1);
+    try eb.addCursor(2, 3);
+    try eb.addCursor(1, 1);
+    try eb.addCursor(1, 1);
+    try std.testing.expectEqual(@as(usize, 3), eb.getCursorCount());
+
+    try eb.insertText("X");
+
+    var out: [64]u8 = undefined;
+    var len = eb.getText(&out);
+    try std.testing.expectEqualStrings("aXbc\ndXef\nghiX", out[0..len]);
+
+    // Cursors keep their order, so the primary stays first
+    try std.testing.expectEqual(@as(u32, 2), eb.getCursor(0).?.col);
+    try std.testing.expectEqual(@as(u32, 2), eb.getCursor(1).?.row);
+    try std.testing.expectEqual(@as(u32, 4), eb.getCursor(1).?.col);
+    try std.testing.expectEqual(@as(u32, 1), eb.getCursor(2).?.row);
+    try std.testing.expectEqual(@as(u32, 2), eb.getCursor(2).?.col);
+
+    _ = try eb.undo();
+    len = eb.getText(&out);
+    try std.testing.expectEqualStrings("abc\ndef\nghi", out[0..len]);
+    try std.testing.expect(!eb.canUndo());
+}
+
+test "EditBuffer - multi-cursor newline insert moves later cursors and highlights" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var eb = try EditBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer eb.deinit();
+
+    try eb.setText("ab\ncd\nef");
+    try eb.tb.addHighlight(2, 0, 2, 1, 0, 0);
+
+    try eb.setCursor(0, 1);
+    try eb.addCursor(1, 1);
+    try eb.insertText("\n");
+
+    var out: [64]u8 = undefined;
+    const len = eb.getText(&out);
+    try std.testing.expectEqualStrings("a\nb\nc\nd\nef", out[0..len]);
+
+    try std.testing.expectEqual(@as(u32, 1), eb.getCursor(0).?.row);
+    try std.testing.expectEqual(@as(u32, 0), eb.getCursor(0).?.col);
+    try std.testing.expectEqual(@as(u32, 3), eb.getCursor(1).?.row);
+    try std.testing.expectEqual(@as(u32, 0), eb.getCursor(1).?.col);
+
+    try std.testing.expectEqual(@as(usize, 0), eb.tb.getLineHighlights(2).len);
+    try std.testing.expectEqual(@as(usize, 1), eb.tb.getLineHighlights(4).len);
+}
+
+test "EditBuffer - multi-cursor backspace merges touching deletes" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var eb = try EditBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer eb.deinit();
+
+    try eb.setText("abcd\nxy");
+    try eb.setCursor(0, 2);
+    try eb.addCursor(0, 3);
+    try eb.addCursor(1, 0);
+    try eb.backspace();
+
+    var out: [64]u8 = undefined;
+    const len = eb.getText(&out);
+    try std.testing.expectEqualStrings("adxy", out[0..len]);
+
+    // The two cursors inside "abcd" collapsed onto one spot
+    try std.testing.expectEqual(@as(usize, 2), eb.getCursorCount());
+    try std.testing.expectEqual(@as(u32, 0), eb.getCursor(0).?.row);
+    try std.testing.expectEqual(@as(u32, 1), eb.getCursor(0).?.col);
+    try std.testing.expectEqual(@as(u32, 0), eb.getCursor(1).?.row);
+    try std.testing.expectEqual(@as(u32, 2), eb.getCursor(1).?.col);
+}
+
+test "EditBuffer - multi-cursor deleteForward joins lines" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var eb = try EditBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer eb.deinit();
+
+    try eb.setText("a\nb\nc");
+    try eb.setCursor(0, 1);
+    try eb.addCursor(1, 1);
+    try eb.addCursor(2, 1);
+    try eb.deleteForward();
+
+    var out: [64]u8 = undefined;
+    const len = eb.getText(&out);
+    try std.testing.expectEqualStrings("abc", out[0..len]);
+    try std.testing.expectEqual(@as(u32, 1), eb.getTextBuffer().getLineCount());
+
+    try std.testing.expectEqual(@as(u32, 1), eb.getCursor(0).?.col);
+    try std.testing.expectEqual(@as(u32, 2), eb.getCursor(1).?.col);
+    try std.testing.expectEqual(@as(u32, 3), eb.getCursor(2).?.col);
+
+    eb.clearExtraCursors();
+    try std.testing.expectEqual(@as(usize, 1), eb.getCursorCount());
+}
@@ -3,13 +3,15 @@ const mem_registry = @import("../mem-registry.zig");
 
 const MemRegistry = mem_registry.MemRegistry;
 const MemRegistryError = mem_registry.MemRegistryError;
+const MemId = mem_registry.MemId;
+const MAX_BUFFERS = mem_registry.MAX_BUFFERS;
 
 test "MemRegistry - init and deinit" {
     var registry = MemRegistry.init(std.testing.allocator);
     defer registry.deinit();
 
     try std.testing.expectEqual(@as(usize, 0), registry.getUsedSlots());
-    try std.testing.expectEqual(@as(usize, 255), registry.getFreeSlots());
+    try std.testing.expectEqual(MAX_BUFFERS, registry.getFreeSlots());
 }
 
 test "MemRegistry - register owned memory" {
@@ -19,9 +21,9 @@ test "MemRegistry - register owned memory" {
     const text = try std.testing.allocator.dupe(u8, "Hello, World!");
     const id = try registry.register(text, true);
 
-    try std.testing.expectEqual(@as(u8, 0), id);
+    try std.testing.expectEqual(@as(MemId, 0), id);
     try std.testing.expectEqual(@as(usize, 1), registry.getUsedSlots());
-    try std.testing.expectEqual(@as(usize, 254), registry.getFreeSlots());
+    try std.testing.expectEqual(MAX_BUFFERS - 1, registry.getFreeSlots());
 
     const retrieved = registry.get(id);
     try std.testing.expect(retrieved != null);
@@ -35,7 +37,7 @@ test "MemRegistry - register non-owned memory" {
     const text = "Hello, World!";
     const id = try registry.register(text, false);
 
-    try std.testing.expectEqual(@as(u8, 0), id);
+    try std.testing.expectEqual(@as(MemId, 0), id);
     try std.testing.expectEqual(@as(usize, 1), registry.getUsedSlots());
 
     const retrieved = registry.get(id);
@@ -55,11 +57,11 @@ test "MemRegistry - register multiple buffers" {
     const id2 = try registry.register(text2, false);
     const id3 = try registry.register(text3, false);
 
-    try std.testing.expectEqual(@as(u8, 0), id1);
-    try std.testing.expectEqual(@as(u8, 1), id2);
-    try std.testing.expectEqual(@as(u8, 2), id3);
+    try std.testing.expectEqual(@as(MemId, 0), id1);
+    try std.testing.expectEqual(@as(MemId, 1), id2);
+    try std.testing.expectEqual(@as(MemId, 2), id3);
     try std.testing.expectEqual(@as(usize, 3), registry.getUsedSlots());
-    try std.testing.expectEqual(@as(usize, 252), registry.getFreeSlots());
+    try std.testing.expectEqual(MAX_BUFFERS - 3, registry.getFreeSlots());
 
     try std.testing.expectEqualStrings("First", registry.get(id1).?);
     try std.testing.expectEqualStrings("Second", registry.get(id2).?);
@@ -132,7 +134,7 @@ test "MemRegistry - clear owned buffers" {
     registry.clear();
 
     try std.testing.expectEqual(@as(usize, 0), registry.getUsedSlots());
-    try std.testing.expectEqual(@as(usize, 255), registry.getFreeSlots());
+    try std.testing.expectEqual(MAX_BUFFERS, registry.getFreeSlots());
 }
 
 test "MemRegistry - clear non-owned buffers" {
@@ -156,12 +158,12 @@ test "MemRegistry - max capacity" {
     defer registry.deinit();
 
     var i: usize = 0;
-    while (i < 255) : (i += 1) {
+    while (i < MAX_BUFFERS) : (i += 1) {
         const text = "test";
         _ = try registry.register(text, false);
     }
 
-    try std.testing.expectEqual(@as(usize, 255), registry.getUsedSlots());
+    try std.testing.expectEqual(MAX_BUFFERS, registry.getUsedSlots());
     try std.testing.expectEqual(@as(usize, 0), registry.getFreeSlots());
 
     const text = "overflow";
@@ -175,13 +177,13 @@ test "MemRegistry - clear and reuse" {
 
     const text1 = "First";
     const id1 = try registry.register(text1, false);
-    try std.testing.expectEqual(@as(u8, 0), id1);
+    try std.testing.expectEqual(@as(MemId, 0), id1);
 
     registry.clear();
 
     const text2 = "Second";
     const id2 = try registry.register(text2, false);
-    try std.testing.expectEqual(@as(u8, 0), id2);
+    try std.testing.expectEqual(@as(MemId, 0), id2);
     try std.testing.expectEqualStrings("Second", registry.get(id2).?);
 }
 
@@ -345,9 +347,9 @@ test "MemRegistry - slot reuse after unregister" {
     const id2 = try registry.register(text2, false);
     const id3 = try registry.register(text3, false);
 
-    try std.testing.expectEqual(@as(u8, 0), id1);
-    try std.testing.expectEqual(@as(u8, 1), id2);
-    try std.testing.expectEqual(@as(u8, 2), id3);
+    try std.testing.expectEqual(@as(MemId, 0), id1);
+    try std.testing.expectEqual(@as(MemId, 1), id2);
+    try std.testing.expectEqual(@as(MemId, 2), id3);
     try std.testing.expectEqual(@as(usize, 3), registry.getUsedSlots());
 
     // Unregister middle slot
@@ -357,7 +359,7 @@ test "MemRegistry - slot reuse after unregister" {
     // Register new buffer - should reuse slot 1
     const text4 = "Fourth";
     const id4 = try registry.register(text4, false);
-    try std.testing.expectEqual(@as(u8, 1), id4);
+    try std.testing.expectEqual(@as(MemId, 1), id4);
     try std.testing.expectEqual(@as(usize, 3), registry.getUsedSlots());
 
     // Verify contents
@@ -374,7 +376,7 @@ test "MemRegistry - thousands of register/unregister cycles" {
     // This ensures slot reuse works over long periods
     var cycle: usize = 0;
     while (cycle < 1000) : (cycle += 1) {
-        var ids: [10]u8 = undefined;
+        var ids: [10]MemId = undefined;
 
         // Register 10 buffers
         var i: usize = 0;
@@ -400,24 +402,19 @@ test "MemRegistry - thousands of register/unregister cycles" {
     try std.testing.expectEqualStrings("final", registry.get(id).?);
 }
 
-test "MemRegistry - max capacity 255 with slot reuse" {
+test "MemRegistry - max capacity with slot reuse" {
     var registry = MemRegistry.init(std.testing.allocator);
     defer registry.deinit();
 
-    // Fill all 255 slots
-    // NOTE: This test ensures the registry respects the u8 ID limit (max 255 slots).
-    // If the ID type is changed from u8 to u16, this test would fail because:
-    // 1. The test fills exactly 255 slots
-    // 2. It expects OutOfMemory error on the 256th registration
-    // 3. With u16, the limit would be 65535, so no error would occur
+    // Fill every slot; ids are handed out in order while none were freed
     var i: usize = 0;
-    var ids: [255]u8 = undefined;
-    while (i < 255) : (i += 1) {
+    while (i < MAX_BUFFERS) : (i += 1) {
         const text = "test";
-        ids[i] = try registry.register(text, false);
+        const id = try registry.register(text, false);
+        try std.testing.expectEqual(@as(MemId, @intCast(i)), id);
     }
 
-    try std.testing.expectEqual(@as(usize, 255), registry.getUsedSlots());
+    try std.testing.expectEqual(MAX_BUFFERS, registry.getUsedSlots());
     try std.testing.expectEqual(@as(usize, 0), registry.getFreeSlots());
 
     // Should fail to register one more
@@ -426,14 +423,14 @@ test "MemRegistry - max capacity 255 with slot reuse" {
     try std.testing.expectError(MemRegistryError.OutOfMemory, result);
 
     // Unregister one slot
-    try registry.unregister(ids[100]);
-    try std.testing.expectEqual(@as(usize, 254), registry.getUsedSlots());
+    try registry.unregister(300);
+    try std.testing.expectEqual(MAX_BUFFERS - 1, registry.getUsedSlots());
     try std.testing.expectEqual(@as(usize, 1), registry.getFreeSlots());
 
     // Now we should be able to register again
     const new_text = "reused";
     const new_id = try registry.register(new_text, false);
-    try std.testing.expectEqual(@as(u8, 100), new_id); // Should reuse slot 100
+    try std.testing.expectEqual(@as(MemId, 300), new_id); // Should reuse slot 300
     try std.testing.expectEqualStrings("reused", registry.get(new_id).?);
 }
 
@@ -456,18 +453,76 @@ test "MemRegistry - getFreeSlots accounts for unregistered slots" {
     var registry = MemRegistry.init(std.testing.allocator);
     defer registry.deinit();
 
-    try std.testing.expectEqual(@as(usize, 255), registry.getFreeSlots());
+    try std.testing.expectEqual(MAX_BUFFERS, registry.getFreeSlots());
 
     const id1 = try registry.register("test1", false);
     const id2 = try registry.register("test2", false);
     const id3 = try registry.register("test3", false);
 
-    try std.testing.expectEqual(@as(usize, 252), registry.getFreeSlots());
+    try std.testing.expectEqual(MAX_BUFFERS - 3, registry.getFreeSlots());
 
     try registry.unregister(id2);
-    try std.testing.expectEqual(@as(usize, 253), registry.getFreeSlots());
+    try std.testing.expectEqual(MAX_BUFFERS - 2, registry.getFreeSlots());
 
     try registry.unregister(id1);
     try registry.unregister(id3);
-    try std.testing.expectEqual(@as(usize, 255), registry.getFreeSlots());
+    try std.testing.expectEqual(MAX_BUFFERS, registry.getFreeSlots());
+}
+
+test "MemRegistry - mapped regions are unmapped on unregister and clear" {
+    if (@import("builtin").os.tag == .windows) return error.SkipZigTest;
+
+    var registry = MemRegistry.init(std.testing.allocator);
+    defer registry.deinit();
+
+    const page = std.heap.page_size_min;
+    const first = try std.posix.mmap(null, page, std.posix.PROT.READ | std.posix.PROT.WRITE, .{ .TYPE = .PRIVATE, .ANONYMOUS = true }, -1, 0);
+    @memset(first, 'a');
+    const second = try std.posix.mmap(null, page, std.posix.PROT.READ, .{ .TYPE = .PRIVATE, .ANONYMOUS = true }, -1, 0);
+
+    const first_id = try registry.registerMapped(first);
+    const second_id = try registry.registerMapped(second);
+
+    try std.testing.expectEqual(@as(u8, 'a'), registry.get(first_id).?[page - 1]);
+    try std.testing.expectEqual(@as(usize, page), registry.get(second_id).?.len);
+
+    try registry.unregister(first_id);
+    try std.testing.expect(registry.get(first_id) == null);
+
+    // The freed slot is reused by a regular buffer, which must not be unmapped
+    const text = try std.testing.allocator.dupe(u8, "owned");
+    const owned_id = try registry.register(text, true);
+    try std.testing.expectEqual(first_id, owned_id);
+
+    registry.clear();
+    try std.testing.expectEqual(@as(usize, 0), registry.getUsedSlots());
+}
+
+test "MemRegistry - reclaimUnreferenced releases only unreferenced reclaimable slots" {
+    var registry = MemRegistry.init(std.testing.allocator);
+    defer registry.deinit();
+
+    const pinned = try registry.register("pinned", false);
+    const kept = try registry.register("kept", false);
+    const dropped = try registry.register(try std.testing.allocator.dupe(u8, "dropped"), true);
+    try registry.markReclaimable(kept);
+    try registry.markReclaimable(dropped);
+    try std.testing.expectEqual(@as(usize, 2), registry.reclaimable_count);
+
+    var referenced = try std.DynamicBitSetUnmanaged.initEmpty(std.testing.allocator, registry.getSlotCount());
+    defer referenced.deinit(std.testing.allocator);
+    referenced.set(kept);
+
+    // The owned buffer is freed on release; the testing allocator catches a leak
+    try std.testing.expectEqual(@as(usize, 1), registry.reclaimUnreferenced(&referenced));
+    try std.testing.expectEqual(@as(usize, 1), registry.reclaimable_count);
+    try std.testing.expectEqualStrings("pinned", registry.get(pinned).?);
+    try std.testing.expectEqualStrings("kept", registry.get(kept).?);
+    try std.testing.expect(registry.get(dropped) == null);
+
+    // Slots that were never marked survive an empty referenced set
+    referenced.unset(kept);
+    try std.testing.expectEqual(@as(usize, 1), registry.reclaimUnreferenced(&referenced));
+    try std.testing.expectEqual(@as(usize, 0), registry.reclaimable_count);
+    try std.testing.expectEqual(@as(usize, 1), registry.getUsedSlots());
 }
@@ -0,0 +1,40 @@
+const std = @import("std");
+const palette = @import("../palette.zig");
+
+test "palette - exact cube and grey colors map to themselves" {
+    var i: u16 = 16;
+    while (i < 256) : (i += 1) {
+        const index: u8 = @intCast(i);
+        try std.testing.expectEqual(index, palette.nearest256(palette.xterm256ToRgb(index)));
+    }
+}
+
+test "palette - nearest256 picks the grey ramp for near-greys" {
+    try std.testing.expectEqual(@as(u8, 16), palette.nearest256(.{ 0, 0, 0 }));
+    try std.testing.expectEqual(@as(u8, 231), palette.nearest256(.{ 255, 255, 255 }));
+    try std.testing.expectEqual(@as(u8, 196), palette.nearest256(.{ 250, 10, 5 }));
+    // 0x44 sits between cube levels 0 and 95 but right on a grey step
+    try std.testing.expectEqual(@as(u8, 238), palette.nearest256(.{ 68, 68, 68 }));
+}
+
+test "palette - nearest16 maps primaries to base colors" {
+    try std.testing.expectEqual(@as(u8, 0), palette.nearest16(.{ 10, 10, 10 }));
+    try std.testing.expectEqual(@as(u8, 9), palette.nearest16(.{ 250, 20, 20 }));
+    try std.testing.expectEqual(@as(u8, 1), palette.nearest16(.{ 200, 0, 0 }));
+    try std.testing.expectEqual(@as(u8, 15), palette.nearest16(.{ 250, 250, 250 }));
+}
+
+test "palette - cache memoizes lookups and resets on depth change" {
+    var cache = palette.PaletteCache{};
+
+    const a = cache.lookup(.ansi256, .{ 12, 200, 34 });
+    const b = cache.lookup(.ansi256, .{ 12, 200, 34 });
+    try std.testing.expectEqual(a, b);
+    try std.testing.expectEqual(palette.nearest256(.{ 12, 200, 34 }), a);
+    try std.testing.expectEqual(@as(u64, 1), cache.misses);
+    try std.testing.expectEqual(@as(u64, 1), cache.hits);
+
+    const c = cache.lookup(.ansi16, .{ 12, 200, 34 });
+    try std.testing.expectEqual(palette.nearest16(.{ 12, 200, 34 }), c);
+    try std.testing.expectEqual(@as(u64, 2), cache.misses);
+}
@@ -684,3 +684,549 @@ test "renderer - link transition mid-line" {
     }
     try std.testing.expect(count >= 2);
 }
+
+test "renderer - collectDirtySpans reports only changed regions" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    const current = try OptimizedBuffer.init(std.testing.allocator, 40, 3, .{ .pool = pool, .id = "current" });
+    defer current.deinit();
+    const next = try OptimizedBuffer.init(std.testing.allocator, 40, 3, .{ .pool = pool, .id = "next" });
+    defer next.deinit();
+
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+    try current.clear(bg, null);
+    try next.clear(bg, null);
+
+    // Row 0: change in the first block, row 1: untouched, row 2: change in the scalar tail
+    try next.drawText("X", 2, 0, .{ 1.0, 1.0, 1.0, 1.0 }, bg, 0);
+    try next.drawText("Y", 39, 2, .{ 1.0, 1.0, 1.0, 1.0 }, bg, 0);
+
+    var spans: std.ArrayListUnmanaged(renderer.DirtySpan) = .{};
+    defer spans.deinit(std.testing.allocator);
+    try spans.ensureTotalCapacity(std.testing.allocator, renderer.maxDirtySpans(40, 3));
+
+    renderer.collectDirtySpans(current, next, 0.00001, &spans);
+
+    try std.testing.expectEqual(@as(usize, 2), spans.items.len);
+    try std.testing.expectEqual(@as(u32, 0), spans.items[0].y);
+    try std.testing.expect(spans.items[0].start <= 2 and spans.items[0].end > 2);
+    try std.testing.expectEqual(@as(u32, 2), spans.items[1].y);
+    try std.testing.expect(spans.items[1].start <= 39 and spans.items[1].end == 40);
+
+    // A color change below the epsilon is not a change
+    next.buffer.fg[45] = .{ current.buffer.fg[45][0] + 0.000001, current.buffer.fg[45][1], current.buffer.fg[45][2], current.buffer.fg[45][3] };
+    renderer.collectDirtySpans(current, next, 0.00001, &spans);
+    try std.testing.expectEqual(@as(usize, 2), spans.items.len);
+    try std.testing.expectEqual(@as(u32, 2), renderer.dirtySpanRowCount(spans.items));
+
+    // Two spans on one row count as one changed row
+    try next.drawText("Z", 30, 0, .{ 1.0, 1.0, 1.0, 1.0 }, bg, 0);
+    renderer.collectDirtySpans(current, next, 0.00001, &spans);
+    try std.testing.expectEqual(@as(usize, 3), spans.items.len);
+    try std.testing.expectEqual(@as(u32, 2), renderer.dirtySpanRowCount(spans.items));
+}
+
+test "renderer - sparse frame only emits changed cells" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var cli_renderer = try CliRenderer.create(
+        std.testing.allocator,
+        80,
+        24,
+        pool,
+        true,
+    );
+    defer cli_renderer.destroy();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+
+    try cli_renderer.getNextBuffer().drawText("Hello World", 0, 0, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("Last line", 0, 23, fg, bg, 0);
+    cli_renderer.render(false);
+
+    try cli_renderer.getNextBuffer().drawText("Hello Xorld", 0, 0, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("Last line", 0, 23, fg, bg, 0);
+    cli_renderer.render(false);
+
+    const output = cli_renderer.getLastOutputForTest();
+    try std.testing.expect(std.mem.indexOf(u8, output, "X") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "ello") == null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "Last") == null);
+    try std.testing.expectEqual(@as(u32, 1), cli_renderer.renderStats.cellsUpdated);
+
+    const current_buffer = cli_renderer.getCurrentBuffer();
+    try std.testing.expectEqual(@as(u32, 'X'), current_buffer.get(6, 0).?.char);
+}
+
+test "renderer - frame larger than the output high-water mark is flushed in chunks" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var cli_renderer = try CliRenderer.create(
+        std.testing.allocator,
+        80,
+        24,
+        pool,
+        true,
+    );
+    defer cli_renderer.destroy();
+
+    cli_renderer.outputHighWaterMark = 512;
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+
+    // Small frame fits without flushing
+    try cli_renderer.getNextBuffer().drawText("Hi", 0, 0, fg, bg, 0);
+    cli_renderer.render(false);
+    try std.testing.expectEqual(@as(u32, 0), cli_renderer.renderStats.outputChunkFlushes);
+    try std.testing.expectEqual(@as(u64, 0), cli_renderer.renderStats.outputOverflowFrames);
+
+    // Full repaint overflows and gets chunked instead of dropped
+    cli_renderer.render(true);
+    try std.testing.expect(cli_renderer.renderStats.outputChunkFlushes > 0);
+    try std.testing.expectEqual(@as(u64, 1), cli_renderer.renderStats.outputOverflowFrames);
+    try std.testing.expectEqual(@as(u32, 80 * 24), cli_renderer.renderStats.cellsUpdated);
+
+    const output = cli_renderer.getLastOutputForTest();
+    try std.testing.expect(output.len <= 512);
+    try std.testing.expect(cli_renderer.renderStats.outputBytes > output.len);
+}
+
+test "renderer - multiple renderers keep separate output" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var main_renderer = try CliRenderer.create(std.testing.allocator, 40, 10, pool, true);
+    defer main_renderer.destroy();
+    var capture_renderer = try CliRenderer.create(std.testing.allocator, 20, 5, pool, true);
+    defer capture_renderer.destroy();
+
+    capture_renderer.setOutputBufferSize(8 * 1024);
+    try std.testing.expectEqual(@as(usize, 8 * 1024), capture_renderer.getOutputBufferSize());
+    try std.testing.expect(main_renderer.getOutputBufferSize() != capture_renderer.getOutputBufferSize());
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+
+    try main_renderer.getNextBuffer().drawText("MainFrame", 0, 0, fg, bg, 0);
+    main_renderer.render(false);
+    try capture_renderer.getNextBuffer().drawText("Capture", 0, 0, fg, bg, 0);
+    capture_renderer.render(false);
+
+    const main_output = main_renderer.getLastOutputForTest();
+    const capture_output = capture_renderer.getLastOutputForTest();
+    try std.testing.expect(std.mem.indexOf(u8, main_output, "MainFrame") != null);
+    try std.testing.expect(std.mem.indexOf(u8, main_output, "Capture") == null);
+    try std.testing.expect(std.mem.indexOf(u8, capture_output, "Capture") != null);
+    try std.testing.expect(std.mem.indexOf(u8, capture_output, "MainFrame") == null);
+}
+
+fn renderFramesOnThread(cli_renderer: *CliRenderer, text: []const u8, frames: usize) void {
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+    for (0..frames) |i| {
+        const next = cli_renderer.getNextBuffer();
+        next.drawText(text, @intCast(i % 10), 0, fg, bg, 0) catch return;
+        cli_renderer.render(false);
+    }
+}
+
+test "renderer - renderers can render concurrently on separate threads" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var first = try CliRenderer.create(std.testing.allocator, 40, 10, pool, true);
+    defer first.destroy();
+    var second = try CliRenderer.create(std.testing.allocator, 40, 10, pool, true);
+    defer second.destroy();
+
+    const t1 = try std.Thread.spawn(.{}, renderFramesOnThread, .{ first, "alpha", 50 });
+    const t2 = try std.Thread.spawn(.{}, renderFramesOnThread, .{ second, "omega", 50 });
+    t1.join();
+    t2.join();
+
+    try std.testing.expect(std.mem.indexOf(u8, first.getLastOutputForTest(), "omega") == null);
+    try std.testing.expect(std.mem.indexOf(u8, second.getLastOutputForTest(), "alpha") == null);
+    try std.testing.expectEqual(@as(u32, 'a'), first.getCurrentBuffer().get(9, 0).?.char);
+    try std.testing.expectEqual(@as(u32, 'o'), second.getCurrentBuffer().get(9, 0).?.char);
+}
+
+test "renderer - FrameHandoff hands over the latest frame and reports stale slots" {
+    var handoff = renderer.FrameHandoff{};
+    try std.testing.expectEqual(@as(?u2, null), handoff.acquire());
+
+    var claimed = handoff.reclaim();
+    try std.testing.expect(!claimed.stale);
+    const first = claimed.slot;
+    handoff.publish();
+
+    // The consumer has not taken the frame, so the producer gets it back
+    claimed = handoff.reclaim();
+    try std.testing.expect(claimed.stale);
+    try std.testing.expectEqual(first, claimed.slot);
+    handoff.publish();
+
+    try std.testing.expectEqual(@as(?u2, first), handoff.acquire());
+    try std.testing.expectEqual(@as(?u2, null), handoff.acquire());
+
+    claimed = handoff.reclaim();
+    try std.testing.expect(!claimed.stale);
+    try std.testing.expect(claimed.slot != first);
+}
+
+fn publishSequence(handoff: *renderer.FrameHandoff, values: *[renderer.FrameHandoff.SLOTS]u64, count: u64) void {
+    var i: u64 = 1;
+    while (i <= count) : (i += 1) {
+        const claimed = handoff.reclaim();
+        values[claimed.slot] = i;
+        handoff.publish();
+    }
+}
+
+test "renderer - FrameHandoff delivers newer frames across threads" {
+    var handoff = renderer.FrameHandoff{};
+    var values = [_]u64{0} ** renderer.FrameHandoff.SLOTS;
+    const count: u64 = 20000;
+
+    const producer = try std.Thread.spawn(.{}, publishSequence, .{ &handoff, &values, count });
+    defer producer.join();
+
+    var last: u64 = 0;
+    while (last < count) {
+        const slot = handoff.acquire() orelse {
+            handoff.wait();
+            continue;
+        };
+        try std.testing.expect(values[slot] > last);
+        last = values[slot];
+    }
+}
+
+test "renderer - threaded frames coalesce while the writer is behind" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var cli_renderer = try CliRenderer.create(std.testing.allocator, 20, 4, pool, true);
+    defer cli_renderer.destroy();
+
+    // Take frames off the handoff by hand in place of the render thread
+    cli_renderer.useThread = true;
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+
+    try cli_renderer.getNextBuffer().drawText("alpha", 0, 0, fg, bg, 0);
+    cli_renderer.render(false);
+    try cli_renderer.getNextBuffer().drawText("omega", 0, 1, fg, bg, 0);
+    cli_renderer.render(false);
+
+    try std.testing.expectEqual(@as(u64, 1), cli_renderer.renderStats.coalescedFrames);
+    try std.testing.expectEqual(@as(u32, 1), cli_renderer.renderStats.writerBacklog);
+    try std.testing.expect(cli_renderer.renderStats.writerBacklogBytes > 0);
+
+    const slot = cli_renderer.frameHandoff.acquire().?;
+    const pending = cli_renderer.outputBuffers[slot].items;
+    const alphaAt = std.mem.indexOf(u8, pending, "alpha").?;
+    const omegaAt = std.mem.indexOf(u8, pending, "omega").?;
+    try std.testing.expect(alphaAt < omegaAt);
+
+    // Writer caught up: the next frame starts a fresh slot
+    try cli_renderer.getNextBuffer().drawText("beta", 0, 2, fg, bg, 0);
+    cli_renderer.render(false);
+    try std.testing.expectEqual(@as(u32, 0), cli_renderer.renderStats.writerBacklog);
+    try std.testing.expect(std.mem.indexOf(u8, cli_renderer.getLastOutputForTest(), "alpha") == null);
+    try std.testing.expect(std.mem.indexOf(u8, cli_renderer.getLastOutputForTest(), "beta") != null);
+
+    // A backlog past the high-water mark is discarded for a full repaint
+    cli_renderer.setOutputBufferSize(0);
+    var label: [16]u8 = undefined;
+    var i: usize = 0;
+    while (cli_renderer.renderStats.droppedFrames == 0 and i < 1000) : (i += 1) {
+        const text = try std.fmt.bufPrint(&label, "frame {d}", .{i});
+        try cli_renderer.getNextBuffer().drawText(text, @intCast(i % 8), 3, fg, bg, 0);
+        cli_renderer.render(false);
+    }
+
+    try std.testing.expect(cli_renderer.renderStats.droppedFrames > 1);
+    try std.testing.expectEqual(@as(u64, cli_renderer.renderStats.writerBacklog), cli_renderer.renderStats.droppedFrames);
+    try std.testing.expectEqual(@as(u32, 20 * 4), cli_renderer.renderStats.cellsUpdated);
+    try std.testing.expect(cli_renderer.getLastOutputForTest().len < cli_renderer.renderStats.writerBacklogBytes);
+}
+
+test "renderer - pen picks the cheapest cursor motion" {
+    var out: std.ArrayListUnmanaged(u8) = .{};
+    defer out.deinit(std.testing.allocator);
+    const writer = out.writer(std.testing.allocator);
+
+    var pen = ansi.Pen{};
+    try pen.moveTo(writer, 10, 5);
+    try std.testing.expectEqualStrings("\x1b[5;10H", out.items);
+
+    out.clearRetainingCapacity();
+    pen.advance(3);
+    try pen.moveTo(writer, 15, 5);
+    try std.testing.expectEqualStrings("\x1b[2C", out.items);
+
+    out.clearRetainingCapacity();
+    try pen.moveTo(writer, 1, 6);
+    try std.testing.expectEqualStrings("\r\n", out.items);
+
+    out.clearRetainingCapacity();
+    try pen.moveTo(writer, 1, 6);
+    try std.testing.expectEqual(@as(usize, 0), out.items.len);
+
+    out.clearRetainingCapacity();
+    try pen.moveTo(writer, 40, 2);
+    try std.testing.expectEqualStrings("\x1b[2;40H", out.items);
+}
+
+test "renderer - pen emits only changed SGR parameters" {
+    var out: std.ArrayListUnmanaged(u8) = .{};
+    defer out.deinit(std.testing.allocator);
+    const writer = out.writer(std.testing.allocator);
+
+    const TA = ansi.TextAttributes;
+    var pen = ansi.Pen{};
+
+    // Unknown state starts with a reset
+    try pen.setStyle(writer, .{ .fg = .{ .rgb = .{ 255, 0, 0 } }, .attributes = TA.BOLD });
+    try std.testing.expectEqualStrings("\x1b[0;1;38;2;255;0;0m", out.items);
+
+    out.clearRetainingCapacity();
+    try pen.setStyle(writer, .{ .fg = .{ .rgb = .{ 255, 0, 0 } }, .attributes = TA.BOLD });
+    try std.testing.expectEqual(@as(usize, 0), out.items.len);
+
+    out.clearRetainingCapacity();
+    try pen.setStyle(writer, .{ .fg = .{ .rgb = .{ 255, 0, 0 } }, .bg = .{ .rgb = .{ 0, 0, 255 } }, .attributes = TA.BOLD | TA.ITALIC });
+    try std.testing.expectEqualStrings("\x1b[3;48;2;0;0;255m", out.items);
+
+    // Dropping dim keeps bold by re-enabling it after 22
+    out.clearRetainingCapacity();
+    pen.resetStyle();
+    try pen.setStyle(writer, .{ .fg = .{ .rgb = .{ 255, 0, 0 } }, .attributes = TA.BOLD | TA.DIM });
+    out.clearRetainingCapacity();
+    try pen.setStyle(writer, .{ .fg = .{ .rgb = .{ 255, 0, 0 } }, .attributes = TA.BOLD });
+    try std.testing.expectEqualStrings("\x1b[22;1m", out.items);
+
+    // Reset is chosen when it is shorter than undoing several parameters
+    out.clearRetainingCapacity();
+    try pen.setStyle(writer, .{ .fg = .{ .rgb = .{ 1, 2, 3 } }, .bg = .{ .rgb = .{ 4, 5, 6 } }, .attributes = TA.BOLD | TA.UNDERLINE | TA.ITALIC });
+    out.clearRetainingCapacity();
+    try pen.setStyle(writer, .{});
+    try std.testing.expectEqualStrings("\x1b[0m", out.items);
+}
+
+test "renderer - runs sharing a style are not reset or re-styled" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var cli_renderer = try CliRenderer.create(std.testing.allocator, 80, 24, pool, true);
+    defer cli_renderer.destroy();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+
+    try cli_renderer.getNextBuffer().drawText("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 0, 0, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 0, 1, fg, bg, 0);
+    cli_renderer.render(false);
+
+    // Two changes on row 0 separated by a short gap, one far away on row 1
+    try cli_renderer.getNextBuffer().drawText("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 0, 0, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 0, 1, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("X", 2, 0, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("Y", 5, 0, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("Z", 25, 1, fg, bg, 0);
+    cli_renderer.render(false);
+
+    const output = cli_renderer.getLastOutputForTest();
+
+    // One style for the whole frame, one reset at the end
+    try std.testing.expectEqual(@as(usize, 1), std.mem.count(u8, output, "38;2;"));
+    try std.testing.expectEqual(@as(usize, 1), std.mem.count(u8, output, ansi.ANSI.reset));
+    // The two-cell gap is rewritten rather than jumped over
+    try std.testing.expect(std.mem.indexOf(u8, output, "XaaY") != null);
+    try std.testing.expectEqual(@as(u32, 3), cli_renderer.renderStats.cellsUpdated);
+}
+
+test "renderer - cursor is re-anchored after a grapheme without explicit width" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var cli_renderer = try CliRenderer.create(std.testing.allocator, 80, 24, pool, true);
+    defer cli_renderer.destroy();
+    try std.testing.expect(!cli_renderer.terminal.getCapabilities().explicit_width);
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+
+    try cli_renderer.getNextBuffer().drawText("aaaaaaaaaa", 0, 0, fg, bg, 0);
+    cli_renderer.render(false);
+
+    // A wide grapheme, one unchanged cell, then a change on the same row
+    try cli_renderer.getNextBuffer().drawText("aaaaaaaaaa", 0, 0, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("👋", 2, 0, fg, bg, 0);
+    try cli_renderer.getNextBuffer().drawText("Y", 5, 0, fg, bg, 0);
+    cli_renderer.render(false);
+
+    const output = cli_renderer.getLastOutputForTest();
+
+    // The terminal's width for the emoji is unknown, so the gap is not
+    // rewritten relative to it; Y is reached with an absolute move
+    try std.testing.expect(std.mem.indexOf(u8, output, "aY") == null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "\x1b[1;6HY") != null);
+}
+
+test "renderer - 256 and 16 color depth emit palette SGR" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var cli_renderer = try CliRenderer.create(std.testing.allocator, 40, 5, pool, true);
+    defer cli_renderer.destroy();
+
+    const fg = RGBA{ 1.0, 0.0, 0.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+
+    cli_renderer.setColorDepth(.ansi256);
+    try std.testing.expectEqual(renderer.ColorDepth.ansi256, cli_renderer.getColorDepth());
+    try cli_renderer.getNextBuffer().drawText("Red", 0, 0, fg, bg, 0);
+    cli_renderer.render(false);
+
+    var output = cli_renderer.getLastOutputForTest();
+    try std.testing.expect(std.mem.indexOf(u8, output, "38;5;196") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "48;5;16") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "38;2;") == null);
+
+    cli_renderer.setColorDepth(null);
+    try std.testing.expectEqual(renderer.ColorDepth.truecolor, cli_renderer.getColorDepth());
+
+    var basic_renderer = try CliRenderer.create(std.testing.allocator, 40, 5, pool, true);
+    defer basic_renderer.destroy();
+
+    basic_renderer.setColorDepth(.ansi16);
+    try basic_renderer.getNextBuffer().drawText("Red", 0, 0, fg, bg, 0);
+    basic_renderer.render(false);
+
+    output = basic_renderer.getLastOutputForTest();
+    try std.testing.expect(std.mem.indexOf(u8, output, "\x1b[0;91;40m") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "38;") == null);
+}
+
+test "renderer - detectRowShift finds scrolled row ranges" {
+    const current = [_]u64{ 1, 2, 3, 4, 5, 6 };
+
+    const up = renderer.detectRowShift(&current, &[_]u64{ 2, 3, 4, 5, 6, 7 }, 8).?;
+    try std.testing.expectEqual(@as(u32, 0), up.top);
+    try std.testing.expectEqual(@as(u32, 6), up.end);
+    try std.testing.expectEqual(@as(i32, 1), up.lines);
+
+    const down = renderer.detectRowShift(&current, &[_]u64{ 9, 9, 1, 2, 3, 4 }, 8).?;
+    try std.testing.expectEqual(@as(u32, 0), down.top);
+    try std.testing.expectEqual(@as(u32, 6), down.end);
+    try std.testing.expectEqual(@as(i32, -2), down.lines);
+
+    // Header and footer stay put, only the middle scrolls
+    const middle = renderer.detectRowShift(&current, &[_]u64{ 1, 3, 4, 5, 8, 6 }, 8).?;
+    try std.testing.expectEqual(@as(u32, 1), middle.top);
+    try std.testing.expectEqual(@as(u32, 5), middle.end);
+    try std.testing.expectEqual(@as(i32, 1), middle.lines);
+
+    try std.testing.expect(renderer.detectRowShift(&current, &[_]u64{ 7, 8, 9, 10, 11, 12 }, 8) == null);
+    try std.testing.expect(renderer.detectRowShift(&current, &current, 8) == null);
+}
+
+test "renderer - scrolled content is replayed with a scroll region" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var cli_renderer = try CliRenderer.create(std.testing.allocator, 40, 10, pool, true);
+    defer cli_renderer.destroy();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+    var line: [16]u8 = undefined;
+
+    for (0..10) |i| {
+        const text = try std.fmt.bufPrint(&line, "log line {d}", .{i});
+        try cli_renderer.getNextBuffer().drawText(text, 0, @intCast(i), fg, bg, 0);
+    }
+    cli_renderer.render(false);
+
+    for (0..10) |i| {
+        const text = try std.fmt.bufPrint(&line, "log line {d}", .{i + 1});
+        try cli_renderer.getNextBuffer().drawText(text, 0, @intCast(i), fg, bg, 0);
+    }
+    cli_renderer.render(false);
+
+    const output = cli_renderer.getLastOutputForTest();
+    try std.testing.expectEqual(@as(u32, 1), cli_renderer.renderStats.linesScrolled);
+    try std.testing.expect(std.mem.indexOf(u8, output, "\x1b[1;10r\x1b[1S\x1b[r") != null);
+    // Only the uncovered last row is repainted
+    try std.testing.expect(cli_renderer.renderStats.cellsUpdated <= 40);
+    try std.testing.expect(std.mem.indexOf(u8, output, "log line 10") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output, "log line 5") == null);
+
+    const current = cli_renderer.getCurrentBuffer();
+    try std.testing.expectEqual(@as(u32, '1'), current.get(9, 0).?.char);
+    try std.testing.expectEqual(@as(u32, '9'), current.get(9, 8).?.char);
+}
+
+test "renderer - collectDirtySpans skips rows neither buffer wrote" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var current = try OptimizedBuffer.init(std.testing.allocator, 10, 4, .{ .pool = pool, .id = "current", .track_rows = true });
+    defer current.deinit();
+    var next = try OptimizedBuffer.init(std.testing.allocator, 10, 4, .{ .pool = pool, .id = "next", .track_rows = true });
+    defer next.deinit();
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+    try current.clear(bg, null);
+    try next.clear(bg, null);
+    try current.drawText("stale", 0, 0, fg, bg, 0);
+    current.clearDirtyRows();
+    next.clearDirtyRows();
+
+    var spans: std.ArrayListUnmanaged(renderer.DirtySpan) = .{};
+    defer spans.deinit(std.testing.allocator);
+    try spans.ensureTotalCapacity(std.testing.allocator, renderer.maxDirtySpans(10, 4));
+
+    // Row 0 differs but neither side marked it, so it is trusted to be in sync
+    try next.drawText("x", 3, 2, fg, bg, 0);
+    renderer.collectDirtySpans(current, next, 0.00001, &spans);
+    try std.testing.expectEqual(@as(usize, 1), spans.items.len);
+    try std.testing.expectEqual(@as(u32, 2), spans.items[0].y);
+
+    next.markRowsDirty(0, 1);
+    renderer.collectDirtySpans(current, next, 0.00001, &spans);
+    try std.testing.expectEqual(@as(usize, 2), spans.items.len);
+    try std.testing.expectEqual(@as(u32, 0), spans.items[0].y);
+}
+
+test "renderer - retained frames keep the next buffer and hit grid" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var cli_renderer = try CliRenderer.create(std.testing.allocator, 20, 4, pool, true);
+    defer cli_renderer.destroy();
+    cli_renderer.setRetainFrames(true);
+
+    const fg = RGBA{ 1.0, 1.0, 1.0, 1.0 };
+    const bg = RGBA{ 0.0, 0.0, 0.0, 1.0 };
+    try cli_renderer.getNextBuffer().drawText("kept", 2, 1, fg, bg, 0);
+    cli_renderer.addToHitGrid(2, 1, 4, 1, 7);
+    cli_renderer.render(false);
+
+    try std.testing.expectEqual(@as(u32, 'k'), cli_renderer.getNextBuffer().get(2, 1).?.char);
+    try std.testing.expectEqual(@as(u32, 7), cli_renderer.checkHit(3, 1));
+
+    // Nothing was drawn, so nothing is emitted and the hit grid survives another swap
+    cli_renderer.render(false);
+    try std.testing.expectEqual(@as(u32, 0), cli_renderer.renderStats.cellsUpdated);
+    try std.testing.expectEqual(@as(u32, 'k'), cli_renderer.getCurrentBuffer().get(2, 1).?.char);
+    try std.testing.expectEqual(@as(u32, 7), cli_renderer.checkHit(3, 1));
+}
@@ -1794,6 +1794,42 @@ test "Rope - marker tracking with many markers" {
     const nl98 = rope.getMarker(.newline, 98).?;
     try std.testing.expectEqual(@as(u32, 197), nl98.leaf_index);
 }
+
+test "Rope - appendSlice and deletePrefix keep the marker cache current" {
+    var arena = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena.deinit();
+
+    const RopeType = rope_mod.Rope(TokenType);
+    var rope = try RopeType.from_slice(arena.allocator(), &[_]TokenType{ .{ .word = 3 }, .{ .newline = {} } });
+    try std.testing.expectEqual(@as(u32, 1), rope.markerCount(.newline));
+
+    // Stream lines in and drop old ones from the front, like a capped log tail
+    for (0..200) |i| {
+        const width: u32 = @intCast(i % 7 + 1);
+        try rope.appendSlice(&[_]TokenType{ .{ .word = width }, .{ .space = 1 }, .{ .newline = {} } });
+        try std.testing.expectEqual(rope.version, rope.marker_cache.version);
+
+        if (i % 3 == 2) {
+            const cut = rope.getMarker(.newline, 1).?.leaf_index + 1;
+            try rope.deletePrefix(cut);
+            try std.testing.expectEqual(rope.version, rope.marker_cache.version);
+        }
+    }
+
+    // A cache rebuilt from scratch must agree with the incrementally kept one
+    const items = try rope.slice(0, rope.count(), arena.allocator());
+    var fresh = try RopeType.from_slice(arena.allocator(), items);
+
+    const count = fresh.markerCount(.newline);
+    try std.testing.expectEqual(count, rope.markerCount(.newline));
+    for (0..count) |i| {
+        const expected = fresh.getMarker(.newline, @intCast(i)).?;
+        const actual = rope.getMarker(.newline, @intCast(i)).?;
+        try std.testing.expectEqual(expected.leaf_index, actual.leaf_index);
+        try std.testing.expectEqual(expected.global_weight, actual.global_weight);
+    }
+}
+
 //===== Debug toText Tests =====
 
 test "Rope - toText shows basic structure" {
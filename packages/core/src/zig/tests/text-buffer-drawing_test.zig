@@ -1161,6 +1161,49 @@ test "loadFile - loads and renders file correctly" {
     try std.testing.expect(std.mem.startsWith(u8, render_result, "ABC"));
 }
 
+test "loadFile - maps large files and releases them on reset" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .unicode);
+    defer tb.deinit();
+
+    const tmpdir = std.testing.tmpDir(.{});
+    var tmp = tmpdir;
+    defer tmp.cleanup();
+
+    // Large enough to take the mmap path
+    const line = "0123456789 abcdefghijklmnopqrstuvwxyz\n";
+    const line_total: u32 = 4096;
+    {
+        const file = try tmp.dir.createFile("large.txt", .{});
+        defer file.close();
+        for (0..line_total) |_| {
+            try file.writeAll(line);
+        }
+    }
+
+    const dir_path = try tmp.dir.realpathAlloc(std.testing.allocator, ".");
+    defer std.testing.allocator.free(dir_path);
+
+    const file_path = try std.fs.path.join(std.testing.allocator, &[_][]const u8{ dir_path, "large.txt" });
+    defer std.testing.allocator.free(file_path);
+
+    try tb.loadFile(file_path);
+
+    // Trailing newline adds an empty final line
+    try std.testing.expectEqual(line_total + 1, tb.getLineCount());
+    try std.testing.expectEqual(@as(u32, line_total * (line.len - 1)), tb.getLength());
+
+    var out: [64]u8 = undefined;
+    const written = tb.getTextRangeByCoords(100, 0, 100, 10, &out);
+    try std.testing.expectEqualStrings("0123456789", out[0..written]);
+
+    try std.testing.expectEqual(@as(usize, 1), tb.mem_registry.getUsedSlots());
+    tb.reset();
+    try std.testing.expectEqual(@as(usize, 0), tb.mem_registry.getUsedSlots());
+}
+
 test "drawTextBuffer - horizontal viewport offset renders correctly without wrapping" {
     const pool = gp.initGlobalPool(std.testing.allocator);
     defer gp.deinitGlobalPool();
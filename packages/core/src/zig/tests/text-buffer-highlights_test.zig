@@ -1,11 +1,16 @@
 const std = @import("std");
 const text_buffer = @import("../text-buffer.zig");
+const edit_buffer = @import("../edit-buffer.zig");
+const highlight_index = @import("../highlight-index.zig");
 const gp = @import("../grapheme.zig");
 const ss = @import("../syntax-style.zig");
 
 const TextBuffer = text_buffer.UnifiedTextBuffer;
 const RGBA = text_buffer.RGBA;
 const Highlight = text_buffer.Highlight;
+const EditBuffer = edit_buffer.EditBuffer;
+const Cursor = edit_buffer.Cursor;
+const HighlightIndex = highlight_index.HighlightIndex;
 
 test "TextBuffer coords - addHighlightByCoords" {
     const pool = gp.initGlobalPool(std.testing.allocator);
@@ -633,3 +638,241 @@ test "TextBuffer char range highlights - emoji grapheme clusters" {
     try std.testing.expectEqual(@as(u32, 4), highlights[0].col_start);
     try std.testing.expectEqual(@as(u32, 8), highlights[0].col_end);
 }
+
+// ===== Highlights Across Edits =====
+
+test "TextBuffer highlights - lines inserted above move highlights down" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var eb = try EditBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer eb.deinit();
+    const tb = eb.getTextBuffer();
+
+    try eb.setText("a\nb\nc");
+    try tb.addHighlight(2, 0, 1, 7, 0, 0);
+
+    try eb.setCursor(0, 0);
+    try eb.insertText("x\ny\n");
+
+    try std.testing.expectEqual(@as(usize, 0), tb.getLineHighlights(2).len);
+    const moved = tb.getLineHighlights(4);
+    try std.testing.expectEqual(@as(usize, 1), moved.len);
+    try std.testing.expectEqual(@as(u32, 7), moved[0].style_id);
+    try std.testing.expect(tb.getLineSpans(4).len > 0);
+}
+
+test "TextBuffer highlights - deleted lines drop their highlights and later lines move up" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var eb = try EditBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer eb.deinit();
+    const tb = eb.getTextBuffer();
+
+    try eb.setText("a\nb\nc\nd");
+    try tb.addHighlight(1, 0, 1, 1, 0, 1);
+    try tb.addHighlight(3, 0, 1, 2, 0, 2);
+
+    // "a|\nb\n|c" joins the first and third lines
+    try eb.deleteRange(Cursor{ .row = 0, .col = 1 }, Cursor{ .row = 2, .col = 0 });
+
+    try std.testing.expectEqual(@as(u32, 2), tb.getLineCount());
+    try std.testing.expectEqual(@as(u32, 1), tb.getHighlightCount());
+    const moved = tb.getLineHighlights(1);
+    try std.testing.expectEqual(@as(usize, 1), moved.len);
+    try std.testing.expectEqual(@as(u16, 2), moved[0].hl_ref);
+}
+
+test "TextBuffer highlights - removeHighlightsByRef keeps other refs and their spans" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+
+    try tb.setText("first\nsecond\nthird");
+    try tb.addHighlight(0, 0, 5, 1, 0, 1);
+    try tb.addHighlight(1, 0, 6, 2, 0, 2);
+    try tb.addHighlight(2, 0, 2, 1, 0, 1);
+    try tb.addHighlight(2, 2, 5, 2, 0, 2);
+
+    tb.removeHighlightsByRef(1);
+
+    try std.testing.expectEqual(@as(u32, 2), tb.getHighlightCount());
+    try std.testing.expectEqual(@as(usize, 0), tb.getLineHighlights(0).len);
+    try std.testing.expectEqual(@as(usize, 0), tb.getLineSpans(0).len);
+    try std.testing.expectEqual(@as(usize, 1), tb.getLineHighlights(1).len);
+
+    const line2 = tb.getLineHighlights(2);
+    try std.testing.expectEqual(@as(usize, 1), line2.len);
+    try std.testing.expectEqual(@as(u32, 2), line2[0].col_start);
+    const spans = tb.getLineSpans(2);
+    try std.testing.expect(spans.len > 0);
+    try std.testing.expectEqual(@as(u32, 0), spans[0].style_id);
+}
+
+test "HighlightIndex - matches a per-line model under random edits" {
+    const line_count = 200;
+    const zeros = [_]u16{0} ** line_count;
+
+    var index = HighlightIndex.init(std.testing.allocator);
+    defer index.deinit();
+
+    // Model: ref + 1 of the single highlight on each line, 0 for none
+    var model: std.ArrayListUnmanaged(u16) = .{};
+    defer model.deinit(std.testing.allocator);
+    try model.appendNTimes(std.testing.allocator, 0, line_count);
+
+    var prng = std.Random.DefaultPrng.init(42);
+    const random = prng.random();
+
+    for (0..2000) |_| {
+        switch (random.uintLessThan(u8, 4)) {
+            0, 1 => {
+                const line = random.uintLessThan(u32, line_count);
+                if (model.items[line] != 0) continue;
+                const hl_ref = random.uintLessThan(u16, 8);
+                try index.add(line, .{ .col_start = 0, .col_end = 1, .style_id = 1, .priority = 0, .hl_ref = hl_ref });
+                model.items[line] = hl_ref + 1;
+            },
+            2 => {
+                const old_end = random.uintLessThan(u32, line_count);
+                const new_end = random.uintLessThan(u32, line_count);
+                index.moveLines(old_end, new_end);
+                if (new_end < old_end) {
+                    try model.replaceRange(std.testing.allocator, new_end, old_end - new_end, &.{});
+                    try model.appendNTimes(std.testing.allocator, 0, old_end - new_end);
+                } else {
+                    try model.insertSlice(std.testing.allocator, old_end, zeros[0 .. new_end - old_end]);
+                    model.shrinkRetainingCapacity(line_count);
+                    // Trim lines pushed past the model's range from the index too
+                    index.moveLines(4 * line_count, line_count);
+                }
+            },
+            else => {
+                const hl_ref = random.uintLessThan(u16, 8);
+                var affected: std.ArrayListUnmanaged(u32) = .{};
+                defer affected.deinit(std.testing.allocator);
+                try index.removeByRef(hl_ref, &affected, std.testing.allocator);
+                for (affected.items) |line| {
+                    try std.testing.expectEqual(hl_ref + 1, model.items[line]);
+                    index.clearLine(line);
+                }
+                for (model.items) |*entry| {
+                    if (entry.* == hl_ref + 1) entry.* = 0;
+                }
+            },
+        }
+
+        var expected_count: u32 = 0;
+        for (model.items, 0..) |entry, line| {
+            const highlights = index.getHighlights(@intCast(line));
+            if (entry == 0) {
+                try std.testing.expectEqual(@as(usize, 0), highlights.len);
+            } else {
+                expected_count += 1;
+                try std.testing.expectEqual(@as(usize, 1), highlights.len);
+                try std.testing.expectEqual(entry - 1, highlights[0].hl_ref);
+            }
+        }
+        try std.testing.expectEqual(expected_count, index.getHighlightCount());
+    }
+}
+
+test "TextBuffer highlights - setHighlightsInLineRange replaces only the given lines" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+
+    // Line char starts: 0, 5, 10, 15
+    try tb.setText("aaaaa\nbbbbb\nccccc\nddddd");
+
+    try tb.addHighlight(0, 0, 2, 9, 0, 0);
+    try tb.addHighlight(1, 0, 5, 9, 0, 0);
+    try tb.addHighlight(3, 1, 3, 9, 0, 0);
+
+    // Unsorted, with two touching ranges of the same style and one spanning lines
+    var highlights = [_]text_buffer.CharRangeHighlight{
+        .{ .char_start = 13, .char_end = 17, .style_id = 2, .priority = 0 },
+        .{ .char_start = 7, .char_end = 8, .style_id = 1, .priority = 0 },
+        .{ .char_start = 5, .char_end = 7, .style_id = 1, .priority = 0 },
+        .{ .char_start = 9, .char_end = 9, .style_id = 3, .priority = 0 },
+    };
+    try tb.setHighlightsInLineRange(1, 3, &highlights);
+
+    // Lines outside the range are untouched
+    const line0 = tb.getLineHighlights(0);
+    try std.testing.expectEqual(@as(usize, 1), line0.len);
+    try std.testing.expectEqual(@as(u32, 9), line0[0].style_id);
+    const line3 = tb.getLineHighlights(3);
+    try std.testing.expectEqual(@as(usize, 1), line3.len);
+    try std.testing.expectEqual(@as(u32, 9), line3[0].style_id);
+
+    // Old line 1 highlight replaced by the merged [5, 8) range
+    const line1 = tb.getLineHighlights(1);
+    try std.testing.expectEqual(@as(usize, 1), line1.len);
+    try std.testing.expectEqual(@as(u32, 0), line1[0].col_start);
+    try std.testing.expectEqual(@as(u32, 3), line1[0].col_end);
+    try std.testing.expectEqual(@as(u32, 1), line1[0].style_id);
+
+    // [13, 17) is clipped to line 2; the empty range is dropped
+    const line2 = tb.getLineHighlights(2);
+    try std.testing.expectEqual(@as(usize, 1), line2.len);
+    try std.testing.expectEqual(@as(u32, 3), line2[0].col_start);
+    try std.testing.expectEqual(@as(u32, 5), line2[0].col_end);
+    try std.testing.expectEqual(@as(u32, 2), line2[0].style_id);
+
+    try std.testing.expect(tb.getLineSpans(1).len > 0);
+}
+
+test "TextBuffer highlights - setHighlightsInLineRange with no highlights clears the range" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+
+    try tb.setText("one\ntwo\nthree");
+    for (0..3) |line| try tb.addHighlight(line, 0, 3, 1, 0, 0);
+
+    var none = [_]text_buffer.CharRangeHighlight{};
+    try tb.setHighlightsInLineRange(0, 100, &none);
+
+    try std.testing.expectEqual(@as(u32, 0), tb.getHighlightCount());
+    for (0..3) |line| {
+        try std.testing.expectEqual(@as(usize, 0), tb.getLineHighlights(line).len);
+        try std.testing.expectEqual(@as(usize, 0), tb.getLineSpans(line).len);
+    }
+}
+
+test "TextBuffer highlights - setHighlightsInLineRangeByBytes measures tabs and wide graphemes" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .unicode);
+    defer tb.deinit();
+
+    try tb.setText("x\n\tab\n👋cd");
+
+    // Bytes from the start of line 1: "\tab" is 0..3, the break 3, "👋" 4..8, "cd" 8..10
+    var highlights = [_]text_buffer.CharRangeHighlight{
+        .{ .char_start = 1, .char_end = 3, .style_id = 1, .priority = 0 },
+        .{ .char_start = 8, .char_end = 10, .style_id = 2, .priority = 0 },
+    };
+    try tb.setHighlightsInLineRangeByBytes(1, 3, &highlights);
+
+    // A tab is tab_width (2) columns and the emoji 2 cells
+    const line1 = tb.getLineHighlights(1);
+    try std.testing.expectEqual(@as(usize, 1), line1.len);
+    try std.testing.expectEqual(@as(u32, 2), line1[0].col_start);
+    try std.testing.expectEqual(@as(u32, 4), line1[0].col_end);
+
+    const line2 = tb.getLineHighlights(2);
+    try std.testing.expectEqual(@as(usize, 1), line2.len);
+    try std.testing.expectEqual(@as(u32, 2), line2[0].col_start);
+    try std.testing.expectEqual(@as(u32, 4), line2[0].col_end);
+    try std.testing.expectEqual(@as(u32, 2), line2[0].style_id);
+}
@@ -1,10 +1,16 @@
 const std = @import("std");
 const testing = std.testing;
 const seg_mod = @import("../text-buffer-segment.zig");
+const chunk_cache_mod = @import("../chunk-cache.zig");
+const mem_registry_mod = @import("../mem-registry.zig");
+const utf8 = @import("../utf8.zig");
 
 const Segment = seg_mod.Segment;
 const UnifiedRope = seg_mod.UnifiedRope;
 const TextChunk = seg_mod.TextChunk;
+const ChunkCache = seg_mod.ChunkCache;
+const ChunkKey = chunk_cache_mod.ChunkKey;
+const MemRegistry = mem_registry_mod.MemRegistry;
 
 test "Segment.measure - text chunk" {
     const chunk = TextChunk{
@@ -318,3 +324,126 @@ test "combineMetrics helper function" {
     try testing.expectEqual(@as(u32, 10), combined.max_line_width);
     try testing.expect(combined.ascii_only);
 }
+
+fn mixedChunk(mem_id: mem_registry_mod.MemId, byte_start: u32, byte_end: u32) TextChunk {
+    return .{ .mem_id = mem_id, .byte_start = byte_start, .byte_end = byte_end, .width = 0 };
+}
+
+test "TextChunk.getGraphemes - cached graphemes match findGraphemeInfo" {
+    const text = "a世界\tb🌍c\u{0301}d\t\t👋🏿 Ελληνικά";
+
+    var registry = MemRegistry.init(testing.allocator);
+    defer registry.deinit();
+    var cache = ChunkCache.init(testing.allocator);
+    defer cache.deinit();
+
+    const mem_id = try registry.register(text, false);
+    const chunk = mixedChunk(mem_id, 0, text.len);
+
+    var expected: std.ArrayListUnmanaged(utf8.GraphemeInfo) = .{};
+    defer expected.deinit(testing.allocator);
+    try utf8.findGraphemeInfo(text, 4, false, .unicode, testing.allocator, &expected);
+    try testing.expect(expected.items.len > 0);
+
+    // First call encodes, second decodes the cached entry
+    for (0..2) |_| {
+        var it = try chunk.getGraphemes(&cache, &registry, 4, .unicode);
+        for (expected.items) |want| {
+            try testing.expectEqual(want, it.next().?);
+        }
+        try testing.expectEqual(@as(?utf8.GraphemeInfo, null), it.next());
+    }
+
+    // Entry bookkeeping included, the encoding is smaller than the slice it replaces
+    try testing.expect(cache.getBytes() < expected.items.len * @sizeOf(utf8.GraphemeInfo));
+}
+
+test "TextChunk.getWrapOffsets - cached breaks match findWrapBreaks" {
+    const text = "one two-three/four 世界, five.six (seven)";
+
+    var registry = MemRegistry.init(testing.allocator);
+    defer registry.deinit();
+    var cache = ChunkCache.init(testing.allocator);
+    defer cache.deinit();
+
+    const mem_id = try registry.register(text, false);
+    const chunk = mixedChunk(mem_id, 0, text.len);
+
+    var expected = utf8.WrapBreakResult.init(testing.allocator);
+    defer expected.deinit();
+    try utf8.findWrapBreaks(text, &expected, .unicode);
+    try testing.expect(expected.breaks.items.len > 0);
+
+    for (0..2) |_| {
+        var it = try chunk.getWrapOffsets(&cache, &registry, .unicode);
+        for (expected.breaks.items) |want| {
+            try testing.expectEqual(want, it.next().?);
+        }
+        try testing.expectEqual(@as(?utf8.WrapBreak, null), it.next());
+    }
+}
+
+test "TextChunk.getGraphemes - replaced mem buffer is not served from cache" {
+    var registry = MemRegistry.init(testing.allocator);
+    defer registry.deinit();
+    var cache = ChunkCache.init(testing.allocator);
+    defer cache.deinit();
+
+    const mem_id = try registry.register("世界", false);
+    const chunk = mixedChunk(mem_id, 0, 6);
+
+    var first = try chunk.getGraphemes(&cache, &registry, 4, .unicode);
+    try testing.expectEqual(@as(u8, 3), first.next().?.byte_len);
+
+    // Same id and byte range, different bytes
+    try registry.replace(mem_id, "ab\tcd\t", false);
+
+    var second = try chunk.getGraphemes(&cache, &registry, 4, .unicode);
+    const tab = second.next().?;
+    try testing.expectEqual(@as(u32, 2), tab.byte_offset);
+    try testing.expectEqual(@as(u8, 1), tab.byte_len);
+}
+
+test "ChunkCache - evicts least recently used chunks over the limit" {
+    const text = "世界" ** 64;
+
+    var registry = MemRegistry.init(testing.allocator);
+    defer registry.deinit();
+    var cache = ChunkCache.init(testing.allocator);
+    defer cache.deinit();
+
+    const mem_id = try registry.register(text, false);
+    const generation = registry.getGeneration(mem_id);
+
+    for (0..64) |i| {
+        const start: u32 = @intCast(i * 6);
+        _ = try mixedChunk(mem_id, start, start + 6).getGraphemes(&cache, &registry, 4, .unicode);
+    }
+    const unbounded = cache.getBytes();
+
+    cache.setMaxBytes(unbounded / 2);
+    try testing.expect(cache.getBytes() <= unbounded / 2);
+
+    // The oldest chunk went first, the newest stays
+    try testing.expect(cache.getGraphemes(ChunkKey{ .mem_id = mem_id, .byte_start = 0, .byte_end = 6 }, generation) == null);
+    try testing.expect(cache.getGraphemes(ChunkKey{ .mem_id = mem_id, .byte_start = 63 * 6, .byte_end = 64 * 6 }, generation) != null);
+
+    // Inserting past the limit keeps the cache near it
+    _ = try mixedChunk(mem_id, 0, 6).getGraphemes(&cache, &registry, 4, .unicode);
+    try testing.expect(cache.getBytes() <= unbounded / 2);
+}
+
+test "ChunkCache - dropStale removes entries of released slots" {
+    var registry = MemRegistry.init(testing.allocator);
+    defer registry.deinit();
+    var cache = ChunkCache.init(testing.allocator);
+    defer cache.deinit();
+
+    const mem_id = try registry.register("世界", false);
+    _ = try mixedChunk(mem_id, 0, 6).getGraphemes(&cache, &registry, 4, .unicode);
+    try testing.expect(cache.getBytes() > 0);
+
+    try registry.unregister(mem_id);
+    cache.dropStale(&registry);
+    try testing.expectEqual(@as(usize, 0), cache.getBytes());
+}
@@ -3022,3 +3022,123 @@ test "TextBufferView word wrapping - chunk at exact wrap boundary" {
     try std.testing.expectEqual(@as(u32, 12), vlines[0].width);
     try std.testing.expectEqual(@as(u32, 9), vlines[1].width);
 }
+
+test "TextBufferView lazy wrap - wraps around the viewport and fills in on demand" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+
+    var text: std.ArrayListUnmanaged(u8) = .{};
+    defer text.deinit(std.testing.allocator);
+    for (0..2000) |i| {
+        try text.writer(std.testing.allocator).print("line {d} has a few words in it\n", .{i});
+    }
+    try tb.setText(text.items);
+
+    var eager = try TextBufferView.init(std.testing.allocator, tb);
+    defer eager.deinit();
+    eager.setWrapMode(.char);
+    eager.setViewport(.{ .x = 0, .y = 0, .width = 12, .height = 5 });
+
+    var lazy = try TextBufferView.init(std.testing.allocator, tb);
+    defer lazy.deinit();
+    lazy.setWrapMode(.char);
+    lazy.setLazyWrap(true);
+    lazy.setViewport(.{ .x = 0, .y = 0, .width = 12, .height = 5 });
+
+    const exact_count = eager.getVirtualLineCount();
+
+    try std.testing.expectEqual(@as(usize, 5), lazy.getVirtualLines().len);
+    try std.testing.expect(!lazy.isWrapComplete());
+    try std.testing.expect(lazy.virtual_lines.items.len < exact_count);
+
+    // Uniform lines make the estimate land close to the real count
+    const estimate = lazy.getVirtualLineCount();
+    try std.testing.expect(estimate > exact_count * 9 / 10 and estimate < exact_count * 11 / 10);
+
+    // Lookups past the wrapped prefix wrap up to the requested line
+    try std.testing.expectEqual(eager.findVisualLineIndex(1500, 14), lazy.findVisualLineIndex(1500, 14));
+
+    // Measuring at another width extrapolates from sample lines instead of wrapping
+    const eager_measure = try eager.measureForDimensions(20, 5);
+    const lazy_measure = try lazy.measureForDimensions(20, 5);
+    try std.testing.expect(lazy_measure.line_count > eager_measure.line_count * 99 / 100);
+    try std.testing.expect(lazy_measure.line_count < eager_measure.line_count * 101 / 100);
+    try std.testing.expectEqual(eager_measure.max_width, lazy_measure.max_width);
+
+    while (!lazy.wrapMoreLines(300)) {}
+    try std.testing.expect(lazy.isWrapComplete());
+    try std.testing.expectEqual(exact_count, lazy.getVirtualLineCount());
+
+    const expected = eager.getLogicalLineInfo();
+    const actual = lazy.getLogicalLineInfo();
+    try std.testing.expectEqualSlices(u32, expected.starts, actual.starts);
+    try std.testing.expectEqualSlices(u32, expected.widths, actual.widths);
+    try std.testing.expectEqualSlices(u32, expected.sources, actual.sources);
+}
+
+
+test "TextBufferView lazy wrap - measuring short texts at another width is exact" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+    try tb.setText("short\na line long enough to wrap a few times at ten\nend");
+
+    var lazy = try TextBufferView.init(std.testing.allocator, tb);
+    defer lazy.deinit();
+    lazy.setWrapMode(.char);
+    lazy.setLazyWrap(true);
+    lazy.setViewport(.{ .x = 0, .y = 0, .width = 40, .height = 2 });
+
+    // Fewer lines than the sample size, so every line is measured
+    const result = try lazy.measureForDimensions(10, 2);
+    try std.testing.expectEqual(@as(u32, 1 + 5 + 1), result.line_count);
+}
+
+test "TextBufferView streaming tail - dropped and appended lines match a fresh view" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+
+    var view = try TextBufferView.init(std.testing.allocator, tb);
+    defer view.deinit();
+    view.setWrapMode(.word);
+    view.setWrapWidth(16);
+
+    try tb.setMaxLines(60);
+
+    var line: [64]u8 = undefined;
+    try tb.appendStreaming("first line");
+    for (0..400) |i| {
+        // Every few appends continue the current line instead of starting one
+        const text = if (i % 4 == 3)
+            try std.fmt.bufPrint(&line, " and more {d}", .{i})
+        else
+            try std.fmt.bufPrint(&line, "\nentry {d} with words to wrap", .{i});
+        try tb.appendStreaming(text);
+        _ = view.getVirtualLineCount();
+    }
+
+    var fresh = try TextBufferView.init(std.testing.allocator, tb);
+    defer fresh.deinit();
+    fresh.setWrapMode(.word);
+    fresh.setWrapWidth(16);
+
+    const expected = fresh.getLogicalLineInfo();
+    const actual = view.getLogicalLineInfo();
+    try std.testing.expectEqualSlices(u32, expected.starts, actual.starts);
+    try std.testing.expectEqualSlices(u32, expected.widths, actual.widths);
+    try std.testing.expectEqualSlices(u32, expected.sources, actual.sources);
+    try std.testing.expectEqualSlices(u32, expected.wraps, actual.wraps);
+
+    const expected_wrap = fresh.getWrapInfo();
+    const actual_wrap = view.getWrapInfo();
+    try std.testing.expectEqualSlices(u32, expected_wrap.line_first_vline, actual_wrap.line_first_vline);
+    try std.testing.expectEqualSlices(u32, expected_wrap.line_vline_counts, actual_wrap.line_vline_counts);
+}
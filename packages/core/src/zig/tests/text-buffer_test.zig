@@ -2091,3 +2091,188 @@ test "TextBuffer append - mixed append and setText" {
     written = tb.getPlainTextIntoBuffer(&out_buffer);
     try std.testing.expectEqualStrings("Reset again", out_buffer[0..written]);
 }
+
+test "TextBuffer dirty lines - edits merge per view until cleared" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+
+    const view_id = try tb.registerView();
+    try std.testing.expect(tb.isViewDirty(view_id));
+    try std.testing.expect(tb.getViewDirtyLines(view_id) == null);
+    tb.clearViewDirty(view_id);
+
+    // Line 5 split into three lines
+    tb.markLinesDirty(5, 6, 8);
+    var lines = tb.getViewDirtyLines(view_id).?;
+    try std.testing.expectEqual(@as(u32, 5), lines.start);
+    try std.testing.expectEqual(@as(u32, 8), lines.end);
+    try std.testing.expectEqual(@as(u32, 6), lines.oldEnd());
+
+    // Lines 2 and 3 joined, which moves the earlier edit up by one
+    tb.markLinesDirty(2, 4, 3);
+    lines = tb.getViewDirtyLines(view_id).?;
+    try std.testing.expectEqual(@as(u32, 2), lines.start);
+    try std.testing.expectEqual(@as(u32, 7), lines.end);
+    try std.testing.expectEqual(@as(u32, 6), lines.oldEnd());
+
+    // A whole-buffer change can't be narrowed again until the view syncs
+    tb.markViewsDirty();
+    tb.markLinesDirty(0, 1, 1);
+    try std.testing.expect(tb.isViewDirty(view_id));
+    try std.testing.expect(tb.getViewDirtyLines(view_id) == null);
+
+    tb.clearViewDirty(view_id);
+    try std.testing.expect(tb.getViewDirtyLines(view_id) == null);
+    tb.unregisterView(view_id);
+}
+
+test "TextBuffer appendStreaming - shares pages and extends the last line in place" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+
+    try tb.appendStreaming("hello");
+    try tb.appendStreaming(" world");
+    // linestart, one merged chunk
+    try std.testing.expectEqual(@as(u32, 2), tb.rope.count());
+
+    // A CRLF split across appends is a single break
+    try tb.appendStreaming("\r");
+    try tb.appendStreaming("\nnext");
+    try std.testing.expectEqual(@as(u32, 2), tb.getLineCount());
+    // Both halves of the CRLF are kept in the page
+    const page = tb.stream_pages.items[0];
+    try std.testing.expectEqualStrings("hello world\r\nnext", page.buf[0..page.len]);
+
+    var line: [32]u8 = undefined;
+    for (0..1000) |i| {
+        try tb.appendStreaming(try std.fmt.bufPrint(&line, "\nline {d}", .{i}));
+    }
+    try std.testing.expectEqual(@as(u32, 1002), tb.getLineCount());
+    try std.testing.expectEqual(@as(usize, 1), tb.mem_registry.getUsedSlots());
+
+    var out_buffer: [31]u8 = undefined;
+    const written = tb.getPlainTextIntoBuffer(&out_buffer);
+    try std.testing.expectEqualStrings("hello world\nnext\nline 0\nline 1\n", out_buffer[0..written]);
+}
+
+test "TextBuffer appendStreaming - line cap keeps memory and mem slots bounded" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer tb.deinit();
+
+    try tb.setMaxLines(100);
+    const view_id = try tb.registerView();
+
+    var line: [80]u8 = undefined;
+    try tb.appendStreaming("line 0 of a long running tail, padded out to a realistic log width");
+    for (1..50_000) |i| {
+        try tb.appendStreaming(try std.fmt.bufPrint(&line, "\nline {d} of a long running tail, padded out to a realistic log width", .{i}));
+    }
+
+    try std.testing.expectEqual(@as(u32, 100), tb.getLineCount());
+    try std.testing.expect(tb.mem_registry.getUsedSlots() <= 3);
+    try std.testing.expect(tb.getArenaAllocatedBytes() < 4 * 1024 * 1024);
+
+    const text = try std.testing.allocator.alloc(u8, tb.getByteSize());
+    defer std.testing.allocator.free(text);
+    const written = tb.getPlainTextIntoBuffer(text);
+    try std.testing.expect(std.mem.startsWith(u8, text[0..written], "line 49900 of"));
+    try std.testing.expect(std.mem.endsWith(u8, text[0..written], "line 49999 of a long running tail, padded out to a realistic log width"));
+
+    // Views learn about the drop separately from the appended tail. Keep an
+    // arena compaction, which dirties views wholesale, out of the way.
+    tb.stream_compact_at = std.math.maxInt(usize);
+    tb.clearViewDirty(view_id);
+    try tb.appendStreaming("\nline 50000");
+    const lines = tb.getViewDirtyLines(view_id).?;
+    try std.testing.expectEqual(@as(u32, 1), lines.dropped_lines);
+    try std.testing.expectEqual(@as(u32, 98), lines.start);
+    try std.testing.expectEqual(@as(u32, 100), lines.end);
+    try std.testing.expectEqual(@as(u32, 99), lines.oldEnd());
+    tb.unregisterView(view_id);
+}
+
+test "TextBuffer - thousands of setText and append calls reclaim mem slots" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var tb = try TextBuffer.init(std.testing.allocator, pool, .unicode);
+    defer tb.deinit();
+
+    // Well past the old 255-slot limit
+    var i: usize = 0;
+    while (i < 5000) : (i += 1) {
+        try tb.setText("first line\n");
+        try tb.append("second line");
+        try std.testing.expect(tb.mem_registry.getUsedSlots() <= 2 * 64 + 2);
+    }
+
+    var out: [64]u8 = undefined;
+    const len = tb.getPlainTextIntoBuffer(&out);
+    try std.testing.expectEqualStrings("first line\nsecond line", out[0..len]);
+
+    // Only the two buffers of the current text are still referenced
+    _ = try tb.reclaimMemBuffers();
+    try std.testing.expectEqual(@as(usize, 2), tb.mem_registry.getUsedSlots());
+}
+
+test "TextBuffer - parallel load produces the same segments as serial load" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    // Big enough to be split into several parts; mixes CRLF, CR, tabs,
+    // wide characters and empty lines
+    const lines = [_][]const u8{
+        "plain ascii line\n",
+        "tab\tseparated\tline\r\n",
+        "世界 wide 🌍 text\n",
+        "\n",
+        "old mac line\r",
+        "café naïve résumé\r\n",
+    };
+    var text: std.ArrayListUnmanaged(u8) = .{};
+    defer text.deinit(std.testing.allocator);
+    var i: usize = 0;
+    while (text.items.len < 5 * 1024 * 1024) : (i += 1) {
+        try text.appendSlice(std.testing.allocator, lines[i % lines.len]);
+    }
+    try text.appendSlice(std.testing.allocator, "no trailing newline");
+
+    var serial = try TextBuffer.init(std.testing.allocator, pool, .unicode);
+    defer serial.deinit();
+    serial.load_threads = 1;
+    try serial.setText(text.items);
+
+    var parallel = try TextBuffer.init(std.testing.allocator, pool, .unicode);
+    defer parallel.deinit();
+    parallel.load_threads = 4;
+    try parallel.setText(text.items);
+
+    try std.testing.expectEqual(serial.getLineCount(), parallel.getLineCount());
+    try std.testing.expectEqual(serial.getLength(), parallel.getLength());
+
+    var arena = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena.deinit();
+    const expected = try serial.rope.to_array(arena.allocator());
+    const actual = try parallel.rope.to_array(arena.allocator());
+    try std.testing.expectEqual(expected.len, actual.len);
+
+    for (expected, actual) |want, got| {
+        try std.testing.expectEqual(std.meta.activeTag(want), std.meta.activeTag(got));
+        if (want.asText()) |want_chunk| {
+            const got_chunk = got.asText().?;
+            try std.testing.expectEqual(want_chunk.byte_start, got_chunk.byte_start);
+            try std.testing.expectEqual(want_chunk.byte_end, got_chunk.byte_end);
+            try std.testing.expectEqual(want_chunk.width, got_chunk.width);
+            try std.testing.expectEqual(want_chunk.flags, got_chunk.flags);
+        }
+    }
+}
@@ -3505,6 +3505,52 @@ test "calculateTextWidth: Hangul Jamo" {
     try testing.expectEqual(@as(u32, 2), width); // Hangul Jamo is width 2
 }
 
+fn repeatText(buf: []u8, unit: []const u8, count: usize) []const u8 {
+    for (0..count) |i| @memcpy(buf[i * unit.len ..][0..unit.len], unit);
+    return buf[0 .. unit.len * count];
+}
+
+test "calculateTextWidth: long CJK and Hangul runs" {
+    var buf: [512]u8 = undefined;
+    const cjk = repeatText(&buf, "中文", 50);
+    try testing.expectEqual(@as(u32, 200), utf8.calculateTextWidth(cjk, 4, false, .unicode));
+    try testing.expectEqual(@as(u32, 200), utf8.calculateTextWidth(cjk, 4, false, .wcwidth));
+
+    const hangul = repeatText(&buf, "한국어", 20);
+    try testing.expectEqual(@as(u32, 120), utf8.calculateTextWidth(hangul, 4, false, .unicode));
+    try testing.expectEqual(@as(u32, 120), utf8.calculateTextWidth(hangul, 4, false, .no_zwj));
+}
+
+test "calculateTextWidth: long Latin, Greek and Cyrillic runs" {
+    var buf: [512]u8 = undefined;
+    const text = repeatText(&buf, "éñüαβγжзи", 20);
+    try testing.expectEqual(@as(u32, 180), utf8.calculateTextWidth(text, 4, false, .unicode));
+    try testing.expectEqual(@as(u32, 180), utf8.calculateTextWidth(text, 4, false, .wcwidth));
+}
+
+test "calculateTextWidth: marks after a long run attach to its last codepoint" {
+    var buf: [512]u8 = undefined;
+    var len = repeatText(&buf, "中", 40).len;
+    @memcpy(buf[len..][0..2], "\u{0301}");
+    len += 2;
+    try testing.expectEqual(@as(u32, 80), utf8.calculateTextWidth(buf[0..len], 4, false, .unicode));
+
+    len = repeatText(&buf, "ж", 40).len;
+    @memcpy(buf[len..][0..3], "\u{FE0F}");
+    len += 3;
+    // VS16 turns the narrow final letter into an emoji presentation
+    try testing.expectEqual(@as(u32, 41), utf8.calculateTextWidth(buf[0..len], 4, false, .unicode));
+}
+
+test "calculateTextWidth: a leading jamo still joins the syllable run" {
+    var buf: [512]u8 = undefined;
+    @memcpy(buf[0..3], "\u{1100}");
+    const len = 3 + repeatText(buf[3..], "가", 40).len;
+    // ᄀ+가 form one width-2 cluster, then 39 syllables of width 2
+    try testing.expectEqual(@as(u32, 80), utf8.calculateTextWidth(buf[0..len], 4, false, .unicode));
+    try testing.expectEqual(@as(u32, 82), utf8.calculateTextWidth(buf[0..len], 4, false, .wcwidth));
+}
+
 // ============================================================================
 // MIXED SCRIPT COMPREHENSIVE TESTS
 // ============================================================================
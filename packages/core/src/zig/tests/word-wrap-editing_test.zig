@@ -444,3 +444,83 @@ test "Word wrap - incremental character edits near boundary" {
     try std.testing.expectEqual(@as(u32, 14), vlines[0].width);
     try std.testing.expectEqual(@as(u32, 6), vlines[1].width);
 }
+
+fn expectSameAsFreshView(view: *TextBufferView, eb: *EditBuffer) !void {
+    var fresh = try TextBufferView.init(std.testing.allocator, eb.getTextBuffer());
+    defer fresh.deinit();
+    fresh.setWrapMode(view.wrap_mode);
+    fresh.setWrapWidth(view.wrap_width);
+
+    const expected = fresh.getLogicalLineInfo();
+    const actual = view.getLogicalLineInfo();
+    try std.testing.expectEqualSlices(u32, expected.starts, actual.starts);
+    try std.testing.expectEqualSlices(u32, expected.widths, actual.widths);
+    try std.testing.expectEqualSlices(u32, expected.sources, actual.sources);
+    try std.testing.expectEqualSlices(u32, expected.wraps, actual.wraps);
+
+    const expected_wrap = fresh.getWrapInfo();
+    const actual_wrap = view.getWrapInfo();
+    try std.testing.expectEqualSlices(u32, expected_wrap.line_first_vline, actual_wrap.line_first_vline);
+    try std.testing.expectEqualSlices(u32, expected_wrap.line_vline_counts, actual_wrap.line_vline_counts);
+
+    const expected_vlines = fresh.getVirtualLines();
+    const actual_vlines = view.getVirtualLines();
+    try std.testing.expectEqual(expected_vlines.len, actual_vlines.len);
+    for (expected_vlines, actual_vlines) |e, a| {
+        try std.testing.expectEqual(e.char_offset, a.char_offset);
+        try std.testing.expectEqual(e.source_line, a.source_line);
+        try std.testing.expectEqual(e.source_col_offset, a.source_col_offset);
+        try std.testing.expectEqual(e.chunks.items.len, a.chunks.items.len);
+    }
+}
+
+test "Word wrap - incremental rewrap matches a full rebuild" {
+    const pool = gp.initGlobalPool(std.testing.allocator);
+    defer gp.deinitGlobalPool();
+
+    var eb = try EditBuffer.init(std.testing.allocator, pool, .wcwidth);
+    defer eb.deinit();
+
+    var view = try TextBufferView.init(std.testing.allocator, eb.getTextBuffer());
+    defer view.deinit();
+
+    view.setWrapMode(.word);
+    view.setWrapWidth(12);
+
+    try eb.setText("first line of text\nsecond\nthird line wraps around\nfourth\nfifth and last");
+    try expectSameAsFreshView(view, eb);
+
+    // Single keystroke inside a wrapped line
+    try eb.setCursor(2, 5);
+    try eb.insertText("x");
+    try expectSameAsFreshView(view, eb);
+
+    // Splitting a line shifts everything after it
+    try eb.insertText("\nnew");
+    try expectSameAsFreshView(view, eb);
+
+    // Joining lines
+    try eb.setCursor(4, 0);
+    try eb.backspace();
+    try expectSameAsFreshView(view, eb);
+
+    // Several edits before the view catches up
+    try eb.setCursor(0, 0);
+    try eb.insertText("a much longer opening ");
+    try eb.setCursor(4, 3);
+    try eb.insertText("\n\n");
+    try eb.deleteRange(.{ .row = 1, .col = 2 }, .{ .row = 3, .col = 1 });
+    try expectSameAsFreshView(view, eb);
+
+    // Edits at the very end of the buffer
+    const last_row = eb.getTextBuffer().getLineCount() - 1;
+    try eb.setCursor(last_row, 0);
+    try eb.deleteLine();
+    try expectSameAsFreshView(view, eb);
+
+    view.setWrapMode(.none);
+    _ = view.getVirtualLineCount();
+    try eb.setCursor(0, 3);
+    try eb.insertText("y\nz");
+    try expectSameAsFreshView(view, eb);
+}
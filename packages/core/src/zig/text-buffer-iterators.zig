@@ -133,6 +133,90 @@ pub fn walkLinesAndSegments(
     }
 }
 
+/// Like walkLinesAndSegments, but only visits logical lines [first_line, end_line).
+/// Line indices and char offsets passed to the callbacks are absolute.
+/// Takes mutable rope for lazy marker cache rebuilding
+pub fn walkLinesAndSegmentsInRange(
+    rope: *UnifiedRope,
+    first_line: u32,
+    end_line: u32,
+    ctx: *anyopaque,
+    segment_callback: *const fn (ctx: *anyopaque, line_idx: u32, chunk: *const TextChunk, chunk_idx_in_line: u32) void,
+    line_end_callback: *const fn (ctx: *anyopaque, line_info: LineInfo) void,
+) void {
+    const last_line = @min(end_line, rope.markerCount(.linestart));
+    if (first_line >= last_line) return;
+
+    const marker = rope.getMarker(.linestart, first_line) orelse return;
+
+    const WalkContext = struct {
+        user_ctx: *anyopaque,
+        seg_callback: *const fn (ctx: *anyopaque, line_idx: u32, chunk: *const TextChunk, chunk_idx_in_line: u32) void,
+        line_callback: *const fn (ctx: *anyopaque, line_info: LineInfo) void,
+        end_line: u32,
+        first_seg: u32,
+        current_line_idx: u32,
+        current_char_offset: u32,
+        line_start_seg: u32,
+        current_seg_idx: u32,
+        line_width: u32 = 0,
+        chunk_idx_in_line: u32 = 0,
+
+        fn walker(walk_ctx_ptr: *anyopaque, seg: *const Segment, idx: u32) UnifiedRope.Node.WalkerResult {
+            const walk_ctx = @as(*@This(), @ptrCast(@alignCast(walk_ctx_ptr)));
+            // walk_from reports indices relative to its start leaf
+            const seg_idx = walk_ctx.first_seg + idx;
+
+            if (seg.asText()) |chunk| {
+                walk_ctx.seg_callback(walk_ctx.user_ctx, walk_ctx.current_line_idx, chunk, walk_ctx.chunk_idx_in_line);
+                walk_ctx.chunk_idx_in_line += 1;
+                walk_ctx.line_width += chunk.width;
+            } else if (seg.isBreak()) {
+                walk_ctx.line_callback(walk_ctx.user_ctx, LineInfo{
+                    .line_idx = walk_ctx.current_line_idx,
+                    .char_offset = walk_ctx.current_char_offset,
+                    .width = walk_ctx.line_width,
+                    .seg_start = walk_ctx.line_start_seg,
+                    .seg_end = seg_idx,
+                });
+
+                walk_ctx.current_line_idx += 1;
+                walk_ctx.current_char_offset += walk_ctx.line_width + 1;
+                walk_ctx.line_start_seg = seg_idx + 1;
+                walk_ctx.line_width = 0;
+                walk_ctx.chunk_idx_in_line = 0;
+            }
+
+            walk_ctx.current_seg_idx = seg_idx + 1;
+            return .{ .keep_walking = walk_ctx.current_line_idx < walk_ctx.end_line };
+        }
+    };
+
+    var walk_ctx = WalkContext{
+        .user_ctx = ctx,
+        .seg_callback = segment_callback,
+        .line_callback = line_end_callback,
+        .end_line = last_line,
+        .first_seg = marker.leaf_index,
+        .current_line_idx = first_line,
+        .current_char_offset = marker.global_weight,
+        .line_start_seg = marker.leaf_index,
+        .current_seg_idx = marker.leaf_index,
+    };
+    rope.walk_from(marker.leaf_index, &walk_ctx, WalkContext.walker) catch {};
+
+    // The final line has no break after it
+    if (walk_ctx.current_line_idx < walk_ctx.end_line) {
+        line_end_callback(ctx, LineInfo{
+            .line_idx = walk_ctx.current_line_idx,
+            .char_offset = walk_ctx.current_char_offset,
+            .width = walk_ctx.line_width,
+            .seg_start = walk_ctx.line_start_seg,
+            .seg_end = walk_ctx.current_seg_idx,
+        });
+    }
+}
+
 pub fn getLineCount(rope: *const UnifiedRope) u32 {
     const metrics = rope.root.metrics();
     return metrics.custom.linestart_count;
@@ -7,6 +7,7 @@ const mem_registry_mod = @import("mem-registry.zig");
 const gp = @import("grapheme.zig");
 
 const utf8 = @import("utf8.zig");
+const chunk_cache_mod = @import("chunk-cache.zig");
 
 pub const RGBA = buffer.RGBA;
 pub const TextSelection = buffer.TextSelection;
@@ -20,6 +21,12 @@ pub const TextBufferError = error{
 };
 
 const MemRegistry = mem_registry_mod.MemRegistry;
+const MemId = mem_registry_mod.MemId;
+const ChunkKey = chunk_cache_mod.ChunkKey;
+
+pub const ChunkCache = chunk_cache_mod.ChunkCache;
+pub const GraphemeIterator = chunk_cache_mod.GraphemeIterator;
+pub const WrapBreakIterator = chunk_cache_mod.WrapBreakIterator;
 
 pub const WrapMode = enum {
     none,
@@ -36,13 +43,11 @@ pub const GraphemeInfo = utf8.GraphemeInfo;
 
 /// A chunk represents a contiguous sequence of UTF-8 bytes from a specific memory buffer
 pub const TextChunk = struct {
-    mem_id: u8,
+    mem_id: MemId,
     byte_start: u32,
     byte_end: u32,
     width: u16,
     flags: u8 = 0,
-    graphemes: ?[]GraphemeInfo = null,
-    wrap_offsets: ?[]utf8.WrapBreak = null,
 
     pub const Flags = struct {
         pub const ASCII_ONLY: u8 = 0b00000001;
@@ -70,67 +75,56 @@ pub const TextChunk = struct {
         return mem_buf[self.byte_start..self.byte_end];
     }
 
+    fn cacheKey(self: *const TextChunk) ChunkKey {
+        return .{ .mem_id = self.mem_id, .byte_start = self.byte_start, .byte_end = self.byte_end };
+    }
+
     /// Lazily compute and cache grapheme info for this chunk
-    /// Returns a slice that is valid until the buffer is reset
-    /// For ASCII-only chunks, returns an empty slice (sentinel)
-    /// For mixed chunks, returns only multibyte (non-ASCII) graphemes and tabs with their column offsets
+    /// The iterator is valid until the next cache insert or buffer reset
+    /// For ASCII-only chunks, yields nothing
+    /// For mixed chunks, yields only multibyte (non-ASCII) graphemes and tabs with their column offsets
     pub fn getGraphemes(
         self: *const TextChunk,
+        cache: *ChunkCache,
         mem_registry: *const MemRegistry,
-        allocator: Allocator,
         tabwidth: u8,
         width_method: utf8.WidthMethod,
-    ) TextBufferError![]const GraphemeInfo {
-        const mut_self = @constCast(self);
-        if (self.graphemes) |cached| {
-            return cached;
-        }
+    ) TextBufferError!GraphemeIterator {
+        if (self.isAsciiOnly()) return GraphemeIterator.empty;
 
-        if (self.isAsciiOnly()) {
-            const empty_slice = try allocator.alloc(GraphemeInfo, 0);
-            mut_self.graphemes = empty_slice;
-            return empty_slice;
-        }
+        const key = self.cacheKey();
+        const generation = mem_registry.getGeneration(self.mem_id);
+        if (cache.getGraphemes(key, generation)) |cached| return cached;
 
         const chunk_bytes = self.getBytes(mem_registry);
 
         var grapheme_list: std.ArrayListUnmanaged(GraphemeInfo) = .{};
-        errdefer grapheme_list.deinit(allocator);
-
-        try utf8.findGraphemeInfo(chunk_bytes, tabwidth, self.isAsciiOnly(), width_method, allocator, &grapheme_list);
+        defer grapheme_list.deinit(cache.allocator);
 
-        // TODO: Calling this with an arena allocator will just double the memory usage?
-        const graphemes = try grapheme_list.toOwnedSlice(allocator);
+        try utf8.findGraphemeInfo(chunk_bytes, tabwidth, false, width_method, cache.allocator, &grapheme_list);
 
-        mut_self.graphemes = graphemes;
-        return graphemes;
+        return cache.putGraphemes(key, generation, grapheme_list.items);
     }
 
     /// Lazily compute and cache wrap offsets for this chunk
-    /// Returns a slice that is valid until the buffer is reset
+    /// The iterator is valid until the next cache insert or buffer reset
     pub fn getWrapOffsets(
         self: *const TextChunk,
+        cache: *ChunkCache,
         mem_registry: *const MemRegistry,
-        allocator: Allocator,
         width_method: utf8.WidthMethod,
-    ) TextBufferError![]const utf8.WrapBreak {
-        const mut_self = @constCast(self);
-        if (self.wrap_offsets) |cached| {
-            return cached;
-        }
+    ) TextBufferError!WrapBreakIterator {
+        const key = self.cacheKey();
+        const generation = mem_registry.getGeneration(self.mem_id);
+        if (cache.getWrapBreaks(key, generation)) |cached| return cached;
 
         const chunk_bytes = self.getBytes(mem_registry);
-        var wrap_result = utf8.WrapBreakResult.init(allocator);
-        errdefer wrap_result.deinit();
+        var wrap_result = utf8.WrapBreakResult.init(cache.allocator);
+        defer wrap_result.deinit();
 
         try utf8.findWrapBreaks(chunk_bytes, &wrap_result, width_method);
 
-        // TODO: Do not cache for chunks < 64 bytes, as it does not profit from the cache
-        // Use toOwnedSlice to transfer ownership without copying
-        const wrap_offsets = try wrap_result.breaks.toOwnedSlice(allocator);
-        mut_self.wrap_offsets = wrap_offsets;
-
-        return wrap_offsets;
+        return cache.putWrapBreaks(key, generation, wrap_result.breaks.items);
     }
 };
 
@@ -143,6 +137,15 @@ pub const Highlight = struct {
     hl_ref: u16 = 0,
 };
 
+/// A highlight over display-width offsets into the whole text, newlines excluded
+pub const CharRangeHighlight = struct {
+    char_start: u32,
+    char_end: u32,
+    style_id: u32,
+    priority: u8,
+    hl_ref: u16 = 0,
+};
+
 /// Pre-computed style span for efficient rendering
 /// Represents a contiguous region with a single style
 pub const StyleSpan = struct {
@@ -282,6 +285,8 @@ pub const Segment = union(enum) {
         if (left_chunk.mem_id != right_chunk.mem_id) return false;
         if (left_chunk.byte_end != right_chunk.byte_start) return false;
         if (left_chunk.flags != right_chunk.flags) return false;
+        // Chunk widths are u16; streaming appends can grow a line past that
+        if (@as(u32, left_chunk.width) + right_chunk.width > std.math.maxInt(u16)) return false;
 
         return true;
     }
@@ -292,9 +297,6 @@ pub const Segment = union(enum) {
         const left_chunk = left.asText().?;
         const right_chunk = right.asText().?;
 
-        // TODO: could clear the caches on the original chunks,
-        // as the original chunks are only kept for history purposes.
-
         return Segment{
             .text = TextChunk{
                 .mem_id = left_chunk.mem_id,
@@ -302,8 +304,6 @@ pub const Segment = union(enum) {
                 .byte_end = right_chunk.byte_end,
                 .width = left_chunk.width + right_chunk.width,
                 .flags = left_chunk.flags,
-                .graphemes = null,
-                .wrap_offsets = null,
             },
         };
     }
@@ -16,6 +16,9 @@ const TextChunk = seg_mod.TextChunk;
 const StyleSpan = tb.StyleSpan;
 const GraphemeInfo = seg_mod.GraphemeInfo;
 
+// Logical lines sampled when a lazily wrapped view is measured at another width
+const MEASURE_SAMPLE_LINES = 256;
+
 pub const TextBufferViewError = error{
     OutOfMemory,
 };
@@ -93,6 +96,12 @@ pub const VirtualLine = struct {
     }
 };
 
+/// Half-open range of logical lines
+const LineSpan = struct {
+    start: u32,
+    end: u32,
+};
+
 pub const LocalSelection = struct {
     anchorX: i32,
     anchorY: i32,
@@ -106,6 +115,10 @@ pub const TextBufferView = UnifiedTextBufferView;
 pub const UnifiedTextBufferView = struct {
     const Self = @This();
 
+    const MIN_GARBAGE_LIMIT: usize = 64 * 1024;
+    /// Fewest logical lines a lazily wrapped view wraps at a time
+    const LAZY_WRAP_STEP: u32 = 256;
+
     text_buffer: *UnifiedTextBuffer,
     original_text_buffer: *UnifiedTextBuffer,
     view_id: u32,
@@ -114,6 +127,10 @@ pub const UnifiedTextBufferView = struct {
     viewport: ?Viewport,
     wrap_width: ?u32,
     wrap_mode: WrapMode,
+    /// Wrap only a prefix of logical lines reaching past the viewport and
+    /// extend it on demand. The virtual line count is an estimate until every
+    /// line has been wrapped.
+    lazy_wrap: bool,
     virtual_lines: std.ArrayListUnmanaged(VirtualLine),
     virtual_lines_dirty: bool,
     cached_line_starts: std.ArrayListUnmanaged(u32),
@@ -124,6 +141,10 @@ pub const UnifiedTextBufferView = struct {
     cached_line_vline_counts: std.ArrayListUnmanaged(u32),
     global_allocator: Allocator,
     virtual_lines_arena: *std.heap.ArenaAllocator,
+    /// Bytes in virtual_lines_arena orphaned by incremental rewraps. Past the
+    /// limit the next update rebuilds from scratch to reclaim them.
+    virtual_lines_garbage: usize,
+    virtual_lines_garbage_limit: usize,
 
     /// Persistent arena for measureForDimensions. Each call resets it with
     /// retain_capacity to avoid mmap/munmap churn during streaming.
@@ -159,6 +180,7 @@ pub const UnifiedTextBufferView = struct {
             .viewport = null,
             .wrap_width = null,
             .wrap_mode = .none,
+            .lazy_wrap = false,
             .virtual_lines = .{},
             .virtual_lines_dirty = true,
             .cached_line_starts = .{},
@@ -169,6 +191,8 @@ pub const UnifiedTextBufferView = struct {
             .cached_line_vline_counts = .{},
             .global_allocator = global_allocator,
             .virtual_lines_arena = virtual_lines_internal_arena,
+            .virtual_lines_garbage = 0,
+            .virtual_lines_garbage_limit = MIN_GARBAGE_LIMIT,
             .measure_arena = std.heap.ArenaAllocator.init(global_allocator),
             .tab_indicator = null,
             .tab_indicator_color = null,
@@ -242,6 +266,124 @@ pub const UnifiedTextBufferView = struct {
         }
     }
 
+    pub fn setLazyWrap(self: *Self, lazy: bool) void {
+        if (self.lazy_wrap != lazy) {
+            self.lazy_wrap = lazy;
+            self.virtual_lines_dirty = true;
+        }
+    }
+
+    pub fn getLazyWrap(self: *const Self) bool {
+        return self.lazy_wrap;
+    }
+
+    /// True once every logical line has been wrapped. Always true unless lazy.
+    pub fn isWrapComplete(self: *Self) bool {
+        self.updateVirtualLines();
+        return self.wrappedLineCount() >= self.text_buffer.getLineCount();
+    }
+
+    /// Wraps up to `max_lines` more logical lines of a lazily wrapped view, so
+    /// callers can fill it in during idle frames.
+    /// Returns true once every line is wrapped.
+    pub fn wrapMoreLines(self: *Self, max_lines: u32) bool {
+        self.updateVirtualLines();
+        const total = self.text_buffer.getLineCount();
+        const wrapped = self.wrappedLineCount();
+        if (wrapped < total) {
+            self.wrapLineRange(wrapped, @min(total, wrapped +| max_lines));
+        }
+        return self.wrappedLineCount() >= total;
+    }
+
+    fn wrappedLineCount(self: *const Self) u32 {
+        return @intCast(self.cached_line_first_vline.items.len);
+    }
+
+    /// Appends the virtual lines of logical lines [start, end) to the cache.
+    /// `start` must be the first line not wrapped yet.
+    fn wrapLineRange(self: *Self, start: u32, end: u32) void {
+        calculateVirtualLinesForLines(
+            self.text_buffer,
+            self.wrap_mode,
+            self.wrap_width,
+            self.virtual_lines_arena.allocator(),
+            VirtualLineOutput{
+                .virtual_lines = &self.virtual_lines,
+                .cached_line_starts = &self.cached_line_starts,
+                .cached_line_widths = &self.cached_line_widths,
+                .cached_line_sources = &self.cached_line_sources,
+                .cached_line_wrap_indices = &self.cached_line_wrap_indices,
+                .cached_line_first_vline = &self.cached_line_first_vline,
+                .cached_line_vline_counts = &self.cached_line_vline_counts,
+            },
+            .{ .start = start, .end = end },
+        );
+        self.virtual_lines_garbage_limit = @max(self.virtual_lines_arena.queryCapacity() / 2, MIN_GARBAGE_LIMIT);
+    }
+
+    /// Wraps until at least `line_count` logical lines are in the cache
+    fn ensureWrappedLines(self: *Self, line_count: u32) void {
+        const target = @min(line_count, self.text_buffer.getLineCount());
+        const wrapped = self.wrappedLineCount();
+        if (wrapped >= target) return;
+        self.wrapLineRange(wrapped, @min(self.text_buffer.getLineCount(), @max(target, wrapped +| LAZY_WRAP_STEP)));
+    }
+
+    /// Wraps until at least `vline_count` virtual lines exist or the buffer is exhausted
+    fn ensureWrappedVirtualLines(self: *Self, vline_count: u32) void {
+        const total = self.text_buffer.getLineCount();
+        while (self.virtual_lines.items.len < vline_count) {
+            const wrapped = self.wrappedLineCount();
+            if (wrapped >= total) break;
+            // Every logical line yields at least one virtual line
+            const missing: u32 = vline_count - @as(u32, @intCast(self.virtual_lines.items.len));
+            self.wrapLineRange(wrapped, @min(total, wrapped +| @max(missing, LAZY_WRAP_STEP)));
+            if (self.wrappedLineCount() == wrapped) break;
+        }
+    }
+
+    /// Keeps the viewport plus one screen of lookahead wrapped
+    fn ensureViewportWrapped(self: *Self) void {
+        if (self.viewport) |vp| {
+            self.ensureWrappedVirtualLines(vp.y +| vp.height +| vp.height);
+        } else {
+            self.ensureWrappedLines(LAZY_WRAP_STEP);
+        }
+    }
+
+    /// Drops cached lines from logical line `line` on; a lazily wrapped view
+    /// wraps them again when they are needed.
+    fn truncateWrappedLines(self: *Self, line: u32) void {
+        if (line >= self.wrappedLineCount()) return;
+        const vline = self.cached_line_first_vline.items[line];
+
+        for (self.virtual_lines.items[vline..]) |dropped| {
+            self.virtual_lines_garbage += dropped.chunks.capacity * @sizeOf(VirtualChunk);
+        }
+        self.virtual_lines.shrinkRetainingCapacity(vline);
+        self.cached_line_starts.shrinkRetainingCapacity(vline);
+        self.cached_line_widths.shrinkRetainingCapacity(vline);
+        self.cached_line_sources.shrinkRetainingCapacity(vline);
+        self.cached_line_wrap_indices.shrinkRetainingCapacity(vline);
+        self.cached_line_first_vline.shrinkRetainingCapacity(line);
+        self.cached_line_vline_counts.shrinkRetainingCapacity(line);
+    }
+
+    /// Virtual lines expected for the logical lines not wrapped yet, assuming
+    /// they wrap like the ones that were
+    fn estimateUnwrappedVirtualLines(self: *const Self) u32 {
+        const total = self.text_buffer.getLineCount();
+        const wrapped = self.wrappedLineCount();
+        if (wrapped >= total) return 0;
+
+        const remaining = total - wrapped;
+        if (wrapped == 0) return remaining;
+
+        const estimate = @as(u64, remaining) * self.virtual_lines.items.len / wrapped;
+        return @intCast(@min(estimate, std.math.maxInt(u32) - self.virtual_lines.items.len));
+    }
+
     fn calculateChunkFitWord(self: *const Self, chunk: *const TextChunk, char_offset_in_chunk: u32, max_width: u32) tb.ChunkFitResult {
         if (max_width == 0) return .{ .char_count = 0, .width = 0 };
 
@@ -249,7 +391,7 @@ pub const UnifiedTextBufferView = struct {
         if (total_width == 0) return .{ .char_count = 0, .width = 0 };
         if (total_width <= max_width) return .{ .char_count = total_width, .width = total_width };
 
-        const wrap_offsets = chunk.getWrapOffsets(&self.text_buffer.mem_registry, self.text_buffer.allocator, self.text_buffer.width_method) catch {
+        var wrap_offsets = chunk.getWrapOffsets(&self.text_buffer.chunk_cache, &self.text_buffer.mem_registry, self.text_buffer.width_method) catch {
             const fit_width = @min(max_width, total_width);
             return .{ .char_count = fit_width, .width = fit_width };
         };
@@ -257,7 +399,7 @@ pub const UnifiedTextBufferView = struct {
         var last_boundary: ?u32 = null;
         var first_boundary: ?u32 = null;
 
-        for (wrap_offsets) |wrap_break| {
+        while (wrap_offsets.next()) |wrap_break| {
             const offset = @as(u32, wrap_break.char_offset);
             if (offset < char_offset_in_chunk) continue;
 
@@ -287,8 +429,31 @@ pub const UnifiedTextBufferView = struct {
 
     pub fn updateVirtualLines(self: *Self) void {
         const buffer_dirty = self.text_buffer.isViewDirty(self.view_id);
-        if (!self.virtual_lines_dirty and !buffer_dirty) return;
+        if (self.virtual_lines_dirty or buffer_dirty) {
+            self.syncVirtualLines();
+        }
+
+        if (self.lazy_wrap) {
+            self.ensureViewportWrapped();
+        }
+    }
+
+    fn syncVirtualLines(self: *Self) void {
+        // Edits report the logical lines they touched; wrapping is per logical
+        // line, so everything else can be kept and shifted.
+        if (!self.virtual_lines_dirty) {
+            if (self.text_buffer.getViewDirtyLines(self.view_id)) |lines| {
+                if (self.rewrapLines(lines)) {
+                    self.text_buffer.clearViewDirty(self.view_id);
+                    return;
+                }
+            }
+        }
+
+        self.rebuildVirtualLines();
+    }
 
+    fn rebuildVirtualLines(self: *Self) void {
         _ = self.virtual_lines_arena.reset(.free_all);
         self.virtual_lines = .{};
         self.cached_line_starts = .{};
@@ -310,22 +475,192 @@ pub const UnifiedTextBufferView = struct {
             .cached_line_vline_counts = &self.cached_line_vline_counts,
         };
 
-        // Call the generic calculation function
-        calculateVirtualLinesGeneric(
+        // Lazily wrapped views start empty and wrap what the viewport needs
+        if (!self.lazy_wrap) {
+            calculateVirtualLinesGeneric(
+                self.text_buffer,
+                self.wrap_mode,
+                self.wrap_width,
+                virtual_allocator,
+                output,
+            );
+        }
+
+        self.virtual_lines_garbage = 0;
+        self.virtual_lines_garbage_limit = @max(self.virtual_lines_arena.queryCapacity() / 2, MIN_GARBAGE_LIMIT);
+        self.virtual_lines_dirty = false;
+        self.text_buffer.clearViewDirty(self.view_id);
+    }
+
+    /// Rewraps the logical lines in `lines` and splices them over the lines they
+    /// replace, shifting indices and char offsets of the lines after them.
+    /// Returns false if the cache can't be patched and needs a full rebuild.
+    fn rewrapLines(self: *Self, lines: tb.DirtyLineRange) bool {
+        if (lines.dropped_lines > 0 and !self.dropLeadingLines(lines.dropped_lines)) return false;
+        if (lines.isEmpty()) return true;
+
+        const new_line_count = self.text_buffer.getLineCount();
+        const old_line_count = @as(i64, new_line_count) - lines.line_delta;
+        const old_end = lines.oldEnd();
+
+        if (old_end < lines.start or old_end > old_line_count or lines.end > new_line_count) return false;
+        // Replaced lines stay in the arena until the next full rebuild
+        if (self.virtual_lines_garbage > self.virtual_lines_garbage_limit) return false;
+
+        const covered = self.wrappedLineCount();
+        if (covered < old_line_count) {
+            if (!self.lazy_wrap) return false;
+            // The edit reaches past the wrapped prefix: cut the prefix at the
+            // first touched line and let it be wrapped again on demand.
+            if (old_end > covered) {
+                self.truncateWrappedLines(lines.start);
+                return true;
+            }
+        } else if (covered != old_line_count) {
+            return false;
+        }
+        if (covered == 0) return false;
+
+        const vline_count = self.virtual_lines.items.len;
+        const vline_start: usize = if (lines.start < covered) self.cached_line_first_vline.items[lines.start] else vline_count;
+        const vline_end: usize = if (old_end < covered) self.cached_line_first_vline.items[old_end] else vline_count;
+
+        var char_delta: i64 = 0;
+        if (old_end < covered) {
+            if (vline_end >= vline_count) return false;
+            const new_next_start = iter_mod.coordsToOffset(&self.text_buffer.rope, lines.end, 0) orelse return false;
+            char_delta = @as(i64, new_next_start) - self.virtual_lines.items[vline_end].char_offset;
+        }
+
+        const virtual_allocator = self.virtual_lines_arena.allocator();
+
+        var new_virtual_lines = std.ArrayListUnmanaged(VirtualLine){};
+        var new_line_starts = std.ArrayListUnmanaged(u32){};
+        var new_line_widths = std.ArrayListUnmanaged(u32){};
+        var new_line_sources = std.ArrayListUnmanaged(u32){};
+        var new_line_wrap_indices = std.ArrayListUnmanaged(u32){};
+        var new_line_first_vline = std.ArrayListUnmanaged(u32){};
+        var new_line_vline_counts = std.ArrayListUnmanaged(u32){};
+
+        calculateVirtualLinesForLines(
             self.text_buffer,
             self.wrap_mode,
             self.wrap_width,
             virtual_allocator,
-            output,
+            VirtualLineOutput{
+                .virtual_lines = &new_virtual_lines,
+                .cached_line_starts = &new_line_starts,
+                .cached_line_widths = &new_line_widths,
+                .cached_line_sources = &new_line_sources,
+                .cached_line_wrap_indices = &new_line_wrap_indices,
+                .cached_line_first_vline = &new_line_first_vline,
+                .cached_line_vline_counts = &new_line_vline_counts,
+            },
+            .{ .start = lines.start, .end = lines.end },
         );
 
-        self.virtual_lines_dirty = false;
-        self.text_buffer.clearViewDirty(self.view_id);
+        // Appends swallow allocation failures, so check nothing went missing
+        if (new_line_first_vline.items.len != lines.end - lines.start) return false;
+        if (new_line_starts.items.len != new_virtual_lines.items.len) return false;
+
+        for (self.virtual_lines.items[vline_start..vline_end]) |vline| {
+            self.virtual_lines_garbage += vline.chunks.capacity * @sizeOf(VirtualChunk);
+        }
+        self.virtual_lines_garbage += new_virtual_lines.capacity * @sizeOf(VirtualLine) +
+            (new_line_starts.capacity + new_line_widths.capacity + new_line_sources.capacity +
+                new_line_wrap_indices.capacity + new_line_first_vline.capacity + new_line_vline_counts.capacity) * @sizeOf(u32);
+
+        for (new_line_first_vline.items) |*first| {
+            first.* += @intCast(vline_start);
+        }
+
+        const old_vlines = vline_end - vline_start;
+        const old_lines = old_end - lines.start;
+        self.spliceList(VirtualLine, &self.virtual_lines, vline_start, old_vlines, new_virtual_lines.items) catch return false;
+        self.spliceList(u32, &self.cached_line_starts, vline_start, old_vlines, new_line_starts.items) catch return false;
+        self.spliceList(u32, &self.cached_line_widths, vline_start, old_vlines, new_line_widths.items) catch return false;
+        self.spliceList(u32, &self.cached_line_sources, vline_start, old_vlines, new_line_sources.items) catch return false;
+        self.spliceList(u32, &self.cached_line_wrap_indices, vline_start, old_vlines, new_line_wrap_indices.items) catch return false;
+        self.spliceList(u32, &self.cached_line_first_vline, lines.start, old_lines, new_line_first_vline.items) catch return false;
+        self.spliceList(u32, &self.cached_line_vline_counts, lines.start, old_lines, new_line_vline_counts.items) catch return false;
+
+        const tail_vline = vline_start + new_virtual_lines.items.len;
+        if (char_delta != 0 or lines.line_delta != 0) {
+            for (self.virtual_lines.items[tail_vline..], self.cached_line_starts.items[tail_vline..], self.cached_line_sources.items[tail_vline..]) |*vline, *line_start, *source| {
+                vline.char_offset = shiftBy(vline.char_offset, char_delta);
+                vline.source_line = shiftBy(vline.source_line, lines.line_delta);
+                line_start.* = vline.char_offset;
+                source.* = @intCast(vline.source_line);
+            }
+        }
+
+        const vline_delta = @as(i64, @intCast(new_virtual_lines.items.len)) - @as(i64, @intCast(old_vlines));
+        if (vline_delta != 0) {
+            for (self.cached_line_first_vline.items[lines.end..]) |*first| {
+                first.* = shiftBy(first.*, vline_delta);
+            }
+        }
+
+        return true;
+    }
+
+    /// Forgets the first `count` logical lines after the buffer dropped them,
+    /// shifting the lines that remain instead of rewrapping them.
+    fn dropLeadingLines(self: *Self, count: u32) bool {
+        const covered = self.wrappedLineCount();
+        if (count >= covered) {
+            if (!self.lazy_wrap or covered == 0) return false;
+            self.truncateWrappedLines(0);
+            return true;
+        }
+
+        const vline_cut = self.cached_line_first_vline.items[count];
+        const char_cut = self.virtual_lines.items[vline_cut].char_offset;
+
+        for (self.virtual_lines.items[0..vline_cut]) |dropped| {
+            self.virtual_lines_garbage += dropped.chunks.capacity * @sizeOf(VirtualChunk);
+        }
+
+        self.spliceList(VirtualLine, &self.virtual_lines, 0, vline_cut, &.{}) catch return false;
+        self.spliceList(u32, &self.cached_line_starts, 0, vline_cut, &.{}) catch return false;
+        self.spliceList(u32, &self.cached_line_widths, 0, vline_cut, &.{}) catch return false;
+        self.spliceList(u32, &self.cached_line_sources, 0, vline_cut, &.{}) catch return false;
+        self.spliceList(u32, &self.cached_line_wrap_indices, 0, vline_cut, &.{}) catch return false;
+        self.spliceList(u32, &self.cached_line_first_vline, 0, count, &.{}) catch return false;
+        self.spliceList(u32, &self.cached_line_vline_counts, 0, count, &.{}) catch return false;
+
+        for (self.virtual_lines.items, self.cached_line_starts.items, self.cached_line_sources.items) |*vline, *line_start, *source| {
+            vline.char_offset -= char_cut;
+            vline.source_line -= count;
+            line_start.* = vline.char_offset;
+            source.* = @intCast(vline.source_line);
+        }
+        for (self.cached_line_first_vline.items) |*first| {
+            first.* -= vline_cut;
+        }
+
+        return true;
+    }
+
+    fn spliceList(self: *Self, comptime T: type, list: *std.ArrayListUnmanaged(T), start: usize, len: usize, items: []const T) Allocator.Error!void {
+        const old_capacity = list.capacity;
+        try list.replaceRange(self.virtual_lines_arena.allocator(), start, len, items);
+        if (list.capacity != old_capacity) {
+            self.virtual_lines_garbage += old_capacity * @sizeOf(T);
+        }
+    }
+
+    fn shiftBy(value: anytype, delta: i64) @TypeOf(value) {
+        return @intCast(@as(i64, @intCast(value)) + delta);
     }
 
+    /// For a lazily wrapped view this includes an estimate for the lines not
+    /// wrapped yet, so scrollbars can size themselves before wrapping finishes.
     pub fn getVirtualLineCount(self: *Self) u32 {
         self.updateVirtualLines();
-        return @intCast(self.virtual_lines.items.len);
+        const wrapped: u32 = @intCast(self.virtual_lines.items.len);
+        if (!self.lazy_wrap) return wrapped;
+        return wrapped + self.estimateUnwrappedVirtualLines();
     }
 
     pub fn getVirtualLines(self: *Self) []const VirtualLine {
@@ -401,6 +736,9 @@ pub const UnifiedTextBufferView = struct {
 
     pub fn findVisualLineIndex(self: *Self, logical_row: u32, logical_col: u32) u32 {
         self.updateVirtualLines();
+        if (self.lazy_wrap) {
+            self.ensureWrappedLines(logical_row +| 1);
+        }
 
         const vlines = self.virtual_lines.items;
         if (vlines.len == 0) return 0;
@@ -725,6 +1063,48 @@ pub const UnifiedTextBufferView = struct {
             }
         }
 
+        // Lazily wrapped views estimate instead of wrapping everything
+        if (self.lazy_wrap and width > 0 and self.wrap_mode != .none) {
+            const max_line_width = iter_mod.getMaxLineWidth(&self.text_buffer.rope);
+
+            // At the view's own width the wrapped prefix gives a better estimate.
+            // It improves as wrapping progresses, so it isn't cached.
+            if (self.wrap_width == width) {
+                return MeasureResult{
+                    .line_count = self.getVirtualLineCount(),
+                    .max_width = @min(width, max_line_width),
+                };
+            }
+
+            // Other widths extrapolate from evenly spaced sample lines, so a new
+            // layout width costs a bounded number of line lookups
+            const line_count = self.text_buffer.getLineCount();
+            const samples = @min(line_count, MEASURE_SAMPLE_LINES);
+            var sampled_rows: u64 = 0;
+            for (0..samples) |i| {
+                const row: u32 = @intCast(@as(u64, i) * line_count / samples);
+                const line_width = iter_mod.lineWidthAt(&self.text_buffer.rope, row);
+                sampled_rows += @max(1, std.math.divCeil(u32, line_width, width) catch 1);
+            }
+            const estimated_lines: u32 = if (samples == 0)
+                0
+            else
+                @intCast(@min(sampled_rows * line_count / samples, std.math.maxInt(u32)));
+
+            const result = MeasureResult{
+                .line_count = estimated_lines,
+                .max_width = @min(width, max_line_width),
+            };
+
+            self.cached_measure_width = width;
+            self.cached_measure_wrap_mode = self.wrap_mode;
+            self.cached_measure_result = result;
+            self.cached_measure_epoch = epoch;
+            self.cached_measure_buffer = self.text_buffer;
+
+            return result;
+        }
+
         // No-wrap path avoids allocations by using marker-based line widths.
         if (width == 0 or self.wrap_mode == .none) {
             const line_count = self.text_buffer.getLineCount();
@@ -810,6 +1190,20 @@ pub const UnifiedTextBufferView = struct {
         wrap_width: ?u32,
         allocator: Allocator,
         output: VirtualLineOutput,
+    ) void {
+        calculateVirtualLinesForLines(text_buffer, wrap_mode, wrap_width, allocator, output, null);
+    }
+
+    /// Virtual line calculation for the logical lines in `lines`, or all lines
+    /// when null. Results are appended to the output; source lines and char
+    /// offsets are absolute and cached_line_first_vline indexes the output.
+    fn calculateVirtualLinesForLines(
+        text_buffer: *UnifiedTextBuffer,
+        wrap_mode: WrapMode,
+        wrap_width: ?u32,
+        allocator: Allocator,
+        output: VirtualLineOutput,
+        lines: ?LineSpan,
     ) void {
         if (wrap_mode == .none or wrap_width == null) {
             // No wrapping - create 1:1 mapping to real lines
@@ -862,7 +1256,11 @@ pub const UnifiedTextBufferView = struct {
                 .current_vline = VirtualLine.init(),
             };
 
-            iter_mod.walkLinesAndSegments(&text_buffer.rope, &ctx, Context.segment_callback, Context.line_end_callback);
+            if (lines) |span| {
+                iter_mod.walkLinesAndSegmentsInRange(&text_buffer.rope, span.start, span.end, &ctx, Context.segment_callback, Context.line_end_callback);
+            } else {
+                iter_mod.walkLinesAndSegments(&text_buffer.rope, &ctx, Context.segment_callback, Context.line_end_callback);
+            }
         } else {
             const wrap_w = wrap_width.?;
 
@@ -923,28 +1321,26 @@ pub const UnifiedTextBufferView = struct {
 
                     if (wctx.wrap_mode == .word) {
                         const chunk_bytes = chunk.getBytes(&wctx.text_buffer.mem_registry);
-                        const wrap_offsets = chunk.getWrapOffsets(&wctx.text_buffer.mem_registry, wctx.text_buffer.allocator, wctx.text_buffer.width_method) catch &[_]utf8.WrapBreak{};
+                        var wrap_offsets = chunk.getWrapOffsets(&wctx.text_buffer.chunk_cache, &wctx.text_buffer.mem_registry, wctx.text_buffer.width_method) catch tb.WrapBreakIterator.empty;
                         const is_ascii_only = (chunk.flags & TextChunk.Flags.ASCII_ONLY) != 0;
 
                         var char_offset: u32 = 0;
                         var byte_offset: u32 = 0;
-                        var wrap_idx: usize = 0;
                         while (char_offset < chunk.width) {
                             const remaining_in_chunk = chunk.width - char_offset;
                             const remaining_on_line = if (wctx.line_position < wctx.wrap_w) wctx.wrap_w - wctx.line_position else 0;
 
                             var last_wrap_that_fits: ?u32 = null;
-                            var saved_wrap_idx = wrap_idx;
-                            while (wrap_idx < wrap_offsets.len) : (wrap_idx += 1) {
-                                const wrap_break = wrap_offsets[wrap_idx];
+                            var saved_wrap_offsets = wrap_offsets;
+                            while (wrap_offsets.next()) |wrap_break| {
                                 const offset = @as(u32, wrap_break.char_offset);
                                 if (offset < char_offset) continue;
                                 const width_to_boundary = offset - char_offset + 1;
                                 if (width_to_boundary > remaining_on_line or width_to_boundary > remaining_in_chunk) break;
                                 last_wrap_that_fits = width_to_boundary;
-                                saved_wrap_idx = wrap_idx + 1;
+                                saved_wrap_offsets = wrap_offsets;
                             }
-                            wrap_idx = saved_wrap_idx;
+                            wrap_offsets = saved_wrap_offsets;
 
                             var to_add: u32 = 0;
                             var has_wrap_after: bool = false;
@@ -1168,9 +1564,18 @@ pub const UnifiedTextBufferView = struct {
                 .output = output,
                 .wrap_mode = wrap_mode,
                 .wrap_w = wrap_w,
+                .current_line_first_vline_idx = @intCast(output.virtual_lines.items.len),
             };
 
-            iter_mod.walkLinesAndSegments(&text_buffer.rope, &wrap_ctx, WrapContext.segment_callback, WrapContext.line_end_callback);
+            if (lines) |span| {
+                const start_offset = iter_mod.coordsToOffset(&text_buffer.rope, span.start, 0) orelse return;
+                wrap_ctx.line_idx = span.start;
+                wrap_ctx.global_char_offset = start_offset;
+                wrap_ctx.current_vline.char_offset = start_offset;
+                iter_mod.walkLinesAndSegmentsInRange(&text_buffer.rope, span.start, span.end, &wrap_ctx, WrapContext.segment_callback, WrapContext.line_end_callback);
+            } else {
+                iter_mod.walkLinesAndSegments(&text_buffer.rope, &wrap_ctx, WrapContext.segment_callback, WrapContext.line_end_callback);
+            }
         }
     }
 };
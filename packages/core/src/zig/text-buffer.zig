@@ -1,7 +1,9 @@
 const std = @import("std");
+const builtin = @import("builtin");
 const Allocator = std.mem.Allocator;
 const seg_mod = @import("text-buffer-segment.zig");
 const iter_mod = @import("text-buffer-iterators.zig");
+const highlight_index_mod = @import("highlight-index.zig");
 const mem_registry_mod = @import("mem-registry.zig");
 const ss = @import("syntax-style.zig");
 const gp = @import("grapheme.zig");
@@ -18,19 +20,117 @@ const LineInfo = iter_mod.LineInfo;
 // Re-export types from segment module
 pub const TextChunk = seg_mod.TextChunk;
 pub const MemRegistry = mem_registry_mod.MemRegistry;
+pub const MemId = mem_registry_mod.MemId;
 pub const RGBA = seg_mod.RGBA;
 pub const TextSelection = seg_mod.TextSelection;
 pub const TextBufferError = seg_mod.TextBufferError;
 pub const Highlight = seg_mod.Highlight;
+pub const CharRangeHighlight = seg_mod.CharRangeHighlight;
 pub const StyleSpan = seg_mod.StyleSpan;
 pub const WrapMode = seg_mod.WrapMode;
 pub const ChunkFitResult = seg_mod.ChunkFitResult;
 pub const GraphemeInfo = seg_mod.GraphemeInfo;
+pub const ChunkCache = seg_mod.ChunkCache;
+pub const GraphemeIterator = seg_mod.GraphemeIterator;
+pub const WrapBreakIterator = seg_mod.WrapBreakIterator;
 
 pub const SyntaxStyle = ss.SyntaxStyle;
+pub const HighlightIndex = highlight_index_mod.HighlightIndex;
 
 pub const TextBuffer = UnifiedTextBuffer;
 
+/// Logical lines changed since a view last synced. The view first forgets its
+/// first `dropped_lines` lines; then lines [start, end) of the current content
+/// replace its lines [start, end - line_delta). Lines outside the range are
+/// unchanged apart from their index and char offset.
+pub const DirtyLineRange = struct {
+    start: u32,
+    end: u32,
+    line_delta: i32,
+    dropped_lines: u32 = 0,
+
+    pub fn oldEnd(self: DirtyLineRange) u32 {
+        return @intCast(@as(i64, self.end) - self.line_delta);
+    }
+
+    /// True when only leading lines were dropped
+    pub fn isEmpty(self: DirtyLineRange) bool {
+        return self.start == self.end and self.line_delta == 0;
+    }
+
+    /// Folds a later edit, given in post-self line coordinates, into this range.
+    pub fn merge(self: DirtyLineRange, later: DirtyLineRange) DirtyLineRange {
+        if (later.dropped_lines > 0) return self.mergeDrop(later.dropped_lines).merge(.{
+            .start = later.start,
+            .end = later.end,
+            .line_delta = later.line_delta,
+        });
+        if (later.isEmpty()) return self;
+        if (self.isEmpty()) return .{
+            .start = later.start,
+            .end = later.end,
+            .line_delta = later.line_delta,
+            .dropped_lines = self.dropped_lines,
+        };
+
+        const later_old_end = later.oldEnd();
+        const end = if (self.end >= later_old_end)
+            @max(@as(u32, @intCast(@as(i64, self.end) + later.line_delta)), later.end)
+        else
+            later.end;
+        return .{
+            .start = @min(self.start, later.start),
+            .end = end,
+            .line_delta = self.line_delta + later.line_delta,
+            .dropped_lines = self.dropped_lines,
+        };
+    }
+
+    fn mergeDrop(self: DirtyLineRange, count: u32) DirtyLineRange {
+        if (self.isEmpty()) return .{ .start = 0, .end = 0, .line_delta = 0, .dropped_lines = self.dropped_lines + count };
+        if (self.start >= count) return .{
+            .start = self.start - count,
+            .end = self.end - count,
+            .line_delta = self.line_delta,
+            .dropped_lines = self.dropped_lines + count,
+        };
+
+        // The drop cuts into the range: fold it into the replaced lines instead,
+        // together with any unchanged lines it took past the range's end.
+        const end = self.end -| count;
+        const old_end = self.oldEnd() + (count -| self.end);
+        return .{
+            .start = 0,
+            .end = end,
+            .line_delta = @as(i32, @intCast(end)) - @as(i32, @intCast(old_end)),
+            .dropped_lines = self.dropped_lines,
+        };
+    }
+};
+
+/// The streaming append arena starts with pages this size and doubles them up
+/// to STREAM_PAGE_MAX, so a long tail needs few mem slots.
+const STREAM_PAGE_MIN: usize = 64 * 1024;
+const STREAM_PAGE_MAX: usize = 4 * 1024 * 1024;
+/// Arena size below which a line-capped stream never compacts its rope
+const STREAM_COMPACT_MIN: usize = 1024 * 1024;
+
+/// Reclaimable mem slots are swept once this many accumulate; after a sweep
+/// the threshold becomes twice what survived, keeping sweeps amortized.
+const RECLAIM_MIN_SLOTS: usize = 64;
+
+/// Texts at least this large are analyzed on several threads, each taking a
+/// newline-aligned part of at least this many bytes.
+const PARALLEL_LOAD_PART_MIN: usize = 1024 * 1024;
+const PARALLEL_LOAD_MAX_THREADS: usize = 16;
+
+/// A page of the streaming append arena, registered once as an owned mem slot
+const StreamPage = struct {
+    mem_id: MemId,
+    buf: []u8,
+    len: usize,
+};
+
 pub const StyledChunk = extern struct {
     text_ptr: [*]const u8,
     text_len: usize,
@@ -59,6 +159,9 @@ pub const UnifiedTextBuffer = struct {
     width_method: utf8.WidthMethod,
 
     view_dirty_flags: std.ArrayListUnmanaged(bool),
+    /// Per view: the lines touched since the view last synced, or null when the
+    /// view must rebuild everything. Only meaningful while the view is dirty.
+    view_dirty_lines: std.ArrayListUnmanaged(?DirtyLineRange),
     next_view_id: u32,
     free_view_ids: std.ArrayListUnmanaged(u32),
 
@@ -66,19 +169,35 @@ pub const UnifiedTextBuffer = struct {
     /// to detect stale caches even after clearViewDirty() runs.
     content_epoch: u64,
 
-    // Per-line highlight cache (invalidated on edits)
-    // Maps line_idx to highlights for that line
-    line_highlights: std.ArrayListUnmanaged(std.ArrayListUnmanaged(Highlight)),
-    line_spans: std.ArrayListUnmanaged(std.ArrayListUnmanaged(StyleSpan)),
+    // Per-line highlights and their style spans, moved along by line edits
+    highlights: HighlightIndex,
     highlight_batch_depth: u32,
     dirty_span_lines: std.AutoHashMap(usize, void),
 
-    styled_text_mem_id: ?u8,
+    styled_text_mem_id: ?MemId,
     styled_buffer: ?[]u8,
     styled_capacity: usize,
 
     tab_width: u8,
 
+    /// Per-chunk grapheme and wrap-break metadata, delta-encoded and shared by
+    /// every rope version; reported through getArenaAllocatedBytes
+    chunk_cache: ChunkCache,
+
+    // Streaming appends: pages oldest first, plus one recycled page kept
+    // registered for reuse once the line cap frees it
+    stream_pages: std.ArrayListUnmanaged(StreamPage),
+    stream_spare: ?StreamPage,
+    stream_pending_cr: bool,
+    stream_max_lines: ?u32,
+    stream_compact_at: usize,
+
+    reclaim_at: usize,
+
+    /// Upper bound on threads used to analyze large texts; 0 picks the CPU count
+    /// and 1 keeps analysis on the calling thread
+    load_threads: u32,
+
     pub fn init(
         global_allocator: Allocator,
         pool: *gp.GraphemePool,
@@ -98,6 +217,9 @@ pub const UnifiedTextBuffer = struct {
         var view_dirty_flags: std.ArrayListUnmanaged(bool) = .{};
         errdefer view_dirty_flags.deinit(global_allocator);
 
+        var view_dirty_lines: std.ArrayListUnmanaged(?DirtyLineRange) = .{};
+        errdefer view_dirty_lines.deinit(global_allocator);
+
         var free_view_ids: std.ArrayListUnmanaged(u32) = .{};
         errdefer free_view_ids.deinit(global_allocator);
 
@@ -120,17 +242,25 @@ pub const UnifiedTextBuffer = struct {
             .pool = pool,
             .width_method = width_method,
             .view_dirty_flags = view_dirty_flags,
+            .view_dirty_lines = view_dirty_lines,
             .next_view_id = 0,
             .free_view_ids = free_view_ids,
             .content_epoch = 0,
-            .line_highlights = .{},
-            .line_spans = .{},
+            .highlights = HighlightIndex.init(global_allocator),
             .highlight_batch_depth = 0,
             .dirty_span_lines = dirty_span_lines,
             .styled_text_mem_id = null,
             .styled_buffer = null,
             .styled_capacity = 0,
             .tab_width = 2,
+            .chunk_cache = ChunkCache.init(global_allocator),
+            .stream_pages = .{},
+            .stream_spare = null,
+            .stream_pending_cr = false,
+            .stream_max_lines = null,
+            .stream_compact_at = STREAM_COMPACT_MIN,
+            .reclaim_at = RECLAIM_MIN_SLOTS,
+            .load_threads = 0,
         };
 
         return self;
@@ -142,18 +272,11 @@ pub const UnifiedTextBuffer = struct {
         }
 
         self.view_dirty_flags.deinit(self.global_allocator);
+        self.view_dirty_lines.deinit(self.global_allocator);
         self.free_view_ids.deinit(self.global_allocator);
 
         // Free highlight/span caches
-        for (self.line_highlights.items) |*hl_list| {
-            hl_list.deinit(self.global_allocator);
-        }
-        self.line_highlights.deinit(self.global_allocator);
-
-        for (self.line_spans.items) |*span_list| {
-            span_list.deinit(self.global_allocator);
-        }
-        self.line_spans.deinit(self.global_allocator);
+        self.highlights.deinit();
 
         // Free dirty span lines hashmap
         self.dirty_span_lines.deinit();
@@ -163,6 +286,10 @@ pub const UnifiedTextBuffer = struct {
             self.global_allocator.free(buf);
         }
 
+        // Stream pages are owned by their mem slots
+        self.stream_pages.deinit(self.global_allocator);
+
+        self.chunk_cache.deinit();
         self.mem_registry.deinit();
         self.arena.deinit();
         self.global_allocator.destroy(self.arena);
@@ -175,12 +302,15 @@ pub const UnifiedTextBuffer = struct {
             const id = self.free_view_ids.items[self.free_view_ids.items.len - 1];
             _ = self.free_view_ids.pop();
             self.view_dirty_flags.items[id] = true;
+            self.view_dirty_lines.items[id] = null;
             return id;
         }
 
         const id = self.next_view_id;
-        self.next_view_id += 1;
+        try self.view_dirty_lines.append(self.global_allocator, null);
+        errdefer _ = self.view_dirty_lines.pop();
         try self.view_dirty_flags.append(self.global_allocator, true);
+        self.next_view_id += 1;
         return id;
     }
 
@@ -203,6 +333,16 @@ pub const UnifiedTextBuffer = struct {
         }
     }
 
+    /// Lines touched since the view last synced. Null when the view is clean or
+    /// when an edit not expressible as a line range requires a full rebuild;
+    /// check isViewDirty() to tell the two apart.
+    pub fn getViewDirtyLines(self: *const Self, view_id: u32) ?DirtyLineRange {
+        if (view_id < self.view_dirty_flags.items.len and self.view_dirty_flags.items[view_id]) {
+            return self.view_dirty_lines.items[view_id];
+        }
+        return null;
+    }
+
     /// Returns the current content epoch. Use this to detect buffer changes
     /// independent of the dirty flag (other code paths may clear dirty).
     pub fn getContentEpoch(self: *const Self) u64 {
@@ -213,8 +353,9 @@ pub const UnifiedTextBuffer = struct {
         // Increment epoch first so views see the new value when checking caches.
         // Use wrapping add for safety, though u64 won't overflow in practice.
         self.content_epoch +%= 1;
-        for (self.view_dirty_flags.items) |*flag| {
+        for (self.view_dirty_flags.items, self.view_dirty_lines.items) |*flag, *lines| {
             flag.* = true;
+            lines.* = null;
         }
     }
 
@@ -222,6 +363,59 @@ pub const UnifiedTextBuffer = struct {
         self.markAllViewsDirty();
     }
 
+    /// Records an edit that replaced lines [start, old_end) with [start, new_end),
+    /// so views can rewrap just those lines. Views already waiting on a full
+    /// rebuild stay that way.
+    pub fn markLinesDirty(self: *Self, start: u32, old_end: u32, new_end: u32) void {
+        self.moveLineHighlights(old_end, new_end);
+        self.content_epoch +%= 1;
+        self.markViewLinesDirty(.{
+            .start = start,
+            .end = new_end,
+            .line_delta = @as(i32, @intCast(new_end)) - @as(i32, @intCast(old_end)),
+        });
+    }
+
+    /// Records a batch of edits applied one after another, each in the line
+    /// coordinates left by the edits before it. Highlights move per edit, but
+    /// views are flagged once with the merged range.
+    pub fn markLineEditsDirty(self: *Self, edits: []const DirtyLineRange) void {
+        if (edits.len == 0) return;
+        var merged = edits[0];
+        for (edits, 0..) |edit, i| {
+            self.moveLineHighlights(edit.oldEnd(), edit.end);
+            if (i > 0) merged = merged.merge(edit);
+        }
+        self.content_epoch +%= 1;
+        self.markViewLinesDirty(merged);
+    }
+
+    fn markViewLinesDirty(self: *Self, edit: DirtyLineRange) void {
+        for (self.view_dirty_flags.items, self.view_dirty_lines.items) |*flag, *lines| {
+            if (!flag.*) {
+                flag.* = true;
+                lines.* = edit;
+            } else if (lines.*) |pending| {
+                lines.* = pending.merge(edit);
+            }
+        }
+    }
+
+    /// Records that the first `count` lines were removed, so views can drop
+    /// them from their caches instead of rewrapping what remains.
+    pub fn markLinesDropped(self: *Self, count: u32) void {
+        self.content_epoch +%= 1;
+        const drop = DirtyLineRange{ .start = 0, .end = 0, .line_delta = 0, .dropped_lines = count };
+        for (self.view_dirty_flags.items, self.view_dirty_lines.items) |*flag, *lines| {
+            if (!flag.*) {
+                flag.* = true;
+                lines.* = drop;
+            } else if (lines.*) |pending| {
+                lines.* = pending.merge(drop);
+            }
+        }
+    }
+
     // Basic queries using unified rope
     pub fn getLength(self: *const Self) u32 {
         const metrics = self.rope.root.metrics();
@@ -257,15 +451,7 @@ pub const UnifiedTextBuffer = struct {
 
     pub fn reset(self: *Self) void {
         // Free highlight/span arrays (they use global_allocator, not arena)
-        for (self.line_highlights.items) |*hl_list| {
-            hl_list.deinit(self.global_allocator);
-        }
-        self.line_highlights.clearRetainingCapacity();
-
-        for (self.line_spans.items) |*span_list| {
-            span_list.deinit(self.global_allocator);
-        }
-        self.line_spans.clearRetainingCapacity();
+        self.highlights.clear();
 
         // Free persistent styled text buffer
         if (self.styled_buffer) |buf| {
@@ -279,6 +465,12 @@ pub const UnifiedTextBuffer = struct {
         _ = self.arena.reset(if (self.arena.queryCapacity() > 0) .retain_capacity else .free_all);
 
         self.mem_registry.clear();
+        self.chunk_cache.clear();
+        self.stream_pages.clearRetainingCapacity();
+        self.stream_spare = null;
+        self.stream_pending_cr = false;
+        self.stream_compact_at = STREAM_COMPACT_MIN;
+        self.reclaim_at = RECLAIM_MIN_SLOTS;
 
         self.rope = UnifiedRope.init(self.allocator) catch return;
 
@@ -326,12 +518,12 @@ pub const UnifiedTextBuffer = struct {
     /// Set the text content using SIMD-optimized line break detection
     pub fn setText(self: *Self, text: []const u8) TextBufferError!void {
         self.clear();
-        const mem_id = try self.mem_registry.register(text, false);
+        const mem_id = try self.registerReclaimable(text, false);
         try self.setTextInternal(mem_id, text);
     }
 
     /// Set text from a pre-registered memory ID
-    pub fn setTextFromMemId(self: *Self, mem_id: u8) TextBufferError!void {
+    pub fn setTextFromMemId(self: *Self, mem_id: MemId) TextBufferError!void {
         const text = self.mem_registry.get(mem_id) orelse return TextBufferError.InvalidMemId;
         self.clear();
         try self.setTextInternal(mem_id, text);
@@ -343,18 +535,18 @@ pub const UnifiedTextBuffer = struct {
             return;
         }
 
-        const mem_id = try self.mem_registry.register(text, false);
+        const mem_id = try self.registerReclaimable(text, false);
         try self.appendInternal(mem_id, text);
     }
 
     /// Append text from a pre-registered memory ID
-    pub fn appendFromMemId(self: *Self, mem_id: u8) TextBufferError!void {
+    pub fn appendFromMemId(self: *Self, mem_id: MemId) TextBufferError!void {
         const text = self.mem_registry.get(mem_id) orelse return TextBufferError.InvalidMemId;
         try self.appendInternal(mem_id, text);
     }
 
     /// Internal append that doesn't register memory
-    fn appendInternal(self: *Self, mem_id: u8, text: []const u8) TextBufferError!void {
+    fn appendInternal(self: *Self, mem_id: MemId, text: []const u8) TextBufferError!void {
         if (text.len == 0) {
             return;
         }
@@ -369,8 +561,191 @@ pub const UnifiedTextBuffer = struct {
         self.markAllViewsDirty();
     }
 
+    /// Append text through the streaming arena, for log tails and other
+    /// high-rate appenders. The bytes are copied into pooled pages, so callers
+    /// may reuse their buffer and the number of mem slots stays bounded.
+    /// Consecutive appends are contiguous within a page, so text without a
+    /// line break extends the last chunk in place, and views rewrap only the
+    /// last line plus the lines added.
+    pub fn appendStreaming(self: *Self, text: []const u8) TextBufferError!void {
+        if (text.len == 0) return;
+
+        // A CRLF split across two appends is one break, not two. The '\n' is
+        // still stored so the pages hold exactly what was appended; only the
+        // break scan skips it.
+        const skip: usize = if (self.stream_pending_cr and text[0] == '\n') 1 else 0;
+        self.stream_pending_cr = text[text.len - 1] == '\r';
+
+        const page = try self.streamPageFor(text.len);
+        const byte_start: u32 = @intCast(page.len);
+        @memcpy(page.buf[page.len..][0..text.len], text);
+        page.len += text.len;
+
+        const bytes = text[skip..];
+        if (bytes.len == 0) return;
+
+        var result = try self.textToSegments(self.global_allocator, bytes, page.mem_id, byte_start + @as(u32, @intCast(skip)), false);
+        defer result.segments.deinit(result.allocator);
+
+        const old_line_count = self.getLineCount();
+        try self.rope.appendSlice(result.segments.items);
+
+        if (old_line_count == 0) {
+            self.markAllViewsDirty();
+        } else {
+            const last_line = old_line_count - 1;
+            self.markLinesDirty(last_line, old_line_count, self.getLineCount());
+        }
+
+        try self.enforceLineCap();
+    }
+
+    /// Cap the buffer at `max_lines` lines, dropping the oldest lines as
+    /// streaming appends add new ones. Null removes the cap.
+    pub fn setMaxLines(self: *Self, max_lines: ?u32) TextBufferError!void {
+        self.stream_max_lines = if (max_lines) |n| @max(n, 1) else null;
+        try self.enforceLineCap();
+    }
+
+    pub fn getMaxLines(self: *const Self) ?u32 {
+        return self.stream_max_lines;
+    }
+
+    fn streamPageFor(self: *Self, len: usize) TextBufferError!*StreamPage {
+        if (self.stream_pages.items.len > 0) {
+            const last = &self.stream_pages.items[self.stream_pages.items.len - 1];
+            if (last.buf.len - last.len >= len) return last;
+        }
+        // Chunk byte offsets are u32
+        if (len > std.math.maxInt(u32)) return TextBufferError.OutOfMemory;
+
+        try self.stream_pages.ensureUnusedCapacity(self.global_allocator, 1);
+
+        if (self.stream_spare) |spare| {
+            if (spare.buf.len >= len) {
+                self.stream_spare = null;
+                // The page is refilled from the start
+                self.mem_registry.touch(spare.mem_id);
+                self.stream_pages.appendAssumeCapacity(.{ .mem_id = spare.mem_id, .buf = spare.buf, .len = 0 });
+                return &self.stream_pages.items[self.stream_pages.items.len - 1];
+            }
+        }
+
+        const prev_size = if (self.stream_pages.items.len > 0) self.stream_pages.items[self.stream_pages.items.len - 1].buf.len else 0;
+        const size = @max(len, std.math.clamp(prev_size * 2, STREAM_PAGE_MIN, STREAM_PAGE_MAX));
+        const buf = self.global_allocator.alloc(u8, size) catch return TextBufferError.OutOfMemory;
+        const mem_id = self.mem_registry.register(buf, true) catch |err| {
+            self.global_allocator.free(buf);
+            return err;
+        };
+
+        self.stream_pages.appendAssumeCapacity(.{ .mem_id = mem_id, .buf = buf, .len = 0 });
+        return &self.stream_pages.items[self.stream_pages.items.len - 1];
+    }
+
+    fn enforceLineCap(self: *Self) TextBufferError!void {
+        const max_lines = self.stream_max_lines orelse return;
+        const line_count = self.getLineCount();
+        if (line_count <= max_lines) return;
+
+        const dropped = line_count - max_lines;
+        const first_kept = self.rope.getMarker(.linestart, dropped) orelse return;
+        try self.rope.deletePrefix(first_kept.leaf_index);
+        // Undo history would bring back lines whose pages get recycled below
+        self.rope.clear_history();
+
+        self.moveLineHighlights(dropped, 0);
+        self.markLinesDropped(dropped);
+        self.releaseStreamPages();
+        try self.compactStreamArena();
+    }
+
+    /// Keep highlights on their text across an edit that replaced the lines
+    /// before `old_end` with the lines before `new_end`
+    fn moveLineHighlights(self: *Self, old_end: u32, new_end: u32) void {
+        if (old_end == new_end) return;
+        self.highlights.moveLines(old_end, new_end);
+
+        if (self.dirty_span_lines.count() == 0) return;
+        var shifted = std.AutoHashMap(usize, void).init(self.global_allocator);
+        var it = self.dirty_span_lines.keyIterator();
+        while (it.next()) |line_idx| {
+            if (line_idx.* >= old_end) {
+                shifted.put(line_idx.* - old_end + new_end, {}) catch {};
+            } else if (line_idx.* < new_end) {
+                shifted.put(line_idx.*, {}) catch {};
+            }
+        }
+        self.dirty_span_lines.deinit();
+        self.dirty_span_lines = shifted;
+    }
+
+    /// Pages are filled in order, so every page before the one holding the
+    /// first text still in the rope is unreferenced. One is kept registered
+    /// for reuse; the rest give their mem slots back.
+    fn releaseStreamPages(self: *Self) void {
+        const pages = self.stream_pages.items;
+        if (pages.len <= 1) return;
+
+        var keep_from = pages.len - 1;
+        if (self.firstTextMemId()) |mem_id| {
+            keep_from = for (pages, 0..) |page, i| {
+                if (page.mem_id == mem_id) break i;
+            } else return; // Older non-stream text still leads the buffer
+        }
+        if (keep_from == 0) return;
+
+        for (pages[0..keep_from]) |page| {
+            if (self.stream_spare == null) {
+                self.stream_spare = page;
+            } else {
+                self.mem_registry.unregister(page.mem_id) catch {};
+            }
+        }
+        self.stream_pages.replaceRangeAssumeCapacity(0, keep_from, &.{});
+    }
+
+    fn firstTextMemId(self: *const Self) ?MemId {
+        const Context = struct {
+            mem_id: ?MemId = null,
+
+            fn walker(ctx_ptr: *anyopaque, seg: *const Segment, idx: u32) UnifiedRope.Node.WalkerResult {
+                _ = idx;
+                const ctx = @as(*@This(), @ptrCast(@alignCast(ctx_ptr)));
+                if (seg.asText()) |chunk| {
+                    ctx.mem_id = chunk.mem_id;
+                    return .{ .keep_walking = false };
+                }
+                return .{};
+            }
+        };
+
+        var ctx = Context{};
+        self.rope.walk(&ctx, Context.walker) catch {};
+        return ctx.mem_id;
+    }
+
+    /// Rope edits allocate from the arena and never free, so a capped stream
+    /// would still grow without bound. Once the arena has doubled since the
+    /// last compaction, copy the live segments into a fresh one.
+    fn compactStreamArena(self: *Self) TextBufferError!void {
+        if (self.arena.queryCapacity() < self.stream_compact_at) return;
+
+        const segments = self.rope.slice(0, self.rope.count(), self.global_allocator) catch return TextBufferError.OutOfMemory;
+        defer self.global_allocator.free(segments);
+
+        _ = self.arena.reset(.free_all);
+        self.rope = try UnifiedRope.init(self.allocator);
+        try self.rope.setSegments(segments);
+
+        self.stream_compact_at = @max(self.arena.queryCapacity() * 2, STREAM_COMPACT_MIN);
+        // Pages released since the last compaction may still have cache entries
+        self.chunk_cache.dropStale(&self.mem_registry);
+        self.markAllViewsDirty();
+    }
+
     /// Internal setText that doesn't call clear (for use by setStyledText)
-    fn setTextInternal(self: *Self, mem_id: u8, text: []const u8) TextBufferError!void {
+    fn setTextInternal(self: *Self, mem_id: MemId, text: []const u8) TextBufferError!void {
         if (text.len == 0) {
             self.markAllViewsDirty();
             return;
@@ -387,7 +762,7 @@ pub const UnifiedTextBuffer = struct {
     /// Create a TextChunk from a memory buffer range
     pub fn createChunk(
         self: *const Self,
-        mem_id: u8,
+        mem_id: MemId,
         byte_start: u32,
         byte_end: u32,
     ) TextChunk {
@@ -411,16 +786,135 @@ pub const UnifiedTextBuffer = struct {
         };
     }
 
+    pub const SegmentsResult = struct {
+        segments: std.ArrayListUnmanaged(Segment),
+        total_width: u32,
+        allocator: Allocator,
+    };
+
     /// Convert text to segments with line breaks
     /// Returns segments array and total width
     pub fn textToSegments(
         self: *const Self,
         allocator: Allocator,
         text: []const u8,
-        mem_id: u8,
+        mem_id: MemId,
+        byte_offset: u32,
+        prepend_linestart: bool,
+    ) TextBufferError!SegmentsResult {
+        const parts = self.loadPartCount(text.len);
+        if (parts > 1) {
+            return self.textToSegmentsParallel(allocator, text, mem_id, byte_offset, prepend_linestart, parts);
+        }
+        return self.textToSegmentsSerial(allocator, text, mem_id, byte_offset, prepend_linestart);
+    }
+
+    fn loadPartCount(self: *const Self, len: usize) usize {
+        if (builtin.single_threaded) return 1;
+        const max_parts = len / PARALLEL_LOAD_PART_MIN;
+        if (max_parts < 2) return 1;
+        const threads: usize = if (self.load_threads != 0)
+            self.load_threads
+        else
+            @min(std.Thread.getCpuCount() catch 1, PARALLEL_LOAD_MAX_THREADS);
+        return @min(threads, max_parts);
+    }
+
+    /// A newline-aligned slice of the text analyzed by one worker. Workers
+    /// allocate from their own page-backed arena so the caller's allocator is
+    /// never touched off-thread.
+    const LoadPart = struct {
+        text: []const u8,
+        byte_offset: u32,
+        prepend_linestart: bool,
+        arena: std.heap.ArenaAllocator,
+        segments: []const Segment = &.{},
+        total_width: u32 = 0,
+        err: ?TextBufferError = null,
+    };
+
+    fn analyzeLoadPart(self: *const Self, mem_id: MemId, part: *LoadPart) void {
+        const result = self.textToSegmentsSerial(part.arena.allocator(), part.text, mem_id, part.byte_offset, part.prepend_linestart) catch |err| {
+            part.err = err;
+            return;
+        };
+        part.segments = result.segments.items;
+        part.total_width = result.total_width;
+    }
+
+    /// Split the text after newlines into `part_count` parts, analyze them
+    /// concurrently and stitch the per-part segments in order. Every part but
+    /// the last ends in a line break, so the stitched result is identical to
+    /// the serial one.
+    fn textToSegmentsParallel(
+        self: *const Self,
+        allocator: Allocator,
+        text: []const u8,
+        mem_id: MemId,
+        byte_offset: u32,
+        prepend_linestart: bool,
+        part_count: usize,
+    ) TextBufferError!SegmentsResult {
+        var parts_buf: [PARALLEL_LOAD_MAX_THREADS]LoadPart = undefined;
+        var parts_len: usize = 0;
+        defer for (parts_buf[0..parts_len]) |*part| part.arena.deinit();
+
+        var start: usize = 0;
+        for (0..part_count) |i| {
+            if (start >= text.len) break;
+            var end = text.len;
+            if (i + 1 < part_count) {
+                const target = @max(start, text.len / part_count * (i + 1));
+                if (std.mem.indexOfScalarPos(u8, text, target, '\n')) |nl| end = nl + 1;
+            }
+            parts_buf[parts_len] = .{
+                .text = text[start..end],
+                .byte_offset = byte_offset + @as(u32, @intCast(start)),
+                .prepend_linestart = prepend_linestart and start == 0,
+                .arena = std.heap.ArenaAllocator.init(std.heap.page_allocator),
+            };
+            parts_len += 1;
+            start = end;
+        }
+        const parts = parts_buf[0..parts_len];
+
+        var threads_buf: [PARALLEL_LOAD_MAX_THREADS]?std.Thread = undefined;
+        const threads = threads_buf[0..parts.len];
+        // The calling thread takes the first part; a part whose thread fails
+        // to spawn is analyzed inline
+        for (parts[1..], threads[1..]) |*part, *thread| {
+            thread.* = std.Thread.spawn(.{}, analyzeLoadPart, .{ self, mem_id, part }) catch null;
+            if (thread.* == null) self.analyzeLoadPart(mem_id, part);
+        }
+        self.analyzeLoadPart(mem_id, &parts[0]);
+        for (threads[1..]) |thread| {
+            if (thread) |t| t.join();
+        }
+
+        var total_segments: usize = 0;
+        var total_width: u32 = 0;
+        for (parts) |part| {
+            if (part.err) |err| return err;
+            total_segments += part.segments.len;
+            total_width += part.total_width;
+        }
+
+        var segments = std.ArrayListUnmanaged(Segment).initCapacity(allocator, total_segments) catch return TextBufferError.OutOfMemory;
+        for (parts) |part| {
+            segments.appendSliceAssumeCapacity(part.segments);
+        }
+
+        return .{ .segments = segments, .total_width = total_width, .allocator = allocator };
+    }
+
+    fn textToSegmentsSerial(
+        self: *const Self,
+        allocator: Allocator,
+        text: []const u8,
+        mem_id: MemId,
         byte_offset: u32,
         prepend_linestart: bool,
-    ) TextBufferError!struct { segments: std.ArrayListUnmanaged(Segment), total_width: u32, allocator: Allocator } {
+    ) TextBufferError!SegmentsResult {
         var break_result = utf8.LineBreakResult.init(allocator);
         defer break_result.deinit();
         try utf8.findLineBreaks(text, &break_result);
@@ -474,11 +968,54 @@ pub const UnifiedTextBuffer = struct {
     }
 
     /// Register a memory buffer
-    pub fn registerMemBuffer(self: *Self, data: []const u8, owned: bool) TextBufferError!u8 {
-        return try self.mem_registry.register(data, owned);
+    pub fn registerMemBuffer(self: *Self, data: []const u8, owned: bool) TextBufferError!MemId {
+        return self.mem_registry.register(data, owned) catch |err| {
+            // A full registry may still hold slots nothing refers to anymore
+            if (self.mem_registry.reclaimable_count == 0) return err;
+            _ = try self.reclaimMemBuffers();
+            return try self.mem_registry.register(data, owned);
+        };
+    }
+
+    /// Register a buffer that only rope segments will refer to. Its slot is
+    /// released, and its memory freed if owned, once no segment of the rope or
+    /// its undo history references it.
+    pub fn registerReclaimable(self: *Self, data: []const u8, owned: bool) TextBufferError!MemId {
+        if (self.mem_registry.reclaimable_count >= self.reclaim_at) {
+            _ = self.reclaimMemBuffers() catch 0;
+        }
+        const mem_id = try self.registerMemBuffer(data, owned);
+        self.mem_registry.markReclaimable(mem_id) catch unreachable;
+        return mem_id;
+    }
+
+    /// Release reclaimable mem slots no longer referenced by the rope or its
+    /// undo history. Returns how many were released.
+    pub fn reclaimMemBuffers(self: *Self) TextBufferError!usize {
+        var referenced = std.DynamicBitSetUnmanaged.initEmpty(self.global_allocator, self.mem_registry.getSlotCount()) catch return TextBufferError.OutOfMemory;
+        defer referenced.deinit(self.global_allocator);
+
+        const Context = struct {
+            referenced: *std.DynamicBitSetUnmanaged,
+
+            fn visit(ctx_ptr: *anyopaque, seg: *const Segment) void {
+                const ctx = @as(*@This(), @ptrCast(@alignCast(ctx_ptr)));
+                if (seg.asText()) |chunk| {
+                    if (chunk.mem_id < ctx.referenced.bit_length) ctx.referenced.set(chunk.mem_id);
+                }
+            }
+        };
+
+        var ctx = Context{ .referenced = &referenced };
+        self.rope.walkReachable(self.global_allocator, &ctx, Context.visit) catch return TextBufferError.OutOfMemory;
+
+        const released = self.mem_registry.reclaimUnreferenced(&referenced);
+        if (released > 0) self.chunk_cache.dropStale(&self.mem_registry);
+        self.reclaim_at = @max(RECLAIM_MIN_SLOTS, self.mem_registry.reclaimable_count * 2);
+        return released;
     }
 
-    pub fn getMemBuffer(self: *const Self, mem_id: u8) ?[]const u8 {
+    pub fn getMemBuffer(self: *const Self, mem_id: MemId) ?[]const u8 {
         return self.mem_registry.get(mem_id);
     }
 
@@ -487,7 +1024,7 @@ pub const UnifiedTextBuffer = struct {
     /// Adds text segment with a break separator before it (if not the first line)
     pub fn addLine(
         self: *Self,
-        mem_id: u8,
+        mem_id: MemId,
         byte_start: u32,
         byte_end: u32,
     ) TextBufferError!void {
@@ -507,8 +1044,15 @@ pub const UnifiedTextBuffer = struct {
         self.markAllViewsDirty();
     }
 
+    /// Rope arena capacity plus the chunk metadata cache
     pub fn getArenaAllocatedBytes(self: *const Self) usize {
-        return self.arena.queryCapacity();
+        return self.arena.queryCapacity() + self.chunk_cache.getBytes();
+    }
+
+    /// Cap the chunk metadata cache at `max_bytes`, evicting the chunks least
+    /// recently drawn or wrapped first. Null lets it grow with the buffer.
+    pub fn setChunkCacheLimit(self: *Self, max_bytes: ?usize) void {
+        self.chunk_cache.setMaxBytes(max_bytes);
     }
 
     /// Extract all text as UTF-8 bytes into provided output buffer
@@ -579,15 +1123,6 @@ pub const UnifiedTextBuffer = struct {
     }
 
     // Highlight system
-    fn ensureLineHighlightStorage(self: *Self, line_idx: usize) TextBufferError!void {
-        while (self.line_highlights.items.len <= line_idx) {
-            try self.line_highlights.append(self.global_allocator, .{});
-        }
-        while (self.line_spans.items.len <= line_idx) {
-            try self.line_spans.append(self.global_allocator, .{});
-        }
-    }
-
     pub fn addHighlight(
         self: *Self,
         line_idx: usize,
@@ -606,8 +1141,6 @@ pub const UnifiedTextBuffer = struct {
             return; // Empty range
         }
 
-        try self.ensureLineHighlightStorage(line_idx);
-
         const hl = Highlight{
             .col_start = col_start,
             .col_end = col_end,
@@ -616,7 +1149,7 @@ pub const UnifiedTextBuffer = struct {
             .hl_ref = hl_ref,
         };
 
-        try self.line_highlights.items[line_idx].append(self.global_allocator, hl);
+        try self.highlights.add(@intCast(line_idx), hl);
 
         if (self.highlight_batch_depth == 0) {
             try self.rebuildLineSpans(line_idx);
@@ -626,31 +1159,27 @@ pub const UnifiedTextBuffer = struct {
     }
 
     pub fn getLineHighlights(self: *const Self, line_idx: usize) []const Highlight {
-        if (line_idx < self.line_highlights.items.len) {
-            return self.line_highlights.items[line_idx].items;
-        }
-        return &[_]Highlight{};
+        if (line_idx > std.math.maxInt(u32)) return &[_]Highlight{};
+        return self.highlights.getHighlights(@intCast(line_idx));
     }
 
     pub fn getLineSpans(self: *const Self, line_idx: usize) []const StyleSpan {
-        if (line_idx < self.line_spans.items.len) {
-            return self.line_spans.items[line_idx].items;
-        }
-        return &[_]StyleSpan{};
+        if (line_idx > std.math.maxInt(u32)) return &[_]StyleSpan{};
+        return self.highlights.getSpans(@intCast(line_idx));
     }
 
     fn rebuildLineSpans(self: *Self, line_idx: usize) TextBufferError!void {
-        if (line_idx >= self.line_spans.items.len) {
-            return TextBufferError.InvalidIndex;
-        }
-
-        self.line_spans.items[line_idx].clearRetainingCapacity();
+        const entry = self.highlights.getMut(@intCast(line_idx)) orelse return; // No highlights
+        const line_spans = &entry.spans;
+        line_spans.clearRetainingCapacity();
 
-        if (line_idx >= self.line_highlights.items.len or self.line_highlights.items[line_idx].items.len == 0) {
-            return; // No highlights
+        if (entry.highlights.items.len == 0) {
+            // Everything was removed; drop the line's entry
+            self.highlights.clearLine(@intCast(line_idx));
+            return;
         }
 
-        const highlights = self.line_highlights.items[line_idx].items;
+        const highlights = entry.highlights.items;
 
         // Collect all boundary columns
         const Event = struct {
@@ -699,7 +1228,7 @@ pub const UnifiedTextBuffer = struct {
 
             // Emit span for the segment leading up to this event
             if (event.col > current_col) {
-                try self.line_spans.items[line_idx].append(self.global_allocator, StyleSpan{
+                try line_spans.append(self.global_allocator, StyleSpan{
                     .col = current_col,
                     .style_id = current_style,
                     .next_col = event.col,
@@ -720,7 +1249,7 @@ pub const UnifiedTextBuffer = struct {
         if (events.items.len > 0 and active.count() == 0) {
             const line_width = iter_mod.lineWidthAt(&self.rope, @intCast(line_idx));
             if (current_col < line_width) {
-                try self.line_spans.items[line_idx].append(self.global_allocator, StyleSpan{
+                try line_spans.append(self.global_allocator, StyleSpan{
                     .col = current_col,
                     .style_id = 0, // No style (default)
                     .next_col = line_width,
@@ -812,64 +1341,215 @@ pub const UnifiedTextBuffer = struct {
         iter_mod.walkLines(&self.rope, &ctx, Context.callback, false);
     }
 
-    /// Remove all highlights with a specific reference ID
-    pub fn removeHighlightsByRef(self: *Self, hl_ref: u16) void {
-        for (self.line_highlights.items, 0..) |*hl_list, line_idx| {
-            var i: usize = 0;
-            var changed = false;
-            while (i < hl_list.items.len) {
-                if (hl_list.items[i].hl_ref == hl_ref) {
-                    _ = hl_list.orderedRemove(i);
-                    changed = true;
+    /// Replace the highlights of lines [start_line, end_line) with `highlights`,
+    /// given as char ranges and sorted in place. Touching ranges with the same
+    /// style, priority and ref are merged, each range is located with a binary
+    /// search over line starts, and every affected line's spans are rebuilt
+    /// once at the end. Parts of ranges outside the line range are dropped.
+    pub fn setHighlightsInLineRange(
+        self: *Self,
+        start_line: u32,
+        end_line: u32,
+        highlights: []CharRangeHighlight,
+    ) TextBufferError!void {
+        const line_count = self.getLineCount();
+        const end = @min(end_line, line_count);
+        if (start_line >= end) return;
+
+        self.startHighlightsTransaction();
+        defer self.endHighlightsTransaction();
+
+        self.highlights.clearLines(start_line, end);
+
+        std.mem.sort(CharRangeHighlight, highlights, {}, struct {
+            fn lessThan(_: void, a: CharRangeHighlight, b: CharRangeHighlight) bool {
+                return a.char_start < b.char_start;
+            }
+        }.lessThan);
+
+        var pending: ?CharRangeHighlight = null;
+        for (highlights) |hl| {
+            if (hl.char_start >= hl.char_end) continue;
+            if (pending) |*prev| {
+                if (hl.char_start <= prev.char_end and hl.style_id == prev.style_id and
+                    hl.priority == prev.priority and hl.hl_ref == prev.hl_ref)
+                {
+                    prev.char_end = @max(prev.char_end, hl.char_end);
                     continue;
                 }
-                i += 1;
+                try self.addCharRangeToLines(prev.*, start_line, end);
             }
-            if (changed) {
-                if (self.highlight_batch_depth == 0) {
-                    self.rebuildLineSpans(line_idx) catch {};
-                } else {
-                    self.markLineSpansDirty(line_idx);
-                }
+            pending = hl;
+        }
+        if (pending) |last| try self.addCharRangeToLines(last, start_line, end);
+    }
+
+    /// setHighlightsInLineRange with char_start/char_end given as UTF-8 byte
+    /// offsets from the start of start_line, each line break counting as one
+    /// byte. Callers holding the source string can compute these without
+    /// knowing the buffer's tab width or width method; they are measured here
+    /// against the stored text and converted in place.
+    pub fn setHighlightsInLineRangeByBytes(
+        self: *Self,
+        start_line: u32,
+        end_line: u32,
+        highlights: []CharRangeHighlight,
+    ) TextBufferError!void {
+        const end = @min(end_line, self.getLineCount());
+        if (start_line >= end) return;
+
+        const ByteLine = struct {
+            byte_start: u32,
+            byte_len: u32,
+            char_start: u32,
+            chunk_start: u32,
+            chunk_end: u32,
+        };
+
+        var lines: std.ArrayListUnmanaged(ByteLine) = .{};
+        defer lines.deinit(self.global_allocator);
+        var chunks: std.ArrayListUnmanaged(TextChunk) = .{};
+        defer chunks.deinit(self.global_allocator);
+
+        const Context = struct {
+            buffer: *Self,
+            lines: *std.ArrayListUnmanaged(ByteLine),
+            chunks: *std.ArrayListUnmanaged(TextChunk),
+            byte_offset: u32 = 0,
+            line_bytes: u32 = 0,
+            failed: bool = false,
+
+            fn segment(ctx_ptr: *anyopaque, line_idx: u32, chunk: *const TextChunk, chunk_idx_in_line: u32) void {
+                _ = line_idx;
+                _ = chunk_idx_in_line;
+                const ctx = @as(*@This(), @ptrCast(@alignCast(ctx_ptr)));
+                ctx.chunks.append(ctx.buffer.global_allocator, chunk.*) catch {
+                    ctx.failed = true;
+                };
+                ctx.line_bytes += chunk.byte_end - chunk.byte_start;
+            }
+
+            fn lineEnd(ctx_ptr: *anyopaque, line_info: LineInfo) void {
+                const ctx = @as(*@This(), @ptrCast(@alignCast(ctx_ptr)));
+                const chunk_start = if (ctx.lines.items.len > 0) ctx.lines.items[ctx.lines.items.len - 1].chunk_end else 0;
+                ctx.lines.append(ctx.buffer.global_allocator, .{
+                    .byte_start = ctx.byte_offset,
+                    .byte_len = ctx.line_bytes,
+                    .char_start = ctx.buffer.lineCharStart(line_info.line_idx),
+                    .chunk_start = chunk_start,
+                    .chunk_end = @intCast(ctx.chunks.items.len),
+                }) catch {
+                    ctx.failed = true;
+                };
+                ctx.byte_offset += ctx.line_bytes + 1;
+                ctx.line_bytes = 0;
             }
+        };
+
+        var ctx = Context{ .buffer = self, .lines = &lines, .chunks = &chunks };
+        iter_mod.walkLinesAndSegmentsInRange(&self.rope, start_line, end, &ctx, Context.segment, Context.lineEnd);
+        if (ctx.failed) return TextBufferError.OutOfMemory;
+        if (lines.items.len == 0) return;
+
+        for (highlights) |*hl| {
+            hl.char_start = self.byteToCharOffset(lines.items, chunks.items, hl.char_start);
+            hl.char_end = self.byteToCharOffset(lines.items, chunks.items, hl.char_end);
         }
+        try self.setHighlightsInLineRange(start_line, end, highlights);
     }
 
-    /// Clear all highlights from a specific line
-    pub fn clearLineHighlights(self: *Self, line_idx: usize) void {
-        if (line_idx < self.line_highlights.items.len) {
-            self.line_highlights.items[line_idx].clearRetainingCapacity();
+    fn byteToCharOffset(self: *const Self, lines: anytype, chunks: []const TextChunk, byte_offset: u32) u32 {
+        // Last line starting at or before the offset
+        var lo: usize = 0;
+        var hi: usize = lines.len;
+        while (hi - lo > 1) {
+            const mid = lo + (hi - lo) / 2;
+            if (lines[mid].byte_start <= byte_offset) lo = mid else hi = mid;
         }
-        if (line_idx < self.line_spans.items.len) {
-            self.line_spans.items[line_idx].clearRetainingCapacity();
+
+        const line = lines[lo];
+        var remaining = @min(byte_offset -| line.byte_start, line.byte_len);
+        var col: u32 = 0;
+        for (chunks[line.chunk_start..line.chunk_end]) |*chunk| {
+            const len = chunk.byte_end - chunk.byte_start;
+            if (remaining >= len) {
+                col += chunk.width;
+                remaining -= len;
+                continue;
+            }
+            if (remaining > 0) col += self.measureText(chunk.getBytes(&self.mem_registry)[0..remaining]);
+            break;
         }
+        return line.char_start + col;
     }
 
-    /// Clear all highlights
-    pub fn clearAllHighlights(self: *Self) void {
-        for (self.line_highlights.items) |*hl_list| {
-            hl_list.clearRetainingCapacity();
+    fn lineCharStart(self: *Self, row: u32) u32 {
+        const marker = self.rope.getMarker(.linestart, row) orelse return 0;
+        // Line `row` has `row` newlines before it
+        return marker.global_weight - row;
+    }
+
+    fn addCharRangeToLines(self: *Self, hl: CharRangeHighlight, start_line: u32, end_line: u32) TextBufferError!void {
+        // Last line starting at or before the range
+        var lo: u32 = start_line;
+        var hi: u32 = end_line;
+        while (hi - lo > 1) {
+            const mid = lo + (hi - lo) / 2;
+            if (self.lineCharStart(mid) <= hl.char_start) lo = mid else hi = mid;
+        }
+
+        var row = lo;
+        while (row < end_line) : (row += 1) {
+            const line_start = self.lineCharStart(row);
+            if (line_start >= hl.char_end) break;
+            const line_end = line_start + iter_mod.lineWidthAt(&self.rope, row);
+            if (line_end <= hl.char_start) continue;
+
+            try self.addHighlight(
+                row,
+                @max(hl.char_start, line_start) - line_start,
+                @min(hl.char_end, line_end) - line_start,
+                hl.style_id,
+                hl.priority,
+                hl.hl_ref,
+            );
         }
-        for (self.line_spans.items) |*span_list| {
-            span_list.clearRetainingCapacity();
+    }
+
+    /// Remove all highlights with a specific reference ID
+    pub fn removeHighlightsByRef(self: *Self, hl_ref: u16) void {
+        var affected: std.ArrayListUnmanaged(u32) = .{};
+        defer affected.deinit(self.global_allocator);
+        self.highlights.removeByRef(hl_ref, &affected, self.global_allocator) catch return;
+
+        for (affected.items) |line_idx| {
+            if (self.highlight_batch_depth == 0) {
+                self.rebuildLineSpans(line_idx) catch {};
+            } else {
+                self.markLineSpansDirty(line_idx);
+            }
         }
     }
 
+    /// Clear all highlights from a specific line
+    pub fn clearLineHighlights(self: *Self, line_idx: usize) void {
+        if (line_idx > std.math.maxInt(u32)) return;
+        self.highlights.clearLine(@intCast(line_idx));
+    }
+
+    /// Clear all highlights
+    pub fn clearAllHighlights(self: *Self) void {
+        self.highlights.clear();
+    }
+
     /// Get highlights for a specific line
     pub fn getLineHighlightsSlice(self: *const Self, line_idx: usize) []const Highlight {
-        if (line_idx < self.line_highlights.items.len) {
-            return self.line_highlights.items[line_idx].items;
-        }
-        return &[_]Highlight{};
+        return self.getLineHighlights(line_idx);
     }
 
     /// Get total number of highlights across all lines
     pub fn getHighlightCount(self: *const Self) u32 {
-        var count: u32 = 0;
-        for (self.line_highlights.items) |hl_list| {
-            count += @intCast(hl_list.items.len);
-        }
-        return count;
+        return self.highlights.getHighlightCount();
     }
 
     /// Set styled text from chunks with individual styling
@@ -958,8 +1638,14 @@ pub const UnifiedTextBuffer = struct {
         }
     }
 
-    /// Load text from a file path (relative to cwd)
-    /// The file content is allocated in the arena and will be freed when the buffer is destroyed
+    /// Files at least this large are memory-mapped instead of copied
+    const MMAP_MIN_FILE_SIZE: u64 = 64 * 1024;
+
+    /// Load a file (path relative to cwd) as the buffer content. Small files are
+    /// read into a buffer the mem registry owns. Large files are memory-mapped
+    /// read-only and registered without copying, so their pages live in the shared
+    /// page cache and are unmapped on reset() or deinit(). Truncating a mapped file
+    /// while it is loaded is undefined behavior (SIGBUS), like any mmap reader.
     pub fn loadFile(self: *Self, path: []const u8) TextBufferError!void {
         const file = std.fs.cwd().openFile(path, .{}) catch |err| {
             return switch (err) {
@@ -974,14 +1660,52 @@ pub const UnifiedTextBuffer = struct {
 
         self.clear();
 
-        const content = self.allocator.alloc(u8, file_size) catch return TextBufferError.OutOfMemory;
-        const bytes_read = file.readAll(content) catch return TextBufferError.OutOfMemory;
-        const text = content[0..bytes_read];
-        const mem_id = try self.mem_registry.register(text, false);
+        if (comptime builtin.os.tag != .windows) {
+            if (file_size >= MMAP_MIN_FILE_SIZE) {
+                if (self.mapFile(file, file_size)) |mapped| {
+                    // The load scans front to back for line breaks; views later touch
+                    // pages in any order, so go back to normal paging afterwards.
+                    defer std.posix.madvise(mapped.region.ptr, mapped.region.len, std.posix.MADV.NORMAL) catch {};
+                    try self.setTextInternal(mapped.mem_id, mapped.region);
+                    return;
+                }
+                // Fall back to reading when the file can't be mapped (pipes, procfs, ...)
+            }
+        }
+
+        const content = self.global_allocator.alloc(u8, file_size) catch return TextBufferError.OutOfMemory;
+        const bytes_read = file.readAll(content) catch {
+            self.global_allocator.free(content);
+            return TextBufferError.OutOfMemory;
+        };
+        const text = self.global_allocator.realloc(content, bytes_read) catch content[0..bytes_read];
+        const mem_id = self.registerReclaimable(text, true) catch |err| {
+            self.global_allocator.free(text);
+            return err;
+        };
 
         try self.setTextInternal(mem_id, text);
     }
 
+    const MappedFile = struct {
+        mem_id: MemId,
+        region: []align(std.heap.page_size_min) u8,
+    };
+
+    fn mapFile(self: *Self, file: std.fs.File, file_size: u64) ?MappedFile {
+        const size = std.math.cast(usize, file_size) orelse return null;
+        const region = std.posix.mmap(null, size, std.posix.PROT.READ, .{ .TYPE = .PRIVATE }, file.handle, 0) catch return null;
+
+        const mem_id = self.mem_registry.registerMapped(region) catch {
+            std.posix.munmap(region);
+            return null;
+        };
+        self.mem_registry.markReclaimable(mem_id) catch unreachable;
+
+        std.posix.madvise(region.ptr, region.len, std.posix.MADV.SEQUENTIAL) catch {};
+        return .{ .mem_id = mem_id, .region = region };
+    }
+
     pub fn getTabWidth(self: *const Self) u8 {
         return self.tab_width;
     }
@@ -994,6 +1718,8 @@ pub const UnifiedTextBuffer = struct {
         const new_width = if (clamped_width % 2 == 0) clamped_width else clamped_width + 1;
         if (self.tab_width == new_width) return;
         self.tab_width = new_width;
+        // Cached grapheme columns include tab widths
+        self.chunk_cache.clearGraphemes();
         self.markAllViewsDirty();
     }
 
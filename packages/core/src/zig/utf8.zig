@@ -1,6 +1,10 @@
 const std = @import("std");
 const uucode = @import("uucode");
 
+/// Byte vector width for the scanning kernels: 32 with AVX2, 64 with AVX-512,
+/// 16 on SSE2/NEON targets
+const simd_len = std.simd.suggestVectorLength(u8) orelse 16;
+
 /// The method to use when calculating the width of a grapheme
 pub const WidthMethod = enum {
     wcwidth,
@@ -9,11 +13,11 @@ pub const WidthMethod = enum {
 };
 
 /// Check if a byte slice contains only printable ASCII (32..126)
-/// Uses SIMD16 for fast checking
+/// Uses target-width SIMD for fast checking
 pub fn isAsciiOnly(text: []const u8) bool {
     if (text.len == 0) return false;
 
-    const vector_len = 16;
+    const vector_len = simd_len;
     const Vec = @Vector(vector_len, u8);
 
     const min_printable: Vec = @splat(32);
@@ -21,7 +25,7 @@ pub fn isAsciiOnly(text: []const u8) bool {
 
     var pos: usize = 0;
 
-    // Process full 16-byte vectors
+    // Process full vectors
     while (pos + vector_len <= text.len) {
         const chunk: Vec = text[pos..][0..vector_len].*;
 
@@ -352,7 +356,7 @@ pub fn findWrapBreaks(text: []const u8, result: *WrapBreakResult, width_method:
 
 pub fn findTabStops(text: []const u8, result: *TabStopResult) !void {
     result.reset();
-    const vector_len = 16;
+    const vector_len = simd_len;
     const Vec = @Vector(vector_len, u8);
 
     const vTab: Vec = @splat('\t');
@@ -383,7 +387,7 @@ pub fn findTabStops(text: []const u8, result: *TabStopResult) !void {
 
 pub fn findLineBreaks(text: []const u8, result: *LineBreakResult) !void {
     result.reset();
-    const vector_len = 16; // Use 16-byte vectors (SSE2/NEON compatible)
+    const vector_len = simd_len;
     const Vec = @Vector(vector_len, u8);
 
     // Prepare vector constants for '\n' and '\r'
@@ -698,6 +702,201 @@ inline fn eastAsianWidth(cp: u21) u32 {
     return 1;
 }
 
+/// Two-level codepoint width table built once from eastAsianWidth.
+/// `blocks` maps each 256-codepoint block to one of the distinct block patterns
+/// in `pages`, which pack four 2-bit widths per byte. Codepoints from
+/// WIDTH_LUT_END on are rare and classified directly.
+const WIDTH_LUT_END: u21 = 0x40000;
+const WIDTH_BLOCK_BITS = 8;
+const WIDTH_BLOCK_SIZE = 1 << WIDTH_BLOCK_BITS;
+const WIDTH_BLOCK_COUNT = WIDTH_LUT_END >> WIDTH_BLOCK_BITS;
+const WIDTH_PAGE_BYTES = WIDTH_BLOCK_SIZE / 4;
+/// Block index meaning "not tabled"; only reached if the data ever has more
+/// than 255 distinct blocks
+const WIDTH_PAGE_NONE: u8 = 0xFF;
+
+const WidthLut = struct {
+    blocks: [WIDTH_BLOCK_COUNT]u8,
+    pages: [WIDTH_PAGE_NONE][WIDTH_PAGE_BYTES]u8,
+    page_count: usize,
+};
+
+var width_lut: WidthLut = undefined;
+var width_lut_once = std.once(buildWidthLut);
+
+fn buildWidthLut() void {
+    width_lut.page_count = 0;
+    for (0..WIDTH_BLOCK_COUNT) |block| {
+        var page = [_]u8{0} ** WIDTH_PAGE_BYTES;
+        const base: u21 = @intCast(block << WIDTH_BLOCK_BITS);
+        for (0..WIDTH_BLOCK_SIZE) |i| {
+            const w: u8 = @intCast(eastAsianWidth(base + @as(u21, @intCast(i))));
+            page[i >> 2] |= w << @intCast((i & 3) * 2);
+        }
+
+        width_lut.blocks[block] = for (width_lut.pages[0..width_lut.page_count], 0..) |*existing, idx| {
+            if (std.mem.eql(u8, existing, &page)) break @intCast(idx);
+        } else if (width_lut.page_count < WIDTH_PAGE_NONE) blk: {
+            width_lut.pages[width_lut.page_count] = page;
+            width_lut.page_count += 1;
+            break :blk @intCast(width_lut.page_count - 1);
+        } else WIDTH_PAGE_NONE;
+    }
+}
+
+/// Display width of a non-ASCII codepoint (0, 1 or 2) via the width table
+pub inline fn codepointWidth(cp: u21) u32 {
+    if (cp >= WIDTH_LUT_END) return eastAsianWidth(cp);
+    width_lut_once.call();
+    const page = width_lut.blocks[cp >> WIDTH_BLOCK_BITS];
+    if (page == WIDTH_PAGE_NONE) return eastAsianWidth(cp);
+    const low = cp & (WIDTH_BLOCK_SIZE - 1);
+    const shift: u3 = @intCast((low & 3) * 2);
+    return (width_lut.pages[page][low >> 2] >> shift) & 0b11;
+}
+
+/// A run of codepoints that each form a grapheme cluster of their own and
+/// share one width, as found by the vector kernels below
+const SimpleRun = struct {
+    count: usize,
+    bytes: usize,
+    width: u32,
+};
+
+/// Codepoints the run kernels accept: every one is a grapheme cluster by itself
+/// whatever surrounds it (no Extend/ZWJ/SpacingMark, Prepend, Hangul jamo,
+/// Extended_Pictographic or Indic consonants), so the break before and after
+/// it is certain unless the neighbor extends it
+inline fn isSimpleTwoByte(cp: u32) bool {
+    return (cp >= 0x00A0 and cp <= 0x02FF and cp != 0x00A9 and cp != 0x00AD and cp != 0x00AE) or // Latin-1, Latin Extended, IPA, modifiers
+        (cp >= 0x0370 and cp <= 0x0482) or // Greek, Cyrillic
+        (cp >= 0x048A and cp <= 0x052F); // Cyrillic (after combining marks), Cyrillic Supplement
+}
+
+inline fn isSimpleThreeByte(cp: u32) bool {
+    return (cp >= 0x4E00 and cp <= 0x9FFF) or // CJK Unified Ideographs
+        (cp >= 0xAC00 and cp <= 0xD7A3); // Hangul Syllables (LV/LVT never join each other)
+}
+
+/// Whether the grapheme break between `cp` and a following simple codepoint is
+/// certain: ASCII and simple codepoints are never Prepend or Hangul L jamo
+inline fn breaksBeforeSimple(cp: u21) bool {
+    if (cp < 0x80) return true;
+    return if (cp < 0x800) isSimpleTwoByte(cp) else isSimpleThreeByte(cp);
+}
+
+/// Build a @shuffle mask picking byte `offset` of every `stride`-byte sequence
+fn sequenceMask(comptime lanes: usize, comptime stride: usize, comptime offset: usize) [lanes]i32 {
+    var mask: [lanes]i32 = undefined;
+    for (0..lanes) |i| mask[i] = @intCast(i * stride + offset);
+    return mask;
+}
+
+inline fn laneBits(comptime lanes: usize, v: @Vector(lanes, bool)) std.meta.Int(.unsigned, lanes) {
+    return @bitCast(v);
+}
+
+/// Lanes of `cp` that fall in [lo, hi]
+inline fn inRange(comptime lanes: usize, cp: @Vector(lanes, u32), lo: u32, hi: u32) std.meta.Int(.unsigned, lanes) {
+    const Cps = @Vector(lanes, u32);
+    return laneBits(lanes, cp >= @as(Cps, @splat(lo))) & laneBits(lanes, cp <= @as(Cps, @splat(hi)));
+}
+
+/// Count the leading 2-byte sequences of `text` that decode to simple
+/// codepoints (all width 1), simd_len bytes at a time
+fn simpleTwoByteRun(text: []const u8) SimpleRun {
+    const lanes = simd_len / 2;
+    const stride = lanes * 2;
+    const Bytes = @Vector(lanes, u8);
+    const Cps = @Vector(lanes, u32);
+    const Mask = std.meta.Int(.unsigned, lanes);
+    const lead_mask = comptime sequenceMask(lanes, 2, 0);
+    const cont_mask = comptime sequenceMask(lanes, 2, 1);
+    const shift6: @Vector(lanes, u5) = @splat(6);
+
+    var count: usize = 0;
+    var pos: usize = 0;
+    while (pos + stride <= text.len) {
+        const chunk: @Vector(stride, u8) = text[pos..][0..stride].*;
+        const b0: Bytes = @shuffle(u8, chunk, undefined, lead_mask);
+        const b1: Bytes = @shuffle(u8, chunk, undefined, cont_mask);
+
+        const is_lead = laneBits(lanes, (b0 & @as(Bytes, @splat(0xE0))) == @as(Bytes, @splat(0xC0)));
+        const is_cont = laneBits(lanes, (b1 & @as(Bytes, @splat(0xC0))) == @as(Bytes, @splat(0x80)));
+
+        const cp = (@as(Cps, @intCast(b0 & @as(Bytes, @splat(0x1F)))) << shift6) |
+            @as(Cps, @intCast(b1 & @as(Bytes, @splat(0x3F))));
+        const excluded = laneBits(lanes, cp == @as(Cps, @splat(0x00A9))) |
+            laneBits(lanes, cp == @as(Cps, @splat(0x00AD))) |
+            laneBits(lanes, cp == @as(Cps, @splat(0x00AE)));
+        const simple = (inRange(lanes, cp, 0x00A0, 0x02FF) & ~excluded) |
+            inRange(lanes, cp, 0x0370, 0x0482) |
+            inRange(lanes, cp, 0x048A, 0x052F);
+
+        const ok: Mask = is_lead & is_cont & simple;
+        if (ok != std.math.maxInt(Mask)) {
+            count += @ctz(~ok);
+            break;
+        }
+        count += lanes;
+        pos += stride;
+    }
+
+    return .{ .count = count, .bytes = count * 2, .width = 1 };
+}
+
+/// Count the leading 3-byte sequences of `text` that decode to CJK ideographs
+/// or Hangul syllables (all width 2), simd_len bytes at a time
+fn simpleThreeByteRun(text: []const u8) SimpleRun {
+    const lanes = simd_len / 3;
+    const stride = lanes * 3;
+    const Bytes = @Vector(lanes, u8);
+    const Cps = @Vector(lanes, u32);
+    const Mask = std.meta.Int(.unsigned, lanes);
+    const lead_mask = comptime sequenceMask(lanes, 3, 0);
+    const mid_mask = comptime sequenceMask(lanes, 3, 1);
+    const last_mask = comptime sequenceMask(lanes, 3, 2);
+    const shift6: @Vector(lanes, u5) = @splat(6);
+    const shift12: @Vector(lanes, u5) = @splat(12);
+    const cont_bits: Bytes = @splat(0xC0);
+    const cont_tag: Bytes = @splat(0x80);
+
+    var count: usize = 0;
+    var pos: usize = 0;
+    while (pos + stride <= text.len) {
+        const chunk: @Vector(stride, u8) = text[pos..][0..stride].*;
+        const b0: Bytes = @shuffle(u8, chunk, undefined, lead_mask);
+        const b1: Bytes = @shuffle(u8, chunk, undefined, mid_mask);
+        const b2: Bytes = @shuffle(u8, chunk, undefined, last_mask);
+
+        const is_lead = laneBits(lanes, (b0 & @as(Bytes, @splat(0xF0))) == @as(Bytes, @splat(0xE0)));
+        const is_cont = laneBits(lanes, (b1 & cont_bits) == cont_tag) & laneBits(lanes, (b2 & cont_bits) == cont_tag);
+
+        const cp = (@as(Cps, @intCast(b0 & @as(Bytes, @splat(0x0F)))) << shift12) |
+            (@as(Cps, @intCast(b1 & @as(Bytes, @splat(0x3F)))) << shift6) |
+            @as(Cps, @intCast(b2 & @as(Bytes, @splat(0x3F))));
+        const simple = inRange(lanes, cp, 0x4E00, 0x9FFF) | inRange(lanes, cp, 0xAC00, 0xD7A3);
+
+        const ok: Mask = is_lead & is_cont & simple;
+        if (ok != std.math.maxInt(Mask)) {
+            count += @ctz(~ok);
+            break;
+        }
+        count += lanes;
+        pos += stride;
+    }
+
+    return .{ .count = count, .bytes = count * 3, .width = 2 };
+}
+
+/// Run the kernel matching the lead byte at the start of `text`
+inline fn simpleRun(text: []const u8) SimpleRun {
+    const b0 = text[0];
+    if ((b0 & 0xE0) == 0xC0) return simpleTwoByteRun(text);
+    if ((b0 & 0xF0) == 0xE0) return simpleThreeByteRun(text);
+    return .{ .count = 0, .bytes = 0, .width = 0 };
+}
+
 /// Calculate the display width of a byte in columns
 /// Used for ASCII-only fast paths
 inline fn asciiCharWidth(byte: u8, tab_width: u8) u32 {
@@ -716,7 +915,7 @@ inline fn charWidth(byte: u8, codepoint: u21, tab_width: u8) u32 {
     } else if (byte < 0x80 and byte >= 32 and byte <= 126) {
         return 1;
     } else if (byte >= 0x80) {
-        return eastAsianWidth(codepoint);
+        return codepointWidth(codepoint);
     }
     return 0;
 }
@@ -1618,6 +1817,23 @@ fn calculateTextWidthUnicode(text: []const u8, tab_width: u8, isASCIIOnly: bool,
 
     while (pos < text.len) {
         const b0 = text[pos];
+
+        // A run of simple codepoints after a certain break needs no per-codepoint
+        // segmentation: each one closes the cluster before it. The last one
+        // stays open in case the codepoint after the run extends it.
+        if (b0 >= 0xC0 and prev_cp != null and breaksBeforeSimple(prev_cp.?)) {
+            const run = simpleRun(text[pos..]);
+            if (run.count > 0) {
+                total_width += state.width + run.width * @as(u32, @intCast(run.count - 1));
+                const last = decodeUtf8Unchecked(text, pos + run.bytes - run.bytes / run.count);
+                state = GraphemeWidthState.init(last.cp, run.width, width_method);
+                prev_cp = last.cp;
+                break_state = .default;
+                pos += run.bytes;
+                continue;
+            }
+        }
+
         const curr_cp: u21 = if (b0 < 0x80) b0 else blk: {
             const dec = decodeUtf8Unchecked(text, pos);
             if (pos + dec.len > text.len) break :blk 0xFFFD;
@@ -1668,6 +1884,16 @@ fn calculateTextWidthWCWidth(text: []const u8, tab_width: u8, isASCIIOnly: bool)
 
     while (pos < text.len) {
         const b0 = text[pos];
+
+        if (b0 >= 0xC0) {
+            const run = simpleRun(text[pos..]);
+            if (run.count > 0) {
+                total_width += run.width * @as(u32, @intCast(run.count));
+                pos += run.bytes;
+                continue;
+            }
+        }
+
         const curr_cp: u21 = if (b0 < 0x80) b0 else blk: {
             const dec = decodeUtf8Unchecked(text, pos);
             if (pos + dec.len > text.len) break :blk 0xFFFD;